@@ -1278,6 +1278,43 @@ slurm_load_jobs(slurm_t self, time_t update_time=0, uint16_t show_flags=0)
 	OUTPUT:
 		RETVAL
 
+#
+# $resp = $slurm->load_jobs_query($query);
+#
+HV *
+slurm_load_jobs_query(slurm_t self, HV *query)
+	PREINIT:
+		job_info_query_t ji_query;
+		job_info_msg_t *ji_msg;
+		int rc;
+	CODE:
+		if (self); /* this is needed to avoid a warning about
+			      unused variables.  But if we take slurm_t self
+			      out of the mix Slurm-> doesn't work,
+			      only Slurm::
+			    */
+		if (hv_to_job_info_query(query, &ji_query) < 0) {
+			XSRETURN_UNDEF;
+		}
+		rc = slurm_load_jobs_query(&ji_query, &ji_msg);
+		free_job_info_query(&ji_query);
+		if (rc == SLURM_SUCCESS) {
+			RETVAL = newHV();
+			sv_2mortal((SV*)RETVAL);
+			rc = job_info_msg_to_hv(ji_msg, RETVAL);
+			/* cannot free ji_msg because RETVAL holds data in it */
+			if (rc >= 0) {
+				hv_store_ptr(RETVAL, "job_info_msg", ji_msg, "Slurm::job_info_msg_t");
+			}
+			if (rc < 0) {
+				XSRETURN_UNDEF;
+			}
+		} else {
+			XSRETURN_UNDEF;
+		}
+	OUTPUT:
+		RETVAL
+
 int
 slurm_notify_job(slurm_t self, uint32_t job_id, char *message)
 	INIT:
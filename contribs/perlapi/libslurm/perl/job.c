@@ -510,3 +510,72 @@ hv_to_job_info_msg(HV *hv, job_info_msg_t *job_info_msg)
 	}
 	return 0;
 }
+
+/*
+ * convert perl array reference of unsigned integers to uint32_t array
+ */
+static int
+_av_to_uint32_array(HV *hv, const char *key, uint32_t **array, uint32_t *cnt)
+{
+	SV **svp;
+	AV *av;
+	int i, n;
+
+	*array = NULL;
+	*cnt = 0;
+	if (! (svp = hv_fetch(hv, key, strlen(key), FALSE)))
+		return 0;
+	if (! (SvROK(*svp) && SvTYPE(SvRV(*svp)) == SVt_PVAV)) {
+		Perl_warn(aTHX_ "%s is not an array reference in HV for job_info_query_t", key);
+		return -1;
+	}
+	av = (AV*)SvRV(*svp);
+	n = av_len(av) + 1;
+	if (n <= 0)
+		return 0;
+	*array = xmalloc(n * sizeof(uint32_t));
+	for (i = 0; i < n; i ++) {
+		if (! (svp = av_fetch(av, i, FALSE))) {
+			Perl_warn(aTHX_ "error fetching element %d of %s", i, key);
+			xfree(*array);
+			return -1;
+		}
+		(*array)[i] = (uint32_t)SvUV(*svp);
+	}
+	*cnt = n;
+	return 0;
+}
+
+/*
+ * convert perl HV to job_info_query_t
+ * free the arrays with free_job_info_query() afterwards
+ */
+int
+hv_to_job_info_query(HV *hv, job_info_query_t *query)
+{
+	memset(query, 0, sizeof(job_info_query_t));
+	query->fields = JOB_FIELD_ALL;
+
+	FETCH_FIELD(hv, query, accounts, charp, FALSE);
+	FETCH_FIELD(hv, query, fields, uint32_t, FALSE);
+	FETCH_FIELD(hv, query, partitions, charp, FALSE);
+	FETCH_FIELD(hv, query, show_flags, uint16_t, FALSE);
+	if (_av_to_uint32_array(hv, "job_ids", &query->job_ids,
+				&query->job_id_cnt) < 0 ||
+	    _av_to_uint32_array(hv, "states", &query->states,
+				&query->state_cnt) < 0 ||
+	    _av_to_uint32_array(hv, "user_ids", &query->user_ids,
+				&query->user_id_cnt) < 0) {
+		free_job_info_query(query);
+		return -1;
+	}
+	return 0;
+}
+
+void
+free_job_info_query(job_info_query_t *query)
+{
+	xfree(query->job_ids);
+	xfree(query->states);
+	xfree(query->user_ids);
+}
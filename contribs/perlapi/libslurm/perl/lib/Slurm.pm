@@ -824,6 +824,18 @@ Issue RPC to get all SLURM job information if changed.
 
 =back    
 
+=head3 $resp = $slurm->load_jobs_query($query);
+
+Issue RPC to get the SLURM job information matching a query. Only the field groups requested are filled in.
+
+=over 2    
+
+=item * IN $query: query, with structure of C<job_info_query_t>. Lists of job ids, states and user ids are array references. C<fields> defaults to JOB_FIELD_ALL.
+    
+=item * RET: job information, with structure of C<job_info_msg_t>. On failure C<undef> is returned with errno set.
+
+=back    
+
 =head3 $rc = $slurm->notify_job($job_id, $message);
 
 Send message to the job's stdout, usable only by user root.
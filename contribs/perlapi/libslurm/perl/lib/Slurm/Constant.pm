@@ -228,6 +228,24 @@ This package export constants for use with Slurm. This includes enumerations and
 
 =back
 
+=head3 fields of slurm_load_jobs_query function call
+
+=over 2
+
+=item * JOB_FIELD_NODES      0x00000001
+
+=item * JOB_FIELD_TEXT       0x00000002
+
+=item * JOB_FIELD_DETAILS    0x00000004
+
+=item * JOB_FIELD_TRES       0x00000008
+
+=item * JOB_FIELD_FED        0x00000010
+
+=item * JOB_FIELD_ALL        0xffffffff
+
+=back
+
 =head3 Consumerable resources parameters
 
 =over 2
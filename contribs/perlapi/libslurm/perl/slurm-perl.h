@@ -63,6 +63,8 @@ extern int job_info_to_hv(job_info_t *job_info, HV *hv);
 extern int job_info_msg_to_hv(job_info_msg_t *job_info_msg, HV *hv);
 extern int hv_to_job_info(HV *hv, job_info_t *job_info);
 extern int hv_to_job_info_msg(HV *hv, job_info_msg_t *job_info_msg);
+extern int hv_to_job_info_query(HV *hv, job_info_query_t *query);
+extern void free_job_info_query(job_info_query_t *query);
 
 /********** step info conversion functions **********/
 extern int job_step_info_to_hv(job_step_info_t *step_info, HV *hv);
@@ -37,6 +37,7 @@
 #include <src/common/assoc_mgr.h>
 #include <src/common/slurm_sim.h>
 #include "src/common/sim_funcs.h"
+#include "src/common/sim_profile.h"
 //#include "src/unittests_lib/tools.h"
 #include <getopt.h>
 
@@ -82,11 +83,13 @@ int sync_loop_wait_time = 1000; /* minimum uSeconds that the sync loop waits
  	 	 	 	 	 	 	 	  simulated time*/
 int signaled  = 0;     /* signal from slurmd */
 char*  workload_trace_file = NULL; /* Name of the file containing the workload to simulate */
+uint32_t profile_cycles = 0;   /* Cycles kept in the profiling ring, 0 disables it */
 char   default_trace_file[] = "test.trace";
 char   help_msg[]= "sim_mgr [endtime]\n\t[-c | --compath <cpath>]\n\t[-f | "
 		   "--fork]\n\t[-a | --accelerator <secs>]\n\t[-w | --wrkldfile"
 		   " <filename> ]\n\t[-h | --help]\n"
 		   "\t\t[-t | --looptime] <uSeconds>\n"
+		   "\t\t[-p | --profile] <cycles>\n"
 		   "Notes:\n\t'endtime' is "
 		   "specified as seconds since Unix epoch. If 0 is specified "
 		   "then the\n\t\tsimulator will run indefinitely.\n\t'cpath' "
@@ -104,7 +107,10 @@ char   help_msg[]= "sim_mgr [endtime]\n\t[-c | --compath <cpath>]\n\t[-f | "
 		   "\t'uSeconds' specify the minimum real time in us that is equivalent\n"
 		   "\t\tto an step increase in the simulation time. A larger uSeconds\n"
 		   "\t\tmakes the simulation slower, a smaller one, faster. Minimum\n"
-		   "\t\tvalue is 1.\n";
+		   "\t\tvalue is 1.\n"
+		   "\t'cycles' enables the per-cycle phase profiler and is the number\n"
+		   "\t\tof most recent cycles kept in shared memory (see\n"
+		   "\t\tsim_prof_dump). 0 uses the default of 16384.\n";
 
 /* Function prototypes */
 void  generateJob(job_trace_t* jobd);
@@ -127,117 +133,203 @@ int workflow_count = 0;
  * Pair of job ids corresponding to the id a job had in the trace and the one
  * that was actually raun with.
  */
-typedef struct job_id_pair_t {
-	uint32_t trace_job_id;
+typedef struct job_id_pair {
+	uint32_t trace_job_id;	/* NO_VAL if the slot is free */
 	uint32_t real_job_id;
-};
-
-/* List of job id pairs for the jobs that have been submitted already. Records
- * are stored in inverse order of growing by trace_job_id */
-List job_id_list;
+} job_id_pair_t;
 
 /*
- * create_job_id_pair - allocates a memory for a job_id_par_t, it will require
- * to be destroyed with _free_job_id_pair.
+ * Open addressing map of the pairs of the jobs submitted already, so the
+ * dependencies of a job are resolved in constant time whatever the number
+ * of jobs submitted before it.
  */
-struct job_id_pair_t *create_job_id_pair() {
-	struct job_id_pair_t *pair_ptr;
-	pair_ptr = xmalloc(sizeof(struct job_id_pair_t));
-	pair_ptr->trace_job_id=NO_VAL;
-	pair_ptr->real_job_id=NO_VAL;
-	return pair_ptr;
+static job_id_pair_t *job_id_map = NULL;
+static uint32_t job_id_map_size = 0;	/* power of 2 */
+static uint32_t job_id_map_cnt = 0;
+
+static uint32_t _job_id_hash(uint32_t trace_job_id)
+{
+	return (trace_job_id * 2654435761u) & (job_id_map_size - 1);
 }
 
-/*
- * _free_job_id_pair deallocates memory.
- */
-void _free_job_id_pair(struct job_id_pair_t *pair_ptr) {
-	xfree(pair_ptr);
+static void _job_id_insert(uint32_t trace_job_id, uint32_t real_job_id)
+{
+	uint32_t i = _job_id_hash(trace_job_id);
+
+	while ((job_id_map[i].trace_job_id != NO_VAL) &&
+	       (job_id_map[i].trace_job_id != trace_job_id))
+		i = (i + 1) & (job_id_map_size - 1);
+	if (job_id_map[i].trace_job_id == NO_VAL)
+		job_id_map_cnt++;
+	job_id_map[i].trace_job_id = trace_job_id;
+	job_id_map[i].real_job_id = real_job_id;
 }
 
 /*
- * Inits the job_id_list global variable.
+ * _create_job_id_map - size the job_id_map for job_cnt jobs, keeping the
+ * pairs already in it. It is grown automatically when more jobs are added.
  */
-void _create_job_id_list() {
-	job_id_list = list_create(_free_job_id_pair);
+static void _create_job_id_map(uint32_t job_cnt)
+{
+	job_id_pair_t *old_map = job_id_map;
+	uint32_t i, old_size = job_id_map_size;
+
+	for (job_id_map_size = 64; job_id_map_size < (job_cnt * 2);
+	     job_id_map_size *= 2)
+		;
+	if (job_id_map_size <= old_size) {
+		job_id_map_size = old_size;
+		return;
+	}
+
+	job_id_map = xmalloc(sizeof(job_id_pair_t) * job_id_map_size);
+	for (i = 0; i < job_id_map_size; i++)
+		job_id_map[i].trace_job_id = NO_VAL;
+	job_id_map_cnt = 0;
+	for (i = 0; i < old_size; i++) {
+		if (old_map[i].trace_job_id != NO_VAL)
+			_job_id_insert(old_map[i].trace_job_id,
+				       old_map[i].real_job_id);
+	}
+	xfree(old_map);
 }
 
 /*
- * _add_job_pair - adds info to the job_id_list for a job that had trace_job_id
+ * _add_job_pair - adds info to the job_id_map for a job that had trace_job_id
  * id in the trace, but received real_job_id from slurmctld when submitted.
  */
-void _add_job_pair(uint32_t trace_job_id, uint32_t real_job_id) {
-	struct job_id_pair_t *pair_ptr=create_job_id_pair();
-	pair_ptr->trace_job_id = trace_job_id;
-	pair_ptr->real_job_id = real_job_id;
-	if(!list_prepend(job_id_list, pair_ptr)) {
-		error("Inserting pair of job_ids in job_id_list");
+static void _add_job_pair(uint32_t trace_job_id, uint32_t real_job_id)
+{
+	if (trace_job_id == NO_VAL) {
+		error("Invalid trace job id %u", trace_job_id);
+		return;
 	}
+	if (((job_id_map_cnt + 1) * 2) > job_id_map_size)
+		_create_job_id_map(job_id_map_cnt + 1);
+	_job_id_insert(trace_job_id, real_job_id);
 }
 
 /*
  * _get_real_job_id - returns the real job id corresponding to the trace job
  * id trace_job_id. If id not found, returns NO_VAL.
  */
-uint32_t _get_real_job_id(uint32_t trace_job_id) {
-	ListIterator *iter = list_iterator_create(job_id_list);
-	struct job_id_pair_t *pair_ptr;
-	uint32_t real_job_id=NO_VAL;
-	while((pair_ptr=list_next(iter))) {
-		if (pair_ptr->trace_job_id==trace_job_id) {
-			real_job_id=pair_ptr->real_job_id;
-			break;
-		} else if(pair_ptr->trace_job_id<trace_job_id) {
-			break;
-		}
+static uint32_t _get_real_job_id(uint32_t trace_job_id)
+{
+	uint32_t i;
+
+	if (!job_id_map_size)
+		return NO_VAL;
+	i = _job_id_hash(trace_job_id);
+	while (job_id_map[i].trace_job_id != NO_VAL) {
+		if (job_id_map[i].trace_job_id == trace_job_id)
+			return job_id_map[i].real_job_id;
+		i = (i + 1) & (job_id_map_size - 1);
+	}
+	return NO_VAL;
+}
+
+/*
+ * One element of a job dependency, e.g. "afterok:12". type points into the
+ * dependency string of the trace record, which is split in place when the
+ * trace is loaded. Elements without a job id (e.g. "singleton") have
+ * trace_job_id set to NO_VAL.
+ */
+typedef struct sim_dep {
+	char *type;
+	uint32_t trace_job_id;
+} sim_dep_t;
+
+/*
+ * Trace record as kept by sim_mgr, with its dependencies parsed once at
+ * load time rather than on every submission. trace must stay first, the
+ * records are linked and submitted as job_trace_t.
+ */
+typedef struct sim_job_trace {
+	job_trace_t trace;
+	uint32_t dep_cnt;
+	sim_dep_t *deps;
+} sim_job_trace_t;
+
+/*
+ * _parse_dependencies - split the "type:id[:id...][,type:id...]" dependency
+ * string of a trace record into sim_job->deps.
+ */
+static void _parse_dependencies(sim_job_trace_t *sim_job)
+{
+	char *dep_string = sim_job->trace.dependency;
+	char *elem, *id, *save_ptr1 = NULL, *save_ptr2 = NULL, *end;
+	uint32_t dep_alloc = 0;
+
+	sim_job->dep_cnt = 0;
+	sim_job->deps = NULL;
+	dep_string[MAX_DEPNAME - 1] = '\0';
+
+	for (elem = strtok_r(dep_string, ",", &save_ptr1); elem;
+	     elem = strtok_r(NULL, ",", &save_ptr1)) {
+		char *type = strtok_r(elem, ":", &save_ptr2);
+
+		if (!type)
+			continue;
+		id = strtok_r(NULL, ":", &save_ptr2);
+		do {
+			if (sim_job->dep_cnt == dep_alloc) {
+				dep_alloc = dep_alloc ? dep_alloc * 2 : 4;
+				xrealloc(sim_job->deps,
+					 sizeof(sim_dep_t) * dep_alloc);
+			}
+			sim_job->deps[sim_job->dep_cnt].type = type;
+			sim_job->deps[sim_job->dep_cnt].trace_job_id = NO_VAL;
+			if (id) {
+				sim_job->deps[sim_job->dep_cnt].trace_job_id =
+					strtoul(id, &end, 10);
+				if (*end) {
+					error("Bad dependency job id \"%s\" "
+					      "for trace job %d", id,
+					      sim_job->trace.job_id);
+					continue;
+				}
+			}
+			sim_job->dep_cnt++;
+		} while (id && (id = strtok_r(NULL, ":", &save_ptr2)));
 	}
-	list_iterator_destroy(iter);
-	return real_job_id;
 }
 
 /*
  * re_write_dependencies - creates a slurm format dependency string (e.g.
- * "afterok:2,afterok:3") with the same structure as dep_string but
- * replacing the trace job ids for real jobs ids.
+ * "afterok:2,afterok:3") with the same structure as the trace dependencies
+ * but replacing the trace job ids for real jobs ids.
  */
-char *re_write_dependencies(char *dep_string) {
-	char *token;
-	char *saveptr1;
-	uint32_t trace_job_id, real_job_id;
-	char buffer[10*1024] = "\0";
-	char buffer_2[10*1024] = "\0";
-	char *new_dep = &buffer;
-	char *new_dep_copy=&buffer_2;
-
-
-	char first=1;
-	for(token = strtok_r(dep_string, ":", &saveptr1);
-		token;
-		token = strtok_r(dep_string, ":", &saveptr1))
-	{
-		dep_string=NULL;
-		char *dep_type = token;
-		//assert_equal_str(token, "afterok", "Bad sbatch depedency format");
-		token = strtok_r(NULL, ",", &saveptr1);
-		trace_job_id = atoi(token);
-		real_job_id = _get_real_job_id(trace_job_id);
-		if (real_job_id==NO_VAL) {
-			error("Real job id not found for job id: %d", trace_job_id);
-			real_job_id=trace_job_id;
+static char *re_write_dependencies(sim_job_trace_t *sim_job)
+{
+	uint32_t i, real_job_id;
+	size_t len = 1, off = 0;
+	char *new_dep;
+
+	if (!sim_job->dep_cnt)
+		return xstrdup("");
+
+	for (i = 0; i < sim_job->dep_cnt; i++)
+		len += strlen(sim_job->deps[i].type) + 12;
+	new_dep = xmalloc(len);
+
+	for (i = 0; i < sim_job->dep_cnt; i++) {
+		sim_dep_t *dep = &sim_job->deps[i];
+
+		if (dep->trace_job_id == NO_VAL) {
+			off += snprintf(new_dep + off, len - off, "%s%s",
+					i ? "," : "", dep->type);
+			continue;
 		}
-		if (first) {
-			sprintf(new_dep_copy, "%s%s:%d", new_dep, dep_type,
-							real_job_id);
-		} else {
-			sprintf(new_dep_copy, "%s,%s:%d", new_dep, dep_type,
-						    real_job_id);
+		real_job_id = _get_real_job_id(dep->trace_job_id);
+		if (real_job_id == NO_VAL) {
+			error("Real job id not found for job id: %u",
+			      dep->trace_job_id);
+			real_job_id = dep->trace_job_id;
 		}
-		char *aux=new_dep;
-		new_dep = new_dep_copy;
-		new_dep_copy = aux;
-		first = 0;
+		off += snprintf(new_dep + off, len - off, "%s%s:%u",
+				i ? "," : "", dep->type, real_job_id);
 	}
-	return xstrdup(new_dep);
+	return new_dep;
 }
 
 /* handler to USR2 signal*/
@@ -344,7 +436,11 @@ time_mgr(void *arg) {
 	time_t time_end=0;
 
 	while (1) {
+		uint64_t prof_start;
+
 		real_gettimeofday(&t_start, NULL);
+		sim_prof_cycle_begin(current_sim[0]);
+		prof_start = sim_prof_begin();
 		/* Do we have to end simulation in this cycle? */
 		if (!time_end && (sim_end_point && sim_end_point <= current_sim[0] || *trace_recs_end_sim==-1)) { /* ANA: added condition for terminating sim using shmem var trace_recs_end_sim when all jobs have finished */
 			fprintf(stderr, "End point of trace arrived, keep simulation for %d"
@@ -388,9 +484,10 @@ time_mgr(void *arg) {
 			}
 
 			waitpid(child, &exec_result, 0);
-			if(exec_result == 0)
+			if(exec_result == 0) {
 				sim_mgr_debug(9, "reservation created\n");
-			else
+				sim_prof_count(SIM_PROF_RSV_CREATED, 1);
+			} else
 				sim_mgr_debug(9, "reservation failed");
 
 			rsv_trace_head = rsv_trace_head->next;
@@ -425,10 +522,12 @@ time_mgr(void *arg) {
 #endif
 
 				generateJob (trace_head);
+				sim_prof_count(SIM_PROF_JOBS_SUBMITTED, 1);
 
 				/* Let's free trace record */
 				temp_ptr = trace_head;
 				trace_head = trace_head->next;
+				xfree(((sim_job_trace_t *) temp_ptr)->deps);
 				free(temp_ptr);
 
 			} else {
@@ -440,9 +539,14 @@ time_mgr(void *arg) {
 			}
 		}
 
+		sim_prof_end(SIM_PROF_SUBMIT, prof_start);
+
 		/* Synchronization with daemons */
+		prof_start = sim_prof_begin();
 		sem_post(slurm_sem);
 		sem_wait(sim_sem);
+		sim_prof_end(SIM_PROF_SYNC_WAIT, prof_start);
+		sim_prof_cycle_end();
 
 		/*
 		 * Time throttling added but currently unstable; for now, run
@@ -504,7 +608,7 @@ generateJob(job_trace_t* jobd) {
 	dmesg.partition     = strdup(jobd->partition);
 	dmesg.account       = strdup(jobd->account);
 	dmesg.reservation   = strdup(jobd->reservation);
-	dmesg.dependency    = re_write_dependencies(jobd->dependency);
+	dmesg.dependency    = re_write_dependencies((sim_job_trace_t *) jobd);
 	dmesg.num_tasks     = jobd->tasks;
 	dmesg.min_cpus      = jobd->tasks * jobd->cpus_per_task; 
 	dmesg.cpus_per_task = jobd->cpus_per_task;
@@ -633,17 +737,21 @@ int
 init_trace_info(void *ptr, int op) {
 
 	job_trace_t *new_trace_record;
+	sim_job_trace_t *new_sim_job;
 	rsv_trace_t *new_rsv_trace_record;
 	static int count = 0;
 
 	if (op == 0) {
-		new_trace_record = calloc(1, sizeof(job_trace_t));
-		if (new_trace_record == NULL) {
+		new_sim_job = calloc(1, sizeof(sim_job_trace_t));
+		if (new_sim_job == NULL) {
 			printf("init_trace_info: Error in calloc.\n");
 			return -1;
 		}
 
-		*new_trace_record = *(job_trace_t *)ptr;
+		new_sim_job->trace = *(job_trace_t *)ptr;
+		new_trace_record = &new_sim_job->trace;
+		new_trace_record->next = NULL;
+		_parse_dependencies(new_sim_job);
 
 		if (count == 0) {
 			sim_start_point = new_trace_record->submit - 60;
@@ -740,6 +848,7 @@ int init_job_trace() {
 		printf("Error opening manifest\n");
 		return -1;
 	}
+	_create_job_id_map(total_trace_records);
 
 	printf("Trace initialization done. Total trace records: %d\n",
 					total_trace_records);
@@ -881,7 +990,6 @@ main(int argc, char *argv[], char *envp[]) {
 		printf("SIM_MGR: Unable to create handler for SIGUSR2!\n");
 	}*/
 
-	_create_job_id_list();
 	if ( !getArgs(argc, argv) ) {
 		printf("Usage: %s\n", help_msg);
 		exit(-1);
@@ -945,6 +1053,11 @@ main(int argc, char *argv[], char *envp[]) {
                 return -1;
         };
 
+	if (profile_cycles && (sim_prof_create(profile_cycles) < 0)) {
+		printf("Error creating the profiling shared memory segment.\n");
+		return -1;
+	}
+
         if(init_job_trace() < 0){
                 printf("An error was detected when reading trace file. "
                        "Exiting...\n");
@@ -1071,14 +1184,16 @@ getArgs(int argc, char** argv) {
 		{"accelerator",	1, 0, 'a'},
 		{"wrkldfile",	1, 0, 'w'},
 		{"help",	0, 0, 'h'},
-		{"looptime",	1, 0, 't'}
+		{"looptime",	1, 0, 't'},
+		{"profile",	1, 0, 'p'},
+		{0, 0, 0, 0}
 	};
 	int ix = 0, valid = 1;
 	int opt_char, option_index;
 	char* ptr;
 
 	while (1) {
-		if ((opt_char = getopt_long(argc, argv, "fc:ha:w:t:" , long_options,
+		if ((opt_char = getopt_long(argc, argv, "fc:ha:w:t:p:" , long_options,
 						&option_index)) == -1 )
 			break;
 
@@ -1104,6 +1219,14 @@ getArgs(int argc, char** argv) {
 					valid = 0;
 				}
 				break;
+			case ('p'):
+				profile_cycles = strtoul(optarg, &ptr, 10);
+				if (*ptr != '\0')
+					valid = 0;
+				else if (!profile_cycles)
+					profile_cycles =
+						SIM_PROF_DEFAULT_CYCLES;
+				break;
 		};
 	}
 
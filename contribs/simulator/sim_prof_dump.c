@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <inttypes.h>
+
+#include "src/common/sim_profile.h"
+
+/*
+ * Export the per-cycle phase profile written by sim_mgr, slurmd and
+ * slurmctld (sim_mgr -p) as CSV or Chrome trace JSON. The latter can be
+ * loaded in chrome://tracing or Perfetto.
+ */
+
+#define OUTPUT_CSV	0
+#define OUTPUT_CHROME	1
+
+static int output_format = OUTPUT_CSV;
+char* profile_file = NULL;
+char* output_file = NULL;
+char help_msg[] = "sim_prof_dump [-i | --input <file>] [-o | --output <file>]"
+		  " [-c | --csv] [-j | --chrome] [-h | --help]\n"
+		  "\t'file' for input defaults to the profiling shared memory"
+		  " segment of the\n\t\tcurrent SLURM_SIM_ID. Output defaults"
+		  " to stdout.\n";
+
+int getArgs(int argc, char** argv);
+
+static sim_prof_shm_t *_map_profile(size_t *size)
+{
+	char shm_name[128], path[256];
+	sim_prof_shm_t *prof;
+	struct stat st;
+	int fd;
+
+	if (profile_file) {
+		snprintf(path, sizeof(path), "%s", profile_file);
+	} else {
+		sim_prof_shm_name(shm_name, sizeof(shm_name));
+		snprintf(path, sizeof(path), "/dev/shm%s", shm_name);
+	}
+
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		printf("Error opening profile: %s\nAbort!\n", path);
+		return NULL;
+	}
+	if (fstat(fd, &st) || (st.st_size < sizeof(sim_prof_shm_t))) {
+		printf("Profile %s is truncated\nAbort!\n", path);
+		close(fd);
+		return NULL;
+	}
+	prof = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (prof == MAP_FAILED) {
+		printf("Error mapping profile: %s\nAbort!\n", path);
+		return NULL;
+	}
+
+	if ((prof->magic != SIM_PROF_MAGIC) ||
+	    (prof->version != SIM_PROF_VERSION) ||
+	    (prof->phase_cnt != SIM_PROF_PHASE_CNT) ||
+	    (prof->count_cnt != SIM_PROF_COUNT_CNT) || !prof->ring_size ||
+	    (st.st_size < sim_prof_shm_size(prof->ring_size))) {
+		printf("%s is not a simulator profile of version %d\nAbort!\n",
+		       path, SIM_PROF_VERSION);
+		munmap(prof, st.st_size);
+		return NULL;
+	}
+
+	*size = st.st_size;
+	return prof;
+}
+
+/* Call f on every recorded cycle, oldest first */
+static void _for_each_cycle(sim_prof_shm_t *prof,
+			    void (*f)(sim_prof_cycle_t *rec, void *arg),
+			    void *arg)
+{
+	uint64_t cycle = prof->cycle;
+	uint32_t i, idx;
+
+	for (i = 1; i <= prof->ring_size; i++) {
+		idx = (cycle + i) % prof->ring_size;
+		if (!prof->ring[idx].seq)
+			continue;
+		f(&prof->ring[idx], arg);
+	}
+}
+
+static void _csv_cycle(sim_prof_cycle_t *rec, void *arg)
+{
+	FILE *out = arg;
+	int i;
+
+	fprintf(out, "%"PRIu64",%u,%u", rec->seq, rec->sim_time,
+		rec->wall_usec);
+	for (i = 0; i < SIM_PROF_PHASE_CNT; i++)
+		fprintf(out, ",%u", rec->phase[i].usec);
+	for (i = 0; i < SIM_PROF_COUNT_CNT; i++)
+		fprintf(out, ",%u", rec->count[i]);
+	fprintf(out, "\n");
+}
+
+static void _dump_csv(sim_prof_shm_t *prof, FILE *out)
+{
+	int i;
+
+	fprintf(out, "cycle,sim_time,wall_usec");
+	for (i = 0; i < SIM_PROF_PHASE_CNT; i++)
+		fprintf(out, ",%s_usec", sim_prof_phase_name(i));
+	for (i = 0; i < SIM_PROF_COUNT_CNT; i++)
+		fprintf(out, ",%s", sim_prof_count_name(i));
+	fprintf(out, "\n");
+
+	_for_each_cycle(prof, _csv_cycle, out);
+}
+
+typedef struct {
+	FILE *out;
+	uint64_t origin;	/* wall_start of the oldest cycle */
+} chrome_args_t;
+
+/* Thread id in the trace of the daemon running phase */
+static int _owner_tid(sim_prof_phase_t phase)
+{
+	const char *owner = sim_prof_phase_owner(phase);
+
+	if (!strcmp(owner, "sim_mgr"))
+		return 1;
+	if (!strcmp(owner, "slurmd"))
+		return 2;
+	return 3;
+}
+
+static void _chrome_cycle(sim_prof_cycle_t *rec, void *arg)
+{
+	chrome_args_t *args = arg;
+	uint64_t ts;
+	int i;
+
+	if (!args->origin)
+		args->origin = rec->wall_start;
+	ts = rec->wall_start - args->origin;
+
+	fprintf(args->out, ",\n{\"name\":\"cycle\",\"cat\":\"sim\",\"ph\":\"X\","
+		"\"pid\":1,\"tid\":0,\"ts\":%"PRIu64",\"dur\":%u,"
+		"\"args\":{\"seq\":%"PRIu64",\"sim_time\":%u}}",
+		ts, rec->wall_usec, rec->seq, rec->sim_time);
+
+	/*
+	 * A phase entered several times in a cycle (e.g. one completion
+	 * message per job) is drawn as one slice from its first entry.
+	 */
+	for (i = 0; i < SIM_PROF_PHASE_CNT; i++) {
+		if (!rec->phase[i].start_usec)
+			continue;
+		fprintf(args->out, ",\n{\"name\":\"%s\",\"cat\":\"sim\","
+			"\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%"PRIu64","
+			"\"dur\":%u}",
+			sim_prof_phase_name(i), _owner_tid(i),
+			ts + rec->phase[i].start_usec, rec->phase[i].usec);
+	}
+
+	fprintf(args->out, ",\n{\"name\":\"events\",\"ph\":\"C\",\"pid\":1,"
+		"\"ts\":%"PRIu64",\"args\":{", ts);
+	for (i = 0; i < SIM_PROF_COUNT_CNT; i++) {
+		fprintf(args->out, "%s\"%s\":%u", i ? "," : "",
+			sim_prof_count_name(i), rec->count[i]);
+	}
+	fprintf(args->out, "}}");
+}
+
+static void _dump_chrome(sim_prof_shm_t *prof, FILE *out)
+{
+	chrome_args_t args = { out, 0 };
+
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+		"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+		"\"args\":{\"name\":\"slurm simulator\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+		"\"args\":{\"name\":\"cycle\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+		"\"args\":{\"name\":\"sim_mgr\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+		"\"args\":{\"name\":\"slurmd\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,"
+		"\"args\":{\"name\":\"slurmctld\"}}");
+
+	_for_each_cycle(prof, _chrome_cycle, &args);
+
+	fprintf(out, "\n]}\n");
+}
+
+int main(int argc, char *argv[]) {
+
+	sim_prof_shm_t *prof;
+	size_t size = 0;
+	FILE *out = stdout;
+
+	if ( !getArgs(argc, argv) ) {
+		printf("Usage: %s\n", help_msg);
+		exit(-1);
+	}
+
+	if ( !(prof = _map_profile(&size)) )
+		exit(-1);
+
+	if (output_file && !(out = fopen(output_file, "w"))) {
+		printf("Error opening output file: %s\nAbort!\n",
+		       output_file);
+		exit(-1);
+	}
+
+	if (output_format == OUTPUT_CHROME)
+		_dump_chrome(prof, out);
+	else
+		_dump_csv(prof, out);
+
+	if (out != stdout)
+		fclose(out);
+	munmap(prof, size);
+
+	return 0;
+}
+
+int
+getArgs(int argc, char** argv) {
+	static struct option long_options[] = {
+		{"input",          1, 0, 'i'},
+		{"output",         1, 0, 'o'},
+		{"csv",            0, 0, 'c'},
+		{"chrome",         0, 0, 'j'},
+		{"help",           0, 0, 'h'},
+		{0, 0, 0, 0}
+	};
+	int opt_char, option_index;
+	int valid = 1;
+
+	while (1) {
+		if ( (opt_char = getopt_long(argc, argv, "i:o:cjh", long_options,
+						&option_index)) == -1 )
+			break;
+		switch (opt_char) {
+			case ('i'):
+				profile_file = strdup(optarg);
+				break;
+			case ('o'):
+				output_file = strdup(optarg);
+				break;
+			case ('c'):
+				output_format = OUTPUT_CSV;
+				break;
+			case ('j'):
+				output_format = OUTPUT_CHROME;
+				break;
+			case ('h'):
+				printf("%s\n", help_msg);
+				exit(0);
+			default:
+				valid = 0;
+		};
+	}
+
+	return valid;
+}
@@ -0,0 +1,915 @@
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include "sim_trace.h"
+
+/*
+ * Bulk trace editing and analysis.
+ *
+ * The trace is mapped once and split into columns (one array per field,
+ * string fields dictionary encoded), so each filter or transform is a
+ * single tight loop over one or two arrays instead of a pass over the
+ * whole file. Operations run in command line order against a selection
+ * mask: filters narrow the selection, transforms and removals apply to
+ * the selected jobs and --all or --remove select every job left. The
+ * result is written back in one sequential pass, copying the fields that
+ * have no column (dependency, manifest) from the original record.
+ *
+ * Example: scale the runtime of all "debug" jobs by 1.5, hand alice's jobs
+ * over to bob and print statistics before and after:
+ *	trace_tool -i test.trace --stats -f partition=debug \
+ *		-s 'duration*=1.5' --all -m username:alice=bob --stats -o out
+ */
+
+#define WRITE_BATCH	256	/* records per write() */
+
+typedef enum {
+	F_JOB_ID, F_SUBMIT, F_DURATION, F_WCLIMIT, F_TASKS,
+	F_CPUS_PER_TASK, F_TASKS_PER_NODE,
+	F_USERNAME, F_QOSNAME, F_PARTITION, F_ACCOUNT, F_RESERVATION,
+	F_CNT
+} field_t;
+
+#define F_FIRST_STR	F_USERNAME
+#define IS_STR(f)	((f) >= F_FIRST_STR)
+#define STR_CNT		(F_CNT - F_FIRST_STR)
+
+static const char *field_names[F_CNT] = {
+	"job_id", "submit", "duration", "wclimit", "tasks",
+	"cpus_per_task", "tasks_per_node",
+	"username", "qosname", "partition", "account", "reservation"
+};
+
+/* Size of the string field in job_trace_t, values are truncated to it */
+static const size_t str_len[STR_CNT] = {
+	MAX_USERNAME_LEN, MAX_QOSNAME, MAX_QOSNAME, MAX_QOSNAME, MAX_RSVNAME
+};
+
+typedef struct {
+	char **str;		/* code -> string */
+	uint32_t cnt;
+	uint32_t alloc;
+	uint32_t *hash;		/* open addressing, code + 1, 0 if empty */
+	uint32_t hash_size;
+} dict_t;
+
+typedef struct {
+	const job_trace_t *rec;	/* mapped input file */
+	size_t map_size;
+	uint32_t rows;		/* rows still in the trace */
+	uint32_t *row;		/* input record of each row */
+	int64_t *num[F_FIRST_STR];
+	uint32_t *code[STR_CNT];
+	dict_t dict[STR_CNT];
+	uint8_t *sel;		/* selection mask */
+} trace_t;
+
+typedef enum {
+	OP_FILTER, OP_ALL, OP_SET, OP_MAP, OP_REMOVE, OP_SORT, OP_STATS
+} op_type_t;
+
+typedef enum {
+	CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE
+} cmp_t;
+
+typedef enum {
+	SET_ASSIGN, SET_ADD, SET_SUB, SET_MUL
+} set_t;
+
+typedef struct {
+	op_type_t type;
+	field_t field;
+	int how;		/* cmp_t or set_t */
+	int64_t ival;
+	double fval;
+	char *sval;
+	char *sval2;		/* OP_MAP: new value */
+} op_t;
+
+static op_t *ops = NULL;
+static int op_cnt = 0;
+
+char* input_file = NULL;
+char* output_file = NULL;
+char default_trace_file[] = "test.trace";
+char help_msg[] = "trace_tool [-i | --input <file>] [-o | --output <file>]\n"
+	"\t[-f | --filter <field><op><value>] [-a | --all]\n"
+	"\t[-s | --set <field><op><value>] [-m | --map <field>:<old>=<new>]\n"
+	"\t[-X | --remove] [-t | --sort] [-S | --stats] [-h | --help]\n"
+	"\n"
+	"Operations run in the order given, over the jobs selected so far:\n"
+	"  --filter  keep in the selection the jobs matching the condition,\n"
+	"            op is one of = != < <= > >= (only = and != for strings)\n"
+	"  --all     select every job left in the trace again\n"
+	"  --set     change a field of the selected jobs, op is = for any field\n"
+	"            and += -= *= for numeric fields ('duration*=1.5')\n"
+	"  --map     rename one value of a string field in the selected jobs,\n"
+	"            <old> may be '*' to rename every value\n"
+	"  --remove  drop the selected jobs from the trace and select all\n"
+	"            the jobs left\n"
+	"  --sort    order the trace by submit time (stable)\n"
+	"  --stats   print arrival, size and runtime statistics of the\n"
+	"            selected jobs\n"
+	"Fields: job_id submit duration wclimit tasks cpus_per_task\n"
+	"        tasks_per_node username qosname partition account reservation\n"
+	"The trace is written to --output only if one is given, it may be\n"
+	"the input file.\n";
+
+int getArgs(int argc, char** argv);
+
+static void *_xcalloc(size_t n, size_t size)
+{
+	void *p = calloc(n ? n : 1, size);
+
+	if (!p) {
+		printf("Out of memory\nAbort!\n");
+		exit(-1);
+	}
+	return p;
+}
+
+static uint32_t _hash_str(const char *s)
+{
+	uint32_t h = 2166136261u;	/* FNV-1a */
+
+	while (*s) {
+		h ^= (uint8_t) *s++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static void _dict_rehash(dict_t *d)
+{
+	uint32_t i, h;
+
+	free(d->hash);
+	d->hash_size = d->hash_size ? d->hash_size * 2 : 64;
+	d->hash = _xcalloc(d->hash_size, sizeof(uint32_t));
+	for (i = 0; i < d->cnt; i++) {
+		h = _hash_str(d->str[i]) & (d->hash_size - 1);
+		while (d->hash[h])
+			h = (h + 1) & (d->hash_size - 1);
+		d->hash[h] = i + 1;
+	}
+}
+
+/* Return the code of s, adding it if add is set, or -1 if not present */
+static int64_t _dict_code(dict_t *d, const char *s, int add)
+{
+	uint32_t h;
+
+	if (!d->hash)
+		_dict_rehash(d);
+	h = _hash_str(s) & (d->hash_size - 1);
+	while (d->hash[h]) {
+		if (!strcmp(d->str[d->hash[h] - 1], s))
+			return d->hash[h] - 1;
+		h = (h + 1) & (d->hash_size - 1);
+	}
+	if (!add)
+		return -1;
+
+	if (d->cnt == d->alloc) {
+		d->alloc = d->alloc ? d->alloc * 2 : 64;
+		d->str = realloc(d->str, d->alloc * sizeof(char *));
+		if (!d->str) {
+			printf("Out of memory\nAbort!\n");
+			exit(-1);
+		}
+	}
+	d->str[d->cnt] = strdup(s);
+	d->hash[h] = ++d->cnt;
+	if ((d->cnt * 2) > d->hash_size)
+		_dict_rehash(d);
+	return d->cnt - 1;
+}
+
+static const char *_str_field(const job_trace_t *rec, field_t f)
+{
+	switch (f) {
+	case F_USERNAME:
+		return rec->username;
+	case F_QOSNAME:
+		return rec->qosname;
+	case F_PARTITION:
+		return rec->partition;
+	case F_ACCOUNT:
+		return rec->account;
+	default:
+		return rec->reservation;
+	}
+}
+
+/* Copy a trace string, which may not be terminated if it fills the field */
+static void _copy_str(char *dst, const char *src, size_t len)
+{
+	size_t n = strnlen(src, len - 1);
+
+	memcpy(dst, src, n);
+	dst[n] = '\0';
+}
+
+static int _load_trace(trace_t *t, const char *path)
+{
+	struct stat st;
+	char buf[MAX_DEPNAME];
+	uint32_t i;
+	int fd, f;
+
+	memset(t, 0, sizeof(trace_t));
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		printf("Error opening workload file: %s\nAbort!\n", path);
+		return -1;
+	}
+	if (fstat(fd, &st)) {
+		printf("Error reading workload file: %s\nAbort!\n", path);
+		close(fd);
+		return -1;
+	}
+	if (st.st_size % sizeof(job_trace_t)) {
+		printf("Warning: %s has a truncated last record, ignored\n",
+		       path);
+	}
+	t->rows = st.st_size / sizeof(job_trace_t);
+	if (t->rows) {
+		t->map_size = st.st_size;
+		t->rec = mmap(NULL, t->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (t->rec == MAP_FAILED) {
+			printf("Error mapping workload file: %s\nAbort!\n",
+			       path);
+			close(fd);
+			return -1;
+		}
+		(void) madvise((void *) t->rec, t->map_size,
+			       MADV_SEQUENTIAL);
+	}
+	close(fd);
+
+	t->row = _xcalloc(t->rows, sizeof(uint32_t));
+	t->sel = _xcalloc(t->rows, sizeof(uint8_t));
+	for (f = 0; f < F_FIRST_STR; f++)
+		t->num[f] = _xcalloc(t->rows, sizeof(int64_t));
+	for (f = 0; f < STR_CNT; f++)
+		t->code[f] = _xcalloc(t->rows, sizeof(uint32_t));
+
+	/* The only pass over the records until the trace is written */
+	for (i = 0; i < t->rows; i++) {
+		const job_trace_t *rec = &t->rec[i];
+
+		t->row[i] = i;
+		t->sel[i] = 1;
+		t->num[F_JOB_ID][i]	    = rec->job_id;
+		t->num[F_SUBMIT][i]	    = rec->submit;
+		t->num[F_DURATION][i]	    = rec->duration;
+		t->num[F_WCLIMIT][i]	    = rec->wclimit;
+		t->num[F_TASKS][i]	    = rec->tasks;
+		t->num[F_CPUS_PER_TASK][i]  = rec->cpus_per_task;
+		t->num[F_TASKS_PER_NODE][i] = rec->tasks_per_node;
+		for (f = 0; f < STR_CNT; f++) {
+			_copy_str(buf, _str_field(rec, F_FIRST_STR + f),
+				  str_len[f]);
+			t->code[f][i] = _dict_code(&t->dict[f], buf, 1);
+		}
+	}
+
+	return 0;
+}
+
+static int _write_trace(trace_t *t, const char *path)
+{
+	job_trace_t *batch;
+	char tmp_path[MAX_WF_FILENAME_LEN];
+	uint32_t i, n = 0;
+	size_t len;
+	int fd, f, rc = 0;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.new", path);
+	if ((fd = open(tmp_path, O_CREAT | O_WRONLY | O_TRUNC,
+		       S_IRUSR | S_IWUSR)) < 0) {
+		printf("Error creating file: %s\nAbort!\n", tmp_path);
+		return -1;
+	}
+
+	batch = _xcalloc(WRITE_BATCH, sizeof(job_trace_t));
+	for (i = 0; i < t->rows; i++) {
+		job_trace_t *rec = &batch[n];
+
+		memcpy(rec, &t->rec[t->row[i]], sizeof(job_trace_t));
+		rec->job_id	    = t->num[F_JOB_ID][i];
+		rec->submit	    = t->num[F_SUBMIT][i];
+		rec->duration	    = t->num[F_DURATION][i];
+		rec->wclimit	    = t->num[F_WCLIMIT][i];
+		rec->tasks	    = t->num[F_TASKS][i];
+		rec->cpus_per_task  = t->num[F_CPUS_PER_TASK][i];
+		rec->tasks_per_node = t->num[F_TASKS_PER_NODE][i];
+		for (f = 0; f < STR_CNT; f++) {
+			char *dst = (char *) _str_field(rec, F_FIRST_STR + f);
+			_copy_str(dst, t->dict[f].str[t->code[f][i]],
+				  str_len[f]);
+		}
+
+		if ((++n < WRITE_BATCH) && (i + 1 < t->rows))
+			continue;
+		len = n * sizeof(job_trace_t);
+		if (write(fd, batch, len) != (ssize_t) len) {
+			printf("Error writing to file: %s: %s\n", tmp_path,
+			       strerror(errno));
+			rc = -1;
+			break;
+		}
+		n = 0;
+	}
+	free(batch);
+
+	if (close(fd) && !rc) {
+		printf("Error writing to file: %s: %s\n", tmp_path,
+		       strerror(errno));
+		rc = -1;
+	}
+	if (!rc && (rename(tmp_path, path) < 0)) {
+		printf("Error renaming file: %s\n", strerror(errno));
+		rc = -1;
+	}
+	if (rc)
+		(void) unlink(tmp_path);
+	else
+		printf("Wrote %u jobs to %s\n", t->rows, path);
+
+	return rc;
+}
+
+/*
+ * Filters and transforms keep the comparison out of the loop, so each
+ * loop is a plain pass over one column the compiler can vectorise.
+ */
+#define CMP_LOOP(col, rel, v)						\
+	for (i = 0; i < rows; i++)					\
+		sel[i] &= ((col)[i] rel (v))
+
+static void _op_filter(trace_t *t, op_t *op)
+{
+	uint8_t *sel = t->sel;
+	uint32_t i, rows = t->rows;
+
+	if (IS_STR(op->field)) {
+		uint32_t *col = t->code[op->field - F_FIRST_STR];
+		int64_t code = _dict_code(&t->dict[op->field - F_FIRST_STR],
+					  op->sval, 0);
+
+		/* A value absent from the trace matches nothing */
+		if (code < 0) {
+			if (op->how == CMP_EQ)
+				memset(sel, 0, rows);
+			return;
+		}
+		if (op->how == CMP_EQ)
+			CMP_LOOP(col, ==, (uint32_t) code);
+		else
+			CMP_LOOP(col, !=, (uint32_t) code);
+		return;
+	}
+
+	switch (op->how) {
+	case CMP_EQ:
+		CMP_LOOP(t->num[op->field], ==, op->ival);
+		break;
+	case CMP_NE:
+		CMP_LOOP(t->num[op->field], !=, op->ival);
+		break;
+	case CMP_LT:
+		CMP_LOOP(t->num[op->field], <, op->ival);
+		break;
+	case CMP_LE:
+		CMP_LOOP(t->num[op->field], <=, op->ival);
+		break;
+	case CMP_GT:
+		CMP_LOOP(t->num[op->field], >, op->ival);
+		break;
+	case CMP_GE:
+		CMP_LOOP(t->num[op->field], >=, op->ival);
+		break;
+	}
+}
+
+static void _op_set(trace_t *t, op_t *op)
+{
+	uint8_t *sel = t->sel;
+	uint32_t i, rows = t->rows;
+	int64_t *col, v;
+	double m;
+
+	if (IS_STR(op->field)) {
+		uint32_t *scol = t->code[op->field - F_FIRST_STR];
+		uint32_t code = _dict_code(&t->dict[op->field - F_FIRST_STR],
+					   op->sval, 1);
+
+		for (i = 0; i < rows; i++)
+			scol[i] = sel[i] ? code : scol[i];
+		return;
+	}
+
+	col = t->num[op->field];
+	v = op->ival;
+	switch (op->how) {
+	case SET_ASSIGN:
+		for (i = 0; i < rows; i++)
+			col[i] = sel[i] ? v : col[i];
+		break;
+	case SET_ADD:
+		for (i = 0; i < rows; i++)
+			col[i] += sel[i] ? v : 0;
+		break;
+	case SET_SUB:
+		for (i = 0; i < rows; i++)
+			col[i] -= sel[i] ? v : 0;
+		break;
+	case SET_MUL:
+		m = op->fval;
+		for (i = 0; i < rows; i++) {
+			if (sel[i])
+				col[i] = (int64_t) ((col[i] * m) + 0.5);
+		}
+		break;
+	}
+}
+
+/* Renaming is done on the dictionary, then one pass over the codes */
+static void _op_map(trace_t *t, op_t *op)
+{
+	int s = op->field - F_FIRST_STR;
+	dict_t *d = &t->dict[s];
+	uint32_t *col = t->code[s], *map, cnt;
+	uint8_t *sel = t->sel;
+	uint32_t i, rows = t->rows;
+	int64_t old_code = -1, new_code;
+
+	if (strcmp(op->sval, "*")) {
+		if ((old_code = _dict_code(d, op->sval, 0)) < 0)
+			return;
+	}
+	new_code = _dict_code(d, op->sval2, 1);
+
+	cnt = d->cnt;
+	map = _xcalloc(cnt, sizeof(uint32_t));
+	for (i = 0; i < cnt; i++) {
+		if ((old_code < 0) || (i == old_code))
+			map[i] = new_code;
+		else
+			map[i] = i;
+	}
+	for (i = 0; i < rows; i++)
+		col[i] = sel[i] ? map[col[i]] : col[i];
+	free(map);
+}
+
+/* Compact every column in place, dropping the selected rows */
+static void _op_remove(trace_t *t)
+{
+	uint32_t i, n = 0;
+	int f;
+
+	for (i = 0; i < t->rows; i++) {
+		if (t->sel[i])
+			continue;
+		if (n != i) {
+			t->row[n] = t->row[i];
+			for (f = 0; f < F_FIRST_STR; f++)
+				t->num[f][n] = t->num[f][i];
+			for (f = 0; f < STR_CNT; f++)
+				t->code[f][n] = t->code[f][i];
+		}
+		n++;
+	}
+	printf("Removed %u jobs, %u left\n", t->rows - n, n);
+	t->rows = n;
+	/* Carry on with every job left */
+	memset(t->sel, 1, t->rows);
+}
+
+static int64_t *sort_key = NULL;
+
+static int _cmp_submit(const void *a, const void *b)
+{
+	uint32_t ia = *(const uint32_t *) a, ib = *(const uint32_t *) b;
+
+	if (sort_key[ia] != sort_key[ib])
+		return (sort_key[ia] < sort_key[ib]) ? -1 : 1;
+	return (ia < ib) ? -1 : (ia > ib);
+}
+
+/* Apply the permutation idx to every column */
+static void _op_sort(trace_t *t)
+{
+	uint32_t *idx, *u32;
+	uint8_t *u8;
+	int64_t *i64;
+	uint32_t i;
+	int f;
+
+	idx = _xcalloc(t->rows, sizeof(uint32_t));
+	for (i = 0; i < t->rows; i++)
+		idx[i] = i;
+	sort_key = t->num[F_SUBMIT];
+	qsort(idx, t->rows, sizeof(uint32_t), _cmp_submit);
+
+	i64 = _xcalloc(t->rows, sizeof(int64_t));
+	for (f = 0; f < F_FIRST_STR; f++) {
+		for (i = 0; i < t->rows; i++)
+			i64[i] = t->num[f][idx[i]];
+		memcpy(t->num[f], i64, t->rows * sizeof(int64_t));
+	}
+	free(i64);
+
+	u32 = _xcalloc(t->rows, sizeof(uint32_t));
+	for (f = 0; f <= STR_CNT; f++) {
+		uint32_t *col = (f == STR_CNT) ? t->row : t->code[f];
+		for (i = 0; i < t->rows; i++)
+			u32[i] = col[idx[i]];
+		memcpy(col, u32, t->rows * sizeof(uint32_t));
+	}
+	free(u32);
+
+	u8 = _xcalloc(t->rows, sizeof(uint8_t));
+	for (i = 0; i < t->rows; i++)
+		u8[i] = t->sel[idx[i]];
+	memcpy(t->sel, u8, t->rows);
+	free(u8);
+	free(idx);
+}
+
+static int _cmp_int64(const void *a, const void *b)
+{
+	int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+
+	return (x < y) ? -1 : (x > y);
+}
+
+static int64_t _pct(int64_t *v, uint32_t n, int pct)
+{
+	uint32_t i = ((uint64_t) n * pct) / 100;
+
+	return v[(i < n) ? i : (n - 1)];
+}
+
+/* Print the distribution of the n values in v, sorting v */
+static void _print_dist(const char *name, const char *unit, int64_t *v,
+			uint32_t n)
+{
+	long double sum = 0;
+	uint32_t i;
+
+	if (!n)
+		return;
+	qsort(v, n, sizeof(int64_t), _cmp_int64);
+	for (i = 0; i < n; i++)
+		sum += v[i];
+	printf("  %-14s min %"PRId64" p10 %"PRId64" p50 %"PRId64
+	       " p90 %"PRId64" p99 %"PRId64" max %"PRId64" mean %.1Lf %s\n",
+	       name, v[0], _pct(v, n, 10), _pct(v, n, 50), _pct(v, n, 90),
+	       _pct(v, n, 99), v[n - 1], sum / n, unit);
+}
+
+/* Count of selected jobs per value of a string field, most common first */
+static void _print_counts(trace_t *t, field_t field, uint32_t sel_cnt)
+{
+	int s = field - F_FIRST_STR;
+	dict_t *d = &t->dict[s];
+	int64_t *cnt;
+	uint32_t i, distinct = 0, shown;
+
+	/* count * dict size + code, sorted descending, keeps codes paired */
+	cnt = _xcalloc(d->cnt, sizeof(int64_t));
+	for (i = 0; i < t->rows; i++)
+		cnt[t->code[s][i]] += t->sel[i];
+	for (i = 0; i < d->cnt; i++) {
+		if (cnt[i])
+			distinct++;
+		cnt[i] = -((cnt[i] * d->cnt) + i);
+	}
+	qsort(cnt, d->cnt, sizeof(int64_t), _cmp_int64);
+
+	printf("  %s: %u distinct\n", field_names[field], distinct);
+	for (i = 0, shown = 0; (i < d->cnt) && (shown < 10); i++) {
+		int64_t c = -cnt[i] / d->cnt;
+		uint32_t code = -cnt[i] % d->cnt;
+		if (!c)
+			break;
+		printf("    %-30s %10"PRId64" (%.1f%%)\n",
+		       d->str[code][0] ? d->str[code] : "(none)", c,
+		       (100.0 * c) / sel_cnt);
+		shown++;
+	}
+	free(cnt);
+}
+
+static void _op_stats(trace_t *t)
+{
+	int64_t *v, first, last;
+	uint32_t hist[33];
+	uint32_t i, n = 0, b;
+
+	v = _xcalloc(t->rows, sizeof(int64_t));
+	for (i = 0; i < t->rows; i++)
+		n += t->sel[i];
+
+	printf("%u of %u jobs selected\n", n, t->rows);
+	if (!n) {
+		free(v);
+		return;
+	}
+
+	/* Arrivals, from the sorted submit times */
+	for (i = 0, n = 0; i < t->rows; i++) {
+		if (t->sel[i])
+			v[n++] = t->num[F_SUBMIT][i];
+	}
+	qsort(v, n, sizeof(int64_t), _cmp_int64);
+	first = v[0];
+	last = v[n - 1];
+	printf("  submit         first %"PRId64" last %"PRId64" span %"PRId64
+	       " s, %.2f jobs/hour\n", first, last, last - first,
+	       (last > first) ? (n * 3600.0) / (last - first) : 0.0);
+	for (i = n - 1; i > 0; i--)
+		v[i] -= v[i - 1];
+	_print_dist("interarrival", "s", v + 1, n - 1);
+
+	for (i = 0, n = 0; i < t->rows; i++) {
+		if (t->sel[i])
+			v[n++] = t->num[F_DURATION][i];
+	}
+	_print_dist("duration", "s", v, n);
+
+	for (i = 0, n = 0; i < t->rows; i++) {
+		if (t->sel[i])
+			v[n++] = t->num[F_WCLIMIT][i];
+	}
+	_print_dist("wclimit", "min", v, n);
+
+	/* Runtime over requested time, in percent */
+	for (i = 0, n = 0; i < t->rows; i++) {
+		if (!t->sel[i] || (t->num[F_WCLIMIT][i] <= 0))
+			continue;
+		v[n++] = (t->num[F_DURATION][i] * 100) /
+			 (t->num[F_WCLIMIT][i] * 60);
+	}
+	_print_dist("wclimit_used", "%", v, n);
+
+	memset(hist, 0, sizeof(hist));
+	for (i = 0, n = 0; i < t->rows; i++) {
+		int64_t cpus;
+		if (!t->sel[i])
+			continue;
+		cpus = t->num[F_TASKS][i];
+		if (t->num[F_CPUS_PER_TASK][i] > 1)
+			cpus *= t->num[F_CPUS_PER_TASK][i];
+		v[n++] = cpus;
+		for (b = 0; (b < 32) && ((1LL << b) < cpus); b++)
+			;
+		hist[b]++;
+	}
+	_print_dist("cpus", "", v, n);
+	printf("  cpus histogram:");
+	for (b = 0; b < 33; b++) {
+		if (hist[b])
+			printf(" <=%lld:%u", 1LL << b, hist[b]);
+	}
+	printf("\n");
+	free(v);
+
+	_print_counts(t, F_USERNAME, n);
+	_print_counts(t, F_PARTITION, n);
+	_print_counts(t, F_QOSNAME, n);
+}
+
+static void _run_ops(trace_t *t)
+{
+	uint32_t i, n;
+	int o;
+
+	for (o = 0; o < op_cnt; o++) {
+		op_t *op = &ops[o];
+
+		switch (op->type) {
+		case OP_FILTER:
+			_op_filter(t, op);
+			for (i = 0, n = 0; i < t->rows; i++)
+				n += t->sel[i];
+			printf("Filter %s: %u jobs selected\n",
+			       field_names[op->field], n);
+			break;
+		case OP_ALL:
+			memset(t->sel, 1, t->rows);
+			break;
+		case OP_SET:
+			_op_set(t, op);
+			break;
+		case OP_MAP:
+			_op_map(t, op);
+			break;
+		case OP_REMOVE:
+			_op_remove(t);
+			break;
+		case OP_SORT:
+			_op_sort(t);
+			break;
+		case OP_STATS:
+			_op_stats(t);
+			break;
+		}
+	}
+}
+
+static int _parse_field(const char *str, size_t len, field_t *field)
+{
+	int f;
+
+	for (f = 0; f < F_CNT; f++) {
+		if ((strlen(field_names[f]) == len) &&
+		    !strncmp(str, field_names[f], len)) {
+			*field = f;
+			return 0;
+		}
+	}
+	printf("Unknown field: %.*s\n", (int) len, str);
+	return -1;
+}
+
+/* Split "<field><op><value>" at the first operator character */
+static int _parse_expr(char *expr, op_t *op, const char **ops_allowed,
+		       int ops_cnt)
+{
+	size_t flen = strcspn(expr, "=!<>+-*");
+	char *rest = expr + flen, *end;
+	int i;
+
+	if (!flen || !*rest || _parse_field(expr, flen, &op->field))
+		return -1;
+
+	for (i = ops_cnt - 1; i >= 0; i--) {
+		/* longest operators are listed last */
+		size_t olen = strlen(ops_allowed[i]);
+		if (!strncmp(rest, ops_allowed[i], olen)) {
+			op->how = i;
+			rest += olen;
+			break;
+		}
+	}
+	if (i < 0) {
+		printf("Bad operator in: %s\n", expr);
+		return -1;
+	}
+
+	if (IS_STR(op->field)) {
+		if ((op->type == OP_FILTER) ? (op->how > CMP_NE) :
+		    (op->how != SET_ASSIGN)) {
+			printf("Only = and != apply to %s\n",
+			       field_names[op->field]);
+			return -1;
+		}
+		op->sval = strdup(rest);
+		return 0;
+	}
+
+	errno = 0;
+	if ((op->type == OP_SET) && (op->how == SET_MUL)) {
+		op->fval = strtod(rest, &end);
+		if (op->fval < 0) {
+			printf("Negative factor in: %s\n", expr);
+			return -1;
+		}
+	} else
+		op->ival = strtoll(rest, &end, 10);
+	if (errno || (end == rest) || *end) {
+		printf("Bad number in: %s\n", expr);
+		return -1;
+	}
+	return 0;
+}
+
+static op_t *_add_op(op_type_t type)
+{
+	ops = realloc(ops, (op_cnt + 1) * sizeof(op_t));
+	if (!ops) {
+		printf("Out of memory\nAbort!\n");
+		exit(-1);
+	}
+	memset(&ops[op_cnt], 0, sizeof(op_t));
+	ops[op_cnt].type = type;
+	return &ops[op_cnt++];
+}
+
+int main(int argc, char *argv[]) {
+
+	trace_t trace;
+
+	if ( !getArgs(argc, argv) ) {
+		printf("Usage: %s\n", help_msg);
+		exit(-1);
+	}
+
+	if (_load_trace(&trace, input_file))
+		exit(-1);
+	printf("Loaded %u jobs from %s\n", trace.rows, input_file);
+
+	_run_ops(&trace);
+
+	if (output_file && _write_trace(&trace, output_file))
+		exit(-1);
+
+	return 0;
+}
+
+int
+getArgs(int argc, char** argv) {
+	static struct option long_options[] = {
+		{"input",          1, 0, 'i'},
+		{"output",         1, 0, 'o'},
+		{"filter",         1, 0, 'f'},
+		{"all",            0, 0, 'a'},
+		{"set",            1, 0, 's'},
+		{"map",            1, 0, 'm'},
+		{"remove",         0, 0, 'X'},
+		{"sort",           0, 0, 't'},
+		{"stats",          0, 0, 'S'},
+		{"help",           0, 0, 'h'},
+		{0, 0, 0, 0}
+	};
+	/* Indexed by cmp_t and set_t */
+	static const char *cmp_ops[] = { "=", "!=", "<", "<=", ">", ">=" };
+	static const char *set_ops[] = { "=", "+=", "-=", "*=" };
+	int opt_char, option_index;
+	char *eq;
+	op_t *op;
+	int valid = 1;
+
+	while (1) {
+		if ( (opt_char = getopt_long(argc, argv, "i:o:f:as:m:XtSh",
+					long_options, &option_index)) == -1 )
+			break;
+		switch (opt_char) {
+			case ('i'):
+				input_file = strdup(optarg);
+				break;
+			case ('o'):
+				output_file = strdup(optarg);
+				break;
+			case ('f'):
+				op = _add_op(OP_FILTER);
+				if (_parse_expr(optarg, op, cmp_ops, 6))
+					valid = 0;
+				break;
+			case ('a'):
+				(void) _add_op(OP_ALL);
+				break;
+			case ('s'):
+				op = _add_op(OP_SET);
+				if (_parse_expr(optarg, op, set_ops, 4))
+					valid = 0;
+				break;
+			case ('m'):
+				op = _add_op(OP_MAP);
+				eq = strchr(optarg, '=');
+				if (!eq || !(op->sval = strchr(optarg, ':')) ||
+				    (op->sval > eq) ||
+				    _parse_field(optarg, op->sval - optarg,
+						 &op->field) ||
+				    !IS_STR(op->field)) {
+					printf("Bad map: %s\n", optarg);
+					valid = 0;
+					break;
+				}
+				op->sval = strndup(op->sval + 1,
+						   eq - op->sval - 1);
+				op->sval2 = strdup(eq + 1);
+				break;
+			case ('X'):
+				(void) _add_op(OP_REMOVE);
+				break;
+			case ('t'):
+				(void) _add_op(OP_SORT);
+				break;
+			case ('S'):
+				(void) _add_op(OP_STATS);
+				break;
+			case ('h'):
+				printf("%s\n", help_msg);
+				exit(0);
+			default:
+				valid = 0;
+		};
+	}
+
+	if (!input_file) input_file = default_trace_file;
+
+	return valid;
+}
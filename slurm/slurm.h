@@ -938,6 +938,21 @@ enum node_states {
 #define SHOW_FEDERATION	0x0040	/* Show federated state information.
 				 * Shows local info if not in federation */
 
+/* Field groups of job records reported by slurm_load_jobs_query(), fields
+ * of groups not requested are reported as NULL. IDs, user, state, reason,
+ * times, priority, partition, account, QOS, name, reservation and CPU and
+ * node counts are always reported. Values can be ORed */
+#define JOB_FIELD_NODES		0x00000001 /* nodes, sched_nodes, node_inx,
+					    * batch_host, alloc_node */
+#define JOB_FIELD_TEXT		0x00000002 /* comments, network, licenses,
+					    * burst buffer, wckey, mcs_label */
+#define JOB_FIELD_DETAILS	0x00000004 /* features, dependency, command,
+					    * work_dir, std_in/out/err,
+					    * requested and excluded nodes */
+#define JOB_FIELD_TRES		0x00000008 /* gres and TRES strings */
+#define JOB_FIELD_FED		0x00000010 /* federation origin, siblings */
+#define JOB_FIELD_ALL		0xffffffff
+
 /* Define keys for ctx_key argument of slurm_step_ctx_get() */
 enum ctx_keys {
 	SLURM_STEP_CTX_STEPID,	/* get the created job step id */
@@ -1780,6 +1795,36 @@ typedef struct job_info_msg {
 	slurm_job_info_t *job_array;	/* the job records */
 } job_info_msg_t;
 
+/* Jobs changed since a generation, see slurm_load_jobs_delta() */
+typedef struct job_info_delta_msg {
+	uint64_t generation;	/* generation of this data, to pass to the
+				 * next slurm_load_jobs_delta() call */
+	uint16_t full;		/* set if job_info holds every job and any
+				 * older copy must be discarded */
+	uint32_t purged_cnt;	/* number of jobs purged */
+	uint32_t *purged_job_ids; /* IDs of the jobs purged */
+	job_info_msg_t *job_info; /* jobs added or modified */
+	uint32_t removed_cnt;	/* number of jobs removed */
+	uint32_t *removed_job_ids; /* IDs of the jobs which changed and are
+				 * no longer visible */
+} job_info_delta_msg_t;
+
+/* Jobs to report by slurm_load_jobs_query(), a job is reported if it
+ * matches every list which is not empty */
+typedef struct job_info_query {
+	char *accounts;		/* comma separated account names */
+	uint32_t fields;	/* JOB_FIELD_* to report */
+	uint32_t job_id_cnt;	/* number of job IDs */
+	uint32_t *job_ids;	/* job, job array or pack job IDs */
+	char *partitions;	/* comma separated partition names */
+	uint16_t show_flags;	/* job filtering options, SHOW_* */
+	uint32_t state_cnt;	/* number of states */
+	uint32_t *states;	/* base job states (e.g. JOB_RUNNING) or
+				 * job state flags (e.g. JOB_COMPLETING) */
+	uint32_t user_id_cnt;	/* number of user IDs */
+	uint32_t *user_ids;	/* job owners */
+} job_info_query_t;
+
 typedef struct step_update_request_msg {
 	time_t end_time;	/* step end time */
 	uint32_t exit_code;	/* exit code for job (status from wait call) */
@@ -2179,6 +2224,20 @@ typedef struct node_info_msg {
 	node_info_t *node_array;	/* the node records */
 } node_info_msg_t;
 
+/* Nodes changed since a generation, see slurm_load_node_delta() */
+typedef struct node_info_delta_msg {
+	uint64_t generation;		/* generation of this data, to pass
+					 * to the next slurm_load_node_delta()
+					 * call */
+	uint16_t full;			/* set if node_info holds every node
+					 * and any older copy must be
+					 * discarded */
+	node_info_msg_t *node_info;	/* nodes added or modified */
+	uint32_t removed_cnt;		/* number of nodes removed */
+	char **removed_names;		/* names of the nodes which changed
+					 * and are no longer visible */
+} node_info_delta_msg_t;
+
 typedef struct front_end_info {
 	char *allow_groups;		/* allowed group string */
 	char *allow_users;		/* allowed user string */
@@ -3033,6 +3092,30 @@ typedef struct stats_info_request_msg {
 	uint16_t command_id;
 } stats_info_request_msg_t;
 
+/* Lock wait/hold time histogram, bucket i counts the times with
+ * 2^i <= usec < 2^(i+1) (0 included in bucket 0, the last bucket has
+ * everything longer) */
+#define LOCK_STATS_HIST_BUCKETS	20
+/* config, job, node, partition and federation locks */
+#define LOCK_STATS_DATATYPES	5
+
+typedef struct lock_stats_hist {
+	uint32_t cnt;
+	uint64_t sum_usec;
+	uint64_t max_usec;
+	uint32_t bucket[LOCK_STATS_HIST_BUCKETS];
+} lock_stats_hist_t;
+
+/* slurmctld lock timing of one RPC type or internal thread */
+typedef struct lock_ctx_stats {
+	uint32_t id;		/* RPC type, or internal context above 0xffff */
+	char *name;
+	lock_stats_hist_t rd_wait[LOCK_STATS_DATATYPES];
+	lock_stats_hist_t rd_hold[LOCK_STATS_DATATYPES];
+	lock_stats_hist_t wr_wait[LOCK_STATS_DATATYPES];
+	lock_stats_hist_t wr_hold[LOCK_STATS_DATATYPES];
+} lock_ctx_stats_t;
+
 typedef struct stats_info_response_msg {
 	uint32_t parts_packed;
 	time_t req_time;
@@ -3082,6 +3165,9 @@ typedef struct stats_info_response_msg {
 	uint32_t *rpc_user_id;
 	uint32_t *rpc_user_cnt;
 	uint64_t *rpc_user_time;
+
+	uint32_t lock_ctx_size;
+	lock_ctx_stats_t *lock_ctx;
 } stats_info_response_msg_t;
 
 #define TRIGGER_FLAG_PERM		0x0001
@@ -3963,6 +4049,39 @@ extern int slurm_load_jobs(time_t update_time,
 			   job_info_msg_t **job_info_msg_pptr,
 			   uint16_t show_flags);
 
+/*
+ * slurm_load_jobs_delta - issue RPC to get the jobs added, modified or
+ *	purged since a generation of the job information (local cluster only)
+ * IN generation - generation of the last response, 0 for all jobs
+ * OUT resp - place to store the changes, resp->full is set if the
+ *	generation was too old or unknown and every job is reported,
+ *	otherwise jobs that changed and are no longer visible are listed in
+ *	resp->removed_job_ids
+ * IN show_flags - job filtering options
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_delta_msg
+ */
+extern int slurm_load_jobs_delta(uint64_t generation,
+				 job_info_delta_msg_t **resp,
+				 uint16_t show_flags);
+
+/*
+ * slurm_free_job_info_delta_msg - free the job changes response message
+ * IN msg - pointer to the message loaded by slurm_load_jobs_delta
+ */
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg);
+
+/*
+ * slurm_load_jobs_query - issue RPC to get the jobs matching a query, the
+ *	selection is done by slurmctld (local cluster only)
+ * IN query - jobs and fields to report
+ * OUT job_info_msg_pptr - place to store a job configuration pointer
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_jobs_query(job_info_query_t *query,
+				 job_info_msg_t **job_info_msg_pptr);
+
 /*
  * slurm_notify_job - send message to the job's stdout,
  *	usable only by user root
@@ -4185,6 +4304,28 @@ extern int slurm_load_node2(time_t update_time, node_info_msg_t **resp,
 			    uint16_t show_flags,
 			    slurmdb_cluster_rec_t *cluster);
 
+/*
+ * slurm_load_node_delta - issue RPC to get the nodes modified since a
+ *	generation of the node information (local cluster only)
+ * IN generation - generation of the last response, 0 for all nodes
+ * OUT resp - place to store the changes, resp->full is set if the
+ *	generation was too old or unknown (e.g. the node table was rebuilt)
+ *	and every node is reported, otherwise nodes that changed and are no
+ *	longer visible are listed in resp->removed_names
+ * IN show_flags - node filtering options
+ * RET 0 or a slurm error code
+ * NOTE: free the response using slurm_free_node_info_delta_msg
+ */
+extern int slurm_load_node_delta(uint64_t generation,
+				 node_info_delta_msg_t **resp,
+				 uint16_t show_flags);
+
+/*
+ * slurm_free_node_info_delta_msg - free the node changes response message
+ * IN msg - pointer to the message loaded by slurm_load_node_delta
+ */
+extern void slurm_free_node_info_delta_msg(node_info_delta_msg_t *msg);
+
 /*
  * slurm_load_node_single - issue RPC to get slurm configuration information
  *	for a specific node
@@ -1359,6 +1359,90 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	return rc;
 }
 
+/*
+ * slurm_load_jobs_delta - issue RPC to get the jobs added, modified or
+ *	purged since a generation of the job information (local cluster only)
+ * IN generation - generation of the last response, 0 for all jobs
+ * OUT resp - place to store the changes, resp->full is set if the
+ *	generation was too old or unknown and every job is reported,
+ *	otherwise jobs that changed and are no longer visible are listed in
+ *	resp->removed_job_ids
+ * IN show_flags - job filtering options
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_delta_msg
+ */
+extern int slurm_load_jobs_delta(uint64_t generation,
+				 job_info_delta_msg_t **resp,
+				 uint16_t show_flags)
+{
+	slurm_msg_t req_msg, resp_msg;
+	info_delta_request_msg_t req = {0};
+	int rc = SLURM_SUCCESS;
+
+	*resp = NULL;
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+	req.generation   = generation;
+	req.show_flags   = (show_flags | SHOW_LOCAL) & (~SHOW_FEDERATION);
+	req_msg.msg_type = REQUEST_JOB_INFO_DELTA;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					   working_cluster_rec) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_JOB_INFO_DELTA:
+		*resp = (job_info_delta_msg_t *) resp_msg.data;
+		resp_msg.data = NULL;
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc == SLURM_SUCCESS) {
+			/* Nothing changed, callers always get a response */
+			*resp = xmalloc(sizeof(job_info_delta_msg_t));
+			(*resp)->generation = generation;
+			(*resp)->job_info = xmalloc(sizeof(job_info_msg_t));
+		}
+		break;
+	default:
+		rc = SLURM_UNEXPECTED_MSG_ERROR;
+		break;
+	}
+	if (rc) {
+		slurm_seterrno(rc);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * slurm_load_jobs_query - issue RPC to get the jobs matching a query, the
+ *	selection is done by slurmctld (local cluster only)
+ * IN query - jobs and fields to report
+ * OUT job_info_msg_pptr - place to store a job configuration pointer
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_jobs_query(job_info_query_t *query,
+				 job_info_msg_t **job_info_msg_pptr)
+{
+	slurm_msg_t req_msg;
+	job_info_query_t req;
+
+	req = *query;
+	req.show_flags = (query->show_flags | SHOW_LOCAL) & (~SHOW_FEDERATION);
+
+	slurm_msg_t_init(&req_msg);
+	req_msg.msg_type = REQUEST_JOB_INFO_QUERY;
+	req_msg.data     = &req;
+
+	return _load_cluster_jobs(&req_msg, job_info_msg_pptr,
+				  working_cluster_rec);
+}
+
 /*
  * slurm_load_job_user - issue RPC to get slurm information about all jobs
  *	to be run as the specified user
@@ -753,6 +753,62 @@ extern int slurm_load_node(time_t update_time, node_info_msg_t **resp,
 	return rc;
 }
 
+/*
+ * slurm_load_node_delta - issue RPC to get the nodes modified since a
+ *	generation of the node information (local cluster only)
+ * IN generation - generation of the last response, 0 for all nodes
+ * OUT resp - place to store the changes, resp->full is set if the
+ *	generation was too old or unknown (e.g. the node table was rebuilt)
+ *	and every node is reported, otherwise nodes that changed and are no
+ *	longer visible are listed in resp->removed_names
+ * IN show_flags - node filtering options
+ * RET 0 or a slurm error code
+ * NOTE: free the response using slurm_free_node_info_delta_msg
+ */
+extern int slurm_load_node_delta(uint64_t generation,
+				 node_info_delta_msg_t **resp,
+				 uint16_t show_flags)
+{
+	slurm_msg_t req_msg, resp_msg;
+	info_delta_request_msg_t req;
+	int rc;
+
+	*resp = NULL;
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+	req.generation   = generation;
+	req.show_flags   = (show_flags | SHOW_LOCAL) & (~SHOW_FEDERATION);
+	req_msg.msg_type = REQUEST_NODE_INFO_DELTA;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					   working_cluster_rec) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_NODE_INFO_DELTA:
+		*resp = (node_info_delta_msg_t *) resp_msg.data;
+		if (show_flags & SHOW_MIXED)
+			_set_node_mixed((*resp)->node_info);
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		/* Nothing changed, callers always get a response */
+		*resp = xmalloc(sizeof(node_info_delta_msg_t));
+		(*resp)->generation = generation;
+		(*resp)->node_info = xmalloc(sizeof(node_info_msg_t));
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		break;
+	}
+
+	return SLURM_PROTOCOL_SUCCESS;
+}
+
 /*
  * slurm_load_node2 - equivalent to slurm_load_node() with addition
  *	of cluster record for communications in a federation
@@ -38,6 +38,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <sys/uio.h>
 
 #include "src/common/fd.h"
 #include "src/common/hostlist.h"
@@ -59,6 +60,7 @@
 #include "src/api/step_launch.h"
 
 #define STDIO_MAX_FREE_BUF 1024
+#define STDIO_MAX_WRITEV 64	/* most messages per writev() to a file */
 
 struct io_buf {
 	int ref_count;
@@ -568,6 +570,73 @@ static bool _file_writable(eio_obj_t *obj)
 	return false;
 }
 
+static void _file_msg_free(struct file_write_info *info, struct io_buf *msg)
+{
+	msg->ref_count--;
+	if (msg->ref_count == 0)
+		list_enqueue(info->cio->free_outgoing, msg);
+}
+
+/*
+ * Without labels a message is written to the file as it is, so write the
+ * current message along with those queued behind it in one writev().
+ * Like write_labelled_message(), block until all of it is written.
+ */
+static int _file_write_unlabelled(eio_obj_t *obj,
+				  struct file_write_info *info)
+{
+	struct iovec iov[STDIO_MAX_WRITEV], *cur = iov;
+	struct io_buf *msgs[STDIO_MAX_WRITEV], *msg;
+	int cnt = 0, i, rc = SLURM_SUCCESS;
+	ssize_t n;
+
+	msgs[0] = info->out_msg;
+	iov[0].iov_base = info->out_msg->data +
+		(info->out_msg->length - info->out_remaining);
+	iov[0].iov_len = info->out_remaining;
+	cnt = 1;
+	while ((cnt < STDIO_MAX_WRITEV) &&
+	       (msg = list_dequeue(info->msg_queue))) {
+		if ((info->taskid != (uint32_t) -1) &&
+		    (msg->header.gtaskid != info->taskid)) {
+			/* we are ignoring messages not from info->taskid */
+			_file_msg_free(info, msg);
+			continue;
+		}
+		msgs[cnt] = msg;
+		iov[cnt].iov_base = msg->data;
+		iov[cnt].iov_len = msg->length;
+		cnt++;
+	}
+	info->out_msg = NULL;
+
+	for (i = cnt; i > 0; ) {
+		if ((n = writev(obj->fd, cur, i)) < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN) ||
+			    (errno == EWOULDBLOCK))
+				continue;
+			info->eof = true;
+			rc = SLURM_ERROR;
+			break;
+		}
+		debug3("  wrote %zd bytes", n);
+		while ((i > 0) && (n >= cur->iov_len)) {
+			n -= cur->iov_len;
+			cur++;
+			i--;
+		}
+		if (i > 0) {
+			cur->iov_base += n;
+			cur->iov_len -= n;
+		}
+	}
+
+	for (i = 0; i < cnt; i++)
+		_file_msg_free(info, msgs[i]);
+
+	return rc;
+}
+
 static int _file_write(eio_obj_t *obj, List objs)
 {
 	struct file_write_info *info = (struct file_write_info *) obj->arg;
@@ -594,6 +663,9 @@ static int _file_write(eio_obj_t *obj, List objs)
 	if ((info->taskid != (uint32_t) -1) &&
 	    (info->out_msg->header.gtaskid != info->taskid)) {
 		/* we are ignoring messages not from info->taskid */
+	} else if (!info->eof && !info->cio->label) {
+		debug2("Leaving  %s", __func__);
+		return _file_write_unlabelled(obj, info);
 	} else if (!info->eof) {
 		ptr = info->out_msg->data + (info->out_msg->length
 					     - info->out_remaining);
@@ -966,27 +1038,53 @@ _wid(int n)
 	return width;
 }
 
+/*
+ * Size of one message buffer, descriptor included and rounded up so the
+ * next descriptor in a slab stays aligned. The "+ 1" is just temporary
+ * so I can stick a \0 at the end and do a printf of the data pointer
+ */
+#define IO_BUF_SIZE \
+	((sizeof(struct io_buf) + MAX_MSG_LEN + io_hdr_packed_size() + 1 + \
+	  15) & ~((size_t) 15))
+
+static void _init_io_buf(struct io_buf *buf)
+{
+	buf->ref_count = 0;
+	buf->length = 0;
+	buf->data = buf + 1;
+}
+
 static struct io_buf *
 _alloc_io_buf(void)
 {
-	struct io_buf *buf;
+	struct io_buf *buf = xmalloc(IO_BUF_SIZE);
 
-	buf = (struct io_buf *)xmalloc(sizeof(struct io_buf));
-	if (!buf)
-		return NULL;
-	buf->ref_count = 0;
-	buf->length = 0;
-	/* The following "+ 1" is just temporary so I can stick a \0 at
-	   the end and do a printf of the data pointer */
-	buf->data = xmalloc(MAX_MSG_LEN + io_hdr_packed_size() + 1);
-	if (!buf->data) {
-		xfree(buf);
-		return NULL;
-	}
+	_init_io_buf(buf);
 
 	return buf;
 }
 
+/*
+ * Carve the initial free buffers of both directions out of one slab
+ * instead of allocating each of them on its own.
+ */
+static void
+_alloc_io_buf_slab(client_io_t *cio)
+{
+	int i;
+
+	cio->io_buf_slab = xmalloc(2 * STDIO_MAX_FREE_BUF * IO_BUF_SIZE);
+	for (i = 0; i < (2 * STDIO_MAX_FREE_BUF); i++) {
+		struct io_buf *buf = cio->io_buf_slab + (i * IO_BUF_SIZE);
+
+		_init_io_buf(buf);
+		if (i < STDIO_MAX_FREE_BUF)
+			list_enqueue(cio->free_incoming, buf);
+		else
+			list_enqueue(cio->free_outgoing, buf);
+	}
+}
+
 static void
 _init_stdio_eio_objs(slurm_step_io_fds_t fds, client_io_t *cio)
 {
@@ -1151,14 +1249,9 @@ client_io_t *client_io_handler_create(slurm_step_io_fds_t fds, int num_tasks,
 
 	cio->free_incoming = list_create(NULL); /* FIXME! Needs destructor */
 	cio->incoming_count = 0;
-	for (i = 0; i < STDIO_MAX_FREE_BUF; i++) {
-		list_enqueue(cio->free_incoming, _alloc_io_buf());
-	}
 	cio->free_outgoing = list_create(NULL); /* FIXME! Needs destructor */
 	cio->outgoing_count = 0;
-	for (i = 0; i < STDIO_MAX_FREE_BUF; i++) {
-		list_enqueue(cio->free_outgoing, _alloc_io_buf());
-	}
+	_alloc_io_buf_slab(cio);
 	cio->sls = NULL;
 
 	return cio;
@@ -1232,6 +1325,7 @@ client_io_handler_destroy(client_io_t *cio)
 	xfree(cio->listensock);
 	eio_handle_destroy(cio->eio);
 	xfree(cio->io_key);
+	xfree(cio->io_buf_slab);
 	xfree(cio);
 }
 
@@ -87,6 +87,8 @@ struct client_io {
 			         * including free_incoming buffers and
 			         * buffers in use.
 			         */
+	void *io_buf_slab;	/* initial free_incoming and free_outgoing
+				 * buffers */
 
 	struct step_launch_state *sls; /* Used to notify the main thread of an
 				       I/O problem.  */
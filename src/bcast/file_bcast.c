@@ -77,6 +77,9 @@
 
 #define MAX_THREADS      8	/* These can be huge messages, so
 				 * only run MAX_THREADS at one time */
+#define DEFAULT_PIPELINE 4	/* blocks in flight */
+#define MAX_PIPELINE     16
+#define MAX_COMP_THREADS 8	/* compression threads */
 
 int block_len;				/* block size */
 int fd;					/* source file descriptor */
@@ -84,12 +87,37 @@ void *src;				/* source mmap'd address */
 struct stat f_stat;			/* source file stats */
 job_sbcast_cred_msg_t *sbcast_cred;	/* job alloc info and sbcast cred */
 
+typedef struct {
+	char *buffer;		/* data as sent, NULL until built */
+	int32_t block_len;	/* bytes in buffer */
+	int32_t orig_len;	/* bytes of the source file it holds */
+	uint16_t compress;	/* compression applied to this block */
+	bool ready;		/* built, may be sent */
+} bcast_block_t;
+
+typedef struct {
+	struct bcast_parameters *params;
+	file_bcast_msg_t *bcast_msg;	/* fields common to all blocks */
+	bcast_block_t *blocks;
+	uint32_t block_cnt;
+	uint32_t next_comp;		/* next block to build */
+	uint32_t next_send;		/* next block to send */
+	uint32_t acked;			/* blocks acknowledged by all nodes */
+	uint32_t window;		/* blocks built ahead of next_send */
+	int rc;				/* first error aborts the transfer */
+	uint64_t size_compressed;
+	uint32_t time_compression;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} bcast_pipe_t;
+
 static int   _bcast_file(struct bcast_parameters *params);
 static int   _file_bcast(struct bcast_parameters *params,
 			 file_bcast_msg_t *bcast_msg,
 			 job_sbcast_cred_msg_t *sbcast_cred);
 static int   _file_state(struct bcast_parameters *params);
 static int   _get_job_info(struct bcast_parameters *params);
+static bool  _pwrite_capable(struct bcast_parameters *params);
 
 
 static int _file_state(struct bcast_parameters *params)
@@ -123,6 +151,8 @@ static int _file_state(struct bcast_parameters *params)
 		error("Can't mmap file `%s`, %m.", params->src_fname);
 		return SLURM_ERROR;
 	}
+	/* blocks are built roughly in order, let the kernel read ahead */
+	(void) madvise(src, f_stat.st_size, MADV_SEQUENTIAL);
 
 	return SLURM_SUCCESS;
 }
@@ -218,44 +248,50 @@ static int _file_bcast(struct bcast_parameters *params,
 	return rc;
 }
 
-/* load a buffer with data from the file to broadcast,
- * return number of bytes read, zero on end of file */
-static int _get_block_none(char **buffer, int *orig_len, bool *more)
+/*
+ * Ask every node whether its slurmd writes blocks at their block_offset.
+ * Older slurmd daemons append blocks in arrival order and reject the
+ * probe, so any failure means blocks must go out one at a time.
+ */
+static bool _pwrite_capable(struct bcast_parameters *params)
 {
-	static int64_t remaining = -1;
-	static void *position;
-	int size;
-
-	if (remaining < 0) {
-		*buffer = xmalloc(block_len);
-		remaining = f_stat.st_size;
-		position = src;
-	}
+	List ret_list = NULL;
+	ListIterator itr;
+	ret_data_info_t *ret_data_info = NULL;
+	bool capable = true;
+	slurm_msg_t msg;
 
-	size = MIN(block_len, remaining);
-	memcpy(*buffer, position, size);
-	remaining -= size;
-	position += size;
+	slurm_msg_t_init(&msg);
+	msg.msg_type = REQUEST_FILE_BCAST_PWRITE;
+
+	ret_list = slurm_send_recv_msgs(
+		sbcast_cred->node_list, &msg, params->timeout, true);
+	if (ret_list == NULL)
+		return false;
 
-	*orig_len = size;
-	*more = (remaining) ? true : false;
-	return size;
+	itr = list_iterator_create(ret_list);
+	while ((ret_data_info = list_next(itr))) {
+		if (slurm_get_return_code(ret_data_info->type,
+					  ret_data_info->data) == SLURM_SUCCESS)
+			continue;
+		verbose("%s can not write blocks out of order",
+			ret_data_info->node_name);
+		capable = false;
+	}
+	list_iterator_destroy(itr);
+	FREE_NULL_LIST(ret_list);
+
+	return capable;
 }
 
-static int _get_block_zlib(struct bcast_parameters *params,
-			   char **buffer,
-			   int *orig_len,
-			   bool *more)
+/* compress one block with zlib, return -1 to send it uncompressed */
+static int _get_block_zlib(char *position, int32_t size, bcast_block_t *block)
 {
 #if HAVE_LIBZ
-	static z_stream strm;
+	z_stream strm;
 	int chunk = (256 * 1024);
 	int flush = Z_NO_FLUSH;
-
-	static int64_t remaining = -1;
-	static int max_out;
-	static void *position;
-	int chunk_remaining, out_remaining, chunk_bite, size = 0;
+	int max_out, chunk_bite;
 
 	/* allocate deflate state, compress each block independently */
 	strm.zalloc = Z_NULL;
@@ -264,129 +300,199 @@ static int _get_block_zlib(struct bcast_parameters *params,
 	strm.avail_in = 0;
 	strm.next_in = Z_NULL;
 	if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK) {
-		error("File compression configuration error,"
-		      "sending uncompressed file.");
-		params->compress = 0;
-		return _get_block_none(buffer, orig_len, more);
-	}
-
-	/* first pass through, initialize */
-	if (remaining < 0) {
-		remaining = f_stat.st_size;
-		max_out = deflateBound(&strm, block_len);
-		*buffer = xmalloc(max_out);
-		position = src;
+		error("File compression configuration error, "
+		      "sending block uncompressed.");
+		return -1;
 	}
 
-	chunk_remaining = MIN(block_len, remaining);
-	out_remaining = max_out;
-	strm.next_out = (void *) *buffer;
-	while (chunk_remaining) {
-		strm.next_in = position;
-		chunk_bite = MIN(chunk, chunk_remaining);
+	max_out = deflateBound(&strm, size);
+	block->buffer = xmalloc(max_out);
+	strm.next_out = (void *) block->buffer;
+	strm.avail_out = max_out;
+	while (size) {
+		strm.next_in = (void *) position;
+		chunk_bite = MIN(chunk, size);
 		strm.avail_in = chunk_bite;
-		strm.avail_out = out_remaining;
 
-		if (chunk_remaining <= chunk)
+		if (size <= chunk)
 			flush = Z_FINISH;
 
 		if (deflate(&strm, flush) == Z_STREAM_ERROR)
 			fatal("Error compressing file");
 
 		position += chunk_bite;
-		size += chunk_bite;
-		chunk_remaining -= chunk_bite;
-		out_remaining = strm.avail_out;
+		size -= chunk_bite;
 	}
-	remaining -= size;
+	block->block_len = max_out - strm.avail_out;
 
 	(void) deflateEnd(&strm);
-
-	*orig_len = size;
-	*more = (remaining) ? true : false;
-	return (max_out - out_remaining);
+	return 0;
 #else
-	info("zlib compression not supported, sending uncompressed file.");
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	return -1;
 #endif
 }
 
-static int _get_block_lz4(struct bcast_parameters *params,
-			  char **buffer,
-			  int32_t *orig_len,
-			  bool *more)
+/* compress one block with lz4, return -1 to send it uncompressed */
+static int _get_block_lz4(char *position, int32_t size, bcast_block_t *block)
 {
 #if HAVE_LZ4
-	int size_out;
-	static int64_t remaining = -1;
-	static void *position;
-	int size;
-
-	if (!f_stat.st_size) {
-		*more = false;
-		return 0;
-	}
-
-	if (remaining < 0) {
-		position = src;
-		remaining = f_stat.st_size;
-		*buffer = xmalloc(block_len);
-	}
+	int max_out = LZ4_compressBound(size);
 
-	/* intentionally limit decompressed size to 10x compressed
-	 * to avoid problems on receive size when decompressed */
-	size = MIN(block_len * 10, remaining);
-	if (!(size_out = LZ4_compress_destSize(position, *buffer,
-					       &size, block_len))) {
+	block->buffer = xmalloc(max_out);
+	if (!(block->block_len = LZ4_compress_default(position, block->buffer,
+						      size, max_out))) {
 		/* compression failure */
 		fatal("LZ4 compression error");
 	}
-	position += size;
-	remaining -= size;
-
-	*orig_len = size;
-	*more = (remaining) ? true : false;
-	return size_out;
+	return 0;
 #else
-	info("lz4 compression not supported, sending uncompressed file.");
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	return -1;
 #endif
+}
 
+/*
+ * Load block inx of the source file, compressed as requested. Blocks cover
+ * fixed ranges of the file so they can be built in any order. Uncompressed
+ * blocks point into the mmap'd file.
+ */
+static void _get_block(uint16_t compress, uint32_t inx, bcast_block_t *block)
+{
+	int64_t offset = (int64_t) inx * block_len;
+	char *position = (char *) src + offset;
+	int32_t size = MIN(block_len, f_stat.st_size - offset);
+	int rc = -1;
+
+	block->orig_len = size;
+	if (size && (compress == COMPRESS_ZLIB))
+		rc = _get_block_zlib(position, size, block);
+	else if (size && (compress == COMPRESS_LZ4))
+		rc = _get_block_lz4(position, size, block);
+
+	if (rc == 0) {
+		block->compress = compress;
+	} else {
+		block->compress = COMPRESS_OFF;
+		block->buffer = size ? position : NULL;
+		block->block_len = size;
+	}
 }
 
-static int _next_block(struct bcast_parameters *params,
-		       char **buffer,
-		       int32_t *orig_len,
-		       bool *more)
+static void _free_block(bcast_block_t *block)
 {
-	switch (params->compress) {
-	case COMPRESS_OFF:
-		return _get_block_none(buffer, orig_len, more);
-	case COMPRESS_ZLIB:
-		return _get_block_zlib(params, buffer, orig_len, more);
-	case COMPRESS_LZ4:
-		return _get_block_lz4(params, buffer, orig_len, more);
+	if (block->compress != COMPRESS_OFF)
+		xfree(block->buffer);
+	block->buffer = NULL;
+}
+
+/* may block inx go out now, must hold pipe mutex */
+static bool _can_send(bcast_pipe_t *bp, uint32_t inx)
+{
+	if (!bp->blocks[inx].ready)
+		return false;
+	/* the first block registers the file on the nodes */
+	if ((inx > 0) && (bp->acked == 0))
+		return false;
+	/* the last block closes it */
+	if ((inx == bp->block_cnt - 1) && (bp->acked < inx))
+		return false;
+	return true;
+}
+
+/* compression worker, fills blocks up to window ahead of the sender */
+static void *_comp_thread(void *arg)
+{
+	bcast_pipe_t *bp = (bcast_pipe_t *) arg;
+	uint32_t inx;
+	DEF_TIMERS;
+
+	slurm_mutex_lock(&bp->mutex);
+	while (1) {
+		while (!bp->rc && (bp->next_comp < bp->block_cnt) &&
+		       (bp->next_comp >= bp->next_send + bp->window))
+			slurm_cond_wait(&bp->cond, &bp->mutex);
+		if (bp->rc || (bp->next_comp >= bp->block_cnt))
+			break;
+		inx = bp->next_comp++;
+		slurm_mutex_unlock(&bp->mutex);
+
+		START_TIMER;
+		_get_block(bp->params->compress, inx, &bp->blocks[inx]);
+		END_TIMER;
+
+		slurm_mutex_lock(&bp->mutex);
+		bp->blocks[inx].ready = true;
+		bp->time_compression += DELTA_TIMER;
+		slurm_cond_broadcast(&bp->cond);
 	}
+	slurm_mutex_unlock(&bp->mutex);
 
-	/* compression type not recognized */
-	error("File compression type %u not supported,"
-	      " sending uncompressed file.", params->compress);
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	return NULL;
+}
+
+/* sender, one per block in flight, sends blocks in order */
+static void *_send_thread(void *arg)
+{
+	bcast_pipe_t *bp = (bcast_pipe_t *) arg;
+	file_bcast_msg_t bcast_msg;
+	bcast_block_t *block;
+	uint32_t inx;
+	int rc;
+
+	slurm_mutex_lock(&bp->mutex);
+	while (1) {
+		while (!bp->rc && (bp->next_send < bp->block_cnt) &&
+		       !_can_send(bp, bp->next_send))
+			slurm_cond_wait(&bp->cond, &bp->mutex);
+		if (bp->rc || (bp->next_send >= bp->block_cnt))
+			break;
+		inx = bp->next_send++;
+		slurm_cond_broadcast(&bp->cond);	/* window moved */
+		slurm_mutex_unlock(&bp->mutex);
+
+		block = &bp->blocks[inx];
+		memcpy(&bcast_msg, bp->bcast_msg, sizeof(file_bcast_msg_t));
+		bcast_msg.block_no	= inx + 1;
+		bcast_msg.block_offset	= (uint64_t) inx * block_len;
+		bcast_msg.block_len	= block->block_len;
+		bcast_msg.uncomp_len	= block->orig_len;
+		bcast_msg.compress	= block->compress;
+		bcast_msg.block		= block->buffer;
+		bcast_msg.last_block	= (inx == bp->block_cnt - 1) ? 1 : 0;
+		debug("block %u, size %u", bcast_msg.block_no,
+		      bcast_msg.block_len);
+
+		rc = _file_bcast(bp->params, &bcast_msg, sbcast_cred);
+
+		slurm_mutex_lock(&bp->mutex);
+		bp->size_compressed += block->block_len;
+		_free_block(block);
+		if (rc != SLURM_SUCCESS)
+			bp->rc = MAX(bp->rc, rc);
+		else
+			bp->acked++;
+		slurm_cond_broadcast(&bp->cond);
+	}
+	slurm_mutex_unlock(&bp->mutex);
+
+	return NULL;
 }
 
-/* read and broadcast the file */
+/*
+ * read and broadcast the file
+ *
+ * Compression threads build blocks ahead of transmission while up to
+ * params->pipeline sender threads each keep one block in flight through
+ * the forwarding tree. The nodes write blocks at their offset, so only the
+ * first block (which creates the file) and the last one (which closes it)
+ * are serialized against the others. If any node's slurmd predates offset
+ * writes a single sender keeps the blocks in order.
+ */
 static int _bcast_file(struct bcast_parameters *params)
 {
-	int rc = SLURM_SUCCESS;
 	file_bcast_msg_t bcast_msg;
-	char *buffer = NULL;
-	int32_t orig_len = 0;
-	uint64_t size_uncompressed = 0, size_compressed = 0;
-	uint32_t time_compression = 0;
-	bool more = true;
+	bcast_pipe_t bp;
+	pthread_t *comp_tids, *send_tids;
+	int comp_cnt, send_cnt, i;
 	DEF_TIMERS;
 
 	if (params->block_size)
@@ -394,9 +500,30 @@ static int _bcast_file(struct bcast_parameters *params)
 	else
 		block_len = MIN((512 * 1024), f_stat.st_size);
 
+	switch (params->compress) {
+	case COMPRESS_OFF:
+		break;
+	case COMPRESS_ZLIB:
+#if !HAVE_LIBZ
+		info("zlib compression not supported, sending uncompressed file.");
+		params->compress = 0;
+#endif
+		break;
+	case COMPRESS_LZ4:
+#if !HAVE_LZ4
+		info("lz4 compression not supported, sending uncompressed file.");
+		params->compress = 0;
+#endif
+		break;
+	default:
+		/* compression type not recognized */
+		error("File compression type %u not supported,"
+		      " sending uncompressed file.", params->compress);
+		params->compress = 0;
+	}
+
 	memset(&bcast_msg, 0, sizeof(file_bcast_msg_t));
 	bcast_msg.fname		= params->dst_fname;
-	bcast_msg.block_no	= 1;
 	bcast_msg.force		= params->force;
 	bcast_msg.modes		= f_stat.st_mode;
 	bcast_msg.uid		= f_stat.st_uid;
@@ -414,35 +541,67 @@ static int _bcast_file(struct bcast_parameters *params)
 		params->fanout = MAX_THREADS;
 	slurm_set_tree_width(MIN(MAX_THREADS, params->fanout));
 
-	while (more) {
-		START_TIMER;
-		bcast_msg.block_len = _next_block(params, &buffer, &orig_len,
-						  &more);
-		END_TIMER;
-		time_compression += DELTA_TIMER;
-		size_uncompressed += orig_len;
-		size_compressed += bcast_msg.block_len;
-		debug("block %u, size %u", bcast_msg.block_no,
-		      bcast_msg.block_len);
-		bcast_msg.compress = params->compress;
-		bcast_msg.uncomp_len = orig_len;
-		bcast_msg.block = buffer;
-		if (!more)
-			bcast_msg.last_block = 1;
-
-		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
-		if (rc != SLURM_SUCCESS)
-			break;
-		if (bcast_msg.last_block)
-			break;	/* end of file */
-		bcast_msg.block_no++;
-		bcast_msg.block_offset += orig_len;
+	send_cnt = params->pipeline;
+	if (send_cnt <= 0)
+		send_cnt = DEFAULT_PIPELINE;
+	send_cnt = MIN(send_cnt, MAX_PIPELINE);
+	if (block_len && (f_stat.st_size > 2 * (off_t) block_len) &&
+	    (send_cnt > 1) && !_pwrite_capable(params)) {
+		verbose("Sending blocks in order, not all nodes support "
+			"pipelined transfers");
+		send_cnt = 1;
+	}
+	if (params->compress == COMPRESS_OFF) {
+		comp_cnt = 1;
+	} else {
+		comp_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+		comp_cnt = MAX(1, MIN(comp_cnt, MAX_COMP_THREADS));
 	}
+
+	memset(&bp, 0, sizeof(bcast_pipe_t));
+	bp.params = params;
+	bp.bcast_msg = &bcast_msg;
+	bp.block_cnt = 1;
+	if (block_len)
+		bp.block_cnt = (f_stat.st_size + block_len - 1) / block_len;
+	bp.blocks = xmalloc(sizeof(bcast_block_t) * bp.block_cnt);
+	bp.window = send_cnt + comp_cnt;
+	slurm_mutex_init(&bp.mutex);
+	slurm_cond_init(&bp.cond, NULL);
+
+	START_TIMER;
+	comp_tids = xmalloc(sizeof(pthread_t) * comp_cnt);
+	for (i = 0; i < comp_cnt; i++)
+		slurm_thread_create(&comp_tids[i], _comp_thread, &bp);
+	send_tids = xmalloc(sizeof(pthread_t) * send_cnt);
+	for (i = 0; i < send_cnt; i++)
+		slurm_thread_create(&send_tids[i], _send_thread, &bp);
+
+	for (i = 0; i < send_cnt; i++)
+		pthread_join(send_tids[i], NULL);
+	/* wake up compression threads stalled on an aborted transfer */
+	slurm_mutex_lock(&bp.mutex);
+	slurm_cond_broadcast(&bp.cond);
+	slurm_mutex_unlock(&bp.mutex);
+	for (i = 0; i < comp_cnt; i++)
+		pthread_join(comp_tids[i], NULL);
+	END_TIMER;
+	verbose("File transferred in %u blocks with %d senders and %d "
+		"compression threads in %s", bp.block_cnt, send_cnt,
+		comp_cnt, TIME_STR);
+
+	for (i = 0; i < bp.block_cnt; i++)
+		_free_block(&bp.blocks[i]);
+	xfree(bp.blocks);
+	xfree(comp_tids);
+	xfree(send_tids);
+	slurm_mutex_destroy(&bp.mutex);
+	slurm_cond_destroy(&bp.cond);
 	xfree(bcast_msg.user_name);
-	xfree(buffer);
 
-	if (size_uncompressed && (params->compress != 0)) {
-		int64_t pct = (int64_t) size_uncompressed - size_compressed;
+	if (f_stat.st_size && (params->compress != 0)) {
+		uint64_t size_uncompressed = f_stat.st_size;
+		int64_t pct = (int64_t) size_uncompressed - bp.size_compressed;
 		/* Dividing a negative by a positive in C99 results in
 		 * "truncation towards zero" which gives unexpected values for
 		 * pct. This construct avoids that problem.
@@ -450,11 +609,11 @@ static int _bcast_file(struct bcast_parameters *params)
 		pct = (pct>=0) ? pct * 100 / size_uncompressed
 			       : - (-pct * 100 / size_uncompressed);
 		verbose("File compressed from %"PRIu64" to %"PRIu64" (%d percent) in %u usec",
-			size_uncompressed, size_compressed, (int) pct,
-			time_compression);
+			size_uncompressed, bp.size_compressed, (int) pct,
+			bp.time_compression);
 	}
 
-	return rc;
+	return bp.rc;
 }
 
 
@@ -38,10 +38,13 @@
 \*****************************************************************************/
 
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "slurm/slurm.h"
@@ -52,9 +55,32 @@
 #include "src/common/slurm_route.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_interface.h"
+#include "src/common/timers.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+/*
+ * Per-node statistics used to choose forwarders. Every exchange made by the
+ * tree threads, and by slurmctld's agent through forward_node_stat(),
+ * updates a smoothed response time and a count of consecutive failures for
+ * the node contacted.
+ */
+#define FWD_RTT_WEIGHT		8	/* EMA weight 1/8, as TCP's SRTT */
+#define FWD_SUSPECT_TIME	300	/* secs a failure keeps a node suspect */
+#define FWD_SWAP_FACTOR		2	/* only replace a forwarder that much
+					 * slower than the best candidate */
+
+typedef struct {
+	char *name;
+	long rtt;		/* smoothed usec per tree level, 0 if unknown */
+	uint32_t fails;		/* consecutive failures */
+	time_t fail_time;	/* time of last failure */
+} fwd_node_stat_t;
+
+static pthread_mutex_t fwd_stat_mutex = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *fwd_stat_hash = NULL;
+
 typedef struct {
 	pthread_cond_t *notify;
 	int            *p_thr_count;
@@ -73,6 +99,195 @@ static void _forward_msg_internal(hostlist_t hl, hostlist_t* sp_hl,
 				  header_t *header, int timeout,
 				  int hl_count);
 
+static const char *_fwd_stat_id(void *item)
+{
+	return ((fwd_node_stat_t *) item)->name;
+}
+
+static void _fwd_stat_free(void *item)
+{
+	fwd_node_stat_t *stat = (fwd_node_stat_t *) item;
+
+	xfree(stat->name);
+	xfree(stat);
+}
+
+/* Number of tree levels below a node forwarding to cnt others */
+static int _fwd_levels(int cnt, uint16_t tree_width)
+{
+	if (!tree_width)
+		tree_width = slurm_get_tree_width();
+	if (!tree_width)
+		return 1;
+	return (cnt / tree_width) + 1;
+}
+
+/*
+ * Cost of using node name as a forwarder: its smoothed RTT, 0 if nothing is
+ * known about it yet or LONG_MAX if it failed recently.
+ * fwd_stat_mutex must be locked.
+ */
+static long _fwd_cost(const char *name, time_t now)
+{
+	fwd_node_stat_t *stat = xhash_get(fwd_stat_hash, name);
+
+	if (!stat)
+		return 0;
+	if (stat->fails && (difftime(now, stat->fail_time) < FWD_SUSPECT_TIME))
+		return LONG_MAX;
+	return stat->rtt;
+}
+
+/*
+ * _plan_forwarders - make the first host of each sub-hostlist built by
+ *	route_g_split_hostlist(), the one which will forward to the rest of
+ *	it, the healthiest and fastest node we know of. A sublist in which
+ *	every node failed recently is split into smaller sublists, down to
+ *	direct sends, so one dead forwarder can not hold the whole branch
+ *	until the message times out. The split never takes the number of
+ *	sublists, each of which gets its own thread, above tree_width.
+ * IN/OUT sp_hl - array of sub-hostlists, may be reallocated
+ * IN/OUT hl_count - number of entries in sp_hl
+ * IN tree_width - fan-out of the message, 0 for TreeWidth
+ */
+static void _plan_forwarders(hostlist_t **sp_hl, int *hl_count,
+			     uint16_t tree_width)
+{
+	hostlist_t *new_hl, hl, first;
+	hostlist_iterator_t itr;
+	long *cost = NULL, known_sum;
+	int i, j, cnt, best, known_cnt, new_cnt = 0, new_size, parts, spare;
+	char *name;
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&fwd_stat_mutex);
+	if (!fwd_stat_hash) {
+		/* Nothing learned yet, keep the plugin's layout */
+		slurm_mutex_unlock(&fwd_stat_mutex);
+		return;
+	}
+
+	if (!tree_width)
+		tree_width = slurm_get_tree_width();
+	spare = MAX((int) tree_width - *hl_count, 0);
+	new_size = *hl_count;
+	new_hl = xmalloc(sizeof(hostlist_t) * new_size);
+	for (i = 0; i < *hl_count; i++) {
+		hl = (*sp_hl)[i];
+		cnt = hostlist_count(hl);
+		if (cnt < 2) {
+			new_hl[new_cnt++] = hl;
+			continue;
+		}
+
+		xrealloc(cost, sizeof(long) * cnt);
+		known_sum = 0;
+		known_cnt = 0;
+		itr = hostlist_iterator_create(hl);
+		for (j = 0; (j < cnt) && (name = hostlist_next(itr)); j++) {
+			cost[j] = _fwd_cost(name, now);
+			if (cost[j] && (cost[j] != LONG_MAX)) {
+				known_sum += cost[j];
+				known_cnt++;
+			}
+			free(name);
+		}
+		hostlist_iterator_destroy(itr);
+
+		/* Nodes never heard from are assumed to be average */
+		best = 0;
+		for (j = 0; j < cnt; j++) {
+			if (!cost[j])
+				cost[j] = known_cnt ? (known_sum / known_cnt) : 1;
+			if (cost[j] < cost[best])
+				best = j;
+		}
+
+		if ((cost[best] == LONG_MAX) &&
+		    ((parts = MIN(cnt, spare + 1)) > 1)) {
+			debug2("%s: no healthy forwarder in %d nodes, "
+			       "splitting them %d ways", __func__, cnt, parts);
+			spare -= parts - 1;
+			new_size += parts - 1;
+			xrealloc(new_hl, sizeof(hostlist_t) * new_size);
+			for (j = 0; j < parts; j++) {
+				int k, part_cnt = (cnt / parts) +
+						  (j < (cnt % parts));
+
+				first = hostlist_create(NULL);
+				for (k = 0; k < part_cnt; k++) {
+					name = hostlist_shift(hl);
+					hostlist_push_host(first, name);
+					free(name);
+				}
+				new_hl[new_cnt++] = first;
+			}
+			hostlist_destroy(hl);
+			continue;
+		}
+
+		/* Don't churn the tree over small differences */
+		if (best && (cost[0] != LONG_MAX) &&
+		    ((cost[best] * FWD_SWAP_FACTOR) > cost[0]))
+			best = 0;
+		if (best) {
+			name = hostlist_nth(hl, best);
+			hostlist_delete_nth(hl, best);
+			first = hostlist_create(name);
+			debug3("%s: forwarding through %s", __func__, name);
+			free(name);
+			hostlist_push_list(first, hl);
+			hostlist_destroy(hl);
+			hl = first;
+		}
+		new_hl[new_cnt++] = hl;
+	}
+	slurm_mutex_unlock(&fwd_stat_mutex);
+
+	xfree(cost);
+	xfree(*sp_hl);
+	*sp_hl = new_hl;
+	*hl_count = new_cnt;
+}
+
+/*
+ * forward_node_stat - record the outcome of an exchange with a node, used
+ *	to choose forwarders in later fan-outs.
+ * IN node_name - node contacted
+ * IN usec - time taken per tree level below the node, ignored on failure
+ * IN ok - false if the node could not be reached or failed to forward
+ */
+extern void forward_node_stat(const char *node_name, long usec, bool ok)
+{
+	fwd_node_stat_t *stat;
+
+	if (!node_name)
+		return;
+
+	slurm_mutex_lock(&fwd_stat_mutex);
+	if (!fwd_stat_hash)
+		fwd_stat_hash = xhash_init(_fwd_stat_id, _fwd_stat_free,
+					   NULL, 0);
+	if (!(stat = xhash_get(fwd_stat_hash, node_name))) {
+		stat = xmalloc(sizeof(fwd_node_stat_t));
+		stat->name = xstrdup(node_name);
+		xhash_add(fwd_stat_hash, stat);
+	}
+	if (!ok) {
+		stat->fails++;
+		stat->fail_time = time(NULL);
+	} else {
+		stat->fails = 0;
+		if (usec < 1)
+			usec = 1;
+		if (!stat->rtt)
+			stat->rtt = usec;
+		else
+			stat->rtt += (usec - stat->rtt) / FWD_RTT_WEIGHT;
+	}
+	slurm_mutex_unlock(&fwd_stat_mutex);
+}
+
 void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 {
 	if (fwd_tree) {
@@ -106,6 +321,7 @@ void *_forward_thread(void *arg)
 	char *buf = NULL;
 	int steps = 0;
 	int start_timeout = fwd_msg->timeout;
+	DEF_TIMERS;
 
 	/* repeat until we are sure the message was sent */
 	while ((name = hostlist_shift(hl))) {
@@ -122,8 +338,10 @@ void *_forward_thread(void *arg)
 			}
 			goto cleanup;
 		}
+		START_TIMER;
 		if ((fd = slurm_open_msg_conn(&addr)) < 0) {
 			error("forward_thread to %s: %m", name);
+			forward_node_stat(name, 0, false);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(
@@ -183,6 +401,7 @@ void *_forward_thread(void *arg)
 				     get_buf_offset(buffer),
 				     SLURM_PROTOCOL_NO_SEND_RECV_FLAGS ) < 0) {
 			error("forward_thread: slurm_msg_sendto: %m");
+			forward_node_stat(name, 0, false);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
@@ -254,6 +473,7 @@ void *_forward_thread(void *arg)
 
 		if (!ret_list || (fwd_msg->header.forward.cnt != 0
 				  && list_count(ret_list) <= 1)) {
+			forward_node_stat(name, 0, false);
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
 					       errno);
@@ -268,8 +488,13 @@ void *_forward_thread(void *arg)
 				continue;
 			}
 			goto cleanup;
-		} else if ((fwd_msg->header.forward.cnt+1)
-			  != list_count(ret_list)) {
+		}
+		END_TIMER;
+		forward_node_stat(name, DELTA_TIMER /
+				  _fwd_levels(fwd_msg->header.forward.cnt,
+					      fwd_msg->header.forward.tree_width),
+				  true);
+		if ((fwd_msg->header.forward.cnt+1) != list_count(ret_list)) {
 			/* this should never be called since the above
 			   should catch the failed forwards and pipe
 			   them back down, but this is here so we
@@ -351,6 +576,8 @@ void *_fwd_tree_thread(void *arg)
 	char *name = NULL;
 	char *buf = NULL;
 	slurm_msg_t send_msg;
+	bool fwd_ok;
+	DEF_TIMERS;
 
 	slurm_msg_t_init(&send_msg);
 	send_msg.msg_type = fwd_tree->orig_msg->msg_type;
@@ -387,8 +614,17 @@ void *_fwd_tree_thread(void *arg)
 		} else
 			debug3("Tree sending to %s", name);
 
+		START_TIMER;
 		ret_list = slurm_send_addr_recv_msgs(&send_msg, name,
 						     fwd_tree->timeout);
+		END_TIMER;
+		fwd_ok = ret_list &&
+			 (list_count(ret_list) > send_msg.forward.cnt) &&
+			 (errno != SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		forward_node_stat(name, DELTA_TIMER /
+				  _fwd_levels(send_msg.forward.cnt,
+					      send_msg.forward.tree_width),
+				  fwd_ok);
 
 		xfree(send_msg.forward.nodelist);
 
@@ -618,6 +854,7 @@ extern int forward_msg(forward_struct_t *forward_struct, header_t *header)
 		hostlist_destroy(hl);
 		return SLURM_ERROR;
 	}
+	_plan_forwarders(&sp_hl, &hl_count, header->forward.tree_width);
 
 	_forward_msg_internal(NULL, sp_hl, forward_struct, header,
 			      forward_struct->timeout, hl_count);
@@ -662,6 +899,7 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 		error("unable to split forward hostlist");
 		return NULL;
 	}
+	_plan_forwarders(&sp_hl, &hl_count, msg->forward.tree_width);
 	slurm_mutex_init(&tree_mutex);
 	slurm_cond_init(&notify, NULL);
 
@@ -111,6 +111,21 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout);
  */
 extern void mark_as_failed_forward(List *ret_list, char *node_name, int err);
 
+/*
+ * forward_node_stat - record the outcome of an exchange with a node.
+ *		       start_msg_tree() and forward_msg() use these to pick
+ *		       the healthiest and fastest node of each branch as its
+ *		       forwarder, exchanges made through them are recorded
+ *		       automatically.
+ *
+ * IN: node_name      - char *   - node contacted
+ * IN: usec           - long     - time taken per tree level below the node,
+ *				   ignored on failure
+ * IN: ok             - bool     - false if the node could not be reached or
+ *				   failed to forward
+ */
+extern void forward_node_stat(const char *node_name, long usec, bool ok);
+
 extern void forward_wait(slurm_msg_t *msg);
 
 /*
@@ -270,6 +270,29 @@ static uint32_t	_build_id(char *gres_name)
 	return id;
 }
 
+/* Convert a gres type (model) name into a number, 0 if none */
+static uint32_t _build_type_id(char *type)
+{
+	if (!type || !type[0])
+		return 0;
+	return _build_id(type);
+}
+
+/*
+ * Return true if a node's gres type satisfies a job's gres type. Compare the
+ * ids first so that only matches, or id collisions, pay for a string compare.
+ */
+static inline bool _type_match(gres_job_state_t *job_gres_ptr,
+			       uint32_t node_type_id, char *node_type)
+{
+	if (!job_gres_ptr->type_id)
+		job_gres_ptr->type_id =
+			_build_type_id(job_gres_ptr->type_model);
+	if (job_gres_ptr->type_id != node_type_id)
+		return false;
+	return !xstrcmp(job_gres_ptr->type_model, node_type);
+}
+
 static int _gres_find_id(void *x, void *key)
 {
 	uint32_t *plugin_id = (uint32_t *)key;
@@ -1251,12 +1274,14 @@ static void _gres_node_list_delete(void *list_element)
 	xfree(gres_node_ptr->topo_gres_cnt_alloc);
 	xfree(gres_node_ptr->topo_gres_cnt_avail);
 	xfree(gres_node_ptr->topo_model);
+	xfree(gres_node_ptr->topo_type_id);
 	for (i = 0; i < gres_node_ptr->type_cnt; i++) {
 		xfree(gres_node_ptr->type_model[i]);
 	}
 	xfree(gres_node_ptr->type_cnt_alloc);
 	xfree(gres_node_ptr->type_cnt_avail);
 	xfree(gres_node_ptr->type_model);
+	xfree(gres_node_ptr->type_id);
 	xfree(gres_node_ptr);
 	xfree(gres_ptr);
 }
@@ -1289,8 +1314,12 @@ static void _add_gres_type(char *type, gres_node_state_t *gres_data,
 		gres_data->type_model =
 			xrealloc(gres_data->type_model,
 				 sizeof(char *) * gres_data->type_cnt);
+		gres_data->type_id =
+			xrealloc(gres_data->type_id,
+				 sizeof(uint32_t) * gres_data->type_cnt);
 		gres_data->type_cnt_avail[i] += tmp_gres_cnt;
 		gres_data->type_model[i] = xstrdup(type);
+		gres_data->type_id[i] = _build_type_id(type);
 	}
 }
 
@@ -1684,6 +1713,7 @@ static int _node_config_validate(char *node_name, char *orig_config,
 		xfree(gres_data->topo_gres_bitmap);
 		xfree(gres_data->topo_cpus_bitmap);
 		xfree(gres_data->topo_model);
+		xfree(gres_data->topo_type_id);
 		gres_data->topo_cnt = set_cnt;
 	}
 
@@ -1715,6 +1745,8 @@ static int _node_config_validate(char *node_name, char *orig_config,
 				 set_cnt * sizeof(bitstr_t *));
 		gres_data->topo_model = xrealloc(gres_data->topo_model,
 						 set_cnt * sizeof(char *));
+		gres_data->topo_type_id = xrealloc(gres_data->topo_type_id,
+						   set_cnt * sizeof(uint32_t));
 		gres_data->topo_cnt = set_cnt;
 
 		iter = list_iterator_create(gres_conf_list);
@@ -1744,6 +1776,8 @@ static int _node_config_validate(char *node_name, char *orig_config,
 			}
 			gres_data->topo_model[i] = xstrdup(gres_slurmd_conf->
 							   type);
+			gres_data->topo_type_id[i] =
+				_build_type_id(gres_slurmd_conf->type);
 			i++;
 		}
 		list_iterator_destroy(iter);
@@ -1822,6 +1856,7 @@ static int _node_config_validate(char *node_name, char *orig_config,
 			xfree(gres_data->topo_gres_cnt_alloc);
 			xfree(gres_data->topo_gres_cnt_avail);
 			xfree(gres_data->topo_model);
+			xfree(gres_data->topo_type_id);
 		}
 		gres_data->topo_cnt = 0;
 	} else if ((fast_schedule == 0) &&
@@ -2262,6 +2297,8 @@ static void *_node_state_dup(void *gres_data)
 	new_gres->topo_gres_cnt_avail = xmalloc(gres_ptr->topo_cnt *
 						sizeof(uint64_t));
 	new_gres->topo_model = xmalloc(gres_ptr->topo_cnt * sizeof(char *));
+	new_gres->topo_type_id = xmalloc(gres_ptr->topo_cnt *
+					 sizeof(uint32_t));
 	for (i = 0; i < gres_ptr->topo_cnt; i++) {
 		if (gres_ptr->topo_cpus_bitmap[i]) {
 			new_gres->topo_cpus_bitmap[i] =
@@ -2274,6 +2311,8 @@ static void *_node_state_dup(void *gres_data)
 		new_gres->topo_gres_cnt_avail[i] =
 			gres_ptr->topo_gres_cnt_avail[i];
 		new_gres->topo_model[i] = xstrdup(gres_ptr->topo_model[i]);
+		new_gres->topo_type_id[i] =
+			_build_type_id(gres_ptr->topo_model[i]);
 	}
 
 	new_gres->type_cnt       = gres_ptr->type_cnt;
@@ -2282,10 +2321,12 @@ static void *_node_state_dup(void *gres_data)
 	new_gres->type_cnt_avail = xmalloc(gres_ptr->type_cnt *
 					   sizeof(uint64_t));
 	new_gres->type_model = xmalloc(gres_ptr->type_cnt * sizeof(char *));
+	new_gres->type_id = xmalloc(gres_ptr->type_cnt * sizeof(uint32_t));
 	for (i = 0; i < gres_ptr->type_cnt; i++) {
 		new_gres->type_cnt_alloc[i] = gres_ptr->type_cnt_alloc[i];
 		new_gres->type_cnt_avail[i] = gres_ptr->type_cnt_avail[i];
 		new_gres->type_model[i] = xstrdup(gres_ptr->type_model[i]);
+		new_gres->type_id[i] = _build_type_id(gres_ptr->type_model[i]);
 	}
 	return new_gres;
 }
@@ -3390,9 +3431,8 @@ static void	_job_core_filter(void *job_gres_data, void *node_gres_data,
 		     node_gres_ptr->topo_gres_cnt_avail[i]))
 			continue;
 		if (job_gres_ptr->type_model &&
-		    (!node_gres_ptr->topo_model[i] ||
-		     xstrcmp(job_gres_ptr->type_model,
-			     node_gres_ptr->topo_model[i])))
+		    !_type_match(job_gres_ptr, node_gres_ptr->topo_type_id[i],
+				 node_gres_ptr->topo_model[i]))
 			continue;
 		if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 			FREE_NULL_BITMAP(avail_cpu_bitmap);	/* No filter */
@@ -3445,9 +3485,9 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 		}
 		for (i = 0; i < node_gres_ptr->topo_cnt; i++) {
 			if (job_gres_ptr->type_model &&
-			    (!node_gres_ptr->topo_model[i] ||
-			     xstrcmp(node_gres_ptr->topo_model[i],
-				     job_gres_ptr->type_model)))
+			    !_type_match(job_gres_ptr,
+					 node_gres_ptr->topo_type_id[i],
+					 node_gres_ptr->topo_model[i]))
 				continue;
 			if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 				gres_avail += node_gres_ptr->
@@ -3527,9 +3567,9 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 			     node_gres_ptr->topo_gres_cnt_avail[i]))
 				continue;
 			if (job_gres_ptr->type_model &&
-			    (!node_gres_ptr->topo_model[i] ||
-			     xstrcmp(node_gres_ptr->topo_model[i],
-				     job_gres_ptr->type_model)))
+			    !_type_match(job_gres_ptr,
+					 node_gres_ptr->topo_type_id[i],
+					 node_gres_ptr->topo_model[i]))
 				continue;
 			if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 				cpus_avail[i] = cpu_end_bit - cpu_start_bit + 1;
@@ -3622,9 +3662,8 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 		return cpu_cnt;
 	} else if (job_gres_ptr->type_model) {
 		for (i = 0; i < node_gres_ptr->type_cnt; i++) {
-			if (node_gres_ptr->type_model[i] &&
-			    !xstrcmp(node_gres_ptr->type_model[i],
-				     job_gres_ptr->type_model))
+			if (_type_match(job_gres_ptr, node_gres_ptr->type_id[i],
+					node_gres_ptr->type_model[i]))
 				break;
 		}
 		if (i >= node_gres_ptr->type_cnt)
@@ -3814,9 +3853,8 @@ static bool _cores_on_gres(bitstr_t *core_bitmap, bitstr_t *alloc_core_bitmap,
 		if (!bit_test(node_gres_ptr->topo_gres_bitmap[i], gres_inx))
 			continue;
 		if (job_gres_ptr->type_model &&
-		    (!node_gres_ptr->topo_model[i] ||
-		     xstrcmp(job_gres_ptr->type_model,
-			     node_gres_ptr->topo_model[i])))
+		    !_type_match(job_gres_ptr, node_gres_ptr->topo_type_id[i],
+				 node_gres_ptr->topo_model[i]))
 			continue;
 		if (!node_gres_ptr->topo_cpus_bitmap[i])
 			return true;
@@ -117,17 +117,20 @@ typedef struct gres_node_state {
 	uint64_t *topo_gres_cnt_alloc;
 	uint64_t *topo_gres_cnt_avail;
 	char **topo_model;		/* Type of this gres (e.g. model name) */
+	uint32_t *topo_type_id;		/* Id of topo_model, 0 if none */
 
 	/* Gres type specific information (if gres.conf contains type option) */
 	uint16_t type_cnt;		/* Size of type_ arrays */
 	uint64_t *type_cnt_alloc;
 	uint64_t *type_cnt_avail;
 	char **type_model;		/* Type of this gres (e.g. model name) */
+	uint32_t *type_id;		/* Id of type_model, 0 if none */
 } gres_node_state_t;
 
 /* Gres job state as used by slurmctld daemon */
 typedef struct gres_job_state {
 	char *type_model;		/* Type of this gres (e.g. model name) */
+	uint32_t type_id;		/* Id of type_model, set on first test */
 
 	/* Count of resources needed per node */
 	uint64_t gres_cnt_alloc;
@@ -2041,6 +2041,38 @@ int hostlist_push_host(hostlist_t hl, const char *str)
 	return hostlist_push_host_dims(hl, str, dims);
 }
 
+int hostlist_push_numbered(hostlist_t hl, const char *prefix,
+			   unsigned long lo, unsigned long hi, int width)
+{
+	if (!prefix || !hl || (hi < lo))
+		return -1;
+
+	return hostlist_push_hr(hl, (char *) prefix, lo, hi, width);
+}
+
+int hostlist_for_each_range(hostlist_t hl, hostlist_range_f f, void *arg)
+{
+	int i, rc = 0;
+	hostrange_t hr;
+
+	if (!hl || !f)
+		return -1;
+
+	LOCK_HOSTLIST(hl);
+	for (i = 0; i < hl->nranges; i++) {
+		hr = hl->hr[i];
+		if (hr->singlehost)
+			rc = f(hr->prefix, 0, 0, -1, arg);
+		else
+			rc = f(hr->prefix, hr->lo, hr->hi, hr->width, arg);
+		if (rc < 0)
+			break;
+	}
+	UNLOCK_HOSTLIST(hl);
+
+	return rc;
+}
+
 int hostlist_push_list(hostlist_t h1, hostlist_t h2)
 {
 	int i, n = 0;
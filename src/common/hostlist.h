@@ -203,6 +203,35 @@ int hostlist_push_host_dims(hostlist_t hl, const char *str, int dims);
 int hostlist_push_host(hostlist_t hl, const char *host);
 
 
+/* hostlist_push_numbered():
+ *
+ * Push the hosts prefix<lo> through prefix<hi> onto the hostlist hl as a
+ * single range, numbers zero padded to width digits. No per host string
+ * is built.
+ *
+ * Returns the number of hosts in hl, or -1 on failure.
+ */
+int hostlist_push_numbered(hostlist_t hl, const char *prefix,
+			   unsigned long lo, unsigned long hi, int width);
+
+/* hostlist_for_each_range():
+ *
+ * Call f once for each range of the hostlist hl, in list order, without
+ * expanding it into host names. For a numbered range, prefix is the part
+ * of the names before the number and width the zero padded width of the
+ * number. For a host without numeric suffix, prefix is the whole name,
+ * lo and hi are 0 and width is -1.
+ *
+ * hl is locked while f runs, f must not use it. Iteration stops at the
+ * first negative value returned by f.
+ *
+ * Returns the last value returned by f, 0 for an empty list.
+ */
+typedef int (*hostlist_range_f)(const char *prefix, unsigned long lo,
+				unsigned long hi, int width, void *arg);
+int hostlist_for_each_range(hostlist_t hl, hostlist_range_f f, void *arg);
+
+
 /* hostlist_push_list():
  *
  * Push a hostlist (hl2) onto another list (hl1)
@@ -66,6 +66,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "slurm/slurm_errno.h"
@@ -100,6 +101,7 @@ strong_alias(log_fatal,		slurm_log_fatal);
 strong_alias(log_oom,		slurm_log_oom);
 strong_alias(log_has_data,	slurm_log_has_data);
 strong_alias(log_flush,		slurm_log_flush);
+strong_alias(log_set_async,	slurm_log_set_async);
 strong_alias(fatal,		slurm_fatal);
 strong_alias(error,		slurm_error);
 strong_alias(info,		slurm_info);
@@ -126,12 +128,34 @@ typedef struct {
 	uint64_t debug_flags;
 }	log_t;
 
+/*
+** Asynchronous logfile output (see log_set_async()).
+** Formatted logfile lines are appended to a ring under log_lock and written
+** out in batches by a writer thread, which holds log_lock only to pick up
+** the pending bytes and to release the space once written.
+*/
+typedef struct {
+	char *ring;
+	uint32_t size;           /* bytes in ring                        */
+	uint64_t head;           /* bytes appended since creation        */
+	uint64_t tail;           /* bytes written since creation         */
+	uint32_t dropped;        /* messages dropped since last report   */
+	bool running;            /* writer thread accepts data           */
+	bool stop;               /* writer thread to exit once drained   */
+	bool writing;            /* writer thread is in writev()         */
+	pthread_t thread;
+	pthread_cond_t data_cond;  /* signalled when data is appended    */
+	pthread_cond_t space_cond; /* signalled when data is written     */
+}	log_async_t;
+
 char *slurm_prog_name = NULL;
 
 /* static variables */
 static pthread_mutex_t  log_lock = PTHREAD_MUTEX_INITIALIZER;
 static log_t            *log = NULL;
 static log_t            *sched_log = NULL;
+static log_async_t      *async = NULL;
+static bool             async_atexit = false;
 
 #define LOG_INITIALIZED ((log != NULL) && (log->initialized))
 #define SCHED_LOG_INITIALIZED ((sched_log != NULL) && (sched_log->initialized))
@@ -151,7 +175,16 @@ extern char * program_invocation_name;
  */
 static void _atfork_prep()   { slurm_mutex_lock(&log_lock);   }
 static void _atfork_parent() { slurm_mutex_unlock(&log_lock); }
-static void _atfork_child()  { slurm_mutex_unlock(&log_lock); }
+static void _atfork_child()
+{
+	/* The writer thread does not exist in the child, the parent writes
+	 * anything pending */
+	if (async) {
+		xfree(async->ring);
+		xfree(async);
+	}
+	slurm_mutex_unlock(&log_lock);
+}
 static bool at_forked = false;
 #define atfork_install_handlers()					\
 	while (!at_forked) {						\
@@ -160,6 +193,7 @@ static bool at_forked = false;
 	}
 
 static void _log_flush(log_t *log);
+static void _async_flush(void);
 
 
 /* Write the current local time into the provided buffer. Returns the
@@ -336,8 +370,10 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 			goto out;
 		}
 
-		if (log->logfp)
+		if (log->logfp) {
+			_async_flush();
 			fclose(log->logfp); /* Ignore errors */
+		}
 
 		log->logfp = fp;
 	}
@@ -458,6 +494,7 @@ void log_fini(void)
 	if (!log)
 		return;
 
+	log_set_async(0);
 	slurm_mutex_lock(&log_lock);
 	_log_flush(log);
 	xfree(log->argv0);
@@ -556,8 +593,10 @@ int log_alter_with_fp(log_options_t opt, log_facility_t fac, FILE *fp_in)
 	int rc = 0;
 	slurm_mutex_lock(&log_lock);
 	rc = _log_init(NULL, opt, fac, NULL);
-	if (log->logfp)
+	if (log->logfp) {
+		_async_flush();
 		fclose(log->logfp); /* Ignore errors */
+	}
 	log->logfp = fp_in;
 	if (log->logfp) {
 		int fd;
@@ -945,6 +984,195 @@ _log_printf(log_t *log, cbuf_t cb, FILE *stream, const char *fmt, ...)
 
 }
 
+/*
+ * Append msg to the asynchronous logfile ring, called with log_lock held.
+ * When the ring is full, messages less severe than errors are dropped and
+ * counted, errors and fatal messages wait for the writer to make room.
+ * RET 0 if queued or dropped, -1 if msg must be written synchronously
+ */
+static int _async_write(log_level_t level, const char *msg)
+{
+	uint32_t len = strlen(msg), off, part;
+	char *report = NULL;
+
+	if (!async || !async->running || log->opt.buffered)
+		return -1;
+	if (len > async->size) {
+		/* Too long for the ring, written in order once it drains */
+		_async_flush();
+		return -1;
+	}
+
+	while ((async->head - async->tail + len) > async->size) {
+		if (level > LOG_LEVEL_ERROR) {
+			async->dropped++;
+			return 0;
+		}
+		slurm_cond_wait(&async->space_cond, &log_lock);
+		if (!async || !async->running)
+			return -1;
+	}
+
+	if (async->dropped) {
+		xlogfmtcat(&report, "[%M] %serror: log: %u messages dropped, "
+			   "logfile writer too slow\n", log->fpfx,
+			   async->dropped);
+		if ((async->head - async->tail + len + strlen(report)) <=
+		    async->size) {
+			async->dropped = 0;
+			_async_write(LOG_LEVEL_ERROR, report);
+		}
+		xfree(report);
+	}
+
+	if (async->head == async->tail)
+		slurm_cond_signal(&async->data_cond);
+
+	off = async->head % async->size;
+	part = MIN(len, async->size - off);
+	memcpy(async->ring + off, msg, part);
+	if (part < len)
+		memcpy(async->ring, msg + part, len - part);
+	async->head += len;
+
+	return 0;
+}
+
+/*
+ * Wait for the writer thread to write out everything appended so far,
+ * called with log_lock held
+ */
+static void _async_flush(void)
+{
+	while (async && async->running &&
+	       ((async->head != async->tail) || async->writing))
+		slurm_cond_wait(&async->space_cond, &log_lock);
+}
+
+static void _async_atexit(void)
+{
+	log_flush();
+}
+
+/* Write iov[cnt] completely to fd, RET -1 on error */
+static int _writev_all(int fd, struct iovec *iov, int cnt)
+{
+	ssize_t rc;
+
+	while (cnt) {
+		rc = writev(fd, iov, cnt);
+		if (rc < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			return -1;
+		}
+		while (cnt && (rc >= iov->iov_len)) {
+			rc -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+		if (cnt) {
+			iov->iov_base = (char *) iov->iov_base + rc;
+			iov->iov_len -= rc;
+		}
+	}
+
+	return 0;
+}
+
+/* Writer thread of the asynchronous logfile, writes everything pending in
+ * one writev() per wake up */
+static void *_async_writer(void *arg)
+{
+	log_async_t *a = (log_async_t *) arg;
+	struct iovec iov[2];
+	uint32_t off, len;
+	int cnt, fd;
+
+	slurm_mutex_lock(&log_lock);
+	while (1) {
+		while (!a->stop && (a->head == a->tail))
+			slurm_cond_wait(&a->data_cond, &log_lock);
+		if (a->head == a->tail)
+			break;
+
+		off = a->tail % a->size;
+		len = a->head - a->tail;
+		iov[0].iov_base = a->ring + off;
+		iov[0].iov_len  = MIN(len, a->size - off);
+		iov[1].iov_base = a->ring;
+		iov[1].iov_len  = len - iov[0].iov_len;
+		cnt = iov[1].iov_len ? 2 : 1;
+		fd = (log && log->logfp) ? fileno(log->logfp) : -1;
+
+		/* The logfile is not closed while writing is set */
+		a->writing = true;
+		slurm_mutex_unlock(&log_lock);
+		if (fd >= 0)
+			(void) _writev_all(fd, iov, cnt);
+		slurm_mutex_lock(&log_lock);
+		a->writing = false;
+
+		a->tail += len;
+		slurm_cond_broadcast(&a->space_cond);
+	}
+	a->running = false;
+	slurm_cond_broadcast(&a->space_cond);
+	slurm_mutex_unlock(&log_lock);
+
+	return NULL;
+}
+
+/*
+ * log_set_async - write the logfile from a background thread, so callers
+ *	only format their message and copy it into a ring of size bytes.
+ *	stderr, syslog and the scheduler log are still written synchronously.
+ *	Pending output is written by log_flush(), fatal(), exit() and
+ *	log_fini().
+ * IN size - bytes of pending output to allow, 0 to flush and go back to
+ *	synchronous writes
+ * RET 0 on success
+ */
+int log_set_async(uint32_t size)
+{
+	log_async_t *old, *new = NULL;
+
+	if (size) {
+		new = xmalloc(sizeof(log_async_t));
+		new->ring = xmalloc(size);
+		new->size = size;
+		new->running = true;
+		slurm_cond_init(&new->data_cond, NULL);
+		slurm_cond_init(&new->space_cond, NULL);
+		slurm_thread_create(&new->thread, _async_writer, new);
+	}
+
+	slurm_mutex_lock(&log_lock);
+	/* Keep the order of messages: switch once the old ring is empty */
+	_async_flush();
+	old = async;
+	if (old) {
+		old->stop = true;
+		slurm_cond_signal(&old->data_cond);
+	}
+	async = new;
+	if (!async_atexit && new) {
+		atexit(_async_atexit);
+		async_atexit = true;
+	}
+	slurm_mutex_unlock(&log_lock);
+
+	if (old) {
+		pthread_join(old->thread, NULL);
+		slurm_cond_destroy(&old->data_cond);
+		slurm_cond_destroy(&old->space_cond);
+		xfree(old->ring);
+		xfree(old);
+	}
+
+	return 0;
+}
+
 /*
  * log a message at the specified level to facilities that have been
  * configured to receive messages at that level
@@ -1055,9 +1283,11 @@ static void log_msg(log_level_t level, const char *fmt, va_list args)
 
 	if ((level <= log->opt.logfile_level) && (log->logfp != NULL)) {
 
-		xlogfmtcat(&msgbuf, "[%M] %s%s%s", log->fpfx, pfx, buf);
-		_log_printf(log, log->fbuf, log->logfp, "%s\n", msgbuf);
-		fflush(log->logfp);
+		xlogfmtcat(&msgbuf, "[%M] %s%s%s\n", log->fpfx, pfx, buf);
+		if (_async_write(level, msgbuf) < 0) {
+			_log_printf(log, log->fbuf, log->logfp, "%s", msgbuf);
+			fflush(log->logfp);
+		}
 
 		xfree(msgbuf);
 	}
@@ -1107,7 +1337,9 @@ void
 log_flush()
 {
 	slurm_mutex_lock(&log_lock);
-	_log_flush(log);
+	_async_flush();
+	if (log)
+		_log_flush(log);
 	slurm_mutex_unlock(&log_lock);
 }
 
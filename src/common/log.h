@@ -46,6 +46,7 @@
 #ifndef _LOG_H
 #define _LOG_H
 
+#include <inttypes.h>
 #include <syslog.h>
 #include <stdio.h>
 
@@ -227,6 +228,13 @@ bool log_has_data(void);
  */
 void log_flush(void);
 
+/*
+ * Write the logfile from a background thread through a ring of size bytes,
+ * 0 to flush it and go back to synchronous writes. When the ring is full,
+ * messages less severe than errors are dropped (and counted in the log).
+ */
+int log_set_async(uint32_t size);
+
 /* log_set_debug_flags()
  * Set or reset the debug flags based on the configuration
  * file or the scontrol command.
@@ -49,12 +49,14 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "src/common/assoc_mgr.h"
 #include "src/common/hostlist.h"
@@ -67,6 +69,7 @@
 #include "src/common/slurm_acct_gather_energy.h"
 #include "src/common/slurm_ext_sensors.h"
 #include "src/common/slurm_topology.h"
+#include "src/common/working_cluster.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -83,8 +86,53 @@ int node_record_count = 0;		/* count in node_record_table_ptr */
 uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 
+/*
+ * Node name index: the node table cut into runs of consecutive records whose
+ * names share a prefix and carry consecutive numeric suffixes with the same
+ * zero padding (e.g. nid00001 through nid19999). It lets hostlist ranges be
+ * mapped to bitmap spans and bitmaps be rendered as ranges without building
+ * a string per node. Rebuilt by rehash_node(), only used while the node
+ * table it was built from is still current.
+ */
+typedef struct {
+	char *prefix;		/* node name up to the numeric suffix */
+	int width;		/* zero padded width of the suffix */
+	unsigned long lo;	/* suffix of the first node of the run */
+	int first;		/* node table offset of the first node */
+	int cnt;		/* count of nodes in the run */
+} name_run_t;
+
+#define NAME_RUN_MAX_WIDTH 9	/* longer suffixes are not indexed */
+
+static name_run_t *name_runs = NULL;	/* in node table order */
+static int *name_runs_sorted = NULL;	/* by prefix, width and suffix */
+static int name_run_cnt = 0;
+static struct node_record *name_run_table = NULL;
+static int name_run_node_cnt = 0;
+
+#define NODELINE_MAX_THREADS	8	/* threads expanding node lines */
+#define NODELINE_THREAD_LINES	64	/* fewest node lines per thread */
+
+/* The nodes of one slurm.conf NodeName line, see _expand_nodeline() */
+typedef struct {
+	char **addresses;		/* NodeAddr of each node */
+	char **aliases;			/* NodeName of each node */
+	int error_code;
+	char **hostnames;		/* NodeHostname of each node */
+	int node_cnt;			/* count of nodes expanded */
+	slurm_conf_node_t *node_ptr;	/* the line from slurm.conf */
+	uint16_t *ports;		/* Port of each node */
+	int state_val;			/* State of the nodes */
+} nodeline_t;
+
+typedef struct {
+	int begin;			/* first line to expand */
+	int end;			/* one past the last line */
+	nodeline_t *lines;
+} nodeline_args_t;
+
 /* Local function defiitions */
-static int	_build_single_nodeline_info(slurm_conf_node_t *node_ptr,
+static int	_build_single_nodeline_info(nodeline_t *line,
 					    struct config_record *config_ptr);
 static int	_delete_config_record (void);
 #if _DEBUG
@@ -95,19 +143,23 @@ static struct node_record *
 static void	_list_delete_config (void *config_entry);
 static int	_list_find_config (void *config_entry, void *key);
 static const char* _node_record_hash_identity (void* item);
+static void	_build_name_runs (void);
+static void	_expand_nodeline(nodeline_t *line);
+static void *	_expand_nodeline_range(void *arg);
+static void	_expand_nodelines(nodeline_t *lines, int line_cnt);
+static void	_free_nodeline(nodeline_t *line);
+static void	_grow_node_table(int node_cnt);
+static void	_free_name_runs (void);
 
 /*
- * _build_single_nodeline_info - From the slurm.conf reader, build table,
- * 	and set values
- * RET 0 if no error, error code otherwise
- * Note: Operates on common variables
- *	default_node_record - default node configuration values
+ * _expand_nodeline - expand the NodeName, NodeAddr, NodeHostname and Port
+ *	hostlists of one slurm.conf node line into per node arrays. Touches no
+ *	global state, so several lines may be expanded at once.
+ * IN/OUT line - node_ptr set, the remaining fields are filled in
  */
-static int _build_single_nodeline_info(slurm_conf_node_t *node_ptr,
-				       struct config_record *config_ptr)
+static void _expand_nodeline(nodeline_t *line)
 {
-	int error_code = SLURM_SUCCESS;
-	struct node_record *node_rec = NULL;
+	slurm_conf_node_t *node_ptr = line->node_ptr;
 	hostlist_t address_list = NULL;
 	hostlist_t alias_list = NULL;
 	hostlist_t hostname_list = NULL;
@@ -116,32 +168,34 @@ static int _build_single_nodeline_info(slurm_conf_node_t *node_ptr,
 	char *alias = NULL;
 	char *hostname = NULL;
 	char *port_str = NULL;
-	int state_val = NODE_STATE_UNKNOWN;
-	int address_count, alias_count, hostname_count, port_count;
+	int address_count, alias_count, hostname_count, port_count, i = 0;
 	uint16_t port = 0;
 
+	line->error_code = SLURM_SUCCESS;
+	line->state_val = NODE_STATE_UNKNOWN;
 	if (node_ptr->state != NULL) {
-		state_val = state_str2int(node_ptr->state, node_ptr->nodenames);
-		if (state_val == NO_VAL)
+		line->state_val = state_str2int(node_ptr->state,
+						node_ptr->nodenames);
+		if (line->state_val == NO_VAL)
 			goto cleanup;
 	}
 
 	if ((address_list = hostlist_create(node_ptr->addresses)) == NULL) {
 		fatal("Unable to create NodeAddr list from %s",
 		      node_ptr->addresses);
-		error_code = errno;
+		line->error_code = errno;
 		goto cleanup;
 	}
 	if ((alias_list = hostlist_create(node_ptr->nodenames)) == NULL) {
 		fatal("Unable to create NodeName list from %s",
 		      node_ptr->nodenames);
-		error_code = errno;
+		line->error_code = errno;
 		goto cleanup;
 	}
 	if ((hostname_list = hostlist_create(node_ptr->hostnames)) == NULL) {
 		fatal("Unable to create NodeHostname list from %s",
 		      node_ptr->hostnames);
-		error_code = errno;
+		line->error_code = errno;
 		goto cleanup;
 	}
 	if (node_ptr->port_str && node_ptr->port_str[0] &&
@@ -157,7 +211,7 @@ static int _build_single_nodeline_info(slurm_conf_node_t *node_ptr,
 	if (port_list == NULL) {
 		error("Unable to create Port list from %s",
 		      node_ptr->port_str);
-		error_code = errno;
+		line->error_code = errno;
 		goto cleanup;
 	}
 
@@ -203,8 +257,13 @@ static int _build_single_nodeline_info(slurm_conf_node_t *node_ptr,
 		goto cleanup;
 	}
 
-	/* now build the individual node structures */
-	while ((alias = hostlist_shift(alias_list))) {
+	/* now expand the individual nodes */
+	line->aliases   = xmalloc(sizeof(char *) * alias_count);
+	line->addresses = xmalloc(sizeof(char *) * alias_count);
+	line->hostnames = xmalloc(sizeof(char *) * alias_count);
+	line->ports     = xmalloc(sizeof(uint16_t) * alias_count);
+	for (i = 0; (i < alias_count) &&
+		    (alias = hostlist_shift(alias_list)); i++) {
 		if (address_count > 0) {
 			address_count--;
 			if (address)
@@ -228,30 +287,15 @@ static int _build_single_nodeline_info(slurm_conf_node_t *node_ptr,
 				fatal("Invalid Port %s", node_ptr->port_str);
 			port = port_int;
 		}
-		/* find_node_record locks this to get the
-		 * alias so we need to unlock */
-		node_rec = find_node_record2(alias);
-
-		if (node_rec == NULL) {
-			node_rec = create_node_record(config_ptr, alias);
-			if ((state_val != NO_VAL) &&
-			    (state_val != NODE_STATE_UNKNOWN))
-				node_rec->node_state = state_val;
-			node_rec->last_response = (time_t) 0;
-			node_rec->comm_name = xstrdup(address);
-			node_rec->node_hostname = xstrdup(hostname);
-			node_rec->port      = port;
-			node_rec->weight    = node_ptr->weight;
-			node_rec->features  = xstrdup(node_ptr->feature);
-			node_rec->reason    = xstrdup(node_ptr->reason);
-		} else {
-			/* FIXME - maybe should be fatal? */
-			error("Reconfiguration for node %s, ignoring!", alias);
-		}
+		line->aliases[i]   = xstrdup(alias);
+		line->addresses[i] = xstrdup(address);
+		line->hostnames[i] = xstrdup(hostname);
+		line->ports[i]     = port;
 		free(alias);
 	}
 	/* free allocated storage */
 cleanup:
+	line->node_cnt = i;
 	if (address)
 		free(address);
 	if (hostname)
@@ -266,7 +310,117 @@ cleanup:
 		hostlist_destroy(hostname_list);
 	if (port_list)
 		hostlist_destroy(port_list);
-	return error_code;
+}
+
+/* Expand the node lines of one nodeline_args_t, see _expand_nodelines() */
+static void *_expand_nodeline_range(void *arg)
+{
+	nodeline_args_t *args = (nodeline_args_t *) arg;
+	int i;
+
+	for (i = args->begin; i < args->end; i++)
+		_expand_nodeline(&args->lines[i]);
+
+	return NULL;
+}
+
+/*
+ * _expand_nodelines - expand slurm.conf node lines on up to
+ *	NODELINE_MAX_THREADS threads, each taking a contiguous range of lines
+ * IN/OUT lines - node_ptr set in each, see _expand_nodeline()
+ * IN line_cnt - count of lines
+ */
+static void _expand_nodelines(nodeline_t *lines, int line_cnt)
+{
+	nodeline_args_t *args;
+	pthread_t *threads;
+	long cpu_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	int thread_cnt, t;
+
+	thread_cnt = MIN(line_cnt / NODELINE_THREAD_LINES,
+			 NODELINE_MAX_THREADS);
+	if (cpu_cnt > 0)
+		thread_cnt = MIN(thread_cnt, cpu_cnt);
+	thread_cnt = MAX(thread_cnt, 1);
+
+	args = xmalloc(sizeof(nodeline_args_t) * thread_cnt);
+	threads = xmalloc(sizeof(pthread_t) * thread_cnt);
+	for (t = 0; t < thread_cnt; t++) {
+		args[t].begin = ((int64_t) line_cnt * t) / thread_cnt;
+		args[t].end = ((int64_t) line_cnt * (t + 1)) / thread_cnt;
+		args[t].lines = lines;
+		if (t)	/* the calling thread takes the first range */
+			slurm_thread_create(&threads[t],
+					    _expand_nodeline_range, &args[t]);
+	}
+	_expand_nodeline_range(&args[0]);
+	for (t = 1; t < thread_cnt; t++)
+		pthread_join(threads[t], NULL);
+
+	xfree(args);
+	xfree(threads);
+}
+
+/* _free_nodeline - free the per node arrays of an expanded node line */
+static void _free_nodeline(nodeline_t *line)
+{
+	int i;
+
+	for (i = 0; i < line->node_cnt; i++) {
+		xfree(line->aliases[i]);
+		xfree(line->addresses[i]);
+		xfree(line->hostnames[i]);
+	}
+	xfree(line->aliases);
+	xfree(line->addresses);
+	xfree(line->hostnames);
+	xfree(line->ports);
+	line->node_cnt = 0;
+}
+
+/*
+ * _build_single_nodeline_info - From an expanded slurm.conf node line, build
+ *	table, and set values
+ * IN/OUT line - from _expand_nodeline(), node names are moved into records
+ * RET 0 if no error, error code otherwise
+ * Note: Operates on common variables
+ *	default_node_record - default node configuration values
+ */
+static int _build_single_nodeline_info(nodeline_t *line,
+				       struct config_record *config_ptr)
+{
+	slurm_conf_node_t *node_ptr = line->node_ptr;
+	struct node_record *node_rec = NULL;
+	int i;
+
+	/* now build the individual node structures */
+	for (i = 0; i < line->node_cnt; i++) {
+		/* find_node_record locks this to get the
+		 * alias so we need to unlock */
+		node_rec = find_node_record2(line->aliases[i]);
+
+		if (node_rec == NULL) {
+			node_rec = create_node_record(config_ptr,
+						      line->aliases[i]);
+			if ((line->state_val != NO_VAL) &&
+			    (line->state_val != NODE_STATE_UNKNOWN))
+				node_rec->node_state = line->state_val;
+			node_rec->last_response = (time_t) 0;
+			node_rec->comm_name = line->addresses[i];
+			line->addresses[i] = NULL;
+			node_rec->node_hostname = line->hostnames[i];
+			line->hostnames[i] = NULL;
+			node_rec->port      = line->ports[i];
+			node_rec->weight    = node_ptr->weight;
+			node_rec->features  = xstrdup(node_ptr->feature);
+			node_rec->reason    = xstrdup(node_ptr->reason);
+		} else {
+			/* FIXME - maybe should be fatal? */
+			error("Reconfiguration for node %s, ignoring!",
+			      line->aliases[i]);
+		}
+	}
+	return line->error_code;
 }
 
 /*
@@ -354,6 +508,128 @@ static const char* _node_record_hash_identity (void* item)
 	return node_ptr->name;
 }
 
+/* Number of decimal digits of num */
+static int _num_digits(unsigned long num)
+{
+	int digits = 1;
+
+	while (num >= 10) {
+		num /= 10;
+		digits++;
+	}
+	return digits;
+}
+
+/*
+ * Split a node name into prefix and numeric suffix, the way hostlist does.
+ * RET false if the name has no indexable suffix
+ */
+static bool _split_node_name(const char *name, int *prefix_len,
+			     unsigned long *num, int *width)
+{
+	const char *p, *end;
+
+	if (!name || (name[0] == '\0'))
+		return false;
+
+	end = name + strlen(name);
+	for (p = end; (p > name) && isdigit((int) p[-1]); p--)
+		;
+	if ((p == end) || ((end - p) > NAME_RUN_MAX_WIDTH))
+		return false;
+
+	*prefix_len = p - name;
+	*width = end - p;
+	*num = strtoul(p, NULL, 10);
+	return true;
+}
+
+static int _cmp_name_runs(const void *x, const void *y)
+{
+	name_run_t *run1 = &name_runs[*(int *) x];
+	name_run_t *run2 = &name_runs[*(int *) y];
+	int rc;
+
+	if ((rc = xstrcmp(run1->prefix, run2->prefix)))
+		return rc;
+	if (run1->width != run2->width)
+		return (run1->width < run2->width) ? -1 : 1;
+	if (run1->lo != run2->lo)
+		return (run1->lo < run2->lo) ? -1 : 1;
+	return 0;
+}
+
+static void _free_name_runs(void)
+{
+	int i;
+
+	for (i = 0; i < name_run_cnt; i++)
+		xfree(name_runs[i].prefix);
+	xfree(name_runs);
+	xfree(name_runs_sorted);
+	name_run_cnt = 0;
+	name_run_table = NULL;
+	name_run_node_cnt = 0;
+}
+
+static void _build_name_runs(void)
+{
+	struct node_record *node_ptr = node_record_table_ptr;
+	name_run_t *run;
+	unsigned long num;
+	int i, prefix_len, width, run_size = 0;
+
+	_free_name_runs();
+	/* Multi-dimensional suffixes are not decimal numbers */
+	if (slurmdb_setup_cluster_name_dims() > 1)
+		return;
+
+	run = NULL;
+	for (i = 0; i < node_record_count; i++, node_ptr++) {
+		if (!_split_node_name(node_ptr->name, &prefix_len, &num,
+				      &width)) {
+			run = NULL;
+			continue;
+		}
+		/* Same name as the next number formatted with run's width */
+		if (run && (num == run->lo + run->cnt) &&
+		    ((width == run->width) ||
+		     ((width > run->width) && (width == _num_digits(num)))) &&
+		    !strncmp(run->prefix, node_ptr->name, prefix_len) &&
+		    (run->prefix[prefix_len] == '\0')) {
+			run->cnt++;
+			continue;
+		}
+		if (name_run_cnt >= run_size) {
+			run_size = MAX(run_size * 2, 64);
+			xrealloc(name_runs, sizeof(name_run_t) * run_size);
+		}
+		run = &name_runs[name_run_cnt++];
+		run->prefix = xstrndup(node_ptr->name, prefix_len);
+		run->width = width;
+		run->lo = num;
+		run->first = i;
+		run->cnt = 1;
+	}
+
+	if (name_run_cnt) {
+		name_runs_sorted = xmalloc(sizeof(int) * name_run_cnt);
+		for (i = 0; i < name_run_cnt; i++)
+			name_runs_sorted[i] = i;
+		qsort(name_runs_sorted, name_run_cnt, sizeof(int),
+		      _cmp_name_runs);
+	}
+	name_run_table = node_record_table_ptr;
+	name_run_node_cnt = node_record_count;
+}
+
+/* Return true if the name index matches the current node table */
+static bool _name_runs_valid(void)
+{
+	return (name_run_table && (name_run_table == node_record_table_ptr) &&
+		(name_run_node_cnt == node_record_count));
+}
+
 /*
  * bitmap2hostlist - given a bitmap, build a hostlist
  * IN bitmap - bitmap pointer
@@ -363,7 +639,8 @@ static const char* _node_record_hash_identity (void* item)
  */
 hostlist_t bitmap2hostlist (bitstr_t *bitmap)
 {
-	int i, first, last;
+	int i, j, r, first, last, end;
+	name_run_t *run;
 	hostlist_t hl;
 
 	if (bitmap == NULL)
@@ -375,10 +652,35 @@ hostlist_t bitmap2hostlist (bitstr_t *bitmap)
 
 	last  = bit_fls(bitmap);
 	hl = hostlist_create(NULL);
-	for (i = first; i <= last; i++) {
+	if (!_name_runs_valid()) {
+		for (i = first; i <= last; i++) {
+			if (bit_test(bitmap, i) == 0)
+				continue;
+			hostlist_push_host(hl, node_record_table_ptr[i].name);
+		}
+		return hl;
+	}
+
+	/* Push each span of set bits within a run as one range */
+	for (i = first, r = 0; i <= last; i++) {
 		if (bit_test(bitmap, i) == 0)
 			continue;
-		hostlist_push_host(hl, node_record_table_ptr[i].name);
+		while ((r < name_run_cnt) &&
+		       (name_runs[r].first + name_runs[r].cnt <= i))
+			r++;
+		if ((r == name_run_cnt) || (name_runs[r].first > i)) {
+			hostlist_push_host(hl, node_record_table_ptr[i].name);
+			continue;
+		}
+		run = &name_runs[r];
+		end = MIN(run->first + run->cnt - 1, last);
+		for (j = i + 1; (j <= end) && bit_test(bitmap, j); j++)
+			;
+		hostlist_push_numbered(hl, run->prefix,
+				       run->lo + (i - run->first),
+				       run->lo + (j - 1 - run->first),
+				       run->width);
+		i = j - 1;
 	}
 	return hl;
 
@@ -528,13 +830,27 @@ extern int build_all_nodeline_info (bool set_bitmap, int tres_cnt)
 {
 	slurm_conf_node_t *node, **ptr_array;
 	struct config_record *config_ptr = NULL;
-	int count;
+	nodeline_t *lines;
+	int count, node_cnt = 0;
 	int i, rc, max_rc = SLURM_SUCCESS;
 
 	count = slurm_conf_nodename_array(&ptr_array);
 	if (count == 0)
 		fatal("No NodeName information available!");
 
+	/*
+	 * Expand hostlists in parallel, then size the node table once and
+	 * create the records in order
+	 */
+	lines = xmalloc(sizeof(nodeline_t) * count);
+	for (i = 0; i < count; i++)
+		lines[i].node_ptr = ptr_array[i];
+	_expand_nodelines(lines, count);
+	for (i = 0; i < count; i++)
+		node_cnt += lines[i].node_cnt;
+	if (node_cnt)
+		_grow_node_table(node_record_count + node_cnt);
+
 	for (i = 0; i < count; i++) {
 		node = ptr_array[i];
 
@@ -566,9 +882,11 @@ extern int build_all_nodeline_info (bool set_bitmap, int tres_cnt)
 		if (node->gres && node->gres[0])
 			config_ptr->gres = xstrdup(node->gres);
 
-		rc = _build_single_nodeline_info(node, config_ptr);
+		rc = _build_single_nodeline_info(&lines[i], config_ptr);
+		_free_nodeline(&lines[i]);
 		max_rc = MAX(max_rc, rc);
 	}
+	xfree(lines);
 
 	if (set_bitmap) {
 		ListIterator config_iterator;
@@ -611,6 +929,34 @@ extern struct config_record * create_config_record (void)
 	return config_ptr;
 }
 
+/*
+ * _grow_node_table - make room for node_cnt records at node_record_table_ptr,
+ *	rounded up to BUF_SIZE to reduce overhead of xrealloc
+ */
+static void _grow_node_table(int node_cnt)
+{
+	int buffer_size;
+
+	if (node_record_table_ptr &&
+	    (xsize(node_record_table_ptr) >=
+	     (node_cnt * sizeof(struct node_record))))
+		return;
+
+	buffer_size = node_cnt * sizeof(struct node_record);
+	buffer_size = ((int) ((buffer_size / BUF_SIZE) + 1)) * BUF_SIZE;
+	if (!node_record_table_ptr) {
+		node_record_table_ptr =
+			(struct node_record *) xmalloc(buffer_size);
+	} else {
+		xrealloc(node_record_table_ptr, buffer_size);
+		/*
+		 * You need to rehash the hash after we realloc or we will have
+		 * only bad memory references in the hash.
+		 */
+		rehash_node();
+	}
+}
+
 /*
  * create_node_record - create a node record and set its values to defaults
  * IN config_ptr - pointer to node's configuration information
@@ -623,31 +969,12 @@ extern struct node_record *create_node_record (
 			struct config_record *config_ptr, char *node_name)
 {
 	struct node_record *node_ptr;
-	int old_buffer_size, new_buffer_size;
 
 	last_node_update = time (NULL);
 	xassert(config_ptr);
 	xassert(node_name);
 
-	/* round up the buffer size to reduce overhead of xrealloc */
-	old_buffer_size = (node_record_count) * sizeof (struct node_record);
-	old_buffer_size =
-		((int) ((old_buffer_size / BUF_SIZE) + 1)) * BUF_SIZE;
-	new_buffer_size =
-		(node_record_count + 1) * sizeof (struct node_record);
-	new_buffer_size =
-		((int) ((new_buffer_size / BUF_SIZE) + 1)) * BUF_SIZE;
-	if (!node_record_table_ptr) {
-		node_record_table_ptr =
-			(struct node_record *) xmalloc (new_buffer_size);
-	} else if (old_buffer_size != new_buffer_size) {
-		xrealloc (node_record_table_ptr, new_buffer_size);
-		/*
-		 * You need to rehash the hash after we realloc or we will have
-		 * only bad memory references in the hash.
-		 */
-		rehash_node();
-	}
+	_grow_node_table(node_record_count + 1);
 	node_ptr = node_record_table_ptr + (node_record_count++);
 	node_ptr->name = xstrdup(node_name);
 	if (!node_hash_table)
@@ -787,6 +1114,7 @@ extern int init_node_conf (void)
 	node_record_count = 0;
 	xfree(node_record_table_ptr);
 	xhash_free(node_hash_table);
+	_free_name_runs();
 
 	if (config_list)	/* delete defunct configuration entries */
 		(void) _delete_config_record ();
@@ -811,6 +1139,7 @@ extern void node_fini2 (void)
 	}
 
 	xhash_free(node_hash_table);
+	_free_name_runs();
 	node_ptr = node_record_table_ptr;
 	for (i = 0; i < node_record_count; i++, node_ptr++)
 		purge_node_rec(node_ptr);
@@ -820,6 +1149,121 @@ extern void node_fini2 (void)
 }
 
 
+typedef struct {
+	bitstr_t *bitmap;
+	bool best_effort;
+	const char *caller;
+	int rc;
+} name_range_args_t;
+
+/* Set the bit of one named node, as found through the hash table */
+static void _name2bit(char *name, name_range_args_t *args)
+{
+	struct node_record *node_ptr;
+
+	node_ptr = _find_node_record(name, args->best_effort, true);
+	if (node_ptr) {
+		bit_set(args->bitmap,
+			(bitoff_t) (node_ptr - node_record_table_ptr));
+	} else {
+		error("%s: invalid node specified %s", args->caller, name);
+		if (!args->best_effort)
+			args->rc = EINVAL;
+	}
+}
+
+/*
+ * hostlist_for_each_range() callback: set the bits of one hostlist range
+ * from the name index, falling back to per node lookups for names not
+ * covered by it (aliases, unknown nodes).
+ */
+static int _name_range2bits(const char *prefix, unsigned long lo,
+			    unsigned long hi, int width, void *arg)
+{
+	name_range_args_t *args = (name_range_args_t *) arg;
+	unsigned long first, last, min_num, matched = 0;
+	name_run_t *run;
+	char name[1024];
+	int i, j, k, max_width;
+
+	if (width < 0) {
+		snprintf(name, sizeof(name), "%s", prefix);
+		_name2bit(name, args);
+		return 0;
+	}
+
+	/* Binary search for the first run with this prefix */
+	i = 0;
+	j = name_run_cnt;
+	while (i < j) {
+		k = (i + j) / 2;
+		if (xstrcmp(name_runs[name_runs_sorted[k]].prefix, prefix) < 0)
+			i = k + 1;
+		else
+			j = k;
+	}
+	for ( ; i < name_run_cnt; i++) {
+		run = &name_runs[name_runs_sorted[i]];
+		if (xstrcmp(run->prefix, prefix))
+			break;
+		first = MAX(lo, run->lo);
+		last = MIN(hi, run->lo + run->cnt - 1);
+		if (width != run->width) {
+			/* Paddings differ, names only match once the
+			 * number is wider than both */
+			max_width = MAX(width, run->width);
+			if (max_width > NAME_RUN_MAX_WIDTH)
+				continue;
+			for (min_num = 1; --max_width > 0; )
+				min_num *= 10;
+			first = MAX(first, min_num);
+		}
+		if (first > last)
+			continue;
+		bit_nset(args->bitmap, run->first + (first - run->lo),
+			 run->first + (last - run->lo));
+		matched += last - first + 1;
+	}
+
+	if (matched == (hi - lo + 1))
+		return 0;
+	for (first = lo; first <= hi; first++) {
+		snprintf(name, sizeof(name), "%s%0*lu", prefix, width, first);
+		_name2bit(name, args);
+		if (first == hi)	/* avoid wrap at ULONG_MAX */
+			break;
+	}
+	return 0;
+}
+
+/* Set in bitmap the bits of the nodes in hostlist hl */
+static int _hostlist2bits(hostlist_t hl, bool best_effort, bitstr_t *bitmap,
+			  const char *caller)
+{
+	name_range_args_t args;
+	hostlist_iterator_t hi;
+	char *name;
+
+	args.bitmap = bitmap;
+	args.best_effort = best_effort;
+	args.caller = caller;
+	args.rc = SLURM_SUCCESS;
+
+	if (_name_runs_valid()) {
+		(void) hostlist_for_each_range(hl, _name_range2bits, &args);
+		return args.rc;
+	}
+
+	hi = hostlist_iterator_create(hl);
+	while ((name = hostlist_next(hi)) != NULL) {
+		_name2bit(name, &args);
+		free(name);
+	}
+	hostlist_iterator_destroy(hi);
+
+	return args.rc;
+}
+
 /*
  * node_name2bitmap - given a node name regular expression, build a bitmap
  *	representation
@@ -833,7 +1277,6 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 			     bitstr_t **bitmap)
 {
 	int rc = SLURM_SUCCESS;
-	char *this_node_name;
 	bitstr_t *my_bitmap;
 	hostlist_t host_list;
 
@@ -853,20 +1296,8 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 		return rc;
 	}
 
-	while ( (this_node_name = hostlist_shift (host_list)) ) {
-		struct node_record *node_ptr;
-		node_ptr = _find_node_record(this_node_name, best_effort, true);
-		if (node_ptr) {
-			bit_set (my_bitmap, (bitoff_t) (node_ptr -
-							node_record_table_ptr));
-		} else {
-			error ("node_name2bitmap: invalid node specified %s",
-			       this_node_name);
-			if (!best_effort)
-				rc = EINVAL;
-		}
-		free (this_node_name);
-	}
+	rc = _hostlist2bits(host_list, best_effort, my_bitmap,
+			    "node_name2bitmap");
 	hostlist_destroy (host_list);
 
 	return rc;
@@ -881,34 +1312,13 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
  */
 extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 {
-	int rc = SLURM_SUCCESS;
 	bitstr_t *my_bitmap;
-	char *name;
-	hostlist_iterator_t hi;
 
 	FREE_NULL_BITMAP(*bitmap);
 	my_bitmap = (bitstr_t *) bit_alloc (node_record_count);
 	*bitmap = my_bitmap;
 
-	hi = hostlist_iterator_create(hl);
-	while ((name = hostlist_next(hi)) != NULL) {
-		struct node_record *node_ptr;
-		node_ptr = _find_node_record(name, best_effort, true);
-		if (node_ptr) {
-			bit_set (my_bitmap, (bitoff_t) (node_ptr -
-							node_record_table_ptr));
-		} else {
-			error ("hostlist2bitmap: invalid node specified %s",
-			       name);
-			if (!best_effort)
-				rc = EINVAL;
-		}
-		free (name);
-	}
-
-	hostlist_iterator_destroy(hi);
-	return rc;
-
+	return _hostlist2bits(hl, best_effort, my_bitmap, "hostlist2bitmap");
 }
 
 /* Purge the contents of a node record */
@@ -955,6 +1365,7 @@ extern void rehash_node (void)
 			continue;	/* vestigial record */
 		xhash_add(node_hash_table, node_ptr);
 	}
+	_build_name_runs();
 
 #if _DEBUG
 	_dump_hash();
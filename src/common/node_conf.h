@@ -170,6 +170,9 @@ struct node_record {
 	char *tres_fmt_str;		/* tres this node has */
 	uint64_t *tres_cnt;		/* tres this node has. NO_PACK*/
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
+	uint64_t delta_gen;		/* change stamp in slurmctld's
+					 * info_delta.c. NO_PACK */
+	uint64_t delta_hash;		/* digest of the packed record. NO_PACK*/
 };
 extern struct node_record *node_record_table_ptr;  /* ptr to node records */
 extern int node_record_count;		/* count in node_record_table_ptr */
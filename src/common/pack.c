@@ -42,8 +42,11 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
 
 #include "slurm/slurm_errno.h"
@@ -64,6 +67,8 @@ strong_alias(free_buf,		slurm_free_buf);
 strong_alias(grow_buf,		slurm_grow_buf);
 strong_alias(init_buf,		slurm_init_buf);
 strong_alias(xfer_buf_data,	slurm_xfer_buf_data);
+strong_alias(get_pool_buf,	slurm_get_pool_buf);
+strong_alias(put_pool_buf,	slurm_put_pool_buf);
 strong_alias(pack_time,		slurm_pack_time);
 strong_alias(unpack_time,	slurm_unpack_time);
 strong_alias(packdouble,	slurm_packdouble);
@@ -92,6 +97,25 @@ strong_alias(unpackstr_array,	slurm_unpackstr_array);
 strong_alias(packmem_array,	slurm_packmem_array);
 strong_alias(unpackmem_array,	slurm_unpackmem_array);
 
+/*
+ * Per-thread buffer cache used by get_pool_buf()/put_pool_buf(). One buffer
+ * is kept per size class so that a message of a given size does not need to
+ * grow a buffer taken from the cache. Only buffers of exactly a class size
+ * are kept, so a thread holds at most the sum of the class sizes.
+ */
+#define BUF_POOL_CLASSES	4
+
+static const uint32_t buf_pool_size[BUF_POOL_CLASSES] = {
+	BUF_SIZE, (64 * 1024), (256 * 1024), (1024 * 1024)
+};
+
+typedef struct {
+	Buf buf[BUF_POOL_CLASSES];
+} buf_pool_t;
+
+static pthread_key_t  buf_pool_key;
+static pthread_once_t buf_pool_once = PTHREAD_ONCE_INIT;
+
 /* Basic buffer management routines */
 /* create_buf - create a buffer with the supplied contents, contents must
  * be xalloc'ed */
@@ -110,6 +134,36 @@ Buf create_buf(char *data, uint32_t size)
 	my_buf->size = size;
 	my_buf->processed = 0;
 	my_buf->head = data;
+	my_buf->mmaped = false;
+
+	return my_buf;
+}
+
+/* create_mmap_buf - create a read only buffer mapping a whole file */
+Buf create_mmap_buf(int fd)
+{
+	Buf my_buf;
+	struct stat f_stat;
+	void *data;
+
+	if (fstat(fd, &f_stat) < 0)
+		return NULL;
+	if (f_stat.st_size == 0)
+		return create_buf(NULL, 0);
+	if (f_stat.st_size > MAX_BUF_SIZE) {
+		error("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
+		      __func__, (uint64_t) f_stat.st_size, MAX_BUF_SIZE);
+		return NULL;
+	}
+
+	data = mmap(NULL, f_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		return NULL;
+	/* Records are unpacked front to back, start the reads now */
+	(void) madvise(data, f_stat.st_size, MADV_WILLNEED);
+
+	my_buf = create_buf(data, f_stat.st_size);
+	my_buf->mmaped = true;
 
 	return my_buf;
 }
@@ -120,7 +174,11 @@ void free_buf(Buf my_buf)
 	if (!my_buf)
 		return;
 	assert(my_buf->magic == BUF_MAGIC);
-	xfree(my_buf->head);
+	if (my_buf->mmaped) {
+		if (my_buf->head)
+			(void) munmap(my_buf->head, my_buf->size);
+	} else
+		xfree(my_buf->head);
 	xfree(my_buf);
 }
 
@@ -133,6 +191,7 @@ void grow_buf (Buf buffer, uint32_t size)
 		return;
 	}
 
+	assert(!buffer->mmaped);
 	buffer->size += size;
 	xrealloc_nz(buffer->head, buffer->size);
 }
@@ -154,6 +213,7 @@ Buf init_buf(uint32_t size)
 	my_buf->size = size;
 	my_buf->processed = 0;
 	my_buf->head = xmalloc(sizeof(char)*size);
+	my_buf->mmaped = false;
 	return my_buf;
 }
 
@@ -164,11 +224,104 @@ void *xfer_buf_data(Buf my_buf)
 	void *data_ptr;
 
 	assert(my_buf->magic == BUF_MAGIC);
+	assert(!my_buf->mmaped);
 	data_ptr = (void *) my_buf->head;
 	xfree(my_buf);
 	return data_ptr;
 }
 
+static void _buf_pool_destroy(void *arg)
+{
+	buf_pool_t *pool = (buf_pool_t *) arg;
+	int i;
+
+	for (i = 0; i < BUF_POOL_CLASSES; i++) {
+		if (pool->buf[i])
+			free_buf(pool->buf[i]);
+	}
+	xfree(pool);
+}
+
+static void _buf_pool_key_init(void)
+{
+	if (pthread_key_create(&buf_pool_key, _buf_pool_destroy))
+		error("%s: pthread_key_create: %m", __func__);
+}
+
+static buf_pool_t *_buf_pool(void)
+{
+	buf_pool_t *pool;
+
+	pthread_once(&buf_pool_once, _buf_pool_key_init);
+	if (!(pool = pthread_getspecific(buf_pool_key))) {
+		pool = xmalloc(sizeof(buf_pool_t));
+		if (pthread_setspecific(buf_pool_key, pool)) {
+			xfree(pool);
+			return NULL;
+		}
+	}
+	return pool;
+}
+
+/* get_pool_buf - return an empty buffer of at least the given size */
+Buf get_pool_buf(uint32_t size)
+{
+	buf_pool_t *pool;
+	Buf my_buf;
+	int i;
+
+	if (size == 0)
+		size = BUF_SIZE;
+	for (i = 0; i < BUF_POOL_CLASSES; i++) {
+		if (size <= buf_pool_size[i])
+			break;
+	}
+	if (i >= BUF_POOL_CLASSES)
+		return init_buf(size);
+
+	if (!(pool = _buf_pool()) || !pool->buf[i])
+		return init_buf(buf_pool_size[i]);
+
+	my_buf = pool->buf[i];
+	pool->buf[i] = NULL;
+	my_buf->processed = 0;
+	return my_buf;
+}
+
+/* put_pool_buf - cache a buffer for reuse by the calling thread */
+void put_pool_buf(Buf my_buf)
+{
+	buf_pool_t *pool;
+	int i;
+
+	if (!my_buf)
+		return;
+	assert(my_buf->magic == BUF_MAGIC);
+	if (!my_buf->head) {
+		xfree(my_buf);
+		return;
+	}
+	if (my_buf->mmaped) {
+		free_buf(my_buf);
+		return;
+	}
+
+	/* Receivers trim size to the message length, restore the capacity */
+	my_buf->size = xsize(my_buf->head);
+	for (i = 0; i < BUF_POOL_CLASSES; i++) {
+		if (my_buf->size == buf_pool_size[i])
+			break;
+	}
+	if ((i >= BUF_POOL_CLASSES) || !(pool = _buf_pool()) ||
+	    pool->buf[i]) {
+		free_buf(my_buf);
+		return;
+	}
+
+	my_buf->processed = 0;
+	pool->buf[i] = my_buf;
+}
+
 /*
  * Given a time_t in host byte order, promote it to int64_t, convert to
  * network byte order, store in buffer and adjust buffer acc'd'ngly
@@ -43,6 +43,7 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <time.h>
 #include <string.h>
 
@@ -64,6 +65,7 @@ struct slurm_buf {
 	char *head;
 	uint32_t size;
 	uint32_t processed;
+	bool mmaped;		/* head is a mapping from create_mmap_buf() */
 };
 
 typedef struct slurm_buf * Buf;
@@ -75,11 +77,28 @@ typedef struct slurm_buf * Buf;
 #define size_buf(__buf)			(__buf->size)
 
 Buf	create_buf (char *data, uint32_t size);
+/*
+ * create_mmap_buf - create a read only buffer mapping the whole file open on
+ *	fd, the kernel is asked to start reading it in right away. The caller
+ *	may close fd once this returns. Do not grow or xfer such a buffer.
+ * RET the buffer or NULL if the file could not be mapped
+ */
+Buf	create_mmap_buf(int fd);
 void	free_buf(Buf my_buf);
 Buf	init_buf(uint32_t size);
 void    grow_buf (Buf my_buf, uint32_t size);
 void	*xfer_buf_data(Buf my_buf);
 
+/*
+ * get_pool_buf - return an empty buffer of at least the given size, reusing
+ *	one cached by the calling thread where possible.
+ * put_pool_buf - return a buffer obtained from get_pool_buf (or any other
+ *	Buf) to the calling thread's cache, freeing it if the cache already
+ *	holds one of its size or its size is not exactly a cached size.
+ */
+Buf	get_pool_buf(uint32_t size);
+void	put_pool_buf(Buf my_buf);
+
 void	pack_time(time_t val, Buf buffer);
 int	unpack_time(time_t *valp, Buf buffer);
 
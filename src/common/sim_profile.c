@@ -0,0 +1,243 @@
+#ifdef SLURM_SIMULATOR
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/sim_profile.h"
+
+static sim_prof_shm_t *sim_prof = NULL;
+static pthread_mutex_t sim_prof_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *phase_names[SIM_PROF_PHASE_CNT] = {
+	"submit", "sync_wait", "complete_send", "helper_rpc", "ctld_wait",
+	"schedule", "backfill", "decay"
+};
+
+static const char *phase_owners[SIM_PROF_PHASE_CNT] = {
+	"sim_mgr", "sim_mgr", "slurmctld", "slurmd", "slurmctld",
+	"slurmctld", "slurmctld", "slurmctld"
+};
+
+static const char *count_names[SIM_PROF_COUNT_CNT] = {
+	"jobs_submitted", "rsv_created", "jobs_ended", "jobs_started",
+	"sched_passes", "bf_passes", "decay_passes"
+};
+
+/*
+ * time() and gettimeofday() return simulated time inside the simulator,
+ * CLOCK_MONOTONIC is left alone and is comparable across the processes.
+ */
+static uint64_t _now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static sim_prof_cycle_t *_cur_cycle(void)
+{
+	uint64_t cycle = sim_prof->cycle;
+
+	if (!cycle)
+		return NULL;
+	return &sim_prof->ring[cycle % sim_prof->ring_size];
+}
+
+extern void sim_prof_shm_name(char *name, size_t len)
+{
+	char *sim_id = getenv("SLURM_SIM_ID");
+
+	snprintf(name, len, "%s%s", SIM_PROF_SHM_NAME, sim_id ? sim_id : "");
+}
+
+extern size_t sim_prof_shm_size(uint32_t ring_size)
+{
+	return sizeof(sim_prof_shm_t) + (ring_size * sizeof(sim_prof_cycle_t));
+}
+
+extern int sim_prof_create(uint32_t ring_size)
+{
+	char name[128];
+	size_t size;
+	void *addr;
+	int fd;
+
+	if (!ring_size)
+		ring_size = SIM_PROF_DEFAULT_CYCLES;
+	size = sim_prof_shm_size(ring_size);
+
+	sim_prof_shm_name(name, sizeof(name));
+	fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		error("%s: shm_open(%s): %m", __func__, name);
+		return -1;
+	}
+	if (ftruncate(fd, size)) {
+		error("%s: ftruncate(%s): %m", __func__, name);
+		close(fd);
+		return -1;
+	}
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		error("%s: mmap(%s): %m", __func__, name);
+		return -1;
+	}
+
+	sim_prof = addr;
+	sim_prof->version   = SIM_PROF_VERSION;
+	sim_prof->phase_cnt = SIM_PROF_PHASE_CNT;
+	sim_prof->count_cnt = SIM_PROF_COUNT_CNT;
+	sim_prof->ring_size = ring_size;
+	sim_prof->cycle     = 0;
+	__sync_synchronize();
+	sim_prof->magic     = SIM_PROF_MAGIC;
+
+	info("SIM: profiling %u cycles into %s", ring_size, name);
+	return 0;
+}
+
+extern int sim_prof_attach(void)
+{
+	sim_prof_shm_t *addr;
+	struct stat st;
+	char name[128];
+	int fd, rc = -1;
+
+	if (sim_prof)
+		return 0;
+
+	slurm_mutex_lock(&sim_prof_mutex);
+	if (sim_prof) {
+		rc = 0;
+		goto fini;
+	}
+
+	sim_prof_shm_name(name, sizeof(name));
+	if ((fd = shm_open(name, O_RDWR, 0)) < 0)
+		goto fini;
+	if (fstat(fd, &st) || (st.st_size < sizeof(sim_prof_shm_t))) {
+		close(fd);
+		goto fini;
+	}
+	addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		    fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		goto fini;
+
+	if ((addr->magic != SIM_PROF_MAGIC) ||
+	    (addr->version != SIM_PROF_VERSION) ||
+	    (addr->phase_cnt != SIM_PROF_PHASE_CNT) ||
+	    (addr->count_cnt != SIM_PROF_COUNT_CNT) || !addr->ring_size ||
+	    (st.st_size < sim_prof_shm_size(addr->ring_size))) {
+		munmap(addr, st.st_size);
+		goto fini;
+	}
+
+	sim_prof = addr;
+	info("SIM: attached to profiling segment %s", name);
+	rc = 0;
+
+fini:
+	slurm_mutex_unlock(&sim_prof_mutex);
+	return rc;
+}
+
+extern void sim_prof_cycle_begin(uint32_t sim_time)
+{
+	sim_prof_cycle_t *rec;
+	uint64_t seq;
+
+	if (!sim_prof)
+		return;
+
+	seq = sim_prof->cycle + 1;
+	rec = &sim_prof->ring[seq % sim_prof->ring_size];
+	memset(rec, 0, sizeof(sim_prof_cycle_t));
+	rec->sim_time = sim_time;
+	rec->wall_start = _now_usec();
+	rec->seq = seq;
+	__sync_synchronize();
+	sim_prof->cycle = seq;
+}
+
+extern void sim_prof_cycle_end(void)
+{
+	sim_prof_cycle_t *rec;
+
+	if (!sim_prof || !(rec = _cur_cycle()))
+		return;
+
+	rec->wall_usec = _now_usec() - rec->wall_start;
+}
+
+extern uint64_t sim_prof_begin(void)
+{
+	if (!sim_prof)
+		return 0;
+	return _now_usec();
+}
+
+extern void sim_prof_end(sim_prof_phase_t phase, uint64_t begin)
+{
+	sim_prof_cycle_t *rec;
+	uint64_t now;
+	uint32_t offset;
+
+	if (!begin || !sim_prof || (phase >= SIM_PROF_PHASE_CNT) ||
+	    !(rec = _cur_cycle()))
+		return;
+
+	now = _now_usec();
+	/* 0 means "did not run", so a phase starting with the cycle is 1 */
+	offset = (begin > rec->wall_start) ? (begin - rec->wall_start) : 1;
+	(void) __sync_bool_compare_and_swap(&rec->phase[phase].start_usec, 0,
+					    offset);
+	(void) __sync_fetch_and_add(&rec->phase[phase].usec,
+				    (uint32_t) (now - begin));
+}
+
+extern void sim_prof_count(sim_prof_count_t counter, uint32_t cnt)
+{
+	sim_prof_cycle_t *rec;
+
+	if (!sim_prof || (counter >= SIM_PROF_COUNT_CNT) ||
+	    !(rec = _cur_cycle()))
+		return;
+
+	(void) __sync_fetch_and_add(&rec->count[counter], cnt);
+}
+
+extern const char *sim_prof_phase_name(sim_prof_phase_t phase)
+{
+	if (phase >= SIM_PROF_PHASE_CNT)
+		return "unknown";
+	return phase_names[phase];
+}
+
+extern const char *sim_prof_phase_owner(sim_prof_phase_t phase)
+{
+	if (phase >= SIM_PROF_PHASE_CNT)
+		return "unknown";
+	return phase_owners[phase];
+}
+
+extern const char *sim_prof_count_name(sim_prof_count_t counter)
+{
+	if (counter >= SIM_PROF_COUNT_CNT)
+		return "unknown";
+	return count_names[counter];
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef __SLURM_SIM_PROFILE_H__
+#define __SLURM_SIM_PROFILE_H__
+
+#ifdef SLURM_SIMULATOR
+
+/*
+ * Per-cycle phase profiler for the simulator.
+ *
+ * sim_mgr owns a shared memory ring with one record per simulated cycle.
+ * sim_mgr, slurmd and slurmctld accumulate the real time spent in each
+ * phase of the cycle and a few event counters into the record of the
+ * current cycle. The ring is read afterwards by sim_prof_dump, which exports
+ * it as CSV or as Chrome trace JSON.
+ *
+ * All the calls below are no-ops while the segment is not attached, so the
+ * hooks can stay in place when sim_mgr runs without profiling.
+ */
+
+#include <inttypes.h>
+
+#define SIM_PROF_SHM_NAME	"/tester_slurm_sim_prof.shm"
+#define SIM_PROF_MAGIC		0x534d5046	/* "SMPF" */
+#define SIM_PROF_VERSION	2
+#define SIM_PROF_DEFAULT_CYCLES	16384
+
+typedef enum {
+	SIM_PROF_SUBMIT,	/* sim_mgr: trace and reservation submission */
+	SIM_PROF_SYNC_WAIT,	/* sim_mgr: waiting for the daemons' cycle */
+	SIM_PROF_COMPLETE_SEND,	/* slurmctld: completing the cycle's jobs */
+	SIM_PROF_HELPER_RPC,	/* slurmd: MESSAGE_SIM_HELPER_CYCLE round trip */
+	SIM_PROF_CTLD_WAIT,	/* slurmctld: waiting for completions/epilogs */
+	SIM_PROF_SCHEDULE,	/* slurmctld: schedule() */
+	SIM_PROF_BACKFILL,	/* slurmctld: backfill pass */
+	SIM_PROF_DECAY,		/* slurmctld: priority decay pass */
+	SIM_PROF_PHASE_CNT
+} sim_prof_phase_t;
+
+typedef enum {
+	SIM_PROF_JOBS_SUBMITTED,
+	SIM_PROF_RSV_CREATED,
+	SIM_PROF_JOBS_ENDED,
+	SIM_PROF_JOBS_STARTED,
+	SIM_PROF_SCHED_PASSES,
+	SIM_PROF_BF_PASSES,
+	SIM_PROF_DECAY_PASSES,
+	SIM_PROF_COUNT_CNT
+} sim_prof_count_t;
+
+typedef struct {
+	uint32_t start_usec;	/* first entry into the phase, relative to
+				 * wall_start, 0 if the phase did not run */
+	uint32_t usec;		/* total time spent in the phase */
+} sim_prof_span_t;
+
+typedef struct {
+	uint64_t seq;		/* cycle sequence number, 0 if slot unused */
+	uint64_t wall_start;	/* CLOCK_MONOTONIC usec at cycle begin */
+	uint32_t sim_time;	/* simulated time of the cycle */
+	uint32_t wall_usec;	/* real time taken by the whole cycle */
+	sim_prof_span_t phase[SIM_PROF_PHASE_CNT];
+	uint32_t count[SIM_PROF_COUNT_CNT];
+} sim_prof_cycle_t;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t phase_cnt;
+	uint32_t count_cnt;
+	uint32_t ring_size;	/* number of records in ring */
+	uint32_t pad;
+	uint64_t cycle;		/* sequence number of the current cycle */
+	sim_prof_cycle_t ring[];
+} sim_prof_shm_t;
+
+/* Build the shm segment name, honoring SLURM_SIM_ID like the semaphores */
+extern void sim_prof_shm_name(char *name, size_t len);
+
+/* Size in bytes of a segment holding ring_size cycle records */
+extern size_t sim_prof_shm_size(uint32_t ring_size);
+
+/*
+ * Create (or reset) the profiling segment with room for ring_size cycles.
+ * Called by sim_mgr only. Returns 0 on success, -1 on error.
+ */
+extern int sim_prof_create(uint32_t ring_size);
+
+/*
+ * Attach to the profiling segment if sim_mgr created one. Cheap to call
+ * repeatedly: returns immediately once attached. Returns 0 if attached.
+ */
+extern int sim_prof_attach(void);
+
+/* Start/end a simulated cycle. Called by sim_mgr only. */
+extern void sim_prof_cycle_begin(uint32_t sim_time);
+extern void sim_prof_cycle_end(void);
+
+/*
+ * Timestamp the beginning of a phase. Returns 0 when profiling is off, in
+ * which case the matching sim_prof_end() does nothing.
+ */
+extern uint64_t sim_prof_begin(void);
+
+/* Add the time elapsed since begin to phase of the current cycle */
+extern void sim_prof_end(sim_prof_phase_t phase, uint64_t begin);
+
+/* Add cnt to counter of the current cycle */
+extern void sim_prof_count(sim_prof_count_t counter, uint32_t cnt);
+
+/* Names used for export, and the daemon each phase runs in */
+extern const char *sim_prof_phase_name(sim_prof_phase_t phase);
+extern const char *sim_prof_phase_owner(sim_prof_phase_t phase);
+extern const char *sim_prof_count_name(sim_prof_count_t counter);
+
+#endif
+#endif /*__SLURM_SIM_PROFILE_H__*/
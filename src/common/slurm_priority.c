@@ -51,6 +51,7 @@ typedef struct slurm_priority_ops {
 	List	 (*get_priority_factors)
 	(priority_factors_request_msg_t *req_msg, uid_t uid);
 	void     (*job_end)        (struct job_record *job_ptr);
+	int      (*decay_pass)     (void);
 } slurm_priority_ops_t;
 
 /*
@@ -63,6 +64,7 @@ static const char *syms[] = {
 	"priority_p_calc_fs_factor",
 	"priority_p_get_priority_factors_list",
 	"priority_p_job_end",
+	"priority_p_decay_pass",
 };
 
 static slurm_priority_ops_t ops;
@@ -172,3 +174,11 @@ extern void priority_g_job_end(struct job_record *job_ptr)
 	(*(ops.job_end))(job_ptr);
 }
 
+extern int priority_g_decay_pass(void)
+{
+	if (slurm_priority_init() < 0)
+		return SLURM_ERROR;
+
+	return (*(ops.decay_pass))();
+}
+
@@ -65,4 +65,10 @@ extern List priority_g_get_priority_factors_list(
  */
 extern void priority_g_job_end(struct job_record *job_ptr);
 
+/* Run one usage decay and job priority factor pass in the calling thread,
+ * as the decay thread of the plugin does every PriorityCalcPeriod. Used by
+ * the scheduler benchmark (slurmctld -b).
+ */
+extern int priority_g_decay_pass(void);
+
 #endif /*_SLURM_PRIORIY_H */
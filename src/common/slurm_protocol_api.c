@@ -3314,24 +3314,34 @@ int slurm_receive_msg(int fd, slurm_msg_t *msg, int timeout)
 	/*
 	 * Receive a msg. slurm_msg_recvfrom() will read the message
 	 *  length and allocate space on the heap for a buffer containing
-	 *  the message.
+	 *  the message. A buffer which is not kept by the caller is taken
+	 *  from this thread's buffer pool instead.
 	 */
-	if (slurm_msg_recvfrom_timeout(fd, &buf, &buflen, 0, timeout) < 0) {
-		rc = errno;
-		goto endit;
+	if (keep_buffer) {
+		if (slurm_msg_recvfrom_timeout(fd, &buf, &buflen, 0,
+					       timeout) < 0) {
+			rc = errno;
+			goto endit;
+		}
+		buffer = create_buf(buf, buflen);
+	} else {
+		buffer = get_pool_buf(BUF_SIZE);
+		if (slurm_msg_recv_buf_timeout(fd, buffer, timeout) < 0) {
+			rc = errno;
+			put_pool_buf(buffer);
+			goto endit;
+		}
 	}
 
 #if	_DEBUG
-	_print_data (buf, buflen);
+	_print_data (get_buf_data(buffer), size_buf(buffer));
 #endif
-	buffer = create_buf(buf, buflen);
-
 	rc = slurm_unpack_received_msg(msg, fd, buffer);
 
 	if (keep_buffer)
 		msg->buffer = buffer;
 	else
-		free_buf(buffer);
+		put_pool_buf(buffer);
 
 endit:
 	slurm_seterrno(rc);
@@ -3351,8 +3361,6 @@ endit:
  */
 List slurm_receive_msgs(int fd, int steps, int timeout)
 {
-	char *buf = NULL;
-	size_t buflen = 0;
 	header_t header;
 	int rc;
 	void *auth_cred = NULL;
@@ -3400,23 +3408,22 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 
 
 	/*
-	 * Receive a msg. slurm_msg_recvfrom() will read the message
-	 *  length and allocate space on the heap for a buffer containing
-	 *  the message.
+	 * Receive a msg into a buffer from this thread's buffer pool
 	 */
-	if (slurm_msg_recvfrom_timeout(fd, &buf, &buflen, 0, timeout) < 0) {
+	buffer = get_pool_buf(BUF_SIZE);
+	if (slurm_msg_recv_buf_timeout(fd, buffer, timeout) < 0) {
+		put_pool_buf(buffer);
 		forward_init(&header.forward, NULL);
 		rc = errno;
 		goto total_return;
 	}
 
 #if	_DEBUG
-	_print_data (buf, buflen);
+	_print_data (get_buf_data(buffer), size_buf(buffer));
 #endif
-	buffer = create_buf(buf, buflen);
 
 	if (unpack_header(&header, buffer) == SLURM_ERROR) {
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		rc = SLURM_COMMUNICATIONS_RECEIVE_ERROR;
 		goto total_return;
 	}
@@ -3436,7 +3443,7 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 			      header.version, uid);
 		}
 
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		rc = SLURM_PROTOCOL_VERSION_ERROR;
 		goto total_return;
 	}
@@ -3459,7 +3466,7 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 	if ((auth_cred = g_slurm_auth_unpack(buffer)) == NULL) {
 		error( "authentication: %s ",
 		       g_slurm_auth_errstr(g_slurm_auth_errno(NULL)));
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		goto total_return;
 	}
@@ -3475,7 +3482,7 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 		error("authentication: %s ",
 		      g_slurm_auth_errstr(g_slurm_auth_errno(auth_cred)));
 		(void) g_slurm_auth_destroy(auth_cred);
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		rc = SLURM_PROTOCOL_AUTHENTICATION_ERROR;
 		goto total_return;
 	}
@@ -3490,13 +3497,13 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 	if ((header.body_length > remaining_buf(buffer)) ||
 	    (unpack_msg(&msg, buffer) != SLURM_SUCCESS)) {
 		(void) g_slurm_auth_destroy(auth_cred);
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		goto total_return;
 	}
 	g_slurm_auth_destroy(auth_cred);
 
-	free_buf(buffer);
+	put_pool_buf(buffer);
 	rc = SLURM_SUCCESS;
 
 total_return:
@@ -3761,26 +3768,34 @@ total_return:
 \**********************************************************************/
 
 /*
- *  Do the wonderful stuff that needs be done to pack msg
- *  and hdr into buffer
+ *  Pack the message body into its own buffer, or reference it directly
+ *  when it is already packed, and update the header packed at the start
+ *  of hdr_buf with the body length
  */
-static void
-_pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer)
+static Buf
+_pack_msg(slurm_msg_t *msg, header_t *hdr, Buf hdr_buf,
+	  char **body, uint32_t *body_len)
 {
-	unsigned int tmplen, msglen;
+	Buf body_buf = NULL;
+	unsigned int tmplen;
 
-	tmplen = get_buf_offset(buffer);
-	pack_msg(msg, buffer);
-	msglen = get_buf_offset(buffer) - tmplen;
+	if (!pack_msg_data_ref(msg, body, body_len)) {
+		body_buf = get_pool_buf(BUF_SIZE);
+		pack_msg(msg, body_buf);
+		*body = get_buf_data(body_buf);
+		*body_len = get_buf_offset(body_buf);
+	}
 
 	/* update header with correct cred and msg lengths */
-	update_header(hdr, msglen);
+	update_header(hdr, *body_len);
 
 	/* repack updated header */
-	tmplen = get_buf_offset(buffer);
-	set_buf_offset(buffer, 0);
-	pack_header(hdr, buffer);
-	set_buf_offset(buffer, tmplen);
+	tmplen = get_buf_offset(hdr_buf);
+	set_buf_offset(hdr_buf, 0);
+	pack_header(hdr, hdr_buf);
+	set_buf_offset(hdr_buf, tmplen);
+
+	return body_buf;
 }
 
 /*
@@ -3790,7 +3805,10 @@ _pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer)
 int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 {
 	header_t header;
-	Buf      buffer;
+	Buf      buffer, body_buf;
+	char *   body = NULL;
+	uint32_t body_len = 0;
+	struct iovec iov[2];
 	int      rc;
 	void *   auth_cred;
 	time_t   start_time = time(NULL);
@@ -3873,7 +3891,7 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 	/*
 	 * Pack header into buffer for transmission
 	 */
-	buffer = init_buf(BUF_SIZE);
+	buffer = get_pool_buf(BUF_SIZE);
 	pack_header(&header, buffer);
 
 	/*
@@ -3884,26 +3902,31 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 	if (rc) {
 		error("authentication: %s",
 		      g_slurm_auth_errstr(g_slurm_auth_errno(auth_cred)));
-		free_buf(buffer);
+		put_pool_buf(buffer);
 		slurm_seterrno_ret(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
 	}
 
 	/*
-	 * Pack message into buffer
+	 * Pack message into a separate buffer so header and body can be
+	 * sent without concatenating them
 	 */
-	_pack_msg(msg, &header, buffer);
+	body_buf = _pack_msg(msg, &header, buffer, &body, &body_len);
 
 #if	_DEBUG
 	_print_data (get_buf_data(buffer),get_buf_offset(buffer));
+	_print_data (body, body_len);
 #endif
 	/*
 	 * Send message
 	 */
-	rc = slurm_msg_sendto( fd, get_buf_data(buffer),
-			       get_buf_offset(buffer),
-			       SLURM_PROTOCOL_NO_SEND_RECV_FLAGS );
+	iov[0].iov_base = get_buf_data(buffer);
+	iov[0].iov_len  = get_buf_offset(buffer);
+	iov[1].iov_base = body;
+	iov[1].iov_len  = body_len;
+	rc = slurm_msg_sendv(fd, iov, (body_len ? 2 : 1),
+			     SLURM_PROTOCOL_NO_SEND_RECV_FLAGS);
 	if ((rc < 0) && (errno == ENOTCONN)) {
-		debug3("slurm_msg_sendto: peer has disappeared for msg_type=%u",
+		debug3("slurm_msg_sendv: peer has disappeared for msg_type=%u",
 		       msg->msg_type);
 	} else if (rc < 0) {
 		slurm_addr_t peer_addr;
@@ -3911,22 +3934,69 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 		if (!slurm_get_peer_addr(fd, &peer_addr)) {
 			slurm_print_slurm_addr(
 				&peer_addr, addr_str, sizeof(addr_str));
-			error("slurm_msg_sendto: address:port=%s "
+			error("slurm_msg_sendv: address:port=%s "
 			      "msg_type=%u: %m",
 			      addr_str, msg->msg_type);
 		} else if (errno == ENOTCONN)
-			debug3("slurm_msg_sendto: peer has disappeared "
+			debug3("slurm_msg_sendv: peer has disappeared "
 			       "for msg_type=%u",
 			       msg->msg_type);
 		else
-			error("slurm_msg_sendto: msg_type=%u: %m",
+			error("slurm_msg_sendv: msg_type=%u: %m",
 			      msg->msg_type);
 	}
 
-	free_buf(buffer);
+	put_pool_buf(body_buf);
+	put_pool_buf(buffer);
 	return rc;
 }
 
+extern Buf slurm_pack_msg_head(slurm_msg_t *msg, uint32_t body_len)
+{
+	header_t header;
+	Buf      buffer;
+	int      rc;
+	uint32_t head_len;
+	void *   auth_cred;
+
+	if (msg->flags & SLURM_GLOBAL_AUTH_KEY) {
+		auth_cred = g_slurm_auth_create(_global_auth_key());
+	} else {
+		char *auth_info = slurm_get_auth_info();
+		auth_cred = g_slurm_auth_create(auth_info);
+		xfree(auth_info);
+	}
+	if (auth_cred == NULL) {
+		error("authentication: %s",
+		      g_slurm_auth_errstr(g_slurm_auth_errno(NULL)) );
+		slurm_seterrno(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
+		return NULL;
+	}
+
+	init_header(&header, msg, msg->flags);
+	update_header(&header, body_len);
+
+	buffer = init_buf(BUF_SIZE);
+	pack32(0, buffer);	/* length prefix, set below */
+	pack_header(&header, buffer);
+	rc = g_slurm_auth_pack(auth_cred, buffer);
+	(void) g_slurm_auth_destroy(auth_cred);
+	if (rc) {
+		error("authentication: %s",
+		      g_slurm_auth_errstr(g_slurm_auth_errno(auth_cred)));
+		free_buf(buffer);
+		slurm_seterrno(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
+		return NULL;
+	}
+
+	head_len = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack32(head_len - sizeof(uint32_t) + body_len, buffer);
+	set_buf_offset(buffer, head_len);
+
+	return buffer;
+}
+
 /**********************************************************************\
  * stream functions
 \**********************************************************************/
@@ -1056,6 +1056,17 @@ int slurm_receive_msg_and_forward(int fd, slurm_addr_t *orig_addr,
  */
 int slurm_send_node_msg(int open_fd, slurm_msg_t *msg);
 
+/* packs the length prefix, header and a new authentication credential of
+ * a message whose body is packed separately (see pack_msg), for callers
+ * which write the message to the socket themselves. Forwarding is not
+ * supported.
+ *
+ * IN msg		- a slurm msg struct, msg->forward initialized
+ * IN body_len		- length of the packed body to follow
+ * RET Buf		- data to send before the body, NULL on error
+ */
+extern Buf slurm_pack_msg_head(slurm_msg_t *msg, uint32_t body_len);
+
 /**********************************************************************\
  * msg connection establishment functions used by msg clients
 \**********************************************************************/
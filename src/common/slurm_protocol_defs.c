@@ -790,6 +790,23 @@ extern void slurm_free_node_info_single_msg(node_info_single_msg_t *msg)
 	}
 }
 
+extern void slurm_free_info_delta_request_msg(info_delta_request_msg_t *msg)
+{
+	xfree(msg);
+}
+
+extern void slurm_free_job_info_query_msg(job_info_query_t *msg)
+{
+	if (msg) {
+		xfree(msg->accounts);
+		xfree(msg->job_ids);
+		xfree(msg->partitions);
+		xfree(msg->states);
+		xfree(msg->user_ids);
+		xfree(msg);
+	}
+}
+
 extern void slurm_free_part_info_request_msg(part_info_request_msg_t *msg)
 {
 	xfree(msg);
@@ -1240,6 +1257,7 @@ extern void slurm_free_sim_job_msg(sim_job_msg_t *msg)
 extern void slurm_free_sim_helper_msg(sim_helper_msg_t *msg)
 {
 	if(msg){
+		xfree(msg->job_ids);
        		xfree(msg);
 	}
 }
@@ -1508,6 +1526,8 @@ extern void slurm_free_suspend_int_msg(suspend_int_msg_t *msg)
 
 extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 {
+	int i;
+
 	if (msg) {
 		xfree(msg->rpc_type_id);
 		xfree(msg->rpc_type_cnt);
@@ -1515,6 +1535,9 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 		xfree(msg->rpc_user_id);
 		xfree(msg->rpc_user_cnt);
 		xfree(msg->rpc_user_time);
+		for (i = 0; i < msg->lock_ctx_size; i++)
+			xfree(msg->lock_ctx[i].name);
+		xfree(msg->lock_ctx);
 		xfree(msg);
 	}
 }
@@ -3443,6 +3466,21 @@ extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr)
 	}
 }
 
+/*
+ * slurm_free_job_info_delta_msg - free the job changes response message
+ * IN msg - pointer to job changes response message
+ * NOTE: buffer is loaded by slurm_load_jobs_delta.
+ */
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg)
+{
+	if (msg) {
+		xfree(msg->purged_job_ids);
+		xfree(msg->removed_job_ids);
+		slurm_free_job_info_msg(msg->job_info);
+		xfree(msg);
+	}
+}
+
 static void _free_all_job_info(job_info_msg_t *msg)
 {
 	int i;
@@ -3560,6 +3598,24 @@ extern void slurm_free_node_info_msg(node_info_msg_t * msg)
 	}
 }
 
+/*
+ * slurm_free_node_info_delta_msg - free the node changes response message
+ * IN msg - pointer to node changes response message
+ * NOTE: buffer is loaded by slurm_load_node_delta.
+ */
+extern void slurm_free_node_info_delta_msg(node_info_delta_msg_t *msg)
+{
+	int i;
+
+	if (msg) {
+		slurm_free_node_info_msg(msg->node_info);
+		for (i = 0; i < msg->removed_cnt; i++)
+			xfree(msg->removed_names[i]);
+		xfree(msg->removed_names);
+		xfree(msg);
+	}
+}
+
 static void _free_all_node_info(node_info_msg_t *msg)
 {
 	int i;
@@ -4090,6 +4146,13 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_NODE_INFO_SINGLE:
 		slurm_free_node_info_single_msg(data);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+	case REQUEST_NODE_INFO_DELTA:
+		slurm_free_info_delta_request_msg(data);
+		break;
+	case REQUEST_JOB_INFO_QUERY:
+		slurm_free_job_info_query_msg(data);
+		break;
 	case REQUEST_PARTITION_INFO:
 		slurm_free_part_info_request_msg(data);
 		break;
@@ -4319,6 +4382,7 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_DAEMON_STATUS:
 	case REQUEST_HEALTH_CHECK:
 	case REQUEST_ACCT_GATHER_UPDATE:
+	case REQUEST_FILE_BCAST_PWRITE:
 	case ACCOUNTING_FIRST_REG:
 	case ACCOUNTING_TRES_CHANGE_DB:
 	case ACCOUNTING_NODES_CHANGE_DB:
@@ -4444,6 +4508,12 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case RESPONSE_JOB_INFO:
 		slurm_free_job_info(data);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		slurm_free_job_info_delta_msg(data);
+		break;
+	case RESPONSE_NODE_INFO_DELTA:
+		slurm_free_node_info_delta_msg(data);
+		break;
 	case REQUEST_JOB_PACK_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_JOB_PACK:
 	case RESPONSE_JOB_PACK_ALLOCATION:
@@ -4724,6 +4794,16 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_BATCH_SCRIPT";
 	case RESPONSE_BATCH_SCRIPT:
 		return "RESPONSE_BATCH_SCRIPT";
+	case REQUEST_JOB_INFO_DELTA:
+		return "REQUEST_JOB_INFO_DELTA";
+	case RESPONSE_JOB_INFO_DELTA:
+		return "RESPONSE_JOB_INFO_DELTA";
+	case REQUEST_NODE_INFO_DELTA:
+		return "REQUEST_NODE_INFO_DELTA";
+	case RESPONSE_NODE_INFO_DELTA:
+		return "RESPONSE_NODE_INFO_DELTA";
+	case REQUEST_JOB_INFO_QUERY:
+		return "REQUEST_JOB_INFO_QUERY";
 
 	case REQUEST_UPDATE_JOB:				/* 3001 */
 		return "REQUEST_UPDATE_JOB";
@@ -4934,6 +5014,8 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_COMPLETE_PROLOG";
 	case RESPONSE_PROLOG_EXECUTING:				/* 6019 */
 		return "RESPONSE_PROLOG_EXECUTING";
+	case REQUEST_FILE_BCAST_PWRITE:				/* 6020 */
+		return "REQUEST_FILE_BCAST_PWRITE";
 
 	case SRUN_PING:						/* 7001 */
 		return "SRUN_PING";
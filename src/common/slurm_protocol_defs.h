@@ -261,6 +261,11 @@ typedef enum {
 	RESPONSE_FED_INFO,		/* 2050 */
 	REQUEST_BATCH_SCRIPT,
 	RESPONSE_BATCH_SCRIPT,
+	REQUEST_JOB_INFO_DELTA,
+	RESPONSE_JOB_INFO_DELTA,
+	REQUEST_NODE_INFO_DELTA,
+	RESPONSE_NODE_INFO_DELTA,
+	REQUEST_JOB_INFO_QUERY,
 
 	REQUEST_UPDATE_JOB = 3001,
 	REQUEST_UPDATE_NODE,
@@ -377,6 +382,7 @@ typedef enum {
 	REQUEST_LAUNCH_PROLOG,
 	REQUEST_COMPLETE_PROLOG,
 	RESPONSE_PROLOG_EXECUTING,	/* 6019 */
+	REQUEST_FILE_BCAST_PWRITE,	/* 6020 */
 
 	REQUEST_PERSIST_INIT = 6500,
 
@@ -607,6 +613,12 @@ typedef struct node_info_request_msg {
 	uint16_t show_flags;
 } node_info_request_msg_t;
 
+/* REQUEST_JOB_INFO_DELTA and REQUEST_NODE_INFO_DELTA */
+typedef struct info_delta_request_msg {
+	uint64_t generation;
+	uint16_t show_flags;
+} info_delta_request_msg_t;
+
 typedef struct node_info_single_msg {
 	char *node_name;
 	uint16_t show_flags;
@@ -1275,6 +1287,9 @@ typedef struct sim_job_msg {
 
 typedef struct sim_helper_msg {
         uint32_t total_jobs_ended;
+        uint32_t job_cnt;	/* entries in job_ids */
+        uint32_t *job_ids;	/* jobs ended in this cycle, completed by
+				 * slurmctld as part of the cycle RPC */
 } sim_helper_msg_t;
 /*****************************************************************************\
  *	SLURM MESSAGE INITIALIZATION
@@ -1323,6 +1338,7 @@ extern void slurm_free_front_end_info_request_msg(
 		front_end_info_request_msg_t *msg);
 extern void slurm_free_node_info_request_msg(node_info_request_msg_t *msg);
 extern void slurm_free_node_info_single_msg(node_info_single_msg_t *msg);
+extern void slurm_free_info_delta_request_msg(info_delta_request_msg_t *msg);
 extern void slurm_free_part_info_request_msg(part_info_request_msg_t *msg);
 extern void slurm_free_sib_msg(sib_msg_t *msg);
 extern void slurm_free_stats_info_request_msg(stats_info_request_msg_t *msg);
@@ -1433,12 +1449,15 @@ extern void slurm_free_submit_response_response_msg(
 		submit_response_msg_t * msg);
 extern void slurm_free_ctl_conf(slurm_ctl_conf_info_msg_t * config_ptr);
 extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr);
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg);
+extern void slurm_free_job_info_query_msg(job_info_query_t *msg);
 extern void slurm_free_job_step_info_response_msg(
 		job_step_info_response_msg_t * msg);
 extern void slurm_free_job_step_info_members (job_step_info_t * msg);
 extern void slurm_free_front_end_info_msg (front_end_info_msg_t * msg);
 extern void slurm_free_front_end_info_members(front_end_info_t * front_end);
 extern void slurm_free_node_info_msg(node_info_msg_t * msg);
+extern void slurm_free_node_info_delta_msg(node_info_delta_msg_t *msg);
 extern void slurm_free_node_info_members(node_info_t * node);
 extern void slurm_free_partition_info_msg(partition_info_msg_t * msg);
 extern void slurm_free_partition_info_members(partition_info_t * part);
@@ -48,6 +48,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "src/common/macros.h"
@@ -87,6 +88,13 @@ typedef enum slurm_socket_type {
 extern ssize_t slurm_msg_recvfrom_timeout(int fd, char **buf,
 		size_t *len, uint32_t flags, int timeout);
 
+/* slurm_msg_recv_buf_timeout is identical to slurm_msg_recvfrom_timeout
+ * except the message is read into the supplied buffer, which is grown as
+ * needed. On success the buffer's size is the message length and its
+ * offset is zero.
+ */
+extern ssize_t slurm_msg_recv_buf_timeout(int fd, Buf buffer, int timeout);
+
 /* slurm_msg_sendto
  * Send message over the given connection, default timeout value
  * IN open_fd - an open file descriptor
@@ -107,6 +115,23 @@ extern ssize_t slurm_msg_sendto_timeout(int open_fd,
 					uint32_t flags,
 					int timeout);
 
+/* slurm_msg_sendv
+ * Send a message made of several segments over the given connection
+ * without first copying them into one buffer, default timeout value
+ * IN open_fd - an open file descriptor
+ * IN iov - segments to transmit, in order (at most 8)
+ * IN iovcnt - number of segments
+ * IN flags - communication specific flags
+ * RET number of message bytes written or SLURM_ERROR
+ */
+extern ssize_t slurm_msg_sendv(int open_fd, struct iovec *iov, int iovcnt,
+			       uint32_t flags);
+/* slurm_msg_sendv_timeout is identical to slurm_msg_sendv except
+ * IN timeout - maximum time to wait for a message in milliseconds */
+extern ssize_t slurm_msg_sendv_timeout(int open_fd, struct iovec *iov,
+				       int iovcnt, uint32_t flags,
+				       int timeout);
+
 /********************/
 /* stream functions */
 /********************/
@@ -170,6 +170,8 @@ static int _unpack_node_info_single_msg(node_info_single_msg_t ** msg,
 
 static int _unpack_node_info_msg(node_info_msg_t ** msg, Buf buffer,
 				 uint16_t protocol_version);
+static int _unpack_node_info_delta_msg(node_info_delta_msg_t ** msg,
+				       Buf buffer, uint16_t protocol_version);
 static int _unpack_node_info_members(node_info_t * node, Buf buffer,
 				     uint16_t protocol_version);
 
@@ -463,6 +465,8 @@ static void _pack_job_script_msg(char *msg, Buf buffer,
 static int _unpack_job_script_msg(char **msg, Buf buffer,
 				  uint16_t protocol_version);
 
+static int _unpack_job_info_delta_msg(job_info_delta_msg_t ** msg,
+				      Buf buffer, uint16_t protocol_version);
 static int _unpack_job_info_msg(job_info_msg_t ** msg, Buf buffer,
 				uint16_t protocol_version);
 
@@ -576,6 +580,18 @@ static int  _unpack_top_job_msg(top_job_msg_t **msg_ptr, Buf buffer,
 
 static void _pack_buffer_msg(slurm_msg_t * msg, Buf buffer);
 
+static void _pack_info_delta_request_msg(info_delta_request_msg_t *msg,
+					 Buf buffer,
+					 uint16_t protocol_version);
+static int _unpack_info_delta_request_msg(info_delta_request_msg_t **msg,
+					  Buf buffer,
+					  uint16_t protocol_version);
+
+static void _pack_job_info_query_msg(job_info_query_t *msg, Buf buffer,
+				     uint16_t protocol_version);
+static int _unpack_job_info_query_msg(job_info_query_t **msg, Buf buffer,
+				      uint16_t protocol_version);
+
 static void _pack_kvs_host_rec(struct kvs_hosts *msg_ptr, Buf buffer,
 			       uint16_t protocol_version);
 static int  _unpack_kvs_host_rec(struct kvs_hosts *msg_ptr, Buf buffer,
@@ -901,6 +917,16 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					    msg->data, buffer,
 					    msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+	case REQUEST_NODE_INFO_DELTA:
+		_pack_info_delta_request_msg((info_delta_request_msg_t *)
+					     msg->data, buffer,
+					     msg->protocol_version);
+		break;
+	case REQUEST_JOB_INFO_QUERY:
+		_pack_job_info_query_msg((job_info_query_t *) msg->data,
+					 buffer, msg->protocol_version);
+		break;
 	case REQUEST_NODE_INFO_SINGLE:
 		_pack_node_info_single_msg((node_info_single_msg_t *)
 					   msg->data, buffer,
@@ -935,6 +961,10 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	case RESPONSE_JOB_INFO:
 		_pack_job_info_msg((slurm_msg_t *) msg, buffer);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+	case RESPONSE_NODE_INFO_DELTA:
+		_pack_buffer_msg((slurm_msg_t *) msg, buffer);
+		break;
 	case RESPONSE_BATCH_SCRIPT:
 		_pack_job_script_msg((char *) msg->data, buffer,
 				     msg->protocol_version);
@@ -1004,6 +1034,7 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	case REQUEST_DAEMON_STATUS:
 	case REQUEST_HEALTH_CHECK:
 	case REQUEST_ACCT_GATHER_UPDATE:
+	case REQUEST_FILE_BCAST_PWRITE:
 	case ACCOUNTING_FIRST_REG:
 	case ACCOUNTING_REGISTER_CTLD:
 	case REQUEST_TOPO_INFO:
@@ -1574,6 +1605,43 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	return SLURM_SUCCESS;
 }
 
+/* pack_msg_data_ref
+ * for message types whose body is an already packed buffer (see
+ * _pack_buffer_msg), return a reference to that data so it can be sent
+ * without being copied into the message buffer
+ * IN msg - the body structure to reference
+ * OUT data, size - packed body and its length
+ * RET true if the body is pre-packed, false if pack_msg must be used
+ */
+extern bool pack_msg_data_ref(slurm_msg_t const *msg, char **data,
+			      uint32_t *size)
+{
+	if (msg->protocol_version < SLURM_MIN_PROTOCOL_VERSION)
+		return false;
+
+	switch (msg->msg_type) {
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_INFO_DELTA:
+	case RESPONSE_NODE_INFO_DELTA:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_LAYOUT_INFO:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_BLOCK_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_FRONT_END_INFO:
+	case RESPONSE_STATS_INFO:
+	case RESPONSE_LICENSE_INFO:
+	case RESPONSE_ASSOC_MGR_INFO:
+		*data = (char *) msg->data;
+		*size = msg->data_size;
+		return true;
+	default:
+		return false;
+	}
+}
+
 /* unpack_msg
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
@@ -1593,6 +1661,17 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						   & (msg->data), buffer,
 						   msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+	case REQUEST_NODE_INFO_DELTA:
+		rc = _unpack_info_delta_request_msg(
+			(info_delta_request_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
+	case REQUEST_JOB_INFO_QUERY:
+		rc = _unpack_job_info_query_msg(
+			(job_info_query_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_NODE_INFO_SINGLE:
 		rc = _unpack_node_info_single_msg((node_info_single_msg_t **)
 						  & (msg->data), buffer,
@@ -1630,6 +1709,16 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					  buffer,
 					  msg->protocol_version);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_msg(
+			(job_info_delta_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
+	case RESPONSE_NODE_INFO_DELTA:
+		rc = _unpack_node_info_delta_msg(
+			(node_info_delta_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case RESPONSE_BATCH_SCRIPT:
 		rc = _unpack_job_script_msg((char **) &(msg->data),
 					    buffer,
@@ -1706,6 +1795,7 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 	case REQUEST_DAEMON_STATUS:
 	case REQUEST_HEALTH_CHECK:
 	case REQUEST_ACCT_GATHER_UPDATE:
+	case REQUEST_FILE_BCAST_PWRITE:
 	case ACCOUNTING_FIRST_REG:
 	case ACCOUNTING_REGISTER_CTLD:
 	case REQUEST_TOPO_INFO:
@@ -4068,6 +4158,32 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* The header is packed by pack_nodes_delta() in slurmctld, followed by
+ * the same body as RESPONSE_NODE_INFO and the names of removed nodes */
+static int
+_unpack_node_info_delta_msg(node_info_delta_msg_t ** msg, Buf buffer,
+			    uint16_t protocol_version)
+{
+	node_info_delta_msg_t *delta;
+
+	xassert(msg != NULL);
+	delta = xmalloc(sizeof(node_info_delta_msg_t));
+	*msg = delta;
+
+	safe_unpack64(&delta->generation, buffer);
+	safe_unpack16(&delta->full, buffer);
+	if (_unpack_node_info_msg(&delta->node_info, buffer, protocol_version))
+		goto unpack_error;
+	safe_unpackstr_array(&delta->removed_names, &delta->removed_cnt,
+			     buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_node_info_delta_msg(delta);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static int
 _unpack_node_info_members(node_info_t * node, Buf buffer,
 			  uint16_t protocol_version)
@@ -5914,6 +6030,34 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* The header is packed by pack_jobs_delta() in slurmctld, followed by
+ * the same body as RESPONSE_JOB_INFO */
+static int
+_unpack_job_info_delta_msg(job_info_delta_msg_t ** msg, Buf buffer,
+			   uint16_t protocol_version)
+{
+	job_info_delta_msg_t *delta;
+
+	xassert(msg != NULL);
+	delta = xmalloc(sizeof(job_info_delta_msg_t));
+	*msg = delta;
+
+	safe_unpack64(&delta->generation, buffer);
+	safe_unpack16(&delta->full, buffer);
+	safe_unpack32_array(&delta->purged_job_ids, &delta->purged_cnt,
+			    buffer);
+	if (_unpack_job_info_msg(&delta->job_info, buffer, protocol_version))
+		goto unpack_error;
+	safe_unpack32_array(&delta->removed_job_ids, &delta->removed_cnt,
+			    buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_delta_msg(delta);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 /* Translate bitmap representation from hex to decimal format, replacing
  * array_task_str and store the bitmap in job->array_bitmap. */
 static void _xlate_task_str(job_info_t *job_ptr)
@@ -12587,6 +12731,71 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void
+_pack_info_delta_request_msg(info_delta_request_msg_t *msg, Buf buffer,
+			     uint16_t protocol_version)
+{
+	pack64(msg->generation, buffer);
+	pack16(msg->show_flags, buffer);
+}
+
+static int
+_unpack_info_delta_request_msg(info_delta_request_msg_t **msg, Buf buffer,
+			       uint16_t protocol_version)
+{
+	info_delta_request_msg_t *delta_req;
+
+	delta_req = xmalloc(sizeof(info_delta_request_msg_t));
+	*msg = delta_req;
+
+	safe_unpack64(&delta_req->generation, buffer);
+	safe_unpack16(&delta_req->show_flags, buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_info_delta_request_msg(delta_req);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
+static void
+_pack_job_info_query_msg(job_info_query_t *msg, Buf buffer,
+			 uint16_t protocol_version)
+{
+	pack16(msg->show_flags, buffer);
+	pack32(msg->fields, buffer);
+	packstr(msg->accounts, buffer);
+	packstr(msg->partitions, buffer);
+	pack32_array(msg->job_ids, msg->job_id_cnt, buffer);
+	pack32_array(msg->states, msg->state_cnt, buffer);
+	pack32_array(msg->user_ids, msg->user_id_cnt, buffer);
+}
+
+static int
+_unpack_job_info_query_msg(job_info_query_t **msg, Buf buffer,
+			   uint16_t protocol_version)
+{
+	uint32_t uint32_tmp;
+	job_info_query_t *query;
+
+	query = xmalloc(sizeof(job_info_query_t));
+	*msg = query;
+
+	safe_unpack16(&query->show_flags, buffer);
+	safe_unpack32(&query->fields, buffer);
+	safe_unpackstr_xmalloc(&query->accounts, &uint32_tmp, buffer);
+	safe_unpackstr_xmalloc(&query->partitions, &uint32_tmp, buffer);
+	safe_unpack32_array(&query->job_ids, &query->job_id_cnt, buffer);
+	safe_unpack32_array(&query->states, &query->state_cnt, buffer);
+	safe_unpack32_array(&query->user_ids, &query->user_id_cnt, buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_query_msg(query);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static void
 _pack_node_info_single_msg(node_info_single_msg_t * msg, Buf buffer,
 			   uint16_t protocol_version)
@@ -13774,6 +13983,7 @@ static void _pack_sim_helper_msg(sim_helper_msg_t *msg, Buf buffer)
        xassert ( msg != NULL );
 
        pack32((uint32_t)msg->total_jobs_ended, buffer ) ;
+       pack32_array(msg->job_ids, msg->job_cnt, buffer);
 }
 
 static int  _unpack_suspend_msg(suspend_msg_t **msg_ptr, Buf buffer,
@@ -13976,6 +14186,7 @@ static int  _unpack_sim_helper_msg(sim_helper_msg_t **msg_ptr, Buf buffer)
        *msg_ptr = msg ;
 
        safe_unpack32(&msg->total_jobs_ended ,      buffer ) ;
+       safe_unpack32_array(&msg->job_ids, &msg->job_cnt, buffer);
        return SLURM_SUCCESS;
 
 unpack_error:
@@ -15168,6 +15379,59 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static int _unpack_lock_stats_hist(lock_stats_hist_t *hist, Buf buffer)
+{
+	int i;
+
+	safe_unpack32(&hist->cnt, buffer);
+	if (!hist->cnt)
+		return SLURM_SUCCESS;
+	safe_unpack64(&hist->sum_usec, buffer);
+	safe_unpack64(&hist->max_usec, buffer);
+	for (i = 0; i < LOCK_STATS_HIST_BUCKETS; i++)
+		safe_unpack32(&hist->bucket[i], buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
+/* Lock timing by RPC type, appended after the RPC statistics and absent
+ * from older slurmctld */
+static int _unpack_lock_ctx_stats(stats_info_response_msg_t *msg, Buf buffer)
+{
+	uint32_t uint32_tmp, datatypes, buckets, i, j;
+	lock_ctx_stats_t *ctx;
+
+	safe_unpack32(&msg->lock_ctx_size, buffer);
+	safe_unpack32(&datatypes, buffer);
+	safe_unpack32(&buckets, buffer);
+	if ((datatypes != LOCK_STATS_DATATYPES) ||
+	    (buckets != LOCK_STATS_HIST_BUCKETS) ||
+	    (msg->lock_ctx_size > NO_VAL16)) {
+		msg->lock_ctx_size = 0;
+		goto unpack_error;
+	}
+	msg->lock_ctx = xmalloc(sizeof(lock_ctx_stats_t) *
+				msg->lock_ctx_size);
+	for (i = 0; i < msg->lock_ctx_size; i++) {
+		ctx = &msg->lock_ctx[i];
+		safe_unpack32(&ctx->id, buffer);
+		safe_unpackstr_xmalloc(&ctx->name, &uint32_tmp, buffer);
+		for (j = 0; j < LOCK_STATS_DATATYPES; j++) {
+			if (_unpack_lock_stats_hist(&ctx->rd_wait[j], buffer) ||
+			    _unpack_lock_stats_hist(&ctx->rd_hold[j], buffer) ||
+			    _unpack_lock_stats_hist(&ctx->wr_wait[j], buffer) ||
+			    _unpack_lock_stats_hist(&ctx->wr_hold[j], buffer))
+				goto unpack_error;
+		}
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
 static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 				       Buf buffer, uint16_t protocol_version)
 {
@@ -15232,6 +15496,10 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 		safe_unpack32_array(&msg->rpc_user_id,   &uint32_tmp, buffer);
 		safe_unpack32_array(&msg->rpc_user_cnt,  &uint32_tmp, buffer);
 		safe_unpack64_array(&msg->rpc_user_time, &uint32_tmp, buffer);
+
+		if (remaining_buf(buffer) &&
+		    _unpack_lock_ctx_stats(msg, buffer))
+			goto unpack_error;
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		safe_unpack32(&msg->parts_packed,	buffer);
 		if (msg->parts_packed) {
@@ -80,6 +80,16 @@ extern int unpack_header ( header_t * header , Buf buffer );
  */
 extern int pack_msg ( slurm_msg_t const * msg , Buf buffer );
 
+/* pack_msg_data_ref
+ * returns a reference to the body of a message whose data is already packed
+ * (e.g. RESPONSE_JOB_INFO) so it can be sent without copying
+ * IN msg - the body structure to reference
+ * OUT data, size - packed body and its length
+ * RET true if the body is pre-packed, false if pack_msg must be used
+ */
+extern bool pack_msg_data_ref(slurm_msg_t const *msg, char **data,
+			      uint32_t *size);
+
 /* unpack_msg
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
@@ -52,6 +52,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "slurm/slurm_errno.h"
@@ -77,6 +78,9 @@
  */
 #define MAX_MSG_SIZE     (1024*1024*1024)
 
+/* Segments accepted by slurm_msg_sendv(), plus the length prefix */
+#define MAX_MSG_IOV      8
+
 
 /* Static functions */
 static int _slurm_connect(int __fd, struct sockaddr const * __addr,
@@ -161,6 +165,36 @@ extern ssize_t slurm_msg_recvfrom_timeout(int fd, char **pbuf, size_t *lenp,
 	return (ssize_t) msglen;
 }
 
+extern ssize_t slurm_msg_recv_buf_timeout(int fd, Buf buffer, int tmout)
+{
+	ssize_t  len;
+	uint32_t msglen;
+
+	len = slurm_recv_timeout( fd, (char *)&msglen,
+				  sizeof(msglen), 0, tmout );
+
+	if (len < ((ssize_t) sizeof(msglen)))
+		return SLURM_ERROR;
+
+	msglen = ntohl(msglen);
+
+	if (msglen > MAX_MSG_SIZE)
+		slurm_seterrno_ret(SLURM_PROTOCOL_INSANE_MSG_LENGTH);
+
+	if (size_buf(buffer) < msglen)
+		grow_buf(buffer, msglen - size_buf(buffer));
+
+	if (slurm_recv_timeout(fd, get_buf_data(buffer), msglen, 0, tmout) !=
+	    msglen)
+		return SLURM_ERROR;
+
+	/* Unpackers check remaining_buf(), so expose only the message */
+	buffer->size = msglen;
+	set_buf_offset(buffer, 0);
+
+	return (ssize_t) msglen;
+}
+
 extern ssize_t slurm_msg_sendto(int fd, char *buffer, size_t size,
 				uint32_t flags)
 {
@@ -197,6 +231,143 @@ ssize_t slurm_msg_sendto_timeout(int fd, char *buffer, size_t size,
 	return len;
 }
 
+extern ssize_t slurm_msg_sendv(int fd, struct iovec *iov, int iovcnt,
+			       uint32_t flags)
+{
+	return slurm_msg_sendv_timeout(fd, iov, iovcnt, flags,
+				       (slurm_get_msg_timeout() * 1000));
+}
+
+/*
+ * Write the length prefix and all segments with writev() so that the header
+ * and body of a message need not be copied into one buffer first.
+ * RET number of body bytes written or SLURM_ERROR on error
+ */
+extern ssize_t slurm_msg_sendv_timeout(int fd, struct iovec *iov, int iovcnt,
+				       uint32_t flags, int timeout)
+{
+	struct iovec vec[MAX_MSG_IOV + 1], *cur = vec;
+	uint32_t usize;
+	size_t size = 0, total, sent = 0;
+	ssize_t rc, len;
+	int i, fd_flags, cnt, timeleft;
+	struct pollfd ufds;
+	struct timeval tstart;
+	SigFunc *ohandler;
+	char temp[2];
+
+	if ((iovcnt < 1) || (iovcnt > MAX_MSG_IOV)) {
+		slurm_seterrno(EINVAL);
+		return SLURM_ERROR;
+	}
+	for (i = 0; i < iovcnt; i++) {
+		vec[i + 1] = iov[i];
+		size += iov[i].iov_len;
+	}
+	usize = htonl(size);
+	vec[0].iov_base = &usize;
+	vec[0].iov_len = sizeof(usize);
+	cnt = iovcnt + 1;
+	total = size + sizeof(usize);
+
+	/*
+	 *  Ignore SIGPIPE so that writev can return a error code if the
+	 *    other side closes the socket
+	 */
+	ohandler = xsignal(SIGPIPE, SIG_IGN);
+
+	ufds.fd     = fd;
+	ufds.events = POLLOUT;
+
+	fd_flags = fcntl(fd, F_GETFL);
+	fd_set_nonblocking(fd);
+
+	gettimeofday(&tstart, NULL);
+
+	while (sent < total) {
+		timeleft = timeout - _tot_wait(&tstart);
+		if (timeleft <= 0) {
+			debug("%s at %zu of %zu, timeout",
+			      __func__, sent, total);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT);
+			len = SLURM_ERROR;
+			goto done;
+		}
+
+		if ((rc = poll(&ufds, 1, timeleft)) <= 0) {
+			if ((rc == 0) || (errno == EINTR) || (errno == EAGAIN))
+				continue;
+			debug("%s at %zu of %zu, poll error: %s",
+			      __func__, sent, total, strerror(errno));
+			slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+			len = SLURM_ERROR;
+			goto done;
+		}
+
+		/* See slurm_send_timeout() for why the socket is probed */
+		if (ufds.revents & POLLERR) {
+			debug("%s: Socket POLLERR", __func__);
+			slurm_seterrno(ENOTCONN);
+			len = SLURM_ERROR;
+			goto done;
+		}
+		if ((ufds.revents & POLLHUP) || (ufds.revents & POLLNVAL) ||
+		    (recv(fd, &temp, 1, flags) == 0)) {
+			debug2("%s: Socket no longer there", __func__);
+			slurm_seterrno(ENOTCONN);
+			len = SLURM_ERROR;
+			goto done;
+		}
+
+		rc = writev(fd, cur, cnt);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN) {	/* poll() lied to us */
+				usleep(10000);
+				continue;
+			}
+			debug("%s at %zu of %zu, writev error: %s",
+			      __func__, sent, total, strerror(errno));
+			slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+			len = SLURM_ERROR;
+			goto done;
+		}
+		if (rc == 0) {
+			debug("%s at %zu of %zu, sent zero bytes",
+			      __func__, sent, total);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_ZERO_BYTES_SENT);
+			len = SLURM_ERROR;
+			goto done;
+		}
+
+		sent += rc;
+		/* Skip fully written segments, trim a partial one */
+		while (cnt && (rc >= (ssize_t) cur->iov_len)) {
+			rc -= cur->iov_len;
+			cur++;
+			cnt--;
+		}
+		if (cnt && rc) {
+			cur->iov_base = (char *) cur->iov_base + rc;
+			cur->iov_len -= rc;
+		}
+	}
+	len = size;
+
+done:
+	/* Reset fd flags to prior state, preserve errno */
+	if (fd_flags != -1) {
+		int slurm_err = slurm_get_errno();
+		if (fcntl(fd, F_SETFL, fd_flags) < 0)
+			error("%s: fcntl(F_SETFL) error: %m", __func__);
+		slurm_seterrno(slurm_err);
+	}
+	xsignal(SIGPIPE, ohandler);
+
+	return len;
+}
+
 /* Send slurm message with timeout
  * RET message size (as specified in argument) or SLURM_ERROR on error */
 extern int slurm_send_timeout(int fd, char *buf, size_t size,
@@ -213,6 +213,7 @@
 #define	log_fp			slurm_log_fp
 #define	log_has_data		slurm_log_has_data
 #define	log_flush		slurm_log_flush
+#define	log_set_async		slurm_log_set_async
 #define	fatal			slurm_fatal
 #define	error			slurm_error
 #define	info			slurm_info
@@ -237,6 +238,8 @@
 #define grow_buf		slurm_grow_buf
 #define	init_buf		slurm_init_buf
 #define	xfer_buf_data		slurm_xfer_buf_data
+#define	get_pool_buf		slurm_get_pool_buf
+#define	put_pool_buf		slurm_put_pool_buf
 #define	pack_time		slurm_pack_time
 #define	unpack_time		slurm_unpack_time
 #define	packdouble		slurm_packdouble
@@ -85,6 +85,9 @@ extern int write_labelled_message(int fd, void *buf, int len, int task_id,
 	if (label) {
 		prefix = _build_label(task_id, task_id_width, pack_offset,
 				      task_offset);
+	} else if (len > 0) {
+		/* Nothing to add per line, write it all at once */
+		return _write_line(fd, NULL, NULL, buf, len);
 	}
 
 	while (remaining > 0) {
@@ -3847,6 +3847,7 @@ fini:
 static void _kill_job(struct job_record *job_ptr, bool hold_job)
 {
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 	job_ptr->end_time = last_job_update;
 	if (hold_job)
 		job_ptr->priority = 0;
@@ -99,32 +99,40 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 /* Other useful declarations */
 static slurm_cgroup_conf_t slurm_cgroup_conf;
 
-static void _prec_extra(jag_prec_t *prec)
+/*
+ * Totals of the task cgroup, read once per poll by _poll_start() rather
+ * than once per process since every process of the task shares them.
+ */
+static struct {
+	bool cpu_valid;
+	unsigned long utime;
+	unsigned long stime;
+	bool rss_valid;
+	unsigned long total_rss;
+	bool pages_valid;
+	unsigned long total_pgpgin;
+} cg_stats;
+
+static void _poll_start(void)
 {
-	unsigned long utime, stime, total_rss, total_pgpgin;
 	char *cpu_time = NULL, *memory_stat = NULL, *ptr;
 	size_t cpu_time_size = 0, memory_stat_size = 0;
 
-	//DEF_TIMERS;
-	//START_TIMER;
-	/* info("before"); */
-	/* print_jag_prec(prec); */
+	memset(&cg_stats, 0, sizeof(cg_stats));
+
 	xcgroup_get_param(&task_cpuacct_cg, "cpuacct.stat",
 			  &cpu_time, &cpu_time_size);
 	if (cpu_time == NULL) {
-		debug2("%s: failed to collect cpuacct.stat pid %d ppid %d",
-		       __func__, prec->pid, prec->ppid);
-	} else {
-		sscanf(cpu_time, "%*s %lu %*s %lu", &utime, &stime);
-		prec->usec = utime;
-		prec->ssec = stime;
+		debug2("%s: failed to collect cpuacct.stat", __func__);
+	} else if (sscanf(cpu_time, "%*s %lu %*s %lu",
+			  &cg_stats.utime, &cg_stats.stime) == 2) {
+		cg_stats.cpu_valid = true;
 	}
 
 	xcgroup_get_param(&task_memory_cg, "memory.stat",
 			  &memory_stat, &memory_stat_size);
 	if (memory_stat == NULL) {
-		debug2("%s: failed to collect memory.stat  pid %d ppid %d",
-		       __func__, prec->pid, prec->ppid);
+		debug2("%s: failed to collect memory.stat", __func__);
 	} else {
 		/*
 		 * This number represents the amount of "dirty" private memory
@@ -132,23 +140,38 @@ static void _prec_extra(jag_prec_t *prec)
 		 * different than what proc presents, but is probably more
 		 * accurate on what the user is actually using.
 		 */
-		if ((ptr = strstr(memory_stat, "total_rss"))) {
-			sscanf(ptr, "total_rss %lu", &total_rss);
-			prec->rss = total_rss / 1024; /* bytes to KB */
-		}
+		if ((ptr = strstr(memory_stat, "total_rss")) &&
+		    (sscanf(ptr, "total_rss %lu", &cg_stats.total_rss) == 1))
+			cg_stats.rss_valid = true;
 
 		/*
 		 * total_pgmajfault is what is reported in proc, so we use
 		 * the same thing here.
 		 */
-		if ((ptr = strstr(memory_stat, "total_pgmajfault"))) {
-			sscanf(ptr, "total_pgmajfault %lu", &total_pgpgin);
-			prec->pages = total_pgpgin;
-		}
+		if ((ptr = strstr(memory_stat, "total_pgmajfault")) &&
+		    (sscanf(ptr, "total_pgmajfault %lu",
+			    &cg_stats.total_pgpgin) == 1))
+			cg_stats.pages_valid = true;
 	}
 
 	xfree(cpu_time);
 	xfree(memory_stat);
+}
+
+static void _prec_extra(jag_prec_t *prec)
+{
+	//DEF_TIMERS;
+	//START_TIMER;
+	/* info("before"); */
+	/* print_jag_prec(prec); */
+	if (cg_stats.cpu_valid) {
+		prec->usec = cg_stats.utime;
+		prec->ssec = cg_stats.stime;
+	}
+	if (cg_stats.rss_valid)
+		prec->rss = cg_stats.total_rss / 1024; /* bytes to KB */
+	if (cg_stats.pages_valid)
+		prec->pages = cg_stats.total_pgpgin;
 
 	/* FIXME: Enable when kernel support ready.
 	 *
@@ -294,6 +317,7 @@ extern void jobacct_gather_p_poll_data(
 	if (first) {
 		memset(&callbacks, 0, sizeof(jag_callbacks_t));
 		first = 0;
+		callbacks.poll_start = _poll_start;
 		callbacks.prec_extra = _prec_extra;
 	}
 
@@ -50,6 +50,7 @@
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_acct_gather_energy.h"
 #include "src/common/slurm_acct_gather_interconnect.h"
+#include "src/common/timers.h"
 #include "src/slurmd/common/proctrack.h"
 
 #include "common_jag.h"
@@ -59,6 +60,24 @@ static long hertz = 0;
 
 static int my_pagesize = 0;
 static DIR  *slash_proc = NULL;
+static int no_share_data = -1;
+static int use_pss = -1;
+
+/*
+ * /proc files of a process in our container, kept open between polls so
+ * that sampling is one pread() per file instead of open/read/close.
+ */
+typedef struct {
+	pid_t pid;
+	int lwp;		/* _is_a_lwp() of pid when opened */
+	int stat_fd;
+	int statm_fd;		/* only with JobAcctGatherParams=NoShare */
+	int io_fd;
+	uint32_t poll_gen;	/* last poll which found the pid */
+} jag_pfd_t;
+
+static List pfd_list = NULL;
+static uint32_t poll_gen = 0;
 static int energy_profile = ENERGY_DATA_NODE_ENERGY_UP;
 static uint64_t debug_flags = 0;
 
@@ -128,14 +147,17 @@ inline static bool _get_freq(char *str)
 /*
  * collects the Pss value from /proc/<pid>/smaps
  */
-static int _get_pss(char *proc_smaps_file, jag_prec_t *prec)
+static int _get_pss(pid_t pid, jag_prec_t *prec)
 {
         uint64_t pss;
 	uint64_t p;
         char line[128];
+	char proc_smaps_file[256];	/* Allow ~20x extra length */
         FILE *fp;
 	int i;
 
+	snprintf(proc_smaps_file, sizeof(proc_smaps_file), "/proc/%d/smaps",
+		 pid);
 	fp = fopen(proc_smaps_file, "r");
         if (!fp) {
                 return -1;
@@ -274,69 +296,92 @@ static int _is_a_lwp(uint32_t pid) {
 
 }
 
+/* _scan_field() - parse one whitespace separated decimal field
+ *
+ * IN/OUT: ptr - position in the buffer, advanced past the field
+ * OUT:	val - the value of the field
+ *
+ * RETVAL:	false - end of buffer or not a number
+ *
+ * This replaces sscanf() for the fixed format /proc files we sample on
+ * every poll, where the format string parsing dominated the cost.
+ */
+static inline bool _scan_field(char **ptr, int64_t *val)
+{
+	char *p = *ptr;
+	uint64_t v = 0;
+	bool neg = false;
+
+	while ((*p == ' ') || (*p == '\t') || (*p == '\n'))
+		p++;
+	if (*p == '-') {
+		neg = true;
+		p++;
+	}
+	if ((*p < '0') || (*p > '9'))
+		return false;
+	do {
+		v = (v * 10) + (*p++ - '0');
+	} while ((*p >= '0') && (*p <= '9'));
+
+	*val = neg ? -(int64_t) v : (int64_t) v;
+	*ptr = p;
+	return true;
+}
+
 /* _get_process_data_line() - get line of data from /proc/<pid>/stat
  *
- * IN:	in - input file descriptor
+ * IN:	sbuf - NUL terminated contents of the file
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
  * 		!=0 - data are valid
  *
- * Based upon stat2proc() from the ps command. It can handle arbitrary
- * executable file basenames for `cmd', i.e. those with embedded whitespace or
- * embedded ')'s. Such names confuse %s (see scanf(3)), so the string is split
- * and %39c is used instead. (except for embedded ')' "(%[^)]c)" would work.
+ * Based upon stat2proc() from the ps command. The executable name may
+ * contain whitespace or ')', so the fields are located from the last ')'
+ * in the line. Fields are numbered as in proc(5); the third one, the
+ * state, is the only non-numeric field after the name.
  */
-static int _get_process_data_line(int in, jag_prec_t *prec) {
-	char sbuf[512], *tmp;
-	int num_read, nvals;
-	char cmd[40], state[1];
-	int ppid, pgrp, session, tty_nr, tpgid;
-	long unsigned flags, minflt, cminflt, majflt, cmajflt;
-	long unsigned utime, stime, starttime, vsize;
-	long int cutime, cstime, priority, nice, timeout, itrealvalue, rss;
-	long unsigned f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13;
-	int exit_signal, last_cpu;
-
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
-	if (num_read <= 0)
-		return 0;
-	sbuf[num_read] = '\0';
-
-	/*
-	 * split into "PID (cmd" and "<rest>" replace trailing ')' with NULL
-	 */
-	tmp = strrchr(sbuf, ')');
-	if (!tmp)
-		return 0;
-	*tmp = '\0';
+static int _get_process_data_line(char *sbuf, jag_prec_t *prec)
+{
+	char *ptr;
+	int64_t val, ppid = 0, majflt = 0, utime = 0, stime = 0;
+	int64_t vsize = 0, rss = 0, last_cpu = 0;
+	int field;
 
-	/* parse these two strings separately, skipping the leading "(". */
-	nvals = sscanf(sbuf, "%d (%39c", &prec->pid, cmd);
-	if (nvals < 2)
+	if (!(ptr = strrchr(sbuf, ')')) || (ptr[1] != ' ') || !ptr[2])
 		return 0;
+	ptr += 3;	/* skip ") " and the state */
 
-	nvals = sscanf(tmp + 2,	 /* skip space after ')' too */
-		       "%c %d %d %d %d %d "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %ld %ld %ld %ld "
-		       "%ld %ld %lu %lu %ld "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %lu %d %d ",
-		       state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-		       &flags, &minflt, &cminflt, &majflt, &cmajflt,
-		       &utime, &stime, &cutime, &cstime, &priority, &nice,
-		       &timeout, &itrealvalue, &starttime, &vsize, &rss,
-		       &f1, &f2, &f3, &f4, &f5 ,&f6, &f7, &f8, &f9, &f10, &f11,
-		       &f12, &f13, &exit_signal, &last_cpu);
 	/* There are some additional fields, which we do not scan or use */
-	if ((nvals < 37) || (rss < 0))
-		return 0;
-
-	/* If current pid corresponds to a Light Weight Process (Thread POSIX) */
-	/* skip it, we will only account the original process (pid==tgid) */
-	if (_is_a_lwp(prec->pid) > 0)
+	for (field = 4; field <= 39; field++) {
+		if (!_scan_field(&ptr, &val))
+			return 0;
+		switch (field) {
+		case 4:
+			ppid = val;
+			break;
+		case 12:
+			majflt = val;
+			break;
+		case 14:
+			utime = val;
+			break;
+		case 15:
+			stime = val;
+			break;
+		case 23:
+			vsize = val;
+			break;
+		case 24:
+			rss = val;
+			break;
+		case 39:
+			last_cpu = val;
+			break;
+		}
+	}
+	if (rss < 0)
 		return 0;
 
 	/* Copy the values that slurm records into our data structure */
@@ -344,7 +389,7 @@ static int _get_process_data_line(int in, jag_prec_t *prec) {
 	prec->pages = majflt;
 	prec->usec  = utime;
 	prec->ssec  = stime;
-	prec->vsize = vsize / 1024; /* convert from bytes to KB */
+	prec->vsize = (uint64_t) vsize / 1024; /* convert from bytes to KB */
 	prec->rss   = rss * my_pagesize;/* convert from pages to KB */
 	prec->last_cpu = last_cpu;
 	return 1;
@@ -352,7 +397,7 @@ static int _get_process_data_line(int in, jag_prec_t *prec) {
 
 /* _get_process_memory_line() - get line of data from /proc/<pid>/statm
  *
- * IN:	in - input file descriptor
+ * IN:	sbuf - NUL terminated contents of the file
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
@@ -363,22 +408,14 @@ static int _get_process_data_line(int in, jag_prec_t *prec) {
  * and return the updated struct.
  *
  */
-static int _get_process_memory_line(int in, jag_prec_t *prec)
+static int _get_process_memory_line(char *sbuf, jag_prec_t *prec)
 {
-	char sbuf[256];
-	int num_read, nvals;
-	long int size, rss, share, text, lib, data, dt;
+	char *ptr = sbuf;
+	int64_t size, rss, share;
 
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
-	if (num_read <= 0)
-		return 0;
-	sbuf[num_read] = '\0';
-
-	nvals = sscanf(sbuf,
-		       "%ld %ld %ld %ld %ld %ld %ld",
-		       &size, &rss, &share, &text, &lib, &data, &dt);
 	/* There are some additional fields, which we do not scan or use */
-	if (nvals != 7)
+	if (!_scan_field(&ptr, &size) || !_scan_field(&ptr, &rss) ||
+	    !_scan_field(&ptr, &share))
 		return 0;
 
 	/* If shared > rss then there is a problem, give up... */
@@ -392,27 +429,9 @@ static int _get_process_memory_line(int in, jag_prec_t *prec)
 	return 1;
 }
 
-static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
-{
-	FILE *statm_fp = NULL;
-	char proc_statm_file[256];	/* Allow ~20x extra length */
-	int rc = 0, fd;
-
-	snprintf(proc_statm_file, sizeof(proc_statm_file), "%sm",
-		 proc_stat_file);
-	if (!(statm_fp = fopen(proc_statm_file, "r")))
-		return rc;  /* Assume the process went away */
-	fd = fileno(statm_fp);
-	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
-		error("%s: fcntl(%s): %m", __func__, proc_statm_file);
-	rc = _get_process_memory_line(fd, prec);
-	fclose(statm_fp);
-	return rc;
-}
-
 /* _get_process_io_data_line() - get line of data from /proc/<pid>/io
  *
- * IN:	in - input file descriptor
+ * IN:	sbuf - NUL terminated contents of the file
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
@@ -423,23 +442,18 @@ static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
  * wrchar: <# of characters written>
  *   . . .
  */
-static int _get_process_io_data_line(int in, jag_prec_t *prec) {
-	char sbuf[256];
-	char f1[7], f3[7];
-	int num_read, nvals;
-	uint64_t rchar, wchar;
+static int _get_process_io_data_line(char *sbuf, jag_prec_t *prec)
+{
+	char *ptr;
+	int64_t rchar, wchar;
 
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
-	if (num_read <= 0)
+	if (!(ptr = strchr(sbuf, ':')))
 		return 0;
-	sbuf[num_read] = '\0';
-
-	nvals = sscanf(sbuf, "%s %"PRIu64" %s %"PRIu64"",
-		       f1, &rchar, f3, &wchar);
-	if (nvals < 4)
+	ptr++;
+	if (!_scan_field(&ptr, &rchar) || !(ptr = strchr(ptr, ':')))
 		return 0;
-
-	if (_is_a_lwp(prec->pid) > 0)
+	ptr++;
+	if (!_scan_field(&ptr, &wchar))
 		return 0;
 
 	/* Copy the values that slurm records into our data structure */
@@ -449,93 +463,211 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	return 1;
 }
 
-static void _handle_stats(List prec_list, char *proc_stat_file, char *proc_io_file,
-			  char *proc_smaps_file, jag_callbacks_t *callbacks)
+static int _find_pfd(void *x, void *key)
 {
-	static int no_share_data = -1;
-	static int use_pss = -1;
-	FILE *stat_fp = NULL;
-	FILE *io_fp = NULL;
-	int fd, fd2;
-	jag_prec_t *prec = NULL;
+	jag_pfd_t *pfd = (jag_pfd_t *) x;
+	pid_t *pid = (pid_t *) key;
 
-	if (no_share_data == -1) {
-		char *acct_params = slurm_get_jobacct_gather_params();
-		if (acct_params && strstr(acct_params, "NoShare"))
-			no_share_data = 1;
-		else
-			no_share_data = 0;
+	return (pfd->pid == *pid);
+}
 
-		if (acct_params && strstr(acct_params, "UsePss"))
-			use_pss = 1;
-		else
-			use_pss = 0;
-		xfree(acct_params);
-	}
+static int _stale_pfd(void *x, void *key)
+{
+	jag_pfd_t *pfd = (jag_pfd_t *) x;
+	uint32_t *gen = (uint32_t *) key;
 
-	if (!(stat_fp = fopen(proc_stat_file, "r")))
-		return;  /* Assume the process went away */
+	return (pfd->poll_gen != *gen);
+}
+
+static int _open_proc_file(pid_t pid, const char *name)
+{
+	char path[256];	/* Allow ~20x extra length */
+	int fd;
+
+	snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
 	/*
-	 * Close the file on exec() of user tasks.
-	 *
-	 * NOTE: If we fork() slurmstepd after the
-	 * fopen() above and before the fcntl() below,
-	 * then the user task may have this extra file
-	 * open, which can cause problems for
-	 * checkpoint/restart, but this should be a very rare
-	 * problem in practice.
+	 * O_CLOEXEC so user tasks we fork() never inherit these, now that
+	 * they stay open between polls.
 	 */
-	fd = fileno(stat_fp);
-	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
-		error("%s: fcntl(%s): %m", __func__, proc_stat_file);
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+		debug3("%s: unable to open %s: %m", __func__, path);
+	return fd;
+}
 
-	prec = try_xmalloc(sizeof(jag_prec_t));
-	if (prec == NULL) {	/* Avoid killing slurmstepd on malloc failure */
-		fclose(stat_fp);
-		return;
+static void _pfd_close(jag_pfd_t *pfd)
+{
+	if (pfd->stat_fd >= 0)
+		(void) close(pfd->stat_fd);
+	if (pfd->statm_fd >= 0)
+		(void) close(pfd->statm_fd);
+	if (pfd->io_fd >= 0)
+		(void) close(pfd->io_fd);
+	pfd->stat_fd = pfd->statm_fd = pfd->io_fd = -1;
+}
+
+/*
+ * Open the /proc files sampled for pfd->pid. A lightweight process is
+ * recorded as such without opening anything, we only account the original
+ * process (pid==tgid).
+ */
+static int _pfd_open(jag_pfd_t *pfd)
+{
+	_pfd_close(pfd);
+
+	if ((pfd->lwp = _is_a_lwp(pfd->pid)) > 0)
+		return SLURM_SUCCESS;
+
+	if ((pfd->stat_fd = _open_proc_file(pfd->pid, "stat")) < 0)
+		return SLURM_ERROR;	/* Assume the process went away */
+	if (no_share_data)
+		pfd->statm_fd = _open_proc_file(pfd->pid, "statm");
+	pfd->io_fd = _open_proc_file(pfd->pid, "io");
+
+	return SLURM_SUCCESS;
+}
+
+static void _destroy_pfd(void *object)
+{
+	jag_pfd_t *pfd = (jag_pfd_t *) object;
+
+	if (pfd) {
+		_pfd_close(pfd);
+		xfree(pfd);
+	}
+}
+
+/* Read a whole /proc file from the start, NUL terminated */
+static int _pread_file(int fd, char *buf, size_t size)
+{
+	ssize_t num_read;
+
+	if (fd < 0)
+		return 0;
+	do {
+		num_read = pread(fd, buf, size - 1, 0);
+	} while ((num_read < 0) && (errno == EINTR));
+	if (num_read <= 0)
+		return 0;
+	buf[num_read] = '\0';
+
+	return num_read;
+}
+
+/*
+ * Find the /proc handles of a pid, opening them on the first poll that
+ * sees it. With persist false nothing is cached and the caller closes
+ * the handles once done.
+ */
+static jag_pfd_t *_get_pfd(pid_t pid, bool persist, jag_pfd_t *tmp_pfd)
+{
+	jag_pfd_t *pfd;
+
+	if (persist && (pfd = list_find_first(pfd_list, _find_pfd, &pid))) {
+		pfd->poll_gen = poll_gen;
+		return pfd;
 	}
-	if (!_get_process_data_line(fd, prec)) {
+
+	pfd = persist ? xmalloc(sizeof(jag_pfd_t)) : tmp_pfd;
+	pfd->pid = pid;
+	pfd->stat_fd = pfd->statm_fd = pfd->io_fd = -1;
+	pfd->poll_gen = poll_gen;
+	if (_pfd_open(pfd) != SLURM_SUCCESS) {
+		if (persist)
+			xfree(pfd);
+		return NULL;
+	}
+	if (persist)
+		list_append(pfd_list, pfd);
+
+	return pfd;
+}
+
+static void _handle_stats(List prec_list, pid_t pid, bool persist,
+			  jag_callbacks_t *callbacks)
+{
+	jag_pfd_t *pfd, tmp_pfd;
+	jag_prec_t *prec = NULL;
+	char sbuf[512];
+
+	if (!(pfd = _get_pfd(pid, persist, &tmp_pfd)))
+		return;  /* Assume the process went away */
+	if (pfd->lwp > 0)
+		goto done;
+
+	if (!_pread_file(pfd->stat_fd, sbuf, sizeof(sbuf))) {
+		/*
+		 * The process we opened exited. Its pid may already belong
+		 * to a new one, so open the files again once.
+		 */
+		if (!persist || (_pfd_open(pfd) != SLURM_SUCCESS) ||
+		    (pfd->lwp > 0) ||
+		    !_pread_file(pfd->stat_fd, sbuf, sizeof(sbuf)))
+			goto done;
+	}
+
+	prec = try_xmalloc(sizeof(jag_prec_t));
+	if (prec == NULL)	/* Avoid killing slurmstepd on malloc failure */
+		goto done;
+	prec->pid = pid;
+	if (!_get_process_data_line(sbuf, prec)) {
 		xfree(prec);
-		fclose(stat_fp);
-		return;
+		goto done;
 	}
-	fclose(stat_fp);
 
 	/* Remove shared data from rss */
-	if (no_share_data)
-		_remove_share_data(proc_stat_file, prec);
+	if (no_share_data && _pread_file(pfd->statm_fd, sbuf, sizeof(sbuf)))
+		_get_process_memory_line(sbuf, prec);
 
 	/* Use PSS instead if RSS */
 	if (use_pss) {
-		if (_get_pss(proc_smaps_file, prec) == -1) {
+		if (_get_pss(pid, prec) == -1) {
 			xfree(prec);
-			return;
+			goto done;
 		}
 	}
 
 	list_append(prec_list, prec);
 
-	if ((io_fp = fopen(proc_io_file, "r"))) {
-		fd2 = fileno(io_fp);
-		if (fcntl(fd2, F_SETFD, FD_CLOEXEC) == -1)
-			error("%s: fcntl: %m", __func__);
-		_get_process_io_data_line(fd2, prec);
-		fclose(io_fp);
-	}
+	if (_pread_file(pfd->io_fd, sbuf, sizeof(sbuf)))
+		_get_process_io_data_line(sbuf, prec);
 	if (callbacks->prec_extra)
 		(*(callbacks->prec_extra))(prec);
+
+done:
+	if (!persist)
+		_pfd_close(pfd);
+}
+
+static void _get_params(void)
+{
+	char *acct_params;
+
+	if (no_share_data != -1)
+		return;
+
+	acct_params = slurm_get_jobacct_gather_params();
+	if (acct_params && strstr(acct_params, "NoShare"))
+		no_share_data = 1;
+	else
+		no_share_data = 0;
+
+	if (acct_params && strstr(acct_params, "UsePss"))
+		use_pss = 1;
+	else
+		use_pss = 0;
+	xfree(acct_params);
 }
 
 static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 		       jag_callbacks_t *callbacks)
 {
 	List prec_list = list_create(destroy_jag_prec);
-	char	proc_stat_file[256];	/* Allow ~20x extra length */
-	char	proc_io_file[256];	/* Allow ~20x extra length */
-	char	proc_smaps_file[256];	/* Allow ~20x extra length */
 	static	int	slash_proc_open = 0;
 	int i;
 
+	_get_params();
+	poll_gen++;
+
 	if (!pgid_plugin) {
 		pid_t *pids = NULL;
 		int npids = 0;
@@ -553,19 +685,25 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 
 			debug4("no pids in this container %"PRIu64"", cont_id);
+			if (pfd_list)
+				list_flush(pfd_list);
 			goto finished;
 		}
-		for (i = 0; i < npids; i++) {
-			snprintf(proc_stat_file, 256, "/proc/%d/stat", pids[i]);
-			snprintf(proc_io_file, 256, "/proc/%d/io", pids[i]);
-			snprintf(proc_smaps_file, 256, "/proc/%d/smaps", pids[i]);
-			_handle_stats(prec_list, proc_stat_file, proc_io_file,
-				      proc_smaps_file, callbacks);
-		}
+		/*
+		 * The container only holds our own processes, so keep their
+		 * /proc files open for the next poll and drop those of the
+		 * processes which have left it.
+		 */
+		if (!pfd_list)
+			pfd_list = list_create(_destroy_pfd);
+		for (i = 0; i < npids; i++)
+			_handle_stats(prec_list, pids[i], true, callbacks);
+		list_delete_all(pfd_list, _stale_pfd, &poll_gen);
 		xfree(pids);
 	} else {
 		struct dirent *slash_proc_entry;
-		char  *iptr = NULL, *optr = NULL, *optr2 = NULL;
+		char *iptr;
+		pid_t pid;
 
 		if (slash_proc_open) {
 			rewinddir(slash_proc);
@@ -577,79 +715,27 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 			slash_proc_open=1;
 		}
-		strcpy(proc_stat_file, "/proc/");
-		strcpy(proc_io_file, "/proc/");
-		strcpy(proc_smaps_file, "/proc/");
 
+		/*
+		 * Every process on the node is looked at here, far too many
+		 * to hold open, so their files are only opened for this poll.
+		 */
 		while ((slash_proc_entry = readdir(slash_proc))) {
-
-			/* Save a few cyles by simulating
-			 * strcat(statFileName, slash_proc_entry->d_name);
-			 * strcat(statFileName, "/stat");
-			 * while checking for a numeric filename (which really
-			 * should be a pid). Then do the same for the
-			 * /proc/<pid>/io file name.
-			 */
-			optr = proc_stat_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-
-			if (i == -1)
-				continue;
-			iptr = (char*)"/stat";
-
-			do {
-				*optr++ = *iptr++;
-			} while (*iptr);
-			*optr = 0;
-
-			optr2 = proc_io_file + sizeof("/proc");
+			/* Only numeric file names, which should be pids */
 			iptr = slash_proc_entry->d_name;
-			i = 0;
+			pid = 0;
 			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
+				if ((*iptr < '0') || (*iptr > '9')) {
+					pid = 0;
 					break;
 				}
+				pid = (pid * 10) + (*iptr++ - '0');
 			} while (*iptr);
-			if (i == -1)
-				continue;
-			iptr = (char*)"/io";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
 
-			optr2 = proc_smaps_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-			if (i == -1)
+			if (pid <= 0)
 				continue;
-			iptr = (char*)"/smaps";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
 
-			_handle_stats(prec_list, proc_stat_file, proc_io_file,
-				      proc_smaps_file,callbacks);
+			_handle_stats(prec_list, pid, false, callbacks);
 		}
 	}
 
@@ -783,6 +869,7 @@ extern void jag_common_fini(void)
 {
 	if (slash_proc)
 		(void) closedir(slash_proc);
+	FREE_NULL_LIST(pfd_list);
 }
 
 extern void destroy_jag_prec(void *object)
@@ -820,6 +907,7 @@ extern void jag_common_poll_data(
 	int energy_counted = 0;
 	time_t ct;
 	static int no_over_memory_kill = -1;
+	DEF_TIMERS;
 
 	xassert(callbacks);
 
@@ -847,8 +935,14 @@ extern void jag_common_poll_data(
 		callbacks->get_precs = _get_precs;
 
 	ct = time(NULL);
+	START_TIMER;
+	if (callbacks->poll_start)
+		(*(callbacks->poll_start))();
 	prec_list = (*(callbacks->get_precs))(task_list, pgid_plugin, cont_id,
 					      callbacks);
+	END_TIMER;
+	debug2("%s: sampled %d processes in %s",
+	       __func__, list_count(prec_list), TIME_STR);
 
 	if (!list_count(prec_list) || !task_list || !list_count(task_list))
 		goto finished;	/* We have no business being here! */
@@ -58,6 +58,7 @@ typedef struct jag_prec {	/* process record */
 } jag_prec_t;
 
 typedef struct jag_callbacks {
+	void (*poll_start) (void);	/* once per poll, before get_precs */
 	void (*prec_extra) (jag_prec_t *prec);
 	List (*get_precs) (List task_list, bool pgid_plugin, uint64_t cont_id,
 			   struct jag_callbacks *callbacks);
@@ -0,0 +1,202 @@
+/*****************************************************************************\
+ *  jag_bench.c - time jobacct_gather sampling against the process count
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Fork N idle processes and time jag_common_poll_data() over them, both as
+ * a proctrack container (the /proc files stay open between polls) and with
+ * the /proc walk used by pgid based proctrack (every process on the node is
+ * read). The task list is empty so only the sampling itself is timed.
+ *
+ * JobAcctGatherParams is read and the acct_gather plugins are loaded, so a
+ * slurm.conf with a PluginDir holding them is needed (set SLURM_CONF). Files
+ * are held open for each process sampled in a container, the soft
+ * RLIMIT_NOFILE is raised to the hard one.
+ *
+ * Usage: jag_bench [process count ...]
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmd/common/proctrack.h"
+
+#include "common_jag.h"
+
+#define POLL_CNT	20
+
+static int default_cnts[] = { 1, 10, 100, 1000, 0 };
+
+static pid_t *bench_pids = NULL;
+static int bench_pid_cnt = 0;
+static int prec_cnt = 0;
+
+/* Normally provided by slurmstepd, return the forked processes */
+extern int proctrack_g_get_pids(uint64_t cont_id, pid_t **pids, int *npids)
+{
+	*pids = xmalloc(sizeof(pid_t) * bench_pid_cnt);
+	memcpy(*pids, bench_pids, sizeof(pid_t) * bench_pid_cnt);
+	*npids = bench_pid_cnt;
+	return SLURM_SUCCESS;
+}
+
+static void _count_prec(jag_prec_t *prec)
+{
+	prec_cnt++;
+}
+
+/* time() and gettimeofday() may be simulated, use the real clock */
+static uint64_t _now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void _raise_nofile(void)
+{
+	struct rlimit rlim;
+
+	if (getrlimit(RLIMIT_NOFILE, &rlim) < 0)
+		return;
+	rlim.rlim_cur = rlim.rlim_max;
+	if (setrlimit(RLIMIT_NOFILE, &rlim) < 0)
+		error("setrlimit(RLIMIT_NOFILE): %m");
+}
+
+static int _fork_procs(int cnt)
+{
+	bench_pids = xmalloc(sizeof(pid_t) * cnt);
+	for (bench_pid_cnt = 0; bench_pid_cnt < cnt; bench_pid_cnt++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			error("fork: %m");
+			return SLURM_ERROR;
+		}
+		if (pid == 0) {
+			pause();
+			_exit(0);
+		}
+		bench_pids[bench_pid_cnt] = pid;
+	}
+	return SLURM_SUCCESS;
+}
+
+static void _kill_procs(void)
+{
+	int i;
+
+	for (i = 0; i < bench_pid_cnt; i++)
+		kill(bench_pids[i], SIGKILL);
+	for (i = 0; i < bench_pid_cnt; i++)
+		(void) waitpid(bench_pids[i], NULL, 0);
+	xfree(bench_pids);
+	bench_pid_cnt = 0;
+}
+
+/* Poll POLL_CNT times, RET usec per poll and set *sampled */
+static double _time_polls(List task_list, bool pgid_plugin,
+			  jag_callbacks_t *callbacks, int *sampled)
+{
+	uint64_t start;
+	int i;
+
+	/* The first poll opens the files of a container, keep it out */
+	jag_common_poll_data(task_list, pgid_plugin, 1, callbacks, false);
+
+	prec_cnt = 0;
+	start = _now_usec();
+	for (i = 0; i < POLL_CNT; i++)
+		jag_common_poll_data(task_list, pgid_plugin, 1, callbacks,
+				     false);
+	*sampled = prec_cnt / POLL_CNT;
+	return (double) (_now_usec() - start) / POLL_CNT;
+}
+
+int main(int argc, char *argv[])
+{
+	log_options_t log_opts = LOG_OPTS_STDERR_ONLY;
+	jag_callbacks_t callbacks;
+	List task_list;
+	int *cnts = default_cnts, i, cont_cnt, walk_cnt, rc = 0;
+	double cont_usec, walk_usec;
+
+	log_init(argv[0], log_opts, 0, NULL);
+
+	if (argc > 1) {
+		cnts = xmalloc(sizeof(int) * argc);
+		for (i = 1; i < argc; i++)
+			cnts[i - 1] = MAX(atoi(argv[i]), 1);
+	}
+
+	_raise_nofile();
+	memset(&callbacks, 0, sizeof(jag_callbacks_t));
+	callbacks.prec_extra = _count_prec;
+	task_list = list_create(NULL);
+	jag_common_init(0);
+
+	printf("%8s %14s %14s %14s %14s\n", "procs", "cont_usec/poll",
+	       "cont_sampled", "walk_usec/poll", "walk_sampled");
+	for (i = 0; cnts[i]; i++) {
+		if (_fork_procs(cnts[i]) != SLURM_SUCCESS) {
+			_kill_procs();
+			rc = 1;
+			break;
+		}
+		cont_usec = _time_polls(task_list, false, &callbacks,
+					&cont_cnt);
+		walk_usec = _time_polls(task_list, true, &callbacks,
+					&walk_cnt);
+		printf("%8d %14.1f %14d %14.1f %14d\n", cnts[i],
+		       cont_usec, cont_cnt, walk_usec, walk_cnt);
+		_kill_procs();
+	}
+
+	jag_common_fini();
+	FREE_NULL_LIST(task_list);
+	if (cnts != default_cnts)
+		xfree(cnts);
+	return rc;
+}
@@ -230,3 +230,9 @@ extern void priority_p_job_end(struct job_record *job_ptr)
 
 	return;
 }
+
+extern int priority_p_decay_pass(void)
+{
+	/* No decaying in basic priority. */
+	return SLURM_SUCCESS;
+}
@@ -69,6 +69,10 @@
 
 #include "fair_tree.h"
 
+#ifdef SLURM_SIMULATOR
+#include "src/common/sim_profile.h"
+#endif
+
 #define SECS_PER_DAY	(24 * 60 * 60)
 #define SECS_PER_WEEK	(7 * SECS_PER_DAY)
 
@@ -1145,6 +1149,62 @@ static int _decay_apply_new_usage_and_weighted_factors(
 }
 
 
+/*
+ * Apply run_delta seconds worth of decay to the association usage and
+ * recalculate the usage and priority factors of all jobs as of start_time.
+ * No decay is applied if run_delta <= 0. Call with decay_lock held.
+ */
+static int _run_decay(time_t start_time, double run_delta)
+{
+	double real_decay;
+	/* Write lock on jobs, read lock on nodes and partitions */
+	slurmctld_lock_t job_write_lock =
+		{ NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+				   NO_LOCK, NO_LOCK, NO_LOCK };
+
+	/* Calculate all the normalized usage unless this is Fair Tree;
+	 * it handles these calculations during its tree traversal */
+	if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
+		assoc_mgr_lock(&locks);
+		_set_children_usage_efctv(
+			assoc_mgr_root_assoc->usage->children_list);
+		assoc_mgr_unlock(&locks);
+	}
+
+	if (run_delta <= 0)
+		goto get_usage;
+	real_decay = pow(decay_factor, run_delta);
+#ifdef DBL_MIN
+	if (real_decay < DBL_MIN)
+		real_decay = DBL_MIN;
+#endif
+	if (priority_debug)
+		info("Decay factor over %g seconds goes "
+		     "from %.15f -> %.15f",
+		     run_delta, decay_factor, real_decay);
+
+	/* first apply decay to used time */
+	if (_apply_decay(real_decay) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
+		lock_slurmctld(job_write_lock);
+		list_for_each(
+			job_list,
+			(ListForF) _decay_apply_new_usage_and_weighted_factors,
+			&start_time
+			);
+		unlock_slurmctld(job_write_lock);
+	}
+
+get_usage:
+	if (flags & PRIORITY_FLAGS_FAIR_TREE)
+		fair_tree_decay(job_list, start_time);
+
+	return SLURM_SUCCESS;
+}
+
 static void *_decay_thread(void *no_data)
 {
 	time_t start_time = time(NULL);
@@ -1154,20 +1214,18 @@ static void *_decay_thread(void *no_data)
 	uint16_t reset_period = slurm_get_priority_reset_period();
 
 	time_t now;
-	double run_delta = 0.0, real_decay = 0.0;
+	double run_delta = 0.0;
 	double elapsed;
-
-	/* Write lock on jobs, read lock on nodes and partitions */
-	slurmctld_lock_t job_write_lock =
-		{ NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
-	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
-				   NO_LOCK, NO_LOCK, NO_LOCK };
+#ifdef SLURM_SIMULATOR
+	uint64_t prof_start;
+#endif
 
 #if HAVE_SYS_PRCTL_H
 	if (prctl(PR_SET_NAME, "decay", NULL, NULL, NULL) < 0) {
 		error("%s: cannot set my name to %s %m", __func__, "decay");
 	}
 #endif
+	(void) set_lock_context(LOCK_CTX_DECAY);
 	/*
 	 * DECAY_FACTOR DESCRIPTION:
 	 *
@@ -1222,6 +1280,10 @@ static void *_decay_thread(void *no_data)
 	while (1) {
 		now = start_time;
 
+#ifdef SLURM_SIMULATOR
+		(void) sim_prof_attach();
+		prof_start = sim_prof_begin();
+#endif
 		slurm_mutex_lock(&decay_lock);
 		running_decay = 1;
 
@@ -1273,60 +1335,28 @@ static void *_decay_thread(void *no_data)
 			}
 		}
 
-		/* Calculate all the normalized usage unless this is Fair Tree;
-		 * it handles these calculations during its tree traversal */
-		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
-			assoc_mgr_lock(&locks);
-			_set_children_usage_efctv(
-				assoc_mgr_root_assoc->usage->children_list);
-			assoc_mgr_unlock(&locks);
-		}
-
-		if (!g_last_ran)
-			goto get_usage;
-		else
+		if (g_last_ran)
 			run_delta = difftime(start_time, g_last_ran);
+		else
+			run_delta = 0.0;
 
-		if (run_delta <= 0)
-			goto get_usage;
-		real_decay = pow(decay_factor, (double)run_delta);
-#ifdef DBL_MIN
-		if (real_decay < DBL_MIN)
-			real_decay = DBL_MIN;
-#endif
-		if (priority_debug)
-			info("Decay factor over %g seconds goes "
-			     "from %.15f -> %.15f",
-			     run_delta, decay_factor, real_decay);
-
-		/* first apply decay to used time */
-		if (_apply_decay(real_decay) != SLURM_SUCCESS) {
+		if (_run_decay(start_time, run_delta) != SLURM_SUCCESS) {
 			error("priority/multifactor: problem applying decay");
 			running_decay = 0;
 			slurm_mutex_unlock(&decay_lock);
 			break;
 		}
 
-		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
-			lock_slurmctld(job_write_lock);
-			list_for_each(
-				job_list,
-				(ListForF) _decay_apply_new_usage_and_weighted_factors,
-				&start_time
-				);
-			unlock_slurmctld(job_write_lock);
-		}
-
-	get_usage:
-		if (flags & PRIORITY_FLAGS_FAIR_TREE)
-			fair_tree_decay(job_list, start_time);
-
 		g_last_ran = start_time;
 
 		_write_last_decay_ran(g_last_ran, last_reset);
 
 		running_decay = 0;
 		slurm_mutex_unlock(&decay_lock);
+#ifdef SLURM_SIMULATOR
+		sim_prof_end(SIM_PROF_DECAY, prof_start);
+		sim_prof_count(SIM_PROF_DECAY_PASSES, 1);
+#endif
 
 		/* Sleep until the next time. */
 		now = time(NULL);
@@ -1958,6 +1988,39 @@ extern void priority_p_job_end(struct job_record *job_ptr)
 	_apply_new_usage(job_ptr, g_last_ran, time(NULL), 1);
 }
 
+extern int priority_p_decay_pass(void)
+{
+	time_t start_time = time(NULL);
+	int rc = SLURM_SUCCESS;
+	uint32_t old_lock_ctx;
+	/* Write lock on jobs, read lock on nodes and partitions */
+	slurmctld_lock_t job_write_lock =
+		{ NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+
+	old_lock_ctx = set_lock_context(LOCK_CTX_DECAY);
+	slurm_mutex_lock(&decay_lock);
+	running_decay = 1;
+	if (calc_fairshare && assoc_mgr_root_assoc) {
+		/* One PriorityCalcPeriod worth of decay, g_last_ran and the
+		 * last_decay_ran state file are left alone */
+		rc = _run_decay(start_time,
+				(double) slurm_get_priority_calc_period());
+	} else {
+		/* No fairshare, only the job priority factors change */
+		lock_slurmctld(job_write_lock);
+		list_for_each(
+			job_list,
+			(ListForF) _decay_apply_new_usage_and_weighted_factors,
+			&start_time);
+		unlock_slurmctld(job_write_lock);
+	}
+	running_decay = 0;
+	slurm_mutex_unlock(&decay_lock);
+	(void) set_lock_context(old_lock_ctx);
+
+	return rc;
+}
+
 extern bool decay_apply_new_usage(struct job_record *job_ptr,
 				  time_t *start_time_ptr)
 {
@@ -2001,6 +2064,7 @@ extern int decay_apply_weighted_factors(struct job_record *job_ptr,
 	    (job_ptr->priority < new_prio)) {
 		job_ptr->priority = new_prio;
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	}
 
 	debug2("priority for job %u is now %u",
@@ -947,6 +947,7 @@ extern void *backfill_agent(void *args)
 	int backfill_cnt = 0;
 
 	debug("Inside backfill agent");
+	(void) set_lock_context(LOCK_CTX_BACKFILL);
 
 #if HAVE_SYS_PRCTL_H
 	if (prctl(PR_SET_NAME, "bckfl", NULL, NULL, NULL) < 0) {
@@ -1029,6 +1030,40 @@ extern void *backfill_agent(void *args)
 	return NULL;
 }
 
+/* backfill_run_pass - run one backfill pass in the calling thread. Used by
+ *	the scheduler benchmark, which runs without backfill_agent */
+extern int backfill_run_pass(void)
+{
+	/* Read config and partitions; Write jobs and nodes */
+	slurmctld_lock_t all_locks = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK };
+	static bool config_loaded = false;
+	bool load_config;
+	uint32_t old_lock_ctx;
+	int rc;
+
+	slurm_mutex_lock(&config_lock);
+	load_config = config_flag || !config_loaded;
+	config_flag = false;
+	config_loaded = true;
+	slurm_mutex_unlock(&config_lock);
+	if (load_config)
+		_load_config();
+
+	if (!pack_job_list)
+		pack_job_list = list_create(_pack_map_del);
+	(void) list_delete_all(pack_job_list, _list_find_all, NULL);
+
+	old_lock_ctx = set_lock_context(LOCK_CTX_BACKFILL);
+	lock_slurmctld(all_locks);
+	_pack_start_clear();
+	rc = _attempt_backfill();
+	unlock_slurmctld(all_locks);
+	(void) set_lock_context(old_lock_ctx);
+
+	return rc;
+}
+
 /* Clear the start_time for all pending jobs. This is used to ensure that a job which
  * can run in multiple partitions has its start_time set to the smallest
  * value in any of those partitions. */
@@ -1412,6 +1447,7 @@ static int _attempt_backfill(void)
 				xfree(job_ptr->state_desc);
 				job_ptr->assoc_id = assoc_rec.id;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			} else {
 				debug("backfill: JobId=%u has invalid association",
 				      job_ptr->job_id);
@@ -1439,12 +1475,14 @@ static int _attempt_backfill(void)
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_QOS;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				assoc_mgr_unlock(&locks);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -1470,6 +1508,7 @@ static int _attempt_backfill(void)
 			xfree(job_ptr->state_desc);
 			job_ptr->state_reason = WAIT_QOS;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			continue;
 		}
 		assoc_mgr_unlock(&qos_read_lock);
@@ -2060,6 +2099,7 @@ next_task:
 		if (start_res > job_ptr->start_time) {
 			job_ptr->start_time = start_res;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		}
 		if ((job_ptr->start_time <= now) &&
 		    (bit_overlap(avail_bitmap, cg_node_bitmap) > 0)) {
@@ -2089,6 +2129,7 @@ next_task:
 			       job_reason_string(job_ptr->state_reason),
 			       job_ptr->priority);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			_set_job_time_limit(job_ptr, orig_time_limit);
 			later_start = 0;
 			if (bb == -1)
@@ -2530,6 +2571,7 @@ static int _start_job(struct job_record *job_ptr, bitstr_t *resv_bitmap)
 		/* job initiated */
 		char job_id_str[64];
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 		info("backfill: Started %s in %s on %s",
 		     jobid2fmt(job_ptr, job_id_str, sizeof(job_id_str)),
 		     job_ptr->part_ptr->name, job_ptr->nodes);
@@ -2918,10 +2960,12 @@ static time_t _pack_start_find(struct job_record *job_ptr, time_t now)
 			if (job_ptr->state_reason == WAIT_TIME) {
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			}
 			if (job_ptr->state_reason_prev == WAIT_TIME) {
 				job_ptr->state_reason_prev = WAIT_NO_REASON;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			}
 		}
 
@@ -3277,6 +3321,7 @@ static void _pack_kill_now(pack_job_map_t *map)
 		job_ptr->end_time   = now;
 		job_ptr->job_state  = JOB_PENDING | JOB_COMPLETING;
 		last_job_update     = now;
+		job_set_changed(job_ptr);
 		build_cg_bitmap(job_ptr);
 		job_completion_logger(job_ptr, false);
 		deallocate_nodes(job_ptr, false, false, false);
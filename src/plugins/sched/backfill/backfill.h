@@ -50,4 +50,8 @@ extern void stop_backfill_agent(void);
 /* Note that slurm.conf has changed */
 extern void backfill_reconfig(void);
 
+/* backfill_run_pass - run one backfill pass in the calling thread. Used by
+ *	the scheduler benchmark, which runs without backfill_agent */
+extern int backfill_run_pass(void);
+
 #endif	/* _SLURM_BACKFILL_H */
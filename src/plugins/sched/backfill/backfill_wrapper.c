@@ -104,3 +104,8 @@ uint32_t slurm_sched_p_initial_priority(uint32_t last_prio,
 {
 	return priority_g_set(last_prio, job_ptr);
 }
+
+int slurm_sched_p_run_pass(void)
+{
+	return backfill_run_pass();
+}
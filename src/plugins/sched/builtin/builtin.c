@@ -217,6 +217,7 @@ static void _compute_start_times(void)
 				       exc_core_bitmap);
 		if (rc == SLURM_SUCCESS) {
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			if (job_ptr->time_limit == INFINITE)
 				time_limit = 365 * 24 * 60 * 60;
 			else if (job_ptr->time_limit != NO_VAL)
@@ -252,6 +253,29 @@ extern void builtin_reconfig(void)
 	config_flag = true;
 }
 
+/* builtin_run_pass - compute the expected start times of pending jobs once
+ *	in the calling thread. Used by the scheduler benchmark, which runs
+ *	without builtin_agent */
+extern int builtin_run_pass(void)
+{
+	/* Read config, nodes and partitions; Write jobs */
+	slurmctld_lock_t all_locks = {
+		READ_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, READ_LOCK };
+	static bool config_loaded = false;
+
+	if (config_flag || !config_loaded) {
+		config_flag = false;
+		config_loaded = true;
+		_load_config();
+	}
+
+	lock_slurmctld(all_locks);
+	_compute_start_times();
+	unlock_slurmctld(all_locks);
+
+	return SLURM_SUCCESS;
+}
+
 /* builtin_agent - detached thread periodically when pending jobs can start */
 extern void *builtin_agent(void *args)
 {
@@ -50,4 +50,8 @@ extern void stop_builtin_agent(void);
 /* Note that slurm.conf has changed */
 extern void builtin_reconfig(void);
 
+/* Compute the expected start times of pending jobs once in the calling
+ * thread, used by the scheduler benchmark */
+extern int builtin_run_pass(void);
+
 #endif	/* _SLURM_BUILTIN_H */
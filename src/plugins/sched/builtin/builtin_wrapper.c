@@ -59,6 +59,9 @@ static pthread_mutex_t thread_flag_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 int init(void)
 {
+	if (slurmctld_config.scheduling_disabled)
+		return SLURM_SUCCESS;
+
 	verbose( "sched: Built-in scheduler plugin loaded" );
 
 	slurm_mutex_lock( &thread_flag_mutex );
@@ -100,3 +103,8 @@ uint32_t slurm_sched_p_initial_priority(uint32_t last_prio,
 {
 	return priority_g_set(last_prio, job_ptr);
 }
+
+int slurm_sched_p_run_pass(void)
+{
+	return builtin_run_pass();
+}
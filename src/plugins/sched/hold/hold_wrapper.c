@@ -79,3 +79,9 @@ uint32_t slurm_sched_p_initial_priority(uint32_t last_prio,
 
 	return priority_g_set(last_prio, job_ptr);
 }
+
+int slurm_sched_p_run_pass(void)
+{
+	/* No scheduling agent */
+	return SLURM_SUCCESS;
+}
@@ -151,6 +151,7 @@ static void _sync_agent(bg_action_t *bg_action_ptr, bg_record_t *bg_record)
 		int sync_user_rc;
 		job_ptr->job_state &= (~JOB_CONFIGURING);
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 		/* Just in case reset the boot flags */
 		bg_record->boot_state = 0;
 		bg_record->boot_count = 0;
@@ -560,6 +561,7 @@ no_reboot:
 		lock_slurmctld(job_write_lock);
 		bg_action_ptr->job_ptr->job_state &= (~JOB_CONFIGURING);
 		last_job_update = time(NULL);
+		job_set_changed(bg_action_ptr->job_ptr);
 		unlock_slurmctld(job_write_lock);
 	}
 
@@ -56,6 +56,7 @@
 
 #define OPT_LONG_HELP   0x100
 #define OPT_LONG_USAGE  0x101
+#define OPT_LONG_PIPELINE 0x102
 
 /* getopt_long options, integers but not characters */
 
@@ -79,6 +80,7 @@ extern void parse_command_line(int argc, char **argv)
 		{"fanout",    required_argument, 0, 'F'},
 		{"force",     no_argument,       0, 'f'},
 		{"jobid",     required_argument, 0, 'j'},
+		{"pipeline",  required_argument, 0, OPT_LONG_PIPELINE},
 		{"preserve",  no_argument,       0, 'p'},
 		{"size",      required_argument, 0, 's'},
 		{"timeout",   required_argument, 0, 't'},
@@ -111,6 +113,8 @@ extern void parse_command_line(int argc, char **argv)
 	params.pack_job_offset = NO_VAL;
 	params.step_id = NO_VAL;
 
+	if ( ( env_val = getenv("SBCAST_PIPELINE") ) )
+		params.pipeline = atoi(env_val);
 	if (getenv("SBCAST_PRESERVE"))
 		params.preserve = true;
 	if ( ( env_val = getenv("SBCAST_SIZE") ) )
@@ -147,6 +151,9 @@ extern void parse_command_line(int argc, char **argv)
 			if (end_ptr[0] == '.')
 				params.step_id = strtol(end_ptr+1, NULL, 10);
 			break;
+		case (int)OPT_LONG_PIPELINE:
+			params.pipeline = atoi(optarg);
+			break;
 		case (int)'p':
 			params.preserve = true;
 			break;
@@ -272,6 +279,7 @@ static void _print_options( void )
 			     params.step_id);
 		}
 	}
+	info("pipeline   = %d", params.pipeline);
 	info("preserve   = %s", params.preserve ? "true" : "false");
 	info("timeout    = %d", params.timeout);
 	info("verbose    = %d", params.verbose);
@@ -294,6 +302,7 @@ Usage: sbcast [OPTIONS] SOURCE DEST\n\
   -f, --force           replace destination file as required\n\
   -F, --fanout=num      specify message fanout\n\
   -j, --jobid=#[+#][.#] specify job ID with optional pack job offset and/or step ID\n\
+      --pipeline=num    blocks transmitted concurrently\n\
   -p, --preserve        preserve modes and times of source file\n\
   -s, --size=num        block size in bytes (rounded off)\n\
   -t, --timeout=secs    specify message timeout (seconds)\n\
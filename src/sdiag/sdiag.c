@@ -60,6 +60,7 @@ stats_info_response_msg_t *buf;
 uint32_t *rpc_type_ave_time = NULL, *rpc_user_ave_time = NULL;
 
 static int  _print_stats(void);
+static void _print_lock_stats(void);
 static void _sort_rpc(void);
 
 stats_info_request_msg_t req;
@@ -200,9 +201,101 @@ static int _print_stats(void)
 		       rpc_user_ave_time[i], buf->rpc_user_time[i]);
 	}
 
+	_print_lock_stats();
+
 	return 0;
 }
 
+static uint64_t _lock_ctx_hold_time(lock_ctx_stats_t *ctx)
+{
+	uint64_t hold = 0;
+	int i;
+
+	for (i = 0; i < LOCK_STATS_DATATYPES; i++)
+		hold += ctx->rd_hold[i].sum_usec + ctx->wr_hold[i].sum_usec;
+	return hold;
+}
+
+static int _cmp_lock_ctx(const void *a, const void *b)
+{
+	lock_ctx_stats_t *ctx_a = (lock_ctx_stats_t *) a;
+	lock_ctx_stats_t *ctx_b = (lock_ctx_stats_t *) b;
+	uint64_t hold_a, hold_b;
+
+	if (sort_by_id) {
+		if (ctx_a->id < ctx_b->id)
+			return -1;
+		return (ctx_a->id > ctx_b->id);
+	}
+
+	/* Largest total hold time first */
+	hold_a = _lock_ctx_hold_time(ctx_a);
+	hold_b = _lock_ctx_hold_time(ctx_b);
+	if (hold_a > hold_b)
+		return -1;
+	return (hold_a < hold_b);
+}
+
+/* Upper bound of the histogram bucket holding the 99th percentile */
+static uint64_t _hist_p99(lock_stats_hist_t *hist)
+{
+	uint32_t sum = 0, target;
+	int i;
+
+	target = hist->cnt - (hist->cnt / 100);
+	for (i = 0; i < LOCK_STATS_HIST_BUCKETS - 1; i++) {
+		sum += hist->bucket[i];
+		if (sum >= target)
+			break;
+	}
+	if (i == LOCK_STATS_HIST_BUCKETS - 1)
+		return hist->max_usec;
+	return MIN((uint64_t) 2 << i, hist->max_usec);
+}
+
+static void _print_lock_hist(char *datatype, char *mode,
+			     lock_stats_hist_t *wait, lock_stats_hist_t *hold)
+{
+	if (!wait->cnt)
+		return;
+	printf("		%-6s %-5s count:%-6u "
+	       "wait ave:%-6"PRIu64" max:%-8"PRIu64" p99:%-8"PRIu64" "
+	       "hold ave:%-6"PRIu64" max:%-8"PRIu64" p99:%"PRIu64"\n",
+	       datatype, mode, wait->cnt,
+	       wait->sum_usec / wait->cnt, wait->max_usec, _hist_p99(wait),
+	       hold->cnt ? hold->sum_usec / hold->cnt : 0, hold->max_usec,
+	       _hist_p99(hold));
+}
+
+static void _print_lock_stats(void)
+{
+	static char *datatype_names[LOCK_STATS_DATATYPES] = {
+		"config", "job", "node", "part", "fed" };
+	lock_ctx_stats_t *ctx;
+	int i, j;
+
+	if (!buf->lock_ctx_size)
+		return;
+
+	qsort(buf->lock_ctx, buf->lock_ctx_size, sizeof(lock_ctx_stats_t),
+	      _cmp_lock_ctx);
+
+	printf("\nLock statistics by caller (microseconds)\n");
+	for (i = 0; i < buf->lock_ctx_size; i++) {
+		ctx = &buf->lock_ctx[i];
+		if (ctx->id <= 0xffff)
+			printf("\t%s (%u)\n", ctx->name, ctx->id);
+		else
+			printf("\t%s\n", ctx->name);
+		for (j = 0; j < LOCK_STATS_DATATYPES; j++) {
+			_print_lock_hist(datatype_names[j], "read",
+					 &ctx->rd_wait[j], &ctx->rd_hold[j]);
+			_print_lock_hist(datatype_names[j], "write",
+					 &ctx->wr_wait[j], &ctx->wr_hold[j]);
+		}
+	}
+}
+
 static void _sort_rpc(void)
 {
 	int i, j;
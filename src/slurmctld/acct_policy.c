@@ -403,35 +403,143 @@ static void _set_qos_order(struct job_record *job_ptr,
 	return;
 }
 
-static int _find_used_limits_for_acct(void *x, void *key)
+/*
+ * Open addressing index of a QOS's acct_limit_list or user_limit_list.
+ * Records are only ever appended to those lists, so an index of the same
+ * list holding list_count() records is current and anything else is
+ * rebuilt. The list pointer is only compared, never followed, so an index
+ * left behind by a QOS whose usage was freed is simply rebuilt.
+ */
+typedef struct {
+	uint32_t cnt;			/* records indexed */
+	uint32_t size;			/* slots, a power of 2 */
+	slurmdb_used_limits_t *slot[];
+} used_limits_hash_t;
+
+/* The indexes of one QOS, in qos_limits_index at its QOS id */
+typedef struct {
+	List acct_list;			/* acct_limit_list indexed */
+	used_limits_hash_t *acct_hash;
+	List user_list;			/* user_limit_list indexed */
+	used_limits_hash_t *user_hash;
+} qos_limits_index_t;
+
+/* Callers may only hold assoc_mgr read locks while updating an index */
+static pthread_mutex_t used_limits_mutex = PTHREAD_MUTEX_INITIALIZER;
+static qos_limits_index_t *qos_limits_index = NULL;
+static uint32_t qos_limits_index_cnt = 0;
+
+static uint32_t _acct_hash_key(char *acct)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	char *account = (char *)key;
+	uint32_t key = 0;
 
-	if (!xstrcmp(account, used_limits->acct))
-		return 1;
+	if (acct) {
+		while (*acct)
+			key = (key * 31) + (unsigned char) *acct++;
+	}
+	return key;
+}
 
-	return 0;
+static uint32_t _user_hash_key(uint32_t user_id)
+{
+	return user_id * 2654435761U;
+}
+
+static uint32_t _used_limits_key(slurmdb_used_limits_t *used_limits,
+				 bool by_acct)
+{
+	if (by_acct)
+		return _acct_hash_key(used_limits->acct);
+	return _user_hash_key(used_limits->uid);
+}
+
+static void _used_limits_hash_add(used_limits_hash_t *hash,
+				  slurmdb_used_limits_t *used_limits,
+				  uint32_t key)
+{
+	uint32_t i = key & (hash->size - 1);
+
+	while (hash->slot[i])
+		i = (i + 1) & (hash->size - 1);
+	hash->slot[i] = used_limits;
+	hash->cnt++;
 }
 
-/* Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+/* Return the indexes of a QOS, used_limits_mutex must be locked */
+static qos_limits_index_t *_qos_limits_index(uint32_t qos_id)
+{
+	if (qos_id >= qos_limits_index_cnt) {
+		qos_limits_index_cnt = qos_id + 1;
+		xrealloc(qos_limits_index,
+			 sizeof(qos_limits_index_t) * qos_limits_index_cnt);
+	}
+	return &qos_limits_index[qos_id];
+}
+
+/*
+ * Return the index of limit_list, rebuilding it if it indexes another list,
+ * is stale or would be more than half full after one more record.
+ */
+static used_limits_hash_t *_used_limits_hash(used_limits_hash_t **hash_ptr,
+					     List *indexed_list,
+					     List limit_list, bool by_acct)
+{
+	used_limits_hash_t *hash = *hash_ptr;
+	slurmdb_used_limits_t *used_limits;
+	ListIterator itr;
+	uint32_t cnt = list_count(limit_list), size = 16;
+
+	if (hash && (*indexed_list == limit_list) && (hash->cnt == cnt) &&
+	    (((cnt + 1) * 2) <= hash->size))
+		return hash;
+
+	while (size < ((cnt + 1) * 4))
+		size <<= 1;
+	xfree(hash);
+	hash = xmalloc(sizeof(used_limits_hash_t) +
+		       (sizeof(slurmdb_used_limits_t *) * size));
+	hash->size = size;
+	itr = list_iterator_create(limit_list);
+	while ((used_limits = list_next(itr)))
+		_used_limits_hash_add(hash, used_limits,
+				      _used_limits_key(used_limits, by_acct));
+	list_iterator_destroy(itr);
+	*hash_ptr = hash;
+	*indexed_list = limit_list;
+
+	return hash;
+}
+
+/* Checks for record in qos_ptr->usage->acct_limit_list of acct if
+ * acct_limit_list doesn't exist it will create it, if the acct
  * record doesn't exist it will add it to the list.
- * In all cases the user record is returned.
+ * In all cases the acct record is returned.
  */
 static slurmdb_used_limits_t *_get_acct_used_limits(
-	List *acct_limit_list, char *acct)
+	slurmdb_qos_rec_t *qos_ptr, char *acct)
 {
+	slurmdb_qos_usage_t *usage = qos_ptr->usage;
 	slurmdb_used_limits_t *used_limits;
-
-	xassert(acct_limit_list);
-
-	if (!*acct_limit_list)
-		*acct_limit_list = list_create(slurmdb_destroy_used_limits);
-
-	if (!(used_limits = list_find_first(*acct_limit_list,
-					    _find_used_limits_for_acct,
-					    acct))) {
+	qos_limits_index_t *index;
+	used_limits_hash_t *hash;
+	uint32_t inx, key = _acct_hash_key(acct);
+
+	xassert(usage);
+
+	slurm_mutex_lock(&used_limits_mutex);
+	if (!usage->acct_limit_list)
+		usage->acct_limit_list =
+			list_create(slurmdb_destroy_used_limits);
+	index = _qos_limits_index(qos_ptr->id);
+	hash = _used_limits_hash(&index->acct_hash, &index->acct_list,
+				 usage->acct_limit_list, true);
+
+	for (inx = key & (hash->size - 1); (used_limits = hash->slot[inx]);
+	     inx = (inx + 1) & (hash->size - 1)) {
+		if (!xstrcmp(acct, used_limits->acct))
+			break;
+	}
+	if (!used_limits) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -440,41 +548,44 @@ static slurmdb_used_limits_t *_get_acct_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_mins = xmalloc(i);
 
-		list_append(*acct_limit_list, used_limits);
+		list_append(usage->acct_limit_list, used_limits);
+		_used_limits_hash_add(hash, used_limits, key);
 	}
+	slurm_mutex_unlock(&used_limits_mutex);
 
 	return used_limits;
 }
 
-static int _find_used_limits_for_user(void *x, void *key)
-{
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	uint32_t user_id = *(uint32_t *)key;
-
-	if (used_limits->uid == user_id)
-		return 1;
-
-	return 0;
-}
-
-/* Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+/* Checks for record in qos_ptr->usage->user_limit_list of user_id if
+ * user_limit_list doesn't exist it will create it, if the user_id
  * record doesn't exist it will add it to the list.
  * In all cases the user record is returned.
  */
 static slurmdb_used_limits_t *_get_user_used_limits(
-	List *user_limit_list, uint32_t user_id)
+	slurmdb_qos_rec_t *qos_ptr, uint32_t user_id)
 {
+	slurmdb_qos_usage_t *usage = qos_ptr->usage;
 	slurmdb_used_limits_t *used_limits;
-
-	xassert(user_limit_list);
-
-	if (!*user_limit_list)
-		*user_limit_list = list_create(slurmdb_destroy_used_limits);
-
-	if (!(used_limits = list_find_first(*user_limit_list,
-					    _find_used_limits_for_user,
-					    &user_id))) {
+	qos_limits_index_t *index;
+	used_limits_hash_t *hash;
+	uint32_t inx, key = _user_hash_key(user_id);
+
+	xassert(usage);
+
+	slurm_mutex_lock(&used_limits_mutex);
+	if (!usage->user_limit_list)
+		usage->user_limit_list =
+			list_create(slurmdb_destroy_used_limits);
+	index = _qos_limits_index(qos_ptr->id);
+	hash = _used_limits_hash(&index->user_hash, &index->user_list,
+				 usage->user_limit_list, false);
+
+	for (inx = key & (hash->size - 1); (used_limits = hash->slot[inx]);
+	     inx = (inx + 1) & (hash->size - 1)) {
+		if (used_limits->uid == user_id)
+			break;
+	}
+	if (!used_limits) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -483,8 +594,10 @@ static slurmdb_used_limits_t *_get_user_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_mins = xmalloc(i);
 
-		list_append(*user_limit_list, used_limits);
+		list_append(usage->user_limit_list, used_limits);
+		_used_limits_hash_add(hash, used_limits, key);
 	}
+	slurm_mutex_unlock(&used_limits_mutex);
 
 	return used_limits;
 }
@@ -528,11 +641,10 @@ static void _qos_adjust_limit_usage(int type, struct job_record *job_ptr,
 	if (!qos_ptr || !job_ptr->assoc_ptr)
 		return;
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
+	used_limits_a =	_get_acct_used_limits(qos_ptr,
 					      job_ptr->assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
-					    job_ptr->user_id);
+	used_limits = _get_user_used_limits(qos_ptr, job_ptr->user_id);
 
 	switch(type) {
 	case ACCT_POLICY_ADD_SUBMIT:
@@ -1679,9 +1791,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	if ((qos_out_ptr->max_submit_jobs_pa == INFINITE) &&
 	    (qos_ptr->max_submit_jobs_pa != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
-			_get_acct_used_limits(
-				&qos_ptr->usage->acct_limit_list,
-				assoc_ptr->acct);
+			_get_acct_used_limits(qos_ptr, assoc_ptr->acct);
 
 		qos_out_ptr->max_submit_jobs_pa = qos_ptr->max_submit_jobs_pa;
 
@@ -1701,9 +1811,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	if ((qos_out_ptr->max_submit_jobs_pu == INFINITE) &&
 	    (qos_ptr->max_submit_jobs_pu != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
-			_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
-				job_desc->user_id);
+			_get_user_used_limits(qos_ptr, job_desc->user_id);
 
 		qos_out_ptr->max_submit_jobs_pu = qos_ptr->max_submit_jobs_pu;
 
@@ -1772,11 +1880,9 @@ static int _qos_job_runnable_pre_select(struct job_record *job_ptr,
 
 	wall_mins = qos_ptr->usage->grp_used_wall / 60;
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
-					      assoc_ptr->acct);
+	used_limits_a =	_get_acct_used_limits(qos_ptr, assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
-					    job_ptr->user_id);
+	used_limits = _get_user_used_limits(qos_ptr, job_ptr->user_id);
 
 
 	/* we don't need to check grp_tres_mins here */
@@ -1978,11 +2084,9 @@ static int _qos_job_runnable_post_select(struct job_record *job_ptr,
 			(uint64_t)(qos_ptr->usage->usage_tres_raw[i] / 60.0);
 	}
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
-					      assoc_ptr->acct);
+	used_limits_a =	_get_acct_used_limits(qos_ptr, assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
-					    job_ptr->user_id);
+	used_limits = _get_user_used_limits(qos_ptr, job_ptr->user_id);
 
 	tres_usage = _validate_tres_usage_limits_for_qos(
 		&tres_pos, qos_ptr->grp_tres_mins_ctld,
@@ -2419,6 +2523,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 	switch (tres_usage) {
 	case TRES_USAGE_CUR_EXCEEDS_LIMIT:
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		info("Job %u timed out, "
 		     "the job is at or exceeds QOS %s's "
 		     "group max tres(%s) minutes of %"PRIu64" "
@@ -2448,6 +2553,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 
 		if (wall_mins >= qos_ptr->grp_wall) {
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			info("Job %u timed out, "
 			     "the job is at or exceeds QOS %s's "
 			     "group wall limit of %u with %u",
@@ -2470,6 +2576,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 		break;
 	case TRES_USAGE_REQ_EXCEEDS_LIMIT:
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		info("Job %u timed out, "
 		     "the job is at or exceeds QOS %s's "
 		     "max tres(%s) minutes of %"PRIu64" with %"PRIu64,
@@ -3923,6 +4030,7 @@ extern int acct_policy_update_pending_job(struct job_record *job_ptr)
 
 	if (update_accounting) {
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 		debug("limits changed for job %u: updating accounting",
 		      job_ptr->job_id);
 		/* Update job record in accounting to reflect changes */
@@ -4016,6 +4124,7 @@ extern bool acct_policy_job_time_out(struct job_record *job_ptr)
 		switch (tres_usage) {
 		case TRES_USAGE_CUR_EXCEEDS_LIMIT:
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			info("Job %u timed out, "
 			     "the job is at or exceeds assoc %u(%s/%s/%s) "
 			     "group max tres(%s) minutes of %"PRIu64
@@ -4062,6 +4171,7 @@ extern bool acct_policy_job_time_out(struct job_record *job_ptr)
 			break;
 		case TRES_USAGE_REQ_EXCEEDS_LIMIT:
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			info("Job %u timed out, "
 			     "the job is at or exceeds assoc %u(%s/%s/%s) "
 			     "max tres(%s) minutes of %"PRIu64
@@ -4096,3 +4206,34 @@ job_failed:
 
 	return false;
 }
+
+/*
+ * acct_policy_remove_qos - Free the used limits index of a QOS being
+ *	removed.
+ */
+extern void acct_policy_remove_qos(uint32_t qos_id)
+{
+	slurm_mutex_lock(&used_limits_mutex);
+	if (qos_id < qos_limits_index_cnt) {
+		xfree(qos_limits_index[qos_id].acct_hash);
+		xfree(qos_limits_index[qos_id].user_hash);
+		memset(&qos_limits_index[qos_id], 0,
+		       sizeof(qos_limits_index_t));
+	}
+	slurm_mutex_unlock(&used_limits_mutex);
+}
+
+/* acct_policy_fini - Free the used limits indexes of all QOS */
+extern void acct_policy_fini(void)
+{
+	uint32_t i;
+
+	slurm_mutex_lock(&used_limits_mutex);
+	for (i = 0; i < qos_limits_index_cnt; i++) {
+		xfree(qos_limits_index[i].acct_hash);
+		xfree(qos_limits_index[i].user_hash);
+	}
+	xfree(qos_limits_index);
+	qos_limits_index_cnt = 0;
+	slurm_mutex_unlock(&used_limits_mutex);
+}
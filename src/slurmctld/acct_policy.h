@@ -153,4 +153,13 @@ extern int acct_policy_update_pending_job(struct job_record *job_ptr);
  */
 extern bool acct_policy_job_time_out(struct job_record *job_ptr);
 
+/*
+ * acct_policy_remove_qos - Free the used limits index of a QOS being
+ *	removed.
+ */
+extern void acct_policy_remove_qos(uint32_t qos_id);
+
+/* acct_policy_fini - Free the used limits indexes of all QOS */
+extern void acct_policy_fini(void);
+
 #endif /* !_HAVE_ACCT_POLICY_H */
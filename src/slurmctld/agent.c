@@ -60,6 +60,13 @@
  *
  *  All the state for each thread is maintained in thd_t struct, which is
  *  used by the watchdog thread as well as the communication threads.
+ *
+ *  When the agent_io.c event loops are running (SchedulerParameters
+ *  agent_io_threads, off by default) the agent thread instead packs the
+ *  message once, hands one non-blocking exchange per node to the event
+ *  loops, at most TreeWidth at a time, and processes the responses itself
+ *  as they complete. No watchdog or per node threads are created; timeouts
+ *  are enforced by the loops.
 \*****************************************************************************/
 
 #include "config.h"
@@ -74,6 +81,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -84,14 +92,17 @@
 #include "src/common/macros.h"
 #include "src/common/node_select.h"
 #include "src/common/parse_time.h"
+#include "src/common/slurm_auth.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_interface.h"
+#include "src/common/slurm_protocol_pack.h"
 #include "src/common/uid.h"
 #include "src/common/xsignal.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/slurmctld/agent.h"
+#include "src/slurmctld/agent_io.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/locks.h"
@@ -108,7 +119,8 @@ typedef enum {
 	DSH_DONE,       /* Request completed normally */
 	DSH_NO_RESP,    /* Request timed out */
 	DSH_FAILED,     /* Request resulted in error */
-	DSH_DUP_JOBID	/* Request resulted in duplicate job ID error */
+	DSH_DUP_JOBID,	/* Request resulted in duplicate job ID error */
+	DSH_NOT_SENT	/* Request not sent, slurmctld out of resources */
 } state_t;
 
 typedef struct thd_complete {
@@ -143,6 +155,7 @@ typedef struct agent_info {
 	slurm_msg_type_t msg_type;	/* RPC to be issued */
 	void **msg_args_pptr;		/* RPC data to be used */
 	uint16_t protocol_version;	/* if set, use this version */
+	List io_done;			/* completed agent_io_task_t */
 } agent_info_t;
 
 typedef struct task_info {
@@ -158,6 +171,14 @@ typedef struct task_info {
 	uint16_t protocol_version;	/* if set, use this version */
 } task_info_t;
 
+/* An RPC to one node carried by agent_io.c, see _agent_io_run() */
+typedef struct agent_io_task {
+	agent_io_req_t io;
+	agent_info_t *agent_ptr;
+	int inx;			/* index in thread_struct */
+	struct timeval start;		/* when the RPC was submitted */
+} agent_io_task_t;
+
 typedef struct queued_request {
 	agent_arg_t* agent_arg_ptr;	/* The queued request */
 	time_t       first_attempt;	/* Time of first check for batch
@@ -170,6 +191,7 @@ typedef struct mail_info {
 	char *message;
 } mail_info_t;
 
+static void _agent_io_run(agent_info_t *agent_ptr);
 static void _agent_retry(int min_wait, bool wait_too);
 static int  _batch_launch_defer(queued_request_t *queued_req_ptr);
 static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type);
@@ -245,7 +267,11 @@ void *agent(void *args)
 #endif
 	slurm_mutex_lock(&agent_cnt_mutex);
 
-	rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count, AGENT_THREAD_COUNT);
+	if (agent_io_enabled())
+		rpc_thread_cnt = 1;
+	else
+		rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count,
+					 AGENT_THREAD_COUNT);
 	while (1) {
 		if (slurmctld_config.shutdown_time ||
 		    ((agent_thread_cnt+rpc_thread_cnt) <= MAX_SERVER_THREADS)) {
@@ -320,33 +346,39 @@ void *agent(void *args)
 	agent_info_ptr = _make_agent_info(agent_arg_ptr);
 	thread_ptr = agent_info_ptr->thread_struct;
 
-	/* start the watchdog thread */
-	slurm_thread_create(&thread_wdog, _wdog, agent_info_ptr);
+	if (agent_io_enabled()) {
+		_agent_io_run(agent_info_ptr);
+	} else {
+		/* start the watchdog thread */
+		slurm_thread_create(&thread_wdog, _wdog, agent_info_ptr);
+
+		debug2("got %d threads to send out",
+		       agent_info_ptr->thread_count);
+		/* start all the other threads
+		 * (up to AGENT_THREAD_COUNT active) */
+		for (i = 0; i < agent_info_ptr->thread_count; i++) {
+			/* wait until "room" for another thread */
+			slurm_mutex_lock(&agent_info_ptr->thread_mutex);
+			while (agent_info_ptr->threads_active >=
+			       AGENT_THREAD_COUNT) {
+				slurm_cond_wait(&agent_info_ptr->thread_cond,
+						&agent_info_ptr->thread_mutex);
+			}
 
-	debug2("got %d threads to send out", agent_info_ptr->thread_count);
-	/* start all the other threads (up to AGENT_THREAD_COUNT active) */
-	for (i = 0; i < agent_info_ptr->thread_count; i++) {
-		/* wait until "room" for another thread */
-		slurm_mutex_lock(&agent_info_ptr->thread_mutex);
-		while (agent_info_ptr->threads_active >=
-		       AGENT_THREAD_COUNT) {
-			slurm_cond_wait(&agent_info_ptr->thread_cond,
-					&agent_info_ptr->thread_mutex);
-		}
+			/* create thread specific data, NOTE: freed from
+			 *      _thread_per_group_rpc() */
+			task_specific_ptr = _make_task_data(agent_info_ptr, i);
 
-		/* create thread specific data, NOTE: freed from
-		 *      _thread_per_group_rpc() */
-		task_specific_ptr = _make_task_data(agent_info_ptr, i);
+			slurm_thread_create_detached(&thread_ptr[i].thread,
+						     _thread_per_group_rpc,
+						     task_specific_ptr);
+			agent_info_ptr->threads_active++;
+			slurm_mutex_unlock(&agent_info_ptr->thread_mutex);
+		}
 
-		slurm_thread_create_detached(&thread_ptr[i].thread,
-					     _thread_per_group_rpc,
-					     task_specific_ptr);
-		agent_info_ptr->threads_active++;
-		slurm_mutex_unlock(&agent_info_ptr->thread_mutex);
+		/* Wait for termination of remaining threads */
+		pthread_join(thread_wdog, NULL);
 	}
-
-	/* Wait for termination of remaining threads */
-	pthread_join(thread_wdog, NULL);
 	delay = (int) difftime(time(NULL), begin_time);
 	if (delay > (slurm_get_msg_timeout() * 2)) {
 		info("agent msg_type=%u ran for %d seconds",
@@ -453,10 +485,18 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 		span = set_span(agent_arg_ptr->node_count,
 				agent_arg_ptr->node_count);
 #else
-		/* Sending message to a possibly large number of slurmd.
-		 * Push all message forwarding to slurmd in order to
-		 * offload as much work from slurmctld as possible. */
-		span = set_span(agent_arg_ptr->node_count, 1);
+		if (agent_io_enabled()) {
+			/* The event loops contact every node directly,
+			 * TreeWidth at a time, see _agent_io_run(). */
+			span = set_span(agent_arg_ptr->node_count,
+					agent_arg_ptr->node_count);
+		} else {
+			/* Sending message to a possibly large number of
+			 * slurmd. Push all message forwarding to slurmd in
+			 * order to offload as much work from slurmctld as
+			 * possible. */
+			span = set_span(agent_arg_ptr->node_count, 1);
+		}
 #endif
 		agent_info_ptr->get_reply = true;
 	} else {
@@ -550,6 +590,9 @@ static void _update_wdog_state(thd_t *thread_ptr,
 		thd_comp->no_resp_cnt++;
 		thd_comp->retry_cnt++;
 		break;
+	case DSH_NOT_SENT:
+		thd_comp->retry_cnt++;
+		break;
 	case DSH_FAILED:
 	case DSH_DUP_JOBID:
 		thd_comp->fail_cnt++;
@@ -557,6 +600,74 @@ static void _update_wdog_state(thd_t *thread_ptr,
 	}
 }
 
+/* Return true if the agent's responses are noted by
+ * _notify_slurmctld_jobs() rather than _notify_slurmctld_nodes() */
+static bool _is_srun_agent(slurm_msg_type_t msg_type)
+{
+	return ((msg_type == SRUN_JOB_COMPLETE)			||
+		(msg_type == SRUN_REQUEST_SUSPEND)		||
+		(msg_type == SRUN_STEP_MISSING)			||
+		(msg_type == SRUN_STEP_SIGNAL)			||
+		(msg_type == SRUN_EXEC)				||
+		(msg_type == SRUN_NODE_FAIL)			||
+		(msg_type == SRUN_PING)				||
+		(msg_type == SRUN_TIMEOUT)			||
+		(msg_type == SRUN_USER_MSG)			||
+		(msg_type == RESPONSE_RESOURCE_ALLOCATION)	||
+		(msg_type == RESPONSE_JOB_PACK_ALLOCATION));
+}
+
+/* Tally the state of every node of an agent into thd_comp.
+ * Call with agent_ptr->thread_mutex locked. */
+static void _agent_scan(agent_info_t *agent_ptr, thd_complete_t *thd_comp)
+{
+	thd_t *thread_ptr = agent_ptr->thread_struct;
+	ListIterator itr;
+	ret_data_info_t *ret_data_info = NULL;
+	int i;
+
+	for (i = 0; i < agent_ptr->thread_count; i++) {
+		//info("thread name %s",thread_ptr[i].node_name);
+		if (!thread_ptr[i].ret_list) {
+			_update_wdog_state(&thread_ptr[i],
+					   &thread_ptr[i].state,
+					   thd_comp);
+		} else {
+			itr = list_iterator_create(thread_ptr[i].ret_list);
+			while ((ret_data_info = list_next(itr))) {
+				_update_wdog_state(&thread_ptr[i],
+						   &ret_data_info->err,
+						   thd_comp);
+			}
+			list_iterator_destroy(itr);
+		}
+	}
+}
+
+/* Report the results of a completed agent to slurmctld and release the
+ * per node data. Call with agent_ptr->thread_mutex locked. */
+static void _agent_done(agent_info_t *agent_ptr, thd_complete_t *thd_comp)
+{
+	thd_t *thread_ptr = agent_ptr->thread_struct;
+	int i;
+
+	if (_is_srun_agent(agent_ptr->msg_type)) {
+		_notify_slurmctld_jobs(agent_ptr);
+	} else {
+		_notify_slurmctld_nodes(agent_ptr,
+					thd_comp->no_resp_cnt,
+					thd_comp->retry_cnt);
+	}
+
+	for (i = 0; i < agent_ptr->thread_count; i++) {
+		FREE_NULL_LIST(thread_ptr[i].ret_list);
+		xfree(thread_ptr[i].nodelist);
+	}
+
+	if (thd_comp->max_delay)
+		debug2("agent maximum delay %d seconds", thd_comp->max_delay);
+}
+
 /*
  * _wdog - Watchdog thread. Send SIGUSR1 to threads which have been active
  *	for too long.
@@ -565,27 +676,9 @@ static void _update_wdog_state(thd_t *thread_ptr,
  */
 void *_wdog(void *args)
 {
-	bool srun_agent = false;
-	int i;
 	agent_info_t *agent_ptr = (agent_info_t *) args;
-	thd_t *thread_ptr = agent_ptr->thread_struct;
 	unsigned long usec = 5000;
-	ListIterator itr;
 	thd_complete_t thd_comp;
-	ret_data_info_t *ret_data_info = NULL;
-
-	if ( (agent_ptr->msg_type == SRUN_JOB_COMPLETE)			||
-	     (agent_ptr->msg_type == SRUN_REQUEST_SUSPEND)		||
-	     (agent_ptr->msg_type == SRUN_STEP_MISSING)			||
-	     (agent_ptr->msg_type == SRUN_STEP_SIGNAL)			||
-	     (agent_ptr->msg_type == SRUN_EXEC)				||
-	     (agent_ptr->msg_type == SRUN_NODE_FAIL)			||
-	     (agent_ptr->msg_type == SRUN_PING)				||
-	     (agent_ptr->msg_type == SRUN_TIMEOUT)			||
-	     (agent_ptr->msg_type == SRUN_USER_MSG)			||
-	     (agent_ptr->msg_type == RESPONSE_RESOURCE_ALLOCATION)	||
-	     (agent_ptr->msg_type == RESPONSE_JOB_PACK_ALLOCATION) )
-		srun_agent = true;
 
 	thd_comp.max_delay = 0;
 
@@ -603,44 +696,14 @@ void *_wdog(void *args)
 		usec = MIN((usec * 2), 1000000);
 
 		slurm_mutex_lock(&agent_ptr->thread_mutex);
-		for (i = 0; i < agent_ptr->thread_count; i++) {
-			//info("thread name %s",thread_ptr[i].node_name);
-			if (!thread_ptr[i].ret_list) {
-				_update_wdog_state(&thread_ptr[i],
-						   &thread_ptr[i].state,
-						   &thd_comp);
-			} else {
-				itr = list_iterator_create(
-					thread_ptr[i].ret_list);
-				while ((ret_data_info = list_next(itr))) {
-					_update_wdog_state(&thread_ptr[i],
-							   &ret_data_info->err,
-							   &thd_comp);
-				}
-				list_iterator_destroy(itr);
-			}
-		}
+		_agent_scan(agent_ptr, &thd_comp);
 		if (thd_comp.work_done)
 			break;
 
 		slurm_mutex_unlock(&agent_ptr->thread_mutex);
 	}
 
-	if (srun_agent) {
-		_notify_slurmctld_jobs(agent_ptr);
-	} else {
-		_notify_slurmctld_nodes(agent_ptr,
-					thd_comp.no_resp_cnt,
-					thd_comp.retry_cnt);
-	}
-
-	for (i = 0; i < agent_ptr->thread_count; i++) {
-		FREE_NULL_LIST(thread_ptr[i].ret_list);
-		xfree(thread_ptr[i].nodelist);
-	}
-
-	if (thd_comp.max_delay)
-		debug2("agent maximum delay %d seconds", thd_comp.max_delay);
+	_agent_done(agent_ptr, &thd_comp);
 
 	slurm_mutex_unlock(&agent_ptr->thread_mutex);
 	pthread_exit(NULL);
@@ -783,6 +846,9 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 			case DSH_DONE:
 				node_did_resp(node_names);
 				break;
+			case DSH_NOT_SENT:
+				/* The node was never contacted */
+				break;
 			default:
 				error("unknown state returned for %s",
 				      node_names);
@@ -824,6 +890,20 @@ static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type)
 	return rc;
 }
 
+/* Return true if msg_type is an RPC to srun rather than to slurmd */
+static bool _is_srun_rpc(slurm_msg_type_t msg_type)
+{
+	return ((msg_type == SRUN_PING)			||
+		(msg_type == SRUN_EXEC)			||
+		(msg_type == SRUN_JOB_COMPLETE)		||
+		(msg_type == SRUN_STEP_MISSING)		||
+		(msg_type == SRUN_STEP_SIGNAL)		||
+		(msg_type == SRUN_TIMEOUT)		||
+		(msg_type == SRUN_USER_MSG)		||
+		(msg_type == RESPONSE_RESOURCE_ALLOCATION) ||
+		(msg_type == SRUN_NODE_FAIL));
+}
+
 /* return a value for which WEXITSTATUS() returns 1 */
 static int _wif_status(void)
 {
@@ -845,32 +925,21 @@ static int _wif_status(void)
 }
 
 /*
- * _thread_per_group_rpc - thread to issue an RPC for a group of nodes
- *                         sending message out to one and forwarding it to
- *                         others if necessary.
- * IN/OUT args - pointer to task_info_t, xfree'd on completion
+ * _proc_ret_list - process the responses to an RPC sent to a group of nodes
+ *	and record each node's state in its ret_data_info->err
+ * IN msg_type - RPC issued
+ * IN msg_args - RPC data
+ * IN/OUT ret_list - responses, see slurm_send_recv_msgs()
+ * IN thread_state - group state if no response changes it
+ * RET state of the group
  */
-static void *_thread_per_group_rpc(void *args)
+static state_t _proc_ret_list(slurm_msg_type_t msg_type, void *msg_args,
+			      List ret_list, state_t thread_state)
 {
-	int rc = SLURM_SUCCESS;
-	slurm_msg_t msg;
-	task_info_t *task_ptr = (task_info_t *) args;
-	/* we cache some pointers from task_info_t because we need
-	 * to xfree args before being finished with their use. xfree
-	 * is required for timely termination of this pthread because
-	 * xfree could lock it at the end, preventing a timely
-	 * thread_exit */
-	pthread_mutex_t *thread_mutex_ptr   = task_ptr->thread_mutex_ptr;
-	pthread_cond_t  *thread_cond_ptr    = task_ptr->thread_cond_ptr;
-	uint32_t        *threads_active_ptr = task_ptr->threads_active_ptr;
-	thd_t           *thread_ptr         = task_ptr->thread_struct_ptr;
-	state_t thread_state = DSH_NO_RESP;
-	slurm_msg_type_t msg_type = task_ptr->msg_type;
+	int rc;
 	bool is_kill_msg, srun_agent;
-	List ret_list = NULL;
 	ListIterator itr;
 	ret_data_info_t *ret_data_info = NULL;
-	int sig_array[2] = {SIGUSR1, 0};
 	/* Locks: Write job, write node */
 	slurmctld_lock_t job_write_lock = {
 		NO_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
@@ -882,90 +951,11 @@ static void *_thread_per_group_rpc(void *args)
 		NO_LOCK, NO_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
 	uint32_t job_id;
 
-	xassert(args != NULL);
-	xsignal(SIGUSR1, _sig_handler);
-	xsignal_unblock(sig_array);
 	is_kill_msg = (	(msg_type == REQUEST_KILL_TIMELIMIT)	||
 			(msg_type == REQUEST_KILL_PREEMPTED)	||
 			(msg_type == REQUEST_TERMINATE_JOB) );
-	srun_agent = (	(msg_type == SRUN_PING)			||
-			(msg_type == SRUN_EXEC)			||
-			(msg_type == SRUN_JOB_COMPLETE)		||
-			(msg_type == SRUN_STEP_MISSING)		||
-			(msg_type == SRUN_STEP_SIGNAL)		||
-			(msg_type == SRUN_TIMEOUT)		||
-			(msg_type == SRUN_USER_MSG)		||
-			(msg_type == RESPONSE_RESOURCE_ALLOCATION) ||
-			(msg_type == SRUN_NODE_FAIL) );
-
-	thread_ptr->start_time = time(NULL);
-
-	slurm_mutex_lock(thread_mutex_ptr);
-	thread_ptr->state = DSH_ACTIVE;
-	thread_ptr->end_time = thread_ptr->start_time + message_timeout;
-	slurm_mutex_unlock(thread_mutex_ptr);
-
-	/* send request message */
-	slurm_msg_t_init(&msg);
-
-	if (task_ptr->protocol_version)
-		msg.protocol_version = task_ptr->protocol_version;
-
-	msg.msg_type = msg_type;
-	msg.data     = task_ptr->msg_args_ptr;
-#if 0
- 	info("sending message type %u to %s", msg_type, thread_ptr->nodelist);
-#endif
-	if (task_ptr->get_reply) {
-		if (thread_ptr->addr) {
-			msg.address = *thread_ptr->addr;
-
-			if (!(ret_list = slurm_send_addr_recv_msgs(
-				     &msg, thread_ptr->nodelist, 0))) {
-				error("_thread_per_group_rpc: "
-				      "no ret_list given");
-				goto cleanup;
-			}
+	srun_agent = _is_srun_rpc(msg_type);
 
-
-		} else {
-			if (!(ret_list = slurm_send_recv_msgs(
-				     thread_ptr->nodelist,
-				     &msg, 0, true))) {
-				error("_thread_per_group_rpc: "
-				      "no ret_list given");
-				goto cleanup;
-			}
-		}
-	} else {
-		if (thread_ptr->addr) {
-			//info("got the address");
-			msg.address = *thread_ptr->addr;
-		} else {
-			//info("no address given");
-			if (slurm_conf_get_addr(thread_ptr->nodelist,
-					       &msg.address) == SLURM_ERROR) {
-				error("_thread_per_group_rpc: "
-				      "can't find address for host %s, "
-				      "check slurm.conf",
-				      thread_ptr->nodelist);
-				goto cleanup;
-			}
-		}
-		//info("sending %u to %s", msg_type, thread_ptr->nodelist);
-		if (slurm_send_only_node_msg(&msg) == SLURM_SUCCESS) {
-			thread_state = DSH_DONE;
-		} else {
-			if (!srun_agent) {
-				lock_slurmctld(node_read_lock);
-				_comm_err(thread_ptr->nodelist, msg_type);
-				unlock_slurmctld(node_read_lock);
-			}
-		}
-		goto cleanup;
-	}
-
-	//info("got %d messages back", list_count(ret_list));
 	itr = list_iterator_create(ret_list);
 	while ((ret_data_info = list_next(itr)) != NULL) {
 		rc = slurm_get_return_code(ret_data_info->type,
@@ -987,7 +977,7 @@ static void *_thread_per_group_rpc(void *args)
 		    (rc == ESLURMD_KILL_JOB_ALREADY_COMPLETE)) {
 			kill_job_msg_t *kill_job;
 			kill_job = (kill_job_msg_t *)
-				task_ptr->msg_args_ptr;
+				msg_args;
 			rc = SLURM_SUCCESS;
 			lock_slurmctld(job_write_lock);
 			if (job_epilog_complete(kill_job->job_id,
@@ -1013,7 +1003,7 @@ static void *_thread_per_group_rpc(void *args)
 		    (rc != ESLURM_DUPLICATE_JOB_ID) &&
 		    (ret_data_info->type != RESPONSE_FORWARD_FAILED)) {
 			batch_job_launch_msg_t *launch_msg_ptr =
-				task_ptr->msg_args_ptr;
+				msg_args;
 			uint32_t job_id = launch_msg_ptr->job_id;
 			info("Killing non-startable batch job %u: %s",
 			     job_id, slurm_strerror(rc));
@@ -1030,7 +1020,7 @@ static void *_thread_per_group_rpc(void *args)
 			 * Cancel rather than leave a stray-but-empty job
 			 * behind on the allocated nodes. */
 			resource_allocation_response_msg_t *msg_ptr =
-				task_ptr->msg_args_ptr;
+				msg_args;
 			job_id = msg_ptr->job_id;
 			info("Killing interactive job %u: %s",
 			     job_id, slurm_strerror(rc));
@@ -1045,7 +1035,7 @@ static void *_thread_per_group_rpc(void *args)
 			/* Communication issue to srun that launched the job
 			 * Cancel rather than leave a stray-but-empty job
 			 * behind on the allocated nodes. */
-			List pack_alloc_list = task_ptr->msg_args_ptr;
+			List pack_alloc_list = msg_args;
 			resource_allocation_response_msg_t *msg_ptr;
 			if (!pack_alloc_list ||
 			    (list_count(pack_alloc_list) == 0))
@@ -1132,6 +1122,112 @@ static void *_thread_per_group_rpc(void *args)
 	}
 	list_iterator_destroy(itr);
 
+	return thread_state;
+}
+
+/*
+ * _thread_per_group_rpc - thread to issue an RPC for a group of nodes
+ *                         sending message out to one and forwarding it to
+ *                         others if necessary.
+ * IN/OUT args - pointer to task_info_t, xfree'd on completion
+ */
+static void *_thread_per_group_rpc(void *args)
+{
+	slurm_msg_t msg;
+	task_info_t *task_ptr = (task_info_t *) args;
+	/* we cache some pointers from task_info_t because we need
+	 * to xfree args before being finished with their use. xfree
+	 * is required for timely termination of this pthread because
+	 * xfree could lock it at the end, preventing a timely
+	 * thread_exit */
+	pthread_mutex_t *thread_mutex_ptr   = task_ptr->thread_mutex_ptr;
+	pthread_cond_t  *thread_cond_ptr    = task_ptr->thread_cond_ptr;
+	uint32_t        *threads_active_ptr = task_ptr->threads_active_ptr;
+	thd_t           *thread_ptr         = task_ptr->thread_struct_ptr;
+	state_t thread_state = DSH_NO_RESP;
+	slurm_msg_type_t msg_type = task_ptr->msg_type;
+	bool srun_agent;
+	List ret_list = NULL;
+	int sig_array[2] = {SIGUSR1, 0};
+	/* Lock: Read node */
+	slurmctld_lock_t node_read_lock = {
+		NO_LOCK, NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
+
+	xassert(args != NULL);
+	xsignal(SIGUSR1, _sig_handler);
+	xsignal_unblock(sig_array);
+	srun_agent = _is_srun_rpc(msg_type);
+
+	thread_ptr->start_time = time(NULL);
+
+	slurm_mutex_lock(thread_mutex_ptr);
+	thread_ptr->state = DSH_ACTIVE;
+	thread_ptr->end_time = thread_ptr->start_time + message_timeout;
+	slurm_mutex_unlock(thread_mutex_ptr);
+
+	/* send request message */
+	slurm_msg_t_init(&msg);
+
+	if (task_ptr->protocol_version)
+		msg.protocol_version = task_ptr->protocol_version;
+
+	msg.msg_type = msg_type;
+	msg.data     = task_ptr->msg_args_ptr;
+#if 0
+ 	info("sending message type %u to %s", msg_type, thread_ptr->nodelist);
+#endif
+	if (task_ptr->get_reply) {
+		if (thread_ptr->addr) {
+			msg.address = *thread_ptr->addr;
+
+			if (!(ret_list = slurm_send_addr_recv_msgs(
+				     &msg, thread_ptr->nodelist, 0))) {
+				error("_thread_per_group_rpc: "
+				      "no ret_list given");
+				goto cleanup;
+			}
+
+
+		} else {
+			if (!(ret_list = slurm_send_recv_msgs(
+				     thread_ptr->nodelist,
+				     &msg, 0, true))) {
+				error("_thread_per_group_rpc: "
+				      "no ret_list given");
+				goto cleanup;
+			}
+		}
+	} else {
+		if (thread_ptr->addr) {
+			//info("got the address");
+			msg.address = *thread_ptr->addr;
+		} else {
+			//info("no address given");
+			if (slurm_conf_get_addr(thread_ptr->nodelist,
+					       &msg.address) == SLURM_ERROR) {
+				error("_thread_per_group_rpc: "
+				      "can't find address for host %s, "
+				      "check slurm.conf",
+				      thread_ptr->nodelist);
+				goto cleanup;
+			}
+		}
+		//info("sending %u to %s", msg_type, thread_ptr->nodelist);
+		if (slurm_send_only_node_msg(&msg) == SLURM_SUCCESS) {
+			thread_state = DSH_DONE;
+		} else {
+			if (!srun_agent) {
+				lock_slurmctld(node_read_lock);
+				_comm_err(thread_ptr->nodelist, msg_type);
+				unlock_slurmctld(node_read_lock);
+			}
+		}
+		goto cleanup;
+	}
+
+	thread_state = _proc_ret_list(msg_type, task_ptr->msg_args_ptr,
+				      ret_list, thread_state);
+
 cleanup:
 	xfree(args);
 
@@ -1150,6 +1246,206 @@ cleanup:
 	return (void *) NULL;
 }
 
+/* agent_io_req_t.done: queue the completed RPC for the agent thread */
+static void _agent_io_done(agent_io_req_t *req)
+{
+	agent_io_task_t *task = (agent_io_task_t *) req->arg;
+	agent_info_t *agent_ptr = task->agent_ptr;
+
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	list_append(agent_ptr->io_done, task);
+	slurm_cond_signal(&agent_ptr->thread_cond);
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+}
+
+/* Process one node's completed RPC as _thread_per_group_rpc() would */
+static void _agent_io_finish(agent_info_t *agent_ptr, agent_io_task_t *task)
+{
+	thd_t *thread_ptr = &agent_ptr->thread_struct[task->inx];
+	state_t thread_state = DSH_NO_RESP;
+	List ret_list = NULL;
+	ret_data_info_t *ret_data_info;
+	slurm_msg_t resp;
+	int rc = task->io.rc;
+	/* Lock: Read node */
+	slurmctld_lock_t node_read_lock = {
+		NO_LOCK, NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
+
+	if (task->io.not_sent) {
+		/* Our failure, not the node's: retry it if the agent
+		 * retries, but do not report it as not responding */
+		error("agent: %s RPC to %s not sent, out of file descriptors",
+		      rpc_num2string(agent_ptr->msg_type),
+		      thread_ptr->nodelist);
+		thread_state = DSH_NOT_SENT;
+	} else if (!agent_ptr->get_reply) {
+		if (rc == SLURM_SUCCESS) {
+			thread_state = DSH_DONE;
+		} else if ((rc != SLURM_UNKNOWN_FORWARD_ADDR) &&
+			   !_is_srun_rpc(agent_ptr->msg_type)) {
+			errno = rc;
+			lock_slurmctld(node_read_lock);
+			_comm_err(thread_ptr->nodelist, agent_ptr->msg_type);
+			unlock_slurmctld(node_read_lock);
+		}
+	} else {
+		slurm_msg_t_init(&resp);
+		if ((rc == SLURM_SUCCESS) &&
+		    (slurm_unpack_received_msg(&resp, -1, task->io.reply) < 0))
+			rc = errno ? errno : SLURM_COMMUNICATIONS_RECEIVE_ERROR;
+		if (rc == SLURM_SUCCESS) {
+			ret_list = list_create(destroy_data_info);
+			ret_data_info = xmalloc(sizeof(ret_data_info_t));
+			ret_data_info->node_name = xstrdup(thread_ptr->nodelist);
+			ret_data_info->type = resp.msg_type;
+			ret_data_info->data = resp.data;
+			list_push(ret_list, ret_data_info);
+		} else {
+			mark_as_failed_forward(&ret_list, thread_ptr->nodelist,
+					       rc);
+		}
+		if (resp.auth_cred)
+			(void) g_slurm_auth_destroy(resp.auth_cred);
+		thread_state = _proc_ret_list(agent_ptr->msg_type,
+					      *agent_ptr->msg_args_pptr,
+					      ret_list, thread_state);
+	}
+	/* Let forwarding trees learn from direct RPCs to nodes too */
+	if (!thread_ptr->addr && !task->io.not_sent &&
+	    (rc != SLURM_UNKNOWN_FORWARD_ADDR)) {
+		struct timeval now;
+
+		gettimeofday(&now, NULL);
+		forward_node_stat(thread_ptr->nodelist,
+				  (now.tv_sec - task->start.tv_sec) * 1000000 +
+				  (now.tv_usec - task->start.tv_usec),
+				  (rc == SLURM_SUCCESS));
+	}
+	free_buf(task->io.head);
+	free_buf(task->io.reply);
+	task->io.head = task->io.reply = NULL;
+
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	thread_ptr->ret_list = ret_list;
+	thread_ptr->state = thread_state;
+	thread_ptr->end_time = (time_t) difftime(time(NULL),
+						 thread_ptr->start_time);
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+}
+
+/* Start the RPC to one node, _agent_io_done() is called when it completes */
+static void _agent_io_start(agent_info_t *agent_ptr, agent_io_task_t *task,
+			    slurm_msg_t *msg, uint32_t body_len)
+{
+	thd_t *thread_ptr = &agent_ptr->thread_struct[task->inx];
+
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	thread_ptr->start_time = time(NULL);
+	thread_ptr->state = DSH_ACTIVE;
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+
+	if (thread_ptr->addr) {
+		task->io.addr = *thread_ptr->addr;
+	} else if (slurm_conf_get_addr(thread_ptr->nodelist,
+				       &task->io.addr) == SLURM_ERROR) {
+		error("%s: can't find address for host %s, check slurm.conf",
+		      __func__, thread_ptr->nodelist);
+		task->io.rc = SLURM_UNKNOWN_FORWARD_ADDR;
+		_agent_io_done(&task->io);
+		return;
+	}
+	if (!(task->io.head = slurm_pack_msg_head(msg, body_len))) {
+		task->io.rc = SLURM_PROTOCOL_AUTHENTICATION_ERROR;
+		_agent_io_done(&task->io);
+		return;
+	}
+	gettimeofday(&task->start, NULL);
+	agent_io_submit(&task->io);
+}
+
+/*
+ * _agent_io_run - issue the agent's RPC to every node through the agent_io.c
+ *	event loops, process the responses as they arrive, then notify
+ *	slurmctld as _wdog() does. The message body is packed once and shared,
+ *	each node gets its own header and credential. At most TreeWidth RPCs
+ *	are in flight, the others wait for one of them to complete.
+ */
+static void _agent_io_run(agent_info_t *agent_ptr)
+{
+	agent_io_task_t *tasks, *task;
+	thd_complete_t thd_comp;
+	slurm_msg_t msg;
+	Buf body_buf = NULL;
+	char *body = NULL;
+	uint32_t body_len = 0;
+	int i, next = 0, pending = 0, max_pending;
+	int timeout = slurm_get_msg_timeout() * 1000;
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = agent_ptr->msg_type;
+	msg.data     = *agent_ptr->msg_args_pptr;
+	/* The body is packed before init_header() would set this */
+	if (agent_ptr->protocol_version)
+		msg.protocol_version = agent_ptr->protocol_version;
+	else
+		msg.protocol_version = SLURM_PROTOCOL_VERSION;
+	if (!pack_msg_data_ref(&msg, &body, &body_len)) {
+		body_buf = init_buf(BUF_SIZE);
+		pack_msg(&msg, body_buf);
+		body = get_buf_data(body_buf);
+		body_len = get_buf_offset(body_buf);
+	}
+
+	debug2("got %d RPCs to send out", agent_ptr->thread_count);
+	max_pending = MAX(slurm_get_tree_width(), 1);
+	agent_ptr->io_done = list_create(NULL);
+	tasks = xmalloc(sizeof(agent_io_task_t) * agent_ptr->thread_count);
+	for (i = 0; i < agent_ptr->thread_count; i++) {
+		task = &tasks[i];
+		task->agent_ptr = agent_ptr;
+		task->inx = i;
+		task->io.body = body;
+		task->io.body_len = body_len;
+		task->io.get_reply = agent_ptr->get_reply;
+		task->io.timeout = timeout;
+		task->io.done = _agent_io_done;
+		task->io.arg = task;
+	}
+
+	while ((next < agent_ptr->thread_count) || pending) {
+		while ((next < agent_ptr->thread_count) &&
+		       (pending < max_pending)) {
+			_agent_io_start(agent_ptr, &tasks[next++], &msg,
+					body_len);
+			pending++;
+		}
+
+		slurm_mutex_lock(&agent_ptr->thread_mutex);
+		while (!(task = list_dequeue(agent_ptr->io_done))) {
+			slurm_cond_wait(&agent_ptr->thread_cond,
+					&agent_ptr->thread_mutex);
+		}
+		slurm_mutex_unlock(&agent_ptr->thread_mutex);
+		_agent_io_finish(agent_ptr, task);
+		pending--;
+	}
+
+	thd_comp.work_done   = true;
+	thd_comp.fail_cnt    = 0;
+	thd_comp.no_resp_cnt = 0;
+	thd_comp.retry_cnt   = 0;
+	thd_comp.max_delay   = 0;
+	thd_comp.now         = time(NULL);
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	_agent_scan(agent_ptr, &thd_comp);
+	_agent_done(agent_ptr, &thd_comp);
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+
+	FREE_NULL_LIST(agent_ptr->io_done);
+	xfree(tasks);
+	free_buf(body_buf);
+}
+
 /*
  * Signal handler.  We are really interested in interrupting hung communictions
  * and causing them to return EINTR. Multiple interupts might be required.
@@ -1234,7 +1530,8 @@ static void _queue_agent_retry(agent_info_t * agent_info_ptr, int count)
 	j = 0;
 	for (i = 0; i < agent_info_ptr->thread_count; i++) {
 		if (!thread_ptr[i].ret_list) {
-			if (thread_ptr[i].state != DSH_NO_RESP)
+			if ((thread_ptr[i].state != DSH_NO_RESP) &&
+			    (thread_ptr[i].state != DSH_NOT_SENT))
 				continue;
 
 			debug("got the name %s to resend",
@@ -1343,6 +1640,21 @@ static void *_agent_init(void *arg)
 
 extern void agent_init(void)
 {
+	char *sched_params, *tmp_ptr;
+	int io_threads = AGENT_IO_THREADS;
+
+	sched_params = slurm_get_sched_params();
+	if ((tmp_ptr = xstrcasestr(sched_params, "agent_io_threads="))) {
+		io_threads = atoi(tmp_ptr + 17);
+		if (io_threads < 0) {
+			error("Invalid SchedulerParameters agent_io_threads: %d",
+			      io_threads);
+			io_threads = AGENT_IO_THREADS;
+		}
+	}
+	xfree(sched_params);
+	agent_io_init(io_threads);
+
 	slurm_mutex_lock(&pending_mutex);
 	if (pending_thread_running) {
 		error("%s: thread already running", __func__);
@@ -0,0 +1,560 @@
+/*****************************************************************************\
+ *  agent_io.c - event driven transport for the slurmctld agent
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+/*
+ * A few event loop threads carry every agent RPC. Each loop owns an epoll
+ * set of non-blocking connections and moves them through connect, send and
+ * (if a reply is wanted) receive as the sockets become ready, so the thread
+ * count no longer grows with the count of nodes being contacted.
+ *
+ * Per message timeouts live in a timer wheel of AGENT_IO_SLOTS slots of
+ * AGENT_IO_TICK msec. A connection is linked into the slot of its expiration
+ * time; each pass of the loop scans only the slots whose tick has elapsed,
+ * skipping entries due on a later turn of the wheel. A refused connect is
+ * retried every AGENT_IO_CONN_RETRY msec until the message times out, as
+ * slurm_send_addr_recv_msgs() does for slurmd restarts. A socket which can
+ * not be created for lack of file descriptors is retried the same way, and
+ * reported as not sent rather than as a node failure.
+ *
+ * Loops never take slurmctld locks or verify credentials: completions are
+ * handed back through req->done() and unpacked by the agent.
+ */
+
+#include "config.h"
+
+#if HAVE_SYS_PRCTL_H
+#  include <sys/prctl.h>
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/fd.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmctld/agent_io.h"
+
+#define AGENT_IO_TICK		100	/* timer wheel resolution, msec */
+#define AGENT_IO_SLOTS		512	/* timer wheel size, ~51 seconds */
+#define AGENT_IO_CONN_RETRY	1000	/* delay before reconnect, msec */
+#define MAX_EVENTS		64
+/* same limit as slurm_msg_recvfrom_timeout() */
+#define MAX_MSG_SIZE		(1024*1024*1024)
+
+typedef enum {
+	IO_CONNECT,		/* waiting for connect() to complete */
+	IO_SEND,		/* writing head and body */
+	IO_RECV,		/* reading the reply */
+	IO_RETRY		/* connect refused or no socket, waiting to
+				 * retry */
+} io_state_t;
+
+typedef struct io_conn {
+	struct io_conn *next, *prev;	/* timer wheel slot or new list */
+	agent_io_req_t *req;
+	io_state_t state;
+	int fd;
+	bool no_fd;		/* last socket() failed for lack of fds */
+	int slot;		/* timer wheel slot, -1 if not linked */
+	int64_t deadline;	/* message timeout, msec */
+	int64_t wake;		/* timer expiration, msec */
+	uint32_t sent;		/* bytes of head and body written */
+	uint32_t msglen;	/* reply length prefix, network byte order */
+	uint32_t len_got;	/* bytes of msglen read */
+	Buf reply;
+	uint32_t reply_got;	/* bytes of reply read */
+} io_conn_t;
+
+typedef struct {
+	int epfd;
+	int wake_fd[2];		/* written by agent_io_submit() */
+	pthread_mutex_t mutex;	/* protects new_conns */
+	io_conn_t *new_conns;	/* submitted but not started */
+	io_conn_t *wheel[AGENT_IO_SLOTS];
+	int64_t tick;		/* last tick scanned */
+} io_loop_t;
+
+static pthread_mutex_t init_mutex = PTHREAD_MUTEX_INITIALIZER;
+static io_loop_t *loops = NULL;
+static int loop_cnt = 0;
+static uint32_t next_loop = 0;
+
+static int64_t _now_msec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((int64_t) ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static void _timer_del(io_loop_t *loop, io_conn_t *conn)
+{
+	if (conn->slot < 0)
+		return;
+	if (conn->prev)
+		conn->prev->next = conn->next;
+	else
+		loop->wheel[conn->slot] = conn->next;
+	if (conn->next)
+		conn->next->prev = conn->prev;
+	conn->next = conn->prev = NULL;
+	conn->slot = -1;
+}
+
+static void _timer_set(io_loop_t *loop, io_conn_t *conn, int64_t wake)
+{
+	/* A timer already due goes in the slot scanned next */
+	int slot = MAX((wake / AGENT_IO_TICK), loop->tick) % AGENT_IO_SLOTS;
+
+	_timer_del(loop, conn);
+	conn->wake = wake;
+	conn->slot = slot;
+	conn->prev = NULL;
+	conn->next = loop->wheel[slot];
+	if (conn->next)
+		conn->next->prev = conn;
+	loop->wheel[slot] = conn;
+}
+
+/* Complete a request and release its connection */
+static void _conn_done(io_loop_t *loop, io_conn_t *conn, int rc)
+{
+	agent_io_req_t *req = conn->req;
+
+	_timer_del(loop, conn);
+	if (conn->fd >= 0) {
+		(void) epoll_ctl(loop->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+		(void) close(conn->fd);
+	}
+	req->rc = rc;
+	req->not_sent = (rc != SLURM_SUCCESS) && conn->no_fd;
+	if (rc == SLURM_SUCCESS) {
+		req->reply = conn->reply;
+	} else {
+		free_buf(conn->reply);
+		req->reply = NULL;
+	}
+	xfree(conn);
+	req->done(req);
+}
+
+/* Connect refused, the slurmd may be restarting, or no socket: retry until
+ * timeout */
+static void _conn_refused(io_loop_t *loop, io_conn_t *conn, int64_t now)
+{
+	if ((now + AGENT_IO_CONN_RETRY) >= conn->deadline) {
+		_conn_done(loop, conn, SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		return;
+	}
+	if (conn->fd >= 0) {
+		(void) epoll_ctl(loop->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+		(void) close(conn->fd);
+		conn->fd = -1;
+	}
+	conn->state = IO_RETRY;
+	_timer_set(loop, conn, now + AGENT_IO_CONN_RETRY);
+}
+
+static void _conn_start(io_loop_t *loop, io_conn_t *conn, int64_t now)
+{
+	struct epoll_event ev;
+	agent_io_req_t *req = conn->req;
+
+	if ((conn->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0) {
+		if ((errno == EMFILE) || (errno == ENFILE) ||
+		    (errno == ENOBUFS) || (errno == ENOMEM)) {
+			/* Wait for other connections to close */
+			if (!conn->no_fd)
+				debug("%s: socket: %m, will retry", __func__);
+			conn->no_fd = true;
+			_conn_refused(loop, conn, now);
+			return;
+		}
+		error("%s: socket: %m", __func__);
+		_conn_done(loop, conn, SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		return;
+	}
+	conn->no_fd = false;
+	fd_set_nonblocking(conn->fd);
+	fd_set_close_on_exec(conn->fd);
+
+	conn->state = IO_SEND;
+	if (connect(conn->fd, (struct sockaddr *) &req->addr,
+		    sizeof(req->addr)) < 0) {
+		if (errno != EINPROGRESS) {
+			if (errno == ECONNREFUSED) {
+				_conn_refused(loop, conn, now);
+			} else {
+				_conn_done(loop, conn,
+					   SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+			}
+			return;
+		}
+		conn->state = IO_CONNECT;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLOUT;
+	ev.data.ptr = conn;
+	if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, conn->fd, &ev) < 0) {
+		error("%s: epoll_ctl: %m", __func__);
+		_conn_done(loop, conn, SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		return;
+	}
+	_timer_set(loop, conn, conn->deadline);
+}
+
+/* RET 1 when everything is written, 0 to wait, -1 on error */
+static int _conn_send(io_conn_t *conn)
+{
+	agent_io_req_t *req = conn->req;
+	uint32_t head_len = get_buf_offset(req->head);
+	uint32_t total = head_len + req->body_len, off;
+	struct iovec iov[2];
+	struct msghdr mh;
+	ssize_t len;
+
+	while (conn->sent < total) {
+		memset(&mh, 0, sizeof(mh));
+		mh.msg_iov = iov;
+		if (conn->sent < head_len) {
+			iov[0].iov_base = get_buf_data(req->head) + conn->sent;
+			iov[0].iov_len  = head_len - conn->sent;
+			mh.msg_iovlen = 1;
+			off = 0;
+		} else
+			off = conn->sent - head_len;
+		if (off < req->body_len) {
+			iov[mh.msg_iovlen].iov_base = req->body + off;
+			iov[mh.msg_iovlen].iov_len  = req->body_len - off;
+			mh.msg_iovlen++;
+		}
+
+		/* MSG_NOSIGNAL: the peer may close, no SIGPIPE please */
+		len = sendmsg(conn->fd, &mh, MSG_NOSIGNAL);
+		if (len > 0) {
+			conn->sent += len;
+			continue;
+		}
+		if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+				  (errno == EINTR)))
+			return 0;
+		debug("%s: send error after %u of %u bytes: %m",
+		      __func__, conn->sent, total);
+		return -1;
+	}
+	return 1;
+}
+
+/* RET 1 when the reply is complete, 0 to wait, -1 on error */
+static int _conn_recv(io_conn_t *conn)
+{
+	ssize_t len;
+
+	while (conn->len_got < sizeof(conn->msglen)) {
+		len = recv(conn->fd, ((char *) &conn->msglen) + conn->len_got,
+			   sizeof(conn->msglen) - conn->len_got, 0);
+		if (len > 0) {
+			conn->len_got += len;
+			continue;
+		}
+		if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+				  (errno == EINTR)))
+			return 0;
+		return -1;
+	}
+
+	if (!conn->reply) {
+		conn->msglen = ntohl(conn->msglen);
+		if ((conn->msglen == 0) || (conn->msglen > MAX_MSG_SIZE)) {
+			error("%s: invalid message length %u",
+			      __func__, conn->msglen);
+			return -1;
+		}
+		conn->reply = init_buf(conn->msglen);
+	}
+
+	while (conn->reply_got < conn->msglen) {
+		len = recv(conn->fd, get_buf_data(conn->reply) +
+			   conn->reply_got, conn->msglen - conn->reply_got, 0);
+		if (len > 0) {
+			conn->reply_got += len;
+			continue;
+		}
+		if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+				  (errno == EINTR)))
+			return 0;
+		return -1;
+	}
+	return 1;
+}
+
+static void _conn_io(io_loop_t *loop, io_conn_t *conn, int64_t now)
+{
+	struct epoll_event ev;
+	int rc, err = 0;
+	socklen_t err_len = sizeof(err);
+
+	if (conn->state == IO_CONNECT) {
+		if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err,
+			       &err_len) < 0)
+			err = errno;
+		if (err == ECONNREFUSED) {
+			_conn_refused(loop, conn, now);
+			return;
+		} else if (err) {
+			debug2("%s: connect: %s", __func__, strerror(err));
+			_conn_done(loop, conn,
+				   SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+			return;
+		}
+		conn->state = IO_SEND;
+	}
+
+	if (conn->state == IO_SEND) {
+		if ((rc = _conn_send(conn)) < 0) {
+			_conn_done(loop, conn, SLURM_COMMUNICATIONS_SEND_ERROR);
+			return;
+		} else if (rc == 0)
+			return;
+		if (!conn->req->get_reply) {
+			_conn_done(loop, conn, SLURM_SUCCESS);
+			return;
+		}
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = conn;
+		if (epoll_ctl(loop->epfd, EPOLL_CTL_MOD, conn->fd, &ev) < 0) {
+			error("%s: epoll_ctl: %m", __func__);
+			_conn_done(loop, conn,
+				   SLURM_COMMUNICATIONS_RECEIVE_ERROR);
+			return;
+		}
+		conn->state = IO_RECV;
+		return;
+	}
+
+	if (conn->state == IO_RECV) {
+		if ((rc = _conn_recv(conn)) < 0)
+			_conn_done(loop, conn,
+				   SLURM_COMMUNICATIONS_RECEIVE_ERROR);
+		else if (rc > 0)
+			_conn_done(loop, conn, SLURM_SUCCESS);
+	}
+}
+
+/* Expire timers of every tick elapsed since the last scan. The current
+ * tick is scanned again next time as entries may be due later within it. */
+static void _timer_run(io_loop_t *loop, int64_t now)
+{
+	int64_t tick = now / AGENT_IO_TICK, t;
+	io_conn_t *conn, *next;
+
+	if ((tick - loop->tick) >= AGENT_IO_SLOTS)
+		loop->tick = tick - AGENT_IO_SLOTS + 1;
+	for (t = loop->tick; t <= tick; t++) {
+		for (conn = loop->wheel[t % AGENT_IO_SLOTS]; conn;
+		     conn = next) {
+			next = conn->next;
+			if (conn->wake > now)
+				continue;
+			_timer_del(loop, conn);
+			if ((conn->state == IO_RETRY) &&
+			    (now < conn->deadline)) {
+				_conn_start(loop, conn, now);
+			} else if ((conn->state == IO_RETRY) ||
+				   (conn->state == IO_CONNECT)) {
+				_conn_done(loop, conn,
+					SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+			} else {
+				debug2("%s: message timed out", __func__);
+				_conn_done(loop, conn,
+					SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT);
+			}
+		}
+	}
+	loop->tick = tick;
+}
+
+static void _start_new(io_loop_t *loop, int64_t now)
+{
+	io_conn_t *conn, *next;
+	char buf[64];
+
+	while (read(loop->wake_fd[0], buf, sizeof(buf)) > 0)
+		;
+
+	slurm_mutex_lock(&loop->mutex);
+	conn = loop->new_conns;
+	loop->new_conns = NULL;
+	slurm_mutex_unlock(&loop->mutex);
+
+	for ( ; conn; conn = next) {
+		next = conn->next;
+		conn->next = NULL;
+		_conn_start(loop, conn, now);
+	}
+}
+
+static void *_io_loop(void *arg)
+{
+	io_loop_t *loop = (io_loop_t *) arg;
+	struct epoll_event events[MAX_EVENTS];
+	io_conn_t *conn;
+	int64_t now;
+	int i, cnt;
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "agent_io", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "agent_io");
+	}
+#endif
+
+	while (1) {
+		cnt = epoll_wait(loop->epfd, events, MAX_EVENTS,
+				 AGENT_IO_TICK);
+		if ((cnt < 0) && (errno != EINTR))
+			error("%s: epoll_wait: %m", __func__);
+		now = _now_msec();
+		for (i = 0; i < cnt; i++) {
+			if (!(conn = events[i].data.ptr))
+				_start_new(loop, now);
+			else
+				_conn_io(loop, conn, now);
+		}
+		_timer_run(loop, now);
+	}
+
+	return NULL;
+}
+
+extern void agent_io_init(int threads)
+{
+	struct epoll_event ev;
+	io_loop_t *loop;
+	int i;
+
+	slurm_mutex_lock(&init_mutex);
+	if (loops || (threads < 1)) {
+		slurm_mutex_unlock(&init_mutex);
+		return;
+	}
+
+	loops = xmalloc(sizeof(io_loop_t) * threads);
+	for (i = 0; i < threads; i++) {
+		loop = &loops[i];
+		if ((loop->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+			error("%s: epoll_create1: %m", __func__);
+			break;
+		}
+		if (pipe(loop->wake_fd) < 0) {
+			error("%s: pipe: %m", __func__);
+			(void) close(loop->epfd);
+			break;
+		}
+		fd_set_nonblocking(loop->wake_fd[0]);
+		fd_set_nonblocking(loop->wake_fd[1]);
+		fd_set_close_on_exec(loop->wake_fd[0]);
+		fd_set_close_on_exec(loop->wake_fd[1]);
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = NULL;
+		if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->wake_fd[0],
+			      &ev) < 0) {
+			error("%s: epoll_ctl: %m", __func__);
+			(void) close(loop->epfd);
+			(void) close(loop->wake_fd[0]);
+			(void) close(loop->wake_fd[1]);
+			break;
+		}
+		slurm_mutex_init(&loop->mutex);
+		loop->tick = _now_msec() / AGENT_IO_TICK;
+		slurm_thread_create_detached(NULL, _io_loop, loop);
+	}
+	loop_cnt = i;
+	if (loop_cnt)
+		debug("%s: started %d agent event loops", __func__, loop_cnt);
+	slurm_mutex_unlock(&init_mutex);
+}
+
+extern bool agent_io_enabled(void)
+{
+	return (loop_cnt > 0);
+}
+
+extern void agent_io_submit(agent_io_req_t *req)
+{
+	io_conn_t *conn;
+	io_loop_t *loop;
+	bool wake;
+	char c = 0;
+
+	xassert(loop_cnt > 0);
+	xassert(req->done);
+
+	conn = xmalloc(sizeof(io_conn_t));
+	conn->req = req;
+	conn->fd = -1;
+	conn->slot = -1;
+	conn->deadline = _now_msec() + req->timeout;
+	req->rc = SLURM_SUCCESS;
+	req->not_sent = false;
+	req->reply = NULL;
+
+	slurm_mutex_lock(&init_mutex);
+	loop = &loops[next_loop++ % loop_cnt];
+	slurm_mutex_unlock(&init_mutex);
+
+	slurm_mutex_lock(&loop->mutex);
+	wake = (loop->new_conns == NULL);
+	conn->next = loop->new_conns;
+	loop->new_conns = conn;
+	slurm_mutex_unlock(&loop->mutex);
+
+	/* A full pipe means a wakeup is already pending */
+	if (wake && (write(loop->wake_fd[1], &c, 1) < 0) &&
+	    (errno != EAGAIN) && (errno != EWOULDBLOCK))
+		error("%s: write: %m", __func__);
+}
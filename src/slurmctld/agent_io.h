@@ -0,0 +1,94 @@
+/*****************************************************************************\
+ *  agent_io.h - event driven transport for the slurmctld agent (agent_io.c)
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#ifndef _SLURMCTLD_AGENT_IO_H
+#define _SLURMCTLD_AGENT_IO_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_defs.h"
+
+/* Default count of agent event loop threads, see agent_io_threads= in
+ * SchedulerParameters. Zero keeps the thread per node agent. */
+#ifndef AGENT_IO_THREADS
+#define AGENT_IO_THREADS 0
+#endif
+
+/*
+ * One message to one node. The caller fills in the request fields and
+ * agent_io_submit() fills in the result fields before calling done().
+ */
+typedef struct agent_io_req {
+	/* request */
+	slurm_addr_t addr;	/* destination */
+	Buf head;		/* length prefix, header and credential,
+				 * see slurm_pack_msg_head() */
+	char *body;		/* packed message body, may be shared by
+				 * several requests */
+	uint32_t body_len;
+	bool get_reply;		/* wait for a response message */
+	int timeout;		/* for the whole exchange, msec */
+	void (*done)(struct agent_io_req *req);	/* called from an event
+				 * loop thread, must not block */
+	void *arg;		/* for use by done() */
+
+	/* result */
+	int rc;			/* SLURM_SUCCESS or error code */
+	bool not_sent;		/* failed before contacting addr, slurmctld
+				 * was out of file descriptors */
+	Buf reply;		/* response message if get_reply, without
+				 * its length prefix */
+} agent_io_req_t;
+
+/*
+ * agent_io_init - start the event loop threads, once
+ * IN threads - count of threads, zero leaves the engine disabled
+ */
+extern void agent_io_init(int threads);
+
+/* agent_io_enabled - true if agent_io_init() started the event loops */
+extern bool agent_io_enabled(void);
+
+/*
+ * agent_io_submit - connect to req->addr, send the message and optionally
+ *	read the response without blocking the caller. req->done() is
+ *	called exactly once when the exchange completes, fails or times out.
+ *	The request must remain valid until then.
+ */
+extern void agent_io_submit(agent_io_req_t *req);
+
+#endif /* !_SLURMCTLD_AGENT_IO_H */
@@ -98,6 +98,7 @@
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
 #include "src/slurmctld/heartbeat.h"
+#include "src/slurmctld/info_cache.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
@@ -110,6 +111,8 @@
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/rpc_pool.h"
+#include "src/slurmctld/sched_bench.h"
 #include "src/slurmctld/sched_plugin.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmctld_plugstack.h"
@@ -191,6 +194,7 @@ time_t  slurmctld_running_job_count_ts = 0;
 
 /* Local variables */
 static pthread_t assoc_cache_thread = (pthread_t) 0;
+static int	bench_iterations = 0;
 static int	daemonize = DEFAULT_DAEMONIZE;
 static int	debug_level = 0;
 static char *	debug_logfile = NULL;
@@ -239,6 +243,7 @@ static void         _parse_commandline(int argc, char **argv);
 inline static int   _ping_backup_controller(void);
 static void         _remove_assoc(slurmdb_assoc_rec_t *rec);
 static void         _remove_qos(slurmdb_qos_rec_t *rec);
+static int          _run_sched_bench(slurm_trigger_callbacks_t *callbacks);
 static void         _update_assoc(slurmdb_assoc_rec_t *rec);
 static void         _update_qos(slurmdb_qos_rec_t *rec);
 static int          _init_tres(void);
@@ -246,7 +251,6 @@ static void         _update_cluster_tres(void);
 
 inline static int   _report_locks_set(void);
 static int          _running_jobs_count();
-static void *       _service_connection(void *arg);
 static void         _set_work_dir(void);
 static int          _shutdown_backup_controller(int wait_time);
 static void *       _slurmctld_background(void *no_data);
@@ -260,7 +264,6 @@ static void *       _purge_files_thread(void *no_data);
 static void         _update_nice(void);
 inline static void  _usage(char *prog_name);
 static bool         _valid_controller(void);
-static bool         _wait_for_server_thread(void);
 
 /* main - slurmctld main function, start various threads and process RPCs */
 int main(int argc, char **argv)
@@ -277,6 +280,7 @@ int main(int argc, char **argv)
 
 	slurm_trigger_callbacks_t callbacks;
 	bool create_clustername_file;
+	char *log_async;
 	/*
 	 * Make sure we have no extra open files which
 	 * would be propagated to spawned tasks.
@@ -306,7 +310,8 @@ int main(int argc, char **argv)
 	create_clustername_file = _verify_clustername();
 
 	_update_nice();
-	_kill_old_slurmctld();
+	if (!bench_iterations)
+		_kill_old_slurmctld();
 
 	total_log_jobs= *trace_recs_end_sim; /* ANA: shared memory variable stored in a global variable, as it will not be changed by another process, to avoid accessing shared memory every time. */
 	for (i = 0; i < 3; i++)
@@ -326,13 +331,21 @@ int main(int argc, char **argv)
 		slurmctld_config.daemonize = 0;
 	}
 
+	/* Size in KB of the ring for writing the logfile asynchronously */
+	if ((log_async = getenv("SLURMCTLD_LOG_ASYNC"))) {
+		i = atoi(log_async);
+		debug("Setting slurmctld asynchronous logging to %d KB", i);
+		log_set_async(MAX(i, 0) * 1024);
+	}
+
 	/*
 	 * Need to create pidfile here in case we setuid() below
 	 * (init_pidfile() exits if it can't initialize pid file).
 	 * On Linux we also need to make this setuid job explicitly
 	 * able to write a core dump.
 	 */
-	_init_pidfile();
+	if (!bench_iterations)
+		_init_pidfile();
 	_become_slurm_user();
 
 	/*
@@ -474,6 +487,8 @@ int main(int argc, char **argv)
 	if (switch_g_slurmctld_init() != SLURM_SUCCESS )
 		fatal( "failed to initialize switch plugin");
 	config_power_mgr();
+	if (bench_iterations)
+		exit(_run_sched_bench(&callbacks));
 	agent_init();
 	if (node_features_g_node_power() && !power_save_test()) {
 		fatal("PowerSave required with NodeFeatures plugin, "
@@ -721,8 +736,10 @@ int main(int argc, char **argv)
 	trigger_fini();
 	fed_mgr_fini();
 	assoc_mgr_fini(slurmctld_conf.state_save_location);
+	acct_policy_fini();
 	reserve_port_config(NULL);
 	free_rpc_stats();
+	info_cache_fini();
 
 	/* Some plugins are needed to purge job/node data structures,
 	 * unplug after other data structures are purged */
@@ -971,17 +988,17 @@ static void _sig_handler(int signal)
 {
 }
 
-/* _slurmctld_rpc_mgr - Read incoming RPCs and create pthread for each */
+/* _slurmctld_rpc_mgr - Read incoming RPCs and queue them to the RPC worker
+ *	threads (rpc_pool.c) */
 void *_slurmctld_rpc_mgr(void *no_data)
 {
-	int newsockfd;
 	int *sockfd;	/* our set of socket file descriptors */
-	slurm_addr_t cli_addr, srv_addr;
+	slurm_addr_t srv_addr;
 	uint16_t port;
 	char ip[32];
-	int fd_next = 0, i, nports;
-	fd_set rfds;
-	connection_arg_t *conn_arg = NULL;
+	int i, nports;
+	uint32_t rpc_workers = RPC_WORKER_THREADS;
+	char *tmp_ptr;
 	/* Locks: Read config */
 	slurmctld_lock_t config_read_lock = {
 		READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
@@ -1036,9 +1053,18 @@ void *_slurmctld_rpc_mgr(void *no_data)
 			debug2("slurmctld listening on %s:%d", ip, ntohs(port));
 		}
 	}
+	if ((tmp_ptr = xstrcasestr(slurmctld_conf.sched_params,
+				   "rpc_workers="))) {
+		i = atoi(tmp_ptr + 12);
+		if (i < 1) {
+			error("Invalid SchedulerParameters rpc_workers: %d",
+			      i);
+		} else
+			rpc_workers = i;
+	}
 	unlock_slurmctld(config_read_lock);
 
-	/* Prepare to catch SIGUSR1 to interrupt accept().
+	/* Prepare to catch SIGUSR1 to interrupt epoll_wait().
 	 * This signal is generated by the slurmctld signal
 	 * handler thread upon receipt of SIGABRT, SIGINT,
 	 * or SIGTERM. That thread does all processing of
@@ -1049,169 +1075,20 @@ void *_slurmctld_rpc_mgr(void *no_data)
 	/*
 	 * Process incoming RPCs until told to shutdown
 	 */
-	while (_wait_for_server_thread()) {
-		int max_fd = -1;
-		FD_ZERO(&rfds);
-		for (i=0; i<nports; i++) {
-			FD_SET(sockfd[i], &rfds);
-			max_fd = MAX(sockfd[i], max_fd);
-		}
-		if (select(max_fd+1, &rfds, NULL, NULL, NULL) == -1) {
-			if (errno != EINTR)
-				error("slurm_accept_msg_conn select: %m");
-			server_thread_decr();
-			continue;
-		}
-		/* find one to process */
-		for (i=0; i<nports; i++) {
-			if (FD_ISSET(sockfd[(fd_next+i) % nports], &rfds)) {
-				i = (fd_next + i) % nports;
-				break;
-			}
-		}
-		fd_next = (i + 1) % nports;
-
-		/*
-		 * accept needed for stream implementation is a no-op in
-		 * message implementation that just passes sockfd to newsockfd
-		 */
-		if ((newsockfd = slurm_accept_msg_conn(sockfd[i],
-						       &cli_addr)) ==
-		    SLURM_SOCKET_ERROR) {
-			if (errno != EINTR)
-				error("slurm_accept_msg_conn: %m");
-			server_thread_decr();
-			continue;
-		}
-		fd_set_close_on_exec(newsockfd);
-		conn_arg = xmalloc(sizeof(connection_arg_t));
-		conn_arg->newsockfd = newsockfd;
-		memcpy(&conn_arg->cli_addr, &cli_addr, sizeof(slurm_addr_t));
-
-		if (slurmctld_conf.debug_flags & DEBUG_FLAG_PROTOCOL) {
-			char inetbuf[64];
-
-			slurm_print_slurm_addr(&cli_addr,
-						inetbuf,
-						sizeof(inetbuf));
-			info("%s: accept() connection from %s", __func__, inetbuf);
-		}
-
-		if (slurmctld_config.shutdown_time) {
-			slurmctld_diag_stats.proc_req_raw++;
-			_service_connection(conn_arg);
-		} else {
-			slurm_thread_create_detached(NULL, _service_connection,
-						     conn_arg);
-		}
-	}
+	rpc_pool_init(MIN(rpc_workers, max_server_threads),
+		      max_server_threads);
+	rpc_pool_serve(sockfd, nports);
 	debug3("_slurmctld_rpc_mgr shutting down");
 	for (i=0; i<nports; i++)
 		(void) slurm_shutdown_msg_engine(sockfd[i]);
 	xfree(sockfd);
+	/* Complete the RPCs already read */
+	rpc_pool_fini();
 	server_thread_decr();
 	pthread_exit((void *) 0);
 	return NULL;
 }
 
-/*
- * _service_connection - service the RPC
- * IN/OUT arg - really just the connection's file descriptor, freed
- *	upon completion
- * RET - NULL
- */
-void *_service_connection(void *arg)
-{
-	connection_arg_t *conn = (connection_arg_t *) arg;
-	void *return_code = NULL;
-	//slurm_msg_t msg;
-	slurm_msg_t msg;
-	
-#if HAVE_SYS_PRCTL_H
-	if (prctl(PR_SET_NAME, "srvcn", NULL, NULL, NULL) < 0) {
-		error("%s: cannot set my name to %s %m", __func__, "srvcn");
-	}
-#endif
-	debug("In service_connection");
-	slurm_msg_t_init(&msg);
-	msg.flags |= SLURM_MSG_KEEP_BUFFER;
-	/*
-	 * slurm_receive_msg sets msg connection fd to accepted fd. This allows
-	 * possibility for slurmctld_req() to close accepted connection.
-	 */
-	if (slurm_receive_msg(conn->newsockfd, &msg, 0) != 0) {
-		char addr_buf[32];
-		slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
-				       sizeof(addr_buf));
-		error("slurm_receive_msg [%s]: %m", addr_buf);
-		/* close the new socket */
-		close(conn->newsockfd);
-		goto cleanup;
-	}
-	if (errno != SLURM_SUCCESS) {
-		if (errno == SLURM_PROTOCOL_VERSION_ERROR) {
-			slurm_send_rc_msg(&msg, SLURM_PROTOCOL_VERSION_ERROR);
-		} else
-			info("_service_connection/slurm_receive_msg %m");
-	} else {
-		/* process the request */
-		slurmctld_req(&msg, conn);
-	}
-
-	if ((conn->newsockfd >= 0) && (close(conn->newsockfd) < 0))
-		error ("close(%d): %m",  conn->newsockfd);
-
-cleanup:
-	slurm_free_msg_members(&msg);
-	xfree(arg);
-	server_thread_decr();
-	pthread_exit(NULL); /*This line does not exist in v17 only in simulator-v14*/
-	return return_code;
-}
-
-/* Increment slurmctld_config.server_thread_count and don't return
- * until its value is no larger than MAX_SERVER_THREADS,
- * RET true unless shutdown in progress */
-static bool _wait_for_server_thread(void)
-{
-	bool print_it = true;
-	bool rc = true;
-
-	slurm_mutex_lock(&slurmctld_config.thread_count_lock);
-	while (1) {
-		if (slurmctld_config.shutdown_time) {
-			rc = false;
-			break;
-		}
-		if (slurmctld_config.server_thread_count < max_server_threads) {
-			slurmctld_config.server_thread_count++;
-			break;
-		} else {
-			/* wait for state change and retry,
-			 * just a delay and not an error.
-			 * This can happen when the epilog completes
-			 * on a bunch of nodes at the same time, which
-			 * can easily happen for highly parallel jobs. */
-			if (print_it) {
-				static time_t last_print_time = 0;
-				time_t now = time(NULL);
-				if (difftime(now, last_print_time) > 2) {
-					verbose("server_thread_count over "
-						"limit (%d), waiting",
-						slurmctld_config.
-						server_thread_count);
-					last_print_time = now;
-				}
-				print_it = false;
-			}
-			slurm_cond_wait(&server_thread_cond,
-					&slurmctld_config.thread_count_lock);
-		}
-	}
-	slurm_mutex_unlock(&slurmctld_config.thread_count_lock);
-	return rc;
-}
-
 /* Decrement slurmctld thread count (as applies to thread limit) */
 extern void server_thread_decr(void)
 {
@@ -1367,6 +1244,7 @@ static void _remove_qos(slurmdb_qos_rec_t *rec)
 	unlock_slurmctld(part_write_lock);
 
 	cnt = job_hold_by_qos_id(rec->id);
+	acct_policy_remove_qos(rec->id);
 
 	if (cnt) {
 		info("Removed QOS:%s held %u jobs", rec->name, cnt);
@@ -2452,6 +2330,56 @@ int slurmctld_shutdown(void)
 }
 
 /* Variables for commandline passing using getopt */
+/*
+ * Recover the saved state and initialize the plugins as the primary
+ * controller does, then run the scheduler benchmark (slurmctld -b) instead
+ * of starting the controller threads.
+ * RET exit code
+ */
+static int _run_sched_bench(slurm_trigger_callbacks_t *callbacks)
+{
+	/* Write lock on config, as for a primary controller startup */
+	slurmctld_lock_t config_write_lock = {
+		WRITE_LOCK, WRITE_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK };
+	int error_code;
+
+	ctld_assoc_mgr_init(callbacks);
+	if (slurm_acct_storage_init(NULL) != SLURM_SUCCESS)
+		fatal("failed to initialize accounting_storage plugin");
+
+	/* read_slurm_conf() loads the sched plugin, keep it from starting
+	 * its agent thread, the benchmark runs the passes itself */
+	slurmctld_config.scheduling_disabled = true;
+	lock_slurmctld(config_write_lock);
+	if ((error_code = read_slurm_conf(recover, false))) {
+		fatal("read_slurm_conf reading %s: %s",
+		      slurmctld_conf.slurm_conf, slurm_strerror(error_code));
+	}
+	unlock_slurmctld(config_write_lock);
+	slurmctld_config.scheduling_disabled = false;
+	select_g_select_nodeinfo_set_all();
+
+	acct_db_conn = acct_storage_g_get_connection(callbacks, 0, false,
+						     slurmctld_conf.cluster_name);
+	if (assoc_mgr_init(acct_db_conn, NULL, errno) &&
+	    (accounting_enforce & ACCOUNTING_ENFORCE_ASSOCS) && !running_cache)
+		fatal("slurmdbd and/or database must be up for the benchmark");
+
+	if (slurm_priority_init() != SLURM_SUCCESS)
+		fatal("failed to initialize priority plugin");
+	if (slurm_sched_init() != SLURM_SUCCESS)
+		fatal("failed to initialize scheduling plugin");
+	if (bb_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize burst buffer plugin");
+
+	error_code = sched_bench_run(bench_iterations);
+
+	acct_storage_g_close_connection(&acct_db_conn);
+	slurm_acct_storage_fini();
+
+	return error_code ? 1 : 0;
+}
+
 extern char *optarg;
 extern int optind, opterr, optopt;
 
@@ -2468,8 +2396,16 @@ static void _parse_commandline(int argc, char **argv)
 	bool bg_recover_override = 0;
 
 	opterr = 0;
-	while ((c = getopt(argc, argv, "BcdDf:hiL:n:rRvV")) != -1)
+	while ((c = getopt(argc, argv, "b:BcdDf:hiL:n:rRvV")) != -1)
 		switch (c) {
+		case 'b':
+			bench_iterations = strtol(optarg, &tmp_char, 10);
+			if ((tmp_char[0] != '\0') || (bench_iterations < 1)) {
+				error("Invalid option for -b option (benchmark "
+				      "iterations)");
+				exit(1);
+			}
+			break;
 		case 'B':
 			bg_recover = 0;
 			bg_recover_override = 1;
@@ -2528,6 +2464,14 @@ static void _parse_commandline(int argc, char **argv)
 			_usage(argv[0]);
 			exit(1);
 		}
+
+	if (bench_iterations) {
+		/* The benchmark runs in the foreground on the full saved
+		 * state, unless -c asked for a cold start */
+		daemonize = 0;
+		if (recover)
+			recover = 2;
+	}
 }
 
 /* _usage - print a message describing the command line arguments of
@@ -2535,6 +2479,8 @@ static void _parse_commandline(int argc, char **argv)
 static void _usage(char *prog_name)
 {
 	fprintf(stderr, "Usage: %s [OPTIONS]\n", prog_name);
+	fprintf(stderr, "  -b iterations "
+			"\tBenchmark the schedulers on the saved state and exit.\n");
 #ifdef HAVE_BG
 	fprintf(stderr, "  -B      "
 			"\tDo not recover state of bluegene blocks.\n");
@@ -0,0 +1,209 @@
+/*****************************************************************************\
+ *  info_cache.c - packed information response cache
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Monitoring tools send the same REQUEST_JOB_INFO, REQUEST_NODE_INFO or
+ * REQUEST_PARTITION_INFO many times while the data does not change. The
+ * packed response is kept here with the last_*_update times it was built
+ * from, and sent again as is while those times are unchanged.
+ *
+ * The update times have a resolution of one second, so a change made in
+ * the second a response was packed leaves them unchanged. A response packed
+ * no later than the second of its last update is therefore only shared
+ * with the identical requests that waited for it while the locks were held,
+ * and never served from the cache afterwards.
+ *
+ * An entry is referenced while its data is being sent. An entry whose
+ * data is still being packed makes identical requests wait for it rather
+ * than pack the same data again.
+ */
+
+#include "config.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmctld/info_cache.h"
+
+#define INFO_CACHE_ENTRIES	16
+
+struct info_cache_ent {
+	uint16_t msg_type;
+	uint16_t show_flags;
+	uint16_t protocol_version;
+	uint32_t vis_uid;
+	time_t gen1, gen2;
+	time_t pack_time;
+	bool packing;		/* data not packed yet */
+	bool stale;		/* removed from the cache, freed on release */
+	int refcnt;
+	char *data;
+	int size;
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  cache_cond  = PTHREAD_COND_INITIALIZER;
+static info_cache_ent_t *cache[INFO_CACHE_ENTRIES];
+
+static void _ent_free(info_cache_ent_t *ent)
+{
+	xfree(ent->data);
+	xfree(ent);
+}
+
+/* Remove slot i from the cache, the entry is freed once unreferenced */
+static void _drop(int i)
+{
+	info_cache_ent_t *ent = cache[i];
+
+	cache[i] = NULL;
+	if (ent->refcnt)
+		ent->stale = true;
+	else
+		_ent_free(ent);
+}
+
+extern info_cache_ent_t *info_cache_get(uint16_t msg_type, uint16_t show_flags,
+					uint16_t protocol_version,
+					uint32_t vis_uid, time_t gen1,
+					time_t gen2, char **data, int *size)
+{
+	info_cache_ent_t *ent = NULL;
+	time_t now = time(NULL);
+	int i, free_inx, old_inx;
+
+	*data = NULL;
+	*size = 0;
+
+	slurm_mutex_lock(&cache_mutex);
+	free_inx = old_inx = -1;
+	for (i = 0; i < INFO_CACHE_ENTRIES; i++) {
+		info_cache_ent_t *tmp = cache[i];
+
+		if (tmp && !tmp->packing &&
+		    ((difftime(now, tmp->pack_time) > INFO_CACHE_MAX_AGE) ||
+		     (tmp->pack_time <= tmp->gen1) ||
+		     (tmp->pack_time <= tmp->gen2) ||
+		     ((tmp->msg_type == msg_type) &&
+		      ((tmp->gen1 != gen1) || (tmp->gen2 != gen2))))) {
+			/* Outdated */
+			_drop(i);
+			tmp = NULL;
+		}
+		if (!tmp) {
+			if (free_inx < 0)
+				free_inx = i;
+			continue;
+		}
+		if ((tmp->msg_type == msg_type) &&
+		    (tmp->show_flags == show_flags) &&
+		    (tmp->protocol_version == protocol_version) &&
+		    (tmp->vis_uid == vis_uid) &&
+		    (tmp->gen1 == gen1) && (tmp->gen2 == gen2)) {
+			ent = tmp;
+			break;
+		}
+		if (!tmp->packing && !tmp->refcnt &&
+		    ((old_inx < 0) ||
+		     (tmp->pack_time < cache[old_inx]->pack_time)))
+			old_inx = i;
+	}
+
+	if (ent && ent->packing) {
+		/* Identical request being packed, wait for its result. The
+		 * locks held by both keep the data unchanged meanwhile. */
+		ent->refcnt++;
+		while (ent->packing)
+			slurm_cond_wait(&cache_cond, &cache_mutex);
+		*data = ent->data;
+		*size = ent->size;
+	} else if (ent) {
+		ent->refcnt++;
+		*data = ent->data;
+		*size = ent->size;
+	} else {
+		if ((free_inx < 0) && (old_inx >= 0)) {
+			_drop(old_inx);
+			free_inx = old_inx;
+		}
+		if (free_inx >= 0) {
+			ent = xmalloc(sizeof(info_cache_ent_t));
+			ent->msg_type = msg_type;
+			ent->show_flags = show_flags;
+			ent->protocol_version = protocol_version;
+			ent->vis_uid = vis_uid;
+			ent->gen1 = gen1;
+			ent->gen2 = gen2;
+			ent->packing = true;
+			ent->refcnt = 1;
+			cache[free_inx] = ent;
+		}
+	}
+	slurm_mutex_unlock(&cache_mutex);
+
+	return ent;
+}
+
+extern void info_cache_put(info_cache_ent_t *ent, char *data, int size)
+{
+	slurm_mutex_lock(&cache_mutex);
+	ent->data = data;
+	ent->size = size;
+	ent->pack_time = time(NULL);
+	ent->packing = false;
+	slurm_cond_broadcast(&cache_cond);
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern void info_cache_release(info_cache_ent_t *ent)
+{
+	slurm_mutex_lock(&cache_mutex);
+	if ((--ent->refcnt == 0) && ent->stale)
+		_ent_free(ent);
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern void info_cache_fini(void)
+{
+	int i;
+
+	slurm_mutex_lock(&cache_mutex);
+	for (i = 0; i < INFO_CACHE_ENTRIES; i++) {
+		if (cache[i])
+			_drop(i);
+	}
+	slurm_mutex_unlock(&cache_mutex);
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************\
+ *  info_cache.h - packed information response cache (info_cache.c)
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_INFO_CACHE_H
+#define _SLURMCTLD_INFO_CACHE_H
+
+#include <inttypes.h>
+#include <time.h>
+
+/* Largest age in seconds of a cached response. Packed records report some
+ * times relative to the pack time (e.g. expected start of pending jobs). */
+#ifndef INFO_CACHE_MAX_AGE
+#define INFO_CACHE_MAX_AGE	2
+#endif
+
+typedef struct info_cache_ent info_cache_ent_t;
+
+/*
+ * info_cache_get - find the packed response to an information request
+ * IN msg_type - request RPC type
+ * IN show_flags - request show_flags
+ * IN protocol_version - client protocol version
+ * IN vis_uid - uid the response is packed for, or NO_VAL if it is the same
+ *	for every user
+ * IN gen1, gen2 - last_*_update times the packed data depends upon, data
+ *	packed in the same second as one of them is not kept for later calls
+ * OUT data, size - the cached response, NULL if the caller must pack it
+ *	and then call info_cache_put()
+ * RET entry to pass to info_cache_put()/info_cache_release(), or NULL if
+ *	the response can not be cached now, the caller then packs its own
+ * NOTE: Call with the locks needed to pack the response held, a caller
+ *	may wait for a concurrent identical request to complete its packing.
+ */
+extern info_cache_ent_t *info_cache_get(uint16_t msg_type, uint16_t show_flags,
+					uint16_t protocol_version,
+					uint32_t vis_uid, time_t gen1,
+					time_t gen2, char **data, int *size);
+
+/*
+ * info_cache_put - store a response packed after info_cache_get() returned
+ *	no data, the cache takes over the buffer
+ * IN ent - entry returned by info_cache_get()
+ * IN data, size - packed response, the pointer stays valid until
+ *	info_cache_release(ent)
+ */
+extern void info_cache_put(info_cache_ent_t *ent, char *data, int size);
+
+/* info_cache_release - done sending the data of an entry */
+extern void info_cache_release(info_cache_ent_t *ent);
+
+/* info_cache_fini - free all cached responses */
+extern void info_cache_fini(void);
+
+#endif /* !_SLURMCTLD_INFO_CACHE_H */
@@ -0,0 +1,208 @@
+/*****************************************************************************\
+ *  info_delta.c - record change stamps for delta information RPCs
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * REQUEST_JOB_INFO_DELTA and REQUEST_NODE_INFO_DELTA return only the
+ * records changed since a generation the client got from an earlier call.
+ *
+ * Job records are stamped with info_delta_touch() where they are modified,
+ * next to the last_job_update changes. Node records are modified in too
+ * many places for that. Instead, when last_node_update moved since the
+ * last scan, a delta request packs every node once more and compares a
+ * digest of its packed form with the one kept in the record. A node whose
+ * digest differs gets a new stamp. The scan is shared by every delta
+ * request until the table changes again, while the responses carry only
+ * the changed records.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmctld/info_delta.h"
+
+/* Leave room for 2^20 stamps per second of uptime, so that stamps given
+ * by an earlier slurmctld are below the first ones of this one */
+#define INFO_DELTA_TIME_SHIFT	20
+
+/* 64-bit FNV-1a */
+static uint64_t _hash(const char *data, uint32_t len)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= (unsigned char) data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+extern void info_delta_lock(info_delta_t *delta)
+{
+	slurm_mutex_lock(&delta->mutex);
+	if (delta->cnt == 0) {
+		delta->cnt = (uint64_t) time(NULL) << INFO_DELTA_TIME_SHIFT;
+		delta->horizon = delta->cnt;
+	}
+}
+
+extern bool info_delta_begin(info_delta_t *delta, time_t last_update)
+{
+	time_t now = time(NULL);
+
+	info_delta_lock(delta);
+
+	/* Some callers set last_*_update to a time taken before they got
+	 * their locks, so scan again until that time is clearly older */
+	if (delta->pass_time && (last_update == delta->last_update) &&
+	    (last_update < (delta->pass_time - 1)))
+		return false;
+
+	delta->pass_time = now;
+	delta->last_update = last_update;
+	return true;
+}
+
+extern void info_delta_end(info_delta_t *delta)
+{
+	slurm_mutex_unlock(&delta->mutex);
+}
+
+extern void info_delta_touch(info_delta_t *delta, uint64_t *gen)
+{
+	info_delta_lock(delta);
+	*gen = ++delta->cnt;
+	slurm_mutex_unlock(&delta->mutex);
+}
+
+extern void info_delta_stamp(info_delta_t *delta, Buf buffer,
+			     uint32_t offset, uint64_t *gen, uint64_t *hash)
+{
+	uint64_t new_hash;
+
+	new_hash = _hash(get_buf_data(buffer) + offset,
+			 get_buf_offset(buffer) - offset);
+	if ((*gen == 0) || (new_hash != *hash)) {
+		*hash = new_hash;
+		*gen = ++delta->cnt;
+	}
+}
+
+extern bool info_delta_since(info_delta_t *delta, uint64_t generation,
+			     uint64_t *since)
+{
+	*since = 0;
+	if ((generation < delta->horizon) || (generation > delta->cnt))
+		return true;
+	*since = generation;
+	return false;
+}
+
+extern uint64_t info_delta_generation(info_delta_t *delta)
+{
+	return delta->cnt;
+}
+
+extern void info_delta_purge(info_delta_t *delta, uint32_t id)
+{
+	uint32_t keep;
+
+	slurm_mutex_lock(&delta->mutex);
+	if (delta->cnt == 0) {	/* no stamps given yet */
+		slurm_mutex_unlock(&delta->mutex);
+		return;
+	}
+
+	if (delta->purge_cnt >= INFO_DELTA_MAX_PURGED) {
+		/* Forget the oldest half */
+		keep = delta->purge_cnt / 2;
+		delta->horizon = delta->purge_gen[delta->purge_cnt - keep - 1];
+		memmove(delta->purge_id,
+			delta->purge_id + delta->purge_cnt - keep,
+			sizeof(uint32_t) * keep);
+		memmove(delta->purge_gen,
+			delta->purge_gen + delta->purge_cnt - keep,
+			sizeof(uint64_t) * keep);
+		delta->purge_cnt = keep;
+	}
+	if (delta->purge_cnt >= delta->purge_size) {
+		delta->purge_size = MAX(64, delta->purge_size * 2);
+		xrealloc(delta->purge_id, sizeof(uint32_t) * delta->purge_size);
+		xrealloc(delta->purge_gen,
+			 sizeof(uint64_t) * delta->purge_size);
+	}
+	delta->purge_id[delta->purge_cnt] = id;
+	delta->purge_gen[delta->purge_cnt] = ++delta->cnt;
+	delta->purge_cnt++;
+	slurm_mutex_unlock(&delta->mutex);
+}
+
+extern void info_delta_pack_purged(info_delta_t *delta, uint64_t since,
+				   bool full, Buf buffer)
+{
+	uint32_t lo = 0, hi = delta->purge_cnt, mid;
+
+	if (full) {
+		pack32_array(NULL, 0, buffer);
+		return;
+	}
+
+	/* purge_gen is sorted, find the first purge after since */
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (delta->purge_gen[mid] <= since)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	pack32_array(delta->purge_id + lo, delta->purge_cnt - lo, buffer);
+}
+
+extern void info_delta_reset(info_delta_t *delta)
+{
+	delta->horizon = ++delta->cnt;
+	delta->purge_cnt = 0;
+}
+
+extern void info_delta_fini(info_delta_t *delta)
+{
+	slurm_mutex_lock(&delta->mutex);
+	xfree(delta->purge_id);
+	xfree(delta->purge_gen);
+	delta->purge_cnt = delta->purge_size = 0;
+	slurm_mutex_unlock(&delta->mutex);
+}
@@ -0,0 +1,150 @@
+/*****************************************************************************\
+ *  info_delta.h - record change stamps for delta information RPCs
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_INFO_DELTA_H
+#define _SLURMCTLD_INFO_DELTA_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "src/common/pack.h"
+
+/* Most purged record IDs remembered. Older purges raise the horizon, and
+ * clients with an older generation get a full response. */
+#ifndef INFO_DELTA_MAX_PURGED
+#define INFO_DELTA_MAX_PURGED	10000
+#endif
+
+/*
+ * Change stamps of one record table. Stamps only grow, also across
+ * slurmctld restarts, and are the generations given to clients. A record
+ * with delta_gen above a client's generation changed after that client
+ * loaded it.
+ */
+typedef struct info_delta {
+	pthread_mutex_t mutex;
+	uint64_t cnt;		/* last stamp given */
+	uint64_t horizon;	/* purges before this stamp are forgotten */
+	time_t pass_time;	/* time of the last info_delta_begin() pass */
+	time_t last_update;	/* table last_*_update seen by that pass */
+	uint32_t purge_cnt;
+	uint32_t purge_size;
+	uint32_t *purge_id;	/* purged record IDs, oldest first */
+	uint64_t *purge_gen;	/* stamp of each purge */
+} info_delta_t;
+
+#define INFO_DELTA_INITIALIZER { PTHREAD_MUTEX_INITIALIZER, 0, 0, 0, 0, 0, \
+				 0, NULL, NULL }
+
+/*
+ * info_delta_begin - lock the table stamps and decide if the records must
+ *	be scanned for changes
+ * IN delta - table stamps
+ * IN last_update - last_*_update time of the table
+ * RET true if the caller must call info_delta_stamp() for every record
+ * NOTE: call info_delta_end() when done with the stamps
+ */
+extern bool info_delta_begin(info_delta_t *delta, time_t last_update);
+
+/*
+ * info_delta_lock - lock the table stamps of a table whose records are
+ *	stamped with info_delta_touch() where they are modified
+ * IN delta - table stamps
+ * NOTE: call info_delta_end() when done with the stamps
+ */
+extern void info_delta_lock(info_delta_t *delta);
+
+/* info_delta_end - unlock the table stamps */
+extern void info_delta_end(info_delta_t *delta);
+
+/*
+ * info_delta_touch - give a modified record a new stamp
+ * IN delta - table stamps, not locked by the caller
+ * OUT gen - the record's delta_gen
+ */
+extern void info_delta_touch(info_delta_t *delta, uint64_t *gen);
+
+/*
+ * info_delta_stamp - record the digest of a packed record, giving it a new
+ *	stamp if it differs from the last one
+ * IN delta - table stamps, locked by info_delta_begin()
+ * IN buffer - buffer holding the packed record
+ * IN offset - offset of the record in buffer, it ends at the buffer offset
+ * IN/OUT gen, hash - the record's delta_gen and delta_hash
+ */
+extern void info_delta_stamp(info_delta_t *delta, Buf buffer,
+			     uint32_t offset, uint64_t *gen, uint64_t *hash);
+
+/*
+ * info_delta_since - find which records a client needs
+ * IN delta - table stamps, locked by info_delta_begin() or info_delta_lock()
+ * IN generation - generation the client has, 0 if none
+ * OUT since - stamp to compare each record's delta_gen with
+ * RET true if every record must be sent
+ */
+extern bool info_delta_since(info_delta_t *delta, uint64_t generation,
+			     uint64_t *since);
+
+/* info_delta_generation - current generation of a locked table */
+extern uint64_t info_delta_generation(info_delta_t *delta);
+
+/*
+ * info_delta_purge - remember that a stamped record was purged
+ * IN delta - table stamps, not locked by the caller
+ * IN id - record ID
+ */
+extern void info_delta_purge(info_delta_t *delta, uint32_t id);
+
+/*
+ * info_delta_pack_purged - pack the IDs purged after a stamp
+ * IN delta - table stamps, locked by info_delta_begin() or info_delta_lock()
+ * IN since - from info_delta_since(), ignored if full
+ * IN full - pack an empty list
+ * IN/OUT buffer - buffer to pack into
+ */
+extern void info_delta_pack_purged(info_delta_t *delta, uint64_t since,
+				   bool full, Buf buffer);
+
+/*
+ * info_delta_reset - forget all purges, all clients get a full response
+ * IN delta - table stamps, locked by info_delta_begin()
+ */
+extern void info_delta_reset(info_delta_t *delta);
+
+/* info_delta_fini - free the purge log of a table */
+extern void info_delta_fini(info_delta_t *delta);
+
+#endif /* !_SLURMCTLD_INFO_DELTA_H */
@@ -0,0 +1,333 @@
+/*****************************************************************************\
+ *  job_journal.c - append-only journal of job state changes
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * With SchedulerParameters=job_state_journal, the job_state file is a full
+ * snapshot written every job_journal_snapshot seconds. In between, each
+ * save appends only the jobs which changed, and the jobs purged, to
+ * job_state.journal. Startup replays the journal over the snapshot.
+ *
+ * Both files hold records of the same form:
+ *	uint16_t type, uint32_t job_id, uint32_t size, data, uint32_t checksum
+ * The checksum covers the header and the data, so that a record torn by a
+ * crash ends the replay. A journal names the time stamp of its snapshot in
+ * its header and is ignored with any other snapshot.
+ *
+ * The journal is only written by the state save thread.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "src/common/log.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/slurmctld/job_journal.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
+
+/* type, job_id and size */
+#define JOURNAL_REC_HEADER_SIZE	(sizeof(uint16_t) + 2 * sizeof(uint32_t))
+
+static bool journal_enabled = false;
+static int snapshot_interval = JOB_JOURNAL_SNAPSHOT_INTERVAL;
+
+static time_t journal_snapshot = 0;	/* snapshot of the journal on disk */
+static uint32_t journal_size = 0;	/* bytes appended to that journal */
+static bool journal_failed = false;	/* journal may end in a bad record */
+
+/* 32-bit FNV-1a */
+static uint32_t _checksum(const char *data, uint32_t len)
+{
+	uint32_t hash = 2166136261U;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= (unsigned char) data[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static char *_journal_file(void)
+{
+	return xstrdup_printf("%s/job_state.journal",
+			      slurmctld_conf.state_save_location);
+}
+
+/* Write the contents of a buffer up to its offset, RET 0 or errno */
+static int _write_buf(int fd, Buf buffer, char *file_name)
+{
+	char *data = get_buf_data(buffer);
+	int pos = 0, nwrite = get_buf_offset(buffer), amount;
+
+	while (nwrite > 0) {
+		amount = write(fd, &data[pos], nwrite);
+		if (amount < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Error writing file %s, %m", file_name);
+			return errno;
+		}
+		nwrite -= amount;
+		pos    += amount;
+	}
+	return SLURM_SUCCESS;
+}
+
+extern void job_journal_reconfig(void)
+{
+	char *sched_params, *tmp_ptr;
+	int i;
+
+	journal_enabled = false;
+	snapshot_interval = JOB_JOURNAL_SNAPSHOT_INTERVAL;
+
+	sched_params = slurm_get_sched_params();
+	if (sched_params) {
+		if (xstrcasestr(sched_params, "job_state_journal"))
+			journal_enabled = true;
+		if ((tmp_ptr = xstrcasestr(sched_params,
+					   "job_journal_snapshot="))) {
+			i = atoi(tmp_ptr + 21);
+			if (i < 1) {
+				error("Invalid SchedulerParameters job_journal_snapshot: %d",
+				      i);
+			} else
+				snapshot_interval = i;
+		}
+		xfree(sched_params);
+	}
+
+	debug2("%s: job_state_journal is %s, snapshot every %d seconds",
+	       __func__, journal_enabled ? "enabled" : "disabled",
+	       snapshot_interval);
+}
+
+extern bool job_journal_enabled(void)
+{
+	return journal_enabled;
+}
+
+extern bool job_journal_snapshot_due(uint32_t snapshot_size,
+				     time_t snapshot_time)
+{
+	if (!snapshot_size || journal_failed)
+		return true;
+	if (difftime(time(NULL), snapshot_time) >= snapshot_interval)
+		return true;
+	/* Keep the replay shorter than loading the snapshot twice */
+	if ((journal_snapshot == snapshot_time) &&
+	    (journal_size > snapshot_size))
+		return true;
+	return false;
+}
+
+extern uint32_t job_journal_rec_begin(Buf buffer, uint16_t type,
+				      uint32_t job_id)
+{
+	uint32_t offset = get_buf_offset(buffer);
+
+	pack16(type, buffer);
+	pack32(job_id, buffer);
+	pack32(0, buffer);	/* data size, set by job_journal_rec_end() */
+
+	return offset;
+}
+
+extern void job_journal_rec_end(Buf buffer, uint32_t offset)
+{
+	uint32_t end = get_buf_offset(buffer);
+
+	set_buf_offset(buffer, offset + sizeof(uint16_t) + sizeof(uint32_t));
+	pack32(end - offset - JOURNAL_REC_HEADER_SIZE, buffer);
+	set_buf_offset(buffer, end);
+	pack32(_checksum(get_buf_data(buffer) + offset, end - offset),
+	       buffer);
+}
+
+extern int job_journal_rec_next(Buf buffer, job_journal_rec_t *rec)
+{
+	uint32_t start = get_buf_offset(buffer), checksum;
+
+	safe_unpack16(&rec->type, buffer);
+	safe_unpack32(&rec->job_id, buffer);
+	safe_unpack32(&rec->size, buffer);
+	if ((rec->size > remaining_buf(buffer)) ||
+	    ((remaining_buf(buffer) - rec->size) < sizeof(uint32_t)))
+		goto unpack_error;
+	rec->offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, rec->offset + rec->size);
+	safe_unpack32(&checksum, buffer);
+	if (checksum != _checksum(get_buf_data(buffer) + start,
+				  rec->offset + rec->size - start))
+		goto unpack_error;
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
+extern int job_journal_append(Buf buffer, time_t snapshot_time)
+{
+	char *journal_file;
+	Buf header = NULL;
+	int error_code = SLURM_SUCCESS, fd, rc;
+
+	journal_file = _journal_file();
+	lock_state_files();
+	if (journal_snapshot != snapshot_time) {
+		/* First records since the snapshot, start a new journal */
+		header = init_buf(BUF_SIZE);
+		packstr(JOB_JOURNAL_VERSION, header);
+		pack16(SLURM_PROTOCOL_VERSION, header);
+		pack_time(snapshot_time, header);
+		journal_size = 0;
+		fd = open(journal_file, O_CREAT|O_WRONLY|O_TRUNC|O_CLOEXEC,
+			  0600);
+	} else
+		fd = open(journal_file, O_WRONLY|O_APPEND|O_CLOEXEC);
+	if (fd < 0) {
+		error("Can't save state, open file %s error %m",
+		      journal_file);
+		error_code = errno;
+	} else {
+		if (header)
+			error_code = _write_buf(fd, header, journal_file);
+		if (!error_code)
+			error_code = _write_buf(fd, buffer, journal_file);
+		rc = fsync_and_close(fd, "job journal");
+		if (rc && !error_code)
+			error_code = rc;
+	}
+	if (error_code) {
+		/* Records appended after a partial one would never be
+		 * replayed, so write a snapshot next */
+		journal_failed = true;
+	} else {
+		journal_snapshot = snapshot_time;
+		journal_size += get_buf_offset(buffer);
+	}
+	unlock_state_files();
+	xfree(journal_file);
+	free_buf(header);
+
+	return error_code;
+}
+
+extern void job_journal_remove(void)
+{
+	char *journal_file = _journal_file();
+
+	lock_state_files();
+	(void) unlink(journal_file);
+	journal_snapshot = 0;
+	journal_size = 0;
+	journal_failed = false;
+	unlock_state_files();
+	xfree(journal_file);
+}
+
+extern Buf job_journal_load(time_t snapshot_time, uint16_t *protocol_version)
+{
+	char *journal_file, *data = NULL, *ver_str = NULL;
+	uint32_t data_size = 0, ver_str_len;
+	int data_allocated, data_read, fd;
+	time_t buf_time = 0;
+	Buf buffer;
+
+	journal_file = _journal_file();
+	lock_state_files();
+	fd = open(journal_file, O_RDONLY);
+	if (fd < 0) {
+		debug("No job state journal (%s) to recover", journal_file);
+		unlock_state_files();
+		xfree(journal_file);
+		return NULL;
+	}
+	data_allocated = BUF_SIZE;
+	data = xmalloc(data_allocated);
+	while (1) {
+		data_read = read(fd, &data[data_size], BUF_SIZE);
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			else {
+				error("Read error on %s: %m", journal_file);
+				break;
+			}
+		} else if (data_read == 0)	/* eof */
+			break;
+		data_size      += data_read;
+		data_allocated += data_read;
+		xrealloc(data, data_allocated);
+	}
+	close(fd);
+	unlock_state_files();
+
+	buffer = create_buf(data, data_size);
+	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
+	if (xstrcmp(ver_str, JOB_JOURNAL_VERSION)) {
+		error("Job state journal %s has an incompatible version",
+		      journal_file);
+		goto unpack_error;
+	}
+	safe_unpack16(protocol_version, buffer);
+	safe_unpack_time(&buf_time, buffer);
+	if (buf_time != snapshot_time) {
+		info("Ignoring job state journal %s of another snapshot",
+		     journal_file);
+		goto unpack_error;
+	}
+
+	xfree(ver_str);
+	xfree(journal_file);
+	return buffer;
+
+unpack_error:
+	xfree(ver_str);
+	xfree(journal_file);
+	free_buf(buffer);
+	return NULL;
+}
@@ -0,0 +1,129 @@
+/*****************************************************************************\
+ *  job_journal.h - append-only journal of job state changes
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_JOB_JOURNAL_H
+#define _SLURMCTLD_JOB_JOURNAL_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "src/common/pack.h"
+
+/* Header string of a job_state snapshot holding journal records */
+#define JOB_JOURNAL_STATE_VERSION	"JOURNAL_STATE_VERSION"
+
+/* Header string of the job_state.journal file */
+#define JOB_JOURNAL_VERSION		"JOB_JOURNAL_VERSION"
+
+/* Default seconds between full snapshots, see job_journal_snapshot= */
+#define JOB_JOURNAL_SNAPSHOT_INTERVAL	600
+
+/* Journal record types */
+#define JOB_JOURNAL_REC_JOB	1	/* state of one job */
+#define JOB_JOURNAL_REC_PURGE	2	/* job record purged, no data */
+#define JOB_JOURNAL_REC_SEQ	3	/* job_id_sequence in job_id, no data */
+
+typedef struct job_journal_rec {
+	uint16_t type;		/* JOB_JOURNAL_REC_* */
+	uint32_t job_id;
+	uint32_t offset;	/* offset of the record data in the buffer */
+	uint32_t size;		/* size of the record data */
+} job_journal_rec_t;
+
+/* job_journal_reconfig - read the journal options from SchedulerParameters */
+extern void job_journal_reconfig(void);
+
+/* job_journal_enabled - true if SchedulerParameters=job_state_journal */
+extern bool job_journal_enabled(void);
+
+/*
+ * job_journal_snapshot_due - decide if the next save must be a full snapshot
+ * IN snapshot_size - size of the last snapshot written, 0 if none
+ * IN snapshot_time - time stamp of the last snapshot written
+ * RET true if the journal is absent, older than the snapshot interval or
+ *	larger than the snapshot itself
+ */
+extern bool job_journal_snapshot_due(uint32_t snapshot_size,
+				     time_t snapshot_time);
+
+/*
+ * job_journal_rec_begin - start a record in a buffer, its data is packed
+ *	next
+ * IN/OUT buffer - buffer to pack into
+ * IN type - JOB_JOURNAL_REC_*
+ * IN job_id - job ID, or value of a JOB_JOURNAL_REC_SEQ record
+ * RET offset of the record, to pass to job_journal_rec_end()
+ */
+extern uint32_t job_journal_rec_begin(Buf buffer, uint16_t type,
+				      uint32_t job_id);
+
+/*
+ * job_journal_rec_end - complete a record once its data is packed
+ * IN/OUT buffer - buffer holding the record
+ * IN offset - from job_journal_rec_begin()
+ */
+extern void job_journal_rec_end(Buf buffer, uint32_t offset);
+
+/*
+ * job_journal_rec_next - get the next record of a buffer
+ * IN/OUT buffer - buffer positioned at a record, left after it
+ * OUT rec - the record, its data is rec->size bytes at rec->offset
+ * RET SLURM_SUCCESS, or SLURM_ERROR if the record is incomplete or damaged,
+ *	as when slurmctld died while writing it
+ */
+extern int job_journal_rec_next(Buf buffer, job_journal_rec_t *rec);
+
+/*
+ * job_journal_append - append records to the journal and sync it to disk
+ * IN buffer - records, from its start to its offset
+ * IN snapshot_time - time stamp of the snapshot the records apply to
+ * RET SLURM_SUCCESS or an errno
+ * NOTE: A journal of an older snapshot is replaced
+ */
+extern int job_journal_append(Buf buffer, time_t snapshot_time);
+
+/* job_journal_remove - remove the journal once a new snapshot is written */
+extern void job_journal_remove(void);
+
+/*
+ * job_journal_load - read the journal of a snapshot
+ * IN snapshot_time - time stamp of the snapshot
+ * OUT protocol_version - protocol version of the records
+ * RET buffer positioned at the first record, NULL if there is no journal
+ *	for this snapshot. Free with free_buf().
+ */
+extern Buf job_journal_load(time_t snapshot_time, uint16_t *protocol_version);
+
+#endif /* !_SLURMCTLD_JOB_JOURNAL_H */
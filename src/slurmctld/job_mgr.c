@@ -87,6 +87,8 @@
 #include "src/slurmctld/fed_mgr.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
+#include "src/slurmctld/info_delta.h"
+#include "src/slurmctld/job_journal.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
@@ -108,6 +110,9 @@
 #define SLURM_CREATE_JOB_FLAG_NO_ALLOCATE_0 0
 #define TOP_PRIORITY 0xffff0000	/* large, but leave headroom for higher */
 
+#define JOB_LOAD_MAX_THREADS	8	/* threads unpacking recovered jobs */
+#define JOB_LOAD_THREAD_RECS	1024	/* fewest job records per thread */
+
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
 #define JOB_ARRAY_HASH_INX(_job_id, _task_id) \
 	((_job_id + _task_id) % hash_table_size)
@@ -130,15 +135,38 @@ typedef struct {
 	bitstr_t **resp_array_task_id;
 } resp_array_struct_t;
 
+typedef struct {
+	char    **accounts;		/* accounts of the query, split */
+	int       account_cnt;
+	struct part_record **parts;	/* partitions of the query */
+	int       part_cnt;
+	job_info_query_t *query;
+} _job_query_t;
+
 typedef struct {
 	Buf       buffer;
+	uint32_t  fields;
 	uint32_t  filter_uid;
 	uint32_t *jobs_packed;
 	uint16_t  protocol_version;
+	_job_query_t *query;
+	uint32_t  removed_cnt;
+	uint32_t *removed_ids;
 	uint16_t  show_flags;
+	uint64_t  since;
 	uid_t     uid;
 } _foreach_pack_job_info_t;
 
+typedef struct {
+	uint32_t  begin;		/* first record to unpack */
+	Buf       buffer;		/* job_state, shared by all threads */
+	uint32_t  end;			/* one past the last record */
+	uint32_t  fail_inx;		/* first record not unpacked */
+	struct job_record **jobs;	/* unpacked records, by index */
+	uint32_t *offsets;		/* offset of each record in buffer */
+	uint16_t  protocol_version;
+} job_unpack_args_t;
+
 /* Global variables */
 List   job_list = NULL;		/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
@@ -149,14 +177,25 @@ List purge_files_list = NULL;	/* job files to delete */
 static int      bf_min_age_reserve = 0;
 static uint32_t delay_boot = 0;
 static uint32_t highest_prio = 0;
+static info_delta_t job_delta = INFO_DELTA_INITIALIZER;
 static uint32_t lowest_prio  = TOP_PRIORITY;
 static int      hash_table_size = 0;
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
+static Buf	job_state_buf = NULL;	/* from prefetch_job_state() */
+static bool	job_state_prefetched = false;
 static struct   job_record **job_array_hash_j = NULL;
 static struct   job_record **job_array_hash_t = NULL;
+static uint32_t job_snapshot_size = 0;	/* size of last journal snapshot */
+static pthread_mutex_t journal_purge_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t journal_purge_cnt = 0;	/* jobs purged since last save */
+static uint32_t *journal_purge_id = NULL;
+static uint32_t journal_purge_size = 0;
+static uint32_t journal_job_id_seq = 0;	/* job_id_sequence last journaled */
+static uint64_t journal_gen = 0;	/* job delta_gen last journaled */
 static bool     kill_invalid_dep;
+static List	kill_batch_list = NULL;	/* see job_kill_batch_begin() */
 static time_t   last_file_write_time = (time_t) 0;
 static uint32_t max_array_size = NO_VAL;
 static bitstr_t *requeue_exit = NULL;
@@ -176,6 +215,8 @@ static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 					 bitstr_t ** exc_bitmap,
 					 bitstr_t ** req_bitmap);
 static char *_copy_nodelist_no_dup(char *node_list);
+static void _add_job_record(struct job_record *job_ptr, uint32_t num_jobs);
+static struct job_record *_alloc_job_record(void);
 static struct job_record *_create_job_record(uint32_t num_jobs);
 static void _delete_job_details(struct job_record *job_entry);
 static void _del_batch_list_rec(void *x);
@@ -184,6 +225,8 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	bool operator, slurmdb_qos_rec_t *qos_rec, int *error_code,
 	bool locked);
 static void _dump_job_details(struct job_details *detail_ptr, Buf buffer);
+static int  _dump_job_journal(void);
+static int  _dump_job_snapshot(void *x, void *arg);
 static int  _dump_job_state(void *x, void *y);
 static void _dump_job_fed_details(job_fed_details_t *fed_details_ptr,
 				  Buf buffer);
@@ -193,15 +236,24 @@ static void _job_array_comp(struct job_record *job_ptr, bool was_running);
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid,
 			char **err_msg, uint16_t protocol_version);
+static uint64_t _job_delta_gen(void);
+static void _free_job_record(struct job_record *job_ptr);
 static void _job_timed_out(struct job_record *job_ptr);
 static void _kill_dependent(struct job_record *job_ptr);
 static void _list_delete_job(void *job_entry);
 static int  _list_find_job_old(void *job_entry, void *key);
 static int  _load_job_details(struct job_record *job_ptr, Buf buffer,
 			      uint16_t protocol_version);
+static int  _load_job_recs(Buf buffer, uint16_t protocol_version,
+			   uint32_t *offsets, uint32_t rec_cnt, int *job_cnt);
 static int  _load_job_fed_details(job_fed_details_t **fed_details_pptr,
 				  Buf buffer, uint16_t protocol_version);
+static void _journal_purge(uint32_t job_id);
+static int  _load_job_snapshot(Buf buffer, time_t buf_time,
+			       uint16_t protocol_version, int *job_cnt);
 static int  _load_job_state(Buf buffer,	uint16_t protocol_version);
+static void _link_job_state(struct job_record *job_ptr);
+static void _load_journal_job_id(time_t buf_time);
 static bitstr_t *_make_requeue_array(char *conf_buf);
 static uint32_t _max_switch_wait(uint32_t input_wait);
 static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
@@ -211,10 +263,12 @@ static time_t _get_last_job_state_write_time(void);
 static void _pack_job_for_ckpt (struct job_record *job_ptr, Buf buffer);
 static void _pack_default_job_details(struct job_record *job_ptr,
 				      Buf buffer,
-				      uint16_t protocol_version);
+				      uint16_t protocol_version,
+				      uint32_t fields);
 static void _pack_pending_job_details(struct job_details *detail_ptr,
 				      Buf buffer,
-				      uint16_t protocol_version);
+				      uint16_t protocol_version,
+				      uint32_t fields);
 static bool _parse_array_tok(char *tok, bitstr_t *array_bitmap, uint32_t max);
 static void _purge_missing_jobs(int node_inx, time_t now);
 static int  _read_data_array_from_file(int fd, char *file_name, char ***data,
@@ -246,6 +300,9 @@ static void _suspend_job(struct job_record *job_ptr, uint16_t op,
 			 bool indf_susp);
 static int  _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp);
 static bool _top_priority(struct job_record *job_ptr, uint32_t pack_job_offset);
+static void *_unpack_job_recs(void *arg);
+static int  _unpack_job_state(Buf buffer, uint16_t protocol_version,
+			      struct job_record **job_pptr);
 static int  _valid_job_part(job_desc_msg_t * job_desc,
 			    uid_t submit_uid, bitstr_t *req_bitmap,
 			    struct part_record **part_pptr,
@@ -458,9 +515,19 @@ static job_array_resp_msg_t *_resp_array_xlate(resp_array_struct_t *resp,
  */
 static struct job_record *_create_job_record(uint32_t num_jobs)
 {
-	struct job_record  *job_ptr;
-	struct job_details *detail_ptr;
+	struct job_record *job_ptr = _alloc_job_record();
+
+	_add_job_record(job_ptr, num_jobs);
+	return job_ptr;
+}
 
+/*
+ * _add_job_record - add a record from _alloc_job_record() to job_list
+ * IN num_jobs - number of jobs this record represents, see
+ *	_create_job_record()
+ */
+static void _add_job_record(struct job_record *job_ptr, uint32_t num_jobs)
+{
 	if ((job_count + num_jobs) >= slurmctld_conf.max_job_cnt) {
 		error("%s: MaxJobCount limit from slurm.conf reached (%u)",
 		      __func__, slurmctld_conf.max_job_cnt);
@@ -468,6 +535,19 @@ static struct job_record *_create_job_record(uint32_t num_jobs)
 
 	job_count += num_jobs;
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
+	(void) list_append(job_list, job_ptr);
+}
+
+/*
+ * _alloc_job_record - allocate an empty job_record including job_details,
+ *	in no list or hash table. Touches no global state.
+ * NOTE: allocates memory that should be xfreed with _free_job_record
+ */
+static struct job_record *_alloc_job_record(void)
+{
+	struct job_record  *job_ptr;
+	struct job_details *detail_ptr;
 
 	job_ptr    = (struct job_record *) xmalloc(sizeof(struct job_record));
 	detail_ptr = (struct job_details *)xmalloc(sizeof(struct job_details));
@@ -483,7 +563,6 @@ static struct job_record *_create_job_record(uint32_t num_jobs)
 	job_ptr->requid = -1; /* force to -1 for sacct to know this
 			       * hasn't been set yet  */
 	job_ptr->billable_tres = (double)NO_VAL;
-	(void) list_append(job_list, job_ptr);
 
 	return job_ptr;
 }
@@ -502,17 +581,6 @@ static void _delete_job_details(struct job_record *job_entry)
 
 	xassert (job_entry->details->magic == DETAILS_MAGIC);
 
-	/*
-	 * Queue up job to have the batch script and environment deleted.
-	 * This is handled by a separate thread to limit the amount of
-	 * time purge_old_job needs to spend holding locks.
-	 */
-	if (IS_JOB_FINISHED(job_entry)) {
-		uint32_t *job_id = xmalloc(sizeof(uint32_t));
-		*job_id = job_entry->job_id;
-		list_enqueue(purge_files_list, job_id);
-	}
-
 	xfree(job_entry->details->acctg_freq);
 	for (i=0; i<job_entry->details->argc; i++)
 		xfree(job_entry->details->argv[i]);
@@ -665,6 +733,9 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 
 /*
  * dump_all_job_state - save the state of all jobs to file for checkpoint
+ *	With SchedulerParameters=job_state_journal, only the jobs changed since
+ *	the last save are appended to the job state journal, unless a new
+ *	snapshot is due.
  *	Changes here should be reflected in load_last_job_id() and
  *	load_all_job_state().
  * RET 0 or error code */
@@ -678,12 +749,13 @@ int dump_all_job_state(void)
 	/* Locks: Read config and job */
 	slurmctld_lock_t job_read_lock =
 		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
-	Buf buffer = init_buf(high_buffer_size);
+	Buf buffer;
 	time_t now = time(NULL);
 	time_t last_state_file_time;
+	bool journal = job_journal_enabled();
+	uint64_t save_gen = 0;
 	DEF_TIMERS;
 
-	START_TIMER;
 	/* Check that last state file was written at expected time.
 	 * This is a check for two slurmctld daemons running at the same
 	 * time in primary mode (a split-brain problem). */
@@ -701,8 +773,18 @@ int dump_all_job_state(void)
 		}
 	}
 
+	if (journal &&
+	    !job_journal_snapshot_due(job_snapshot_size, last_file_write_time))
+		return _dump_job_journal();
+
+	START_TIMER;
+	buffer = init_buf(high_buffer_size);
+
 	/* write header: version, time */
-	packstr(JOB_STATE_VERSION, buffer);
+	if (journal)
+		packstr(JOB_JOURNAL_STATE_VERSION, buffer);
+	else
+		packstr(JOB_STATE_VERSION, buffer);
 	pack16(SLURM_PROTOCOL_VERSION, buffer);
 	pack_time(now, buffer);
 
@@ -718,7 +800,15 @@ int dump_all_job_state(void)
 
 	/* write individual job records */
 	lock_slurmctld(job_read_lock);
-	list_for_each(job_list, _dump_job_state, buffer);
+	if (journal) {
+		save_gen = _job_delta_gen();
+		list_for_each(job_list, _dump_job_snapshot, buffer);
+		slurm_mutex_lock(&journal_purge_mutex);
+		journal_purge_cnt = 0;
+		slurm_mutex_unlock(&journal_purge_mutex);
+		journal_job_id_seq = job_id_sequence;
+	} else
+		list_for_each(job_list, _dump_job_state, buffer);
 
 	/* write the buffer to file */
 	old_file = xstrdup(slurmctld_conf.state_save_location);
@@ -772,9 +862,10 @@ int dump_all_job_state(void)
 		if (rc && !error_code)
 			error_code = rc;
 	}
-	if (error_code)
+	if (error_code) {
 		(void) unlink(new_file);
-	else {			/* file shuffle */
+		job_snapshot_size = 0;	/* journal needs a new snapshot */
+	} else {			/* file shuffle */
 		(void) unlink(old_file);
 		if (link(reg_file, old_file))
 			debug4("unable to create link for %s -> %s: %m",
@@ -785,17 +876,137 @@ int dump_all_job_state(void)
 			       new_file, reg_file);
 		(void) unlink(new_file);
 		last_file_write_time = now;
+		job_snapshot_size = journal ? get_buf_offset(buffer) : 0;
+		if (journal)
+			journal_gen = save_gen;
 	}
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
 	unlock_state_files();
 
+	/* The journal of the previous snapshot is obsolete */
+	if (!error_code)
+		job_journal_remove();
+
 	free_buf(buffer);
 	END_TIMER2("dump_all_job_state");
 	return error_code;
 }
 
+/*
+ * _dump_job_journal - append the jobs changed or purged since the last save
+ *	to the job state journal. Jobs are stamped by job_set_changed() where
+ *	they are modified, so only those stamped since the last save are
+ *	packed while the job read lock is held. The records are written
+ *	without it.
+ * RET 0 or error code
+ */
+static int _dump_job_journal(void)
+{
+	static int high_buffer_size = BUF_SIZE;
+	/* Locks: Read config and job */
+	slurmctld_lock_t job_read_lock =
+		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	uint64_t save_gen;
+	uint32_t offset, i, purge_cnt;
+	int error_code = SLURM_SUCCESS, job_cnt = 0;
+	Buf buffer = init_buf(high_buffer_size);
+	DEF_TIMERS;
+
+	START_TIMER;
+	lock_slurmctld(job_read_lock);
+	save_gen = _job_delta_gen();
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = list_next(job_iterator))) {
+		if (job_ptr->delta_gen <= journal_gen)
+			continue;	/* unchanged since last saved */
+		offset = job_journal_rec_begin(buffer, JOB_JOURNAL_REC_JOB,
+					       job_ptr->job_id);
+		_dump_job_state(job_ptr, buffer);
+		job_journal_rec_end(buffer, offset);
+		job_cnt++;
+	}
+	list_iterator_destroy(job_iterator);
+
+	slurm_mutex_lock(&journal_purge_mutex);
+	purge_cnt = journal_purge_cnt;
+	for (i = 0; i < journal_purge_cnt; i++) {
+		offset = job_journal_rec_begin(buffer, JOB_JOURNAL_REC_PURGE,
+					       journal_purge_id[i]);
+		job_journal_rec_end(buffer, offset);
+	}
+	journal_purge_cnt = 0;
+	slurm_mutex_unlock(&journal_purge_mutex);
+
+	if (job_cnt || purge_cnt || (journal_job_id_seq != job_id_sequence)) {
+		offset = job_journal_rec_begin(buffer, JOB_JOURNAL_REC_SEQ,
+					       job_id_sequence);
+		job_journal_rec_end(buffer, offset);
+		journal_job_id_seq = job_id_sequence;
+	}
+	unlock_slurmctld(job_read_lock);
+
+	if (get_buf_offset(buffer)) {
+		high_buffer_size = MAX(get_buf_offset(buffer),
+				       high_buffer_size);
+		error_code = job_journal_append(buffer, last_file_write_time);
+	}
+	/* Jobs changed after save_gen was taken stay above it. On error
+	 * the same jobs are journaled again by the next save. */
+	if (error_code == SLURM_SUCCESS)
+		journal_gen = save_gen;
+	free_buf(buffer);
+	debug3("%s: journaled %d changed and %u purged jobs",
+	       __func__, job_cnt, purge_cnt);
+	END_TIMER2("dump_all_job_state");
+	return error_code;
+}
+
+/* _journal_purge - remember a purged job for the next journal save */
+static void _journal_purge(uint32_t job_id)
+{
+	slurm_mutex_lock(&journal_purge_mutex);
+	if (journal_purge_cnt >= journal_purge_size) {
+		journal_purge_size = MAX(journal_purge_size * 2, 1024);
+		xrealloc(journal_purge_id,
+			 sizeof(uint32_t) * journal_purge_size);
+	}
+	journal_purge_id[journal_purge_cnt++] = job_id;
+	slurm_mutex_unlock(&journal_purge_mutex);
+}
+
+/*
+ * _dump_job_snapshot - dump the state of a specific job as a journal record
+ */
+static int _dump_job_snapshot(void *x, void *arg)
+{
+	struct job_record *job_ptr = (struct job_record *) x;
+	Buf buffer = (Buf) arg;
+	uint32_t offset;
+
+	offset = job_journal_rec_begin(buffer, JOB_JOURNAL_REC_JOB,
+				       job_ptr->job_id);
+	_dump_job_state(job_ptr, buffer);
+	job_journal_rec_end(buffer, offset);
+
+	return 0;
+}
+
+/* _job_delta_gen - last stamp given by job_set_changed() */
+static uint64_t _job_delta_gen(void)
+{
+	uint64_t gen;
+
+	info_delta_lock(&job_delta);
+	gen = info_delta_generation(&job_delta);
+	info_delta_end(&job_delta);
+
+	return gen;
+}
+
 static int _find_resv_part(void *x, void *key)
 {
 	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
@@ -933,7 +1144,8 @@ static time_t _get_last_job_state_write_time(void)
 
 	buffer = create_buf(data, data_size);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
-	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+	if (ver_str && (!xstrcmp(ver_str, JOB_STATE_VERSION) ||
+			!xstrcmp(ver_str, JOB_JOURNAL_STATE_VERSION)))
 		safe_unpack16(&protocol_version, buffer);
 	safe_unpack_time(&buf_time, buffer);
 
@@ -943,6 +1155,47 @@ unpack_error:
 	return buf_time;
 }
 
+/*
+ * _map_job_state_file - map the job state save file (or its backup)
+ * RET buffer of the file contents or NULL if there is none
+ */
+static Buf _map_job_state_file(void)
+{
+	int state_fd;
+	char *state_file;
+	Buf buffer = NULL;
+
+	lock_state_files();
+	state_fd = _open_job_state_file(&state_file);
+	if (state_fd < 0) {
+		info("No job state file (%s) to recover", state_file);
+	} else {
+		if (!(buffer = create_mmap_buf(state_fd))) {
+			/* Fails below as an incompatible version */
+			error("Could not map %s: %m", state_file);
+			buffer = create_buf(NULL, 0);
+		}
+		close(state_fd);
+	}
+	xfree(state_file);
+	unlock_state_files();
+
+	return buffer;
+}
+
+/*
+ * prefetch_job_state - map the job state save file ahead of
+ *	load_all_job_state() so that the kernel reads it in while the node and
+ *	partition tables are built.
+ */
+extern void prefetch_job_state(void)
+{
+	if (job_state_prefetched)
+		return;
+	job_state_buf = _map_job_state_file();
+	job_state_prefetched = true;
+}
+
 /*
  * load_all_job_state - load the job state from file, recover from last
  *	checkpoint. Execute this after loading the configuration file data.
@@ -951,58 +1204,35 @@ unpack_error:
  */
 extern int load_all_job_state(void)
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
-	uint32_t data_size = 0;
-	int state_fd, job_cnt = 0;
-	char *data = NULL, *state_file;
+	int error_code = SLURM_SUCCESS;
+	int job_cnt = 0;
 	Buf buffer;
 	time_t buf_time;
 	uint32_t saved_job_id;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = NO_VAL16;
+	bool journal_state = false;
 	assoc_mgr_lock_t locks = { READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
 
-	/* read the file */
-	lock_state_files();
-	state_fd = _open_job_state_file(&state_file);
-	if (state_fd < 0) {
-		info("No job state file (%s) to recover", state_file);
-		xfree(state_file);
-		unlock_state_files();
+	/* map the file, unless prefetch_job_state() already did */
+	if (job_state_prefetched) {
+		buffer = job_state_buf;
+		job_state_buf = NULL;
+		job_state_prefetched = false;
+	} else
+		buffer = _map_job_state_file();
+	if (!buffer)
 		return ENOENT;
-	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
-		close(state_fd);
-	}
-	xfree(state_file);
-	unlock_state_files();
 
 	job_id_sequence = MAX(job_id_sequence, slurmctld_conf.first_job_id);
 
-	buffer = create_buf(data, data_size);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
-	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+	if (ver_str && !xstrcmp(ver_str, JOB_JOURNAL_STATE_VERSION))
+		journal_state = true;
+	if (ver_str && (!xstrcmp(ver_str, JOB_STATE_VERSION) || journal_state))
 		safe_unpack16(&protocol_version, buffer);
 	xfree(ver_str);
 
@@ -1023,6 +1253,12 @@ extern int load_all_job_state(void)
 	debug3("Job id in job_state header is %u", saved_job_id);
 
 	assoc_mgr_lock(&locks);
+	if (journal_state) {
+		error_code = _load_job_snapshot(buffer, buf_time,
+						protocol_version, &job_cnt);
+		if (error_code != SLURM_SUCCESS)
+			goto unpack_error;
+	}
 	while (remaining_buf(buffer) > 0) {
 		error_code = _load_job_state(buffer, protocol_version);
 		if (error_code != SLURM_SUCCESS)
@@ -1046,6 +1282,275 @@ unpack_error:
 	return SLURM_FAILURE;
 }
 
+/* Compare journal records by job ID, then by position */
+static int _cmp_journal_rec_id(const void *x, const void *y)
+{
+	const job_journal_rec_t *rec1 = x, *rec2 = y;
+
+	if (rec1->job_id < rec2->job_id)
+		return -1;
+	if (rec1->job_id > rec2->job_id)
+		return 1;
+	if (rec1->offset < rec2->offset)
+		return -1;
+	if (rec1->offset > rec2->offset)
+		return 1;
+	return 0;
+}
+
+/* Compare journal records by job ID only, for bsearch() */
+static int _find_journal_rec_id(const void *x, const void *y)
+{
+	const job_journal_rec_t *rec1 = x, *rec2 = y;
+
+	if (rec1->job_id < rec2->job_id)
+		return -1;
+	if (rec1->job_id > rec2->job_id)
+		return 1;
+	return 0;
+}
+
+/* Compare journal records by position */
+static int _cmp_journal_rec_offset(const void *x, const void *y)
+{
+	const job_journal_rec_t *rec1 = x, *rec2 = y;
+
+	if (rec1->offset < rec2->offset)
+		return -1;
+	if (rec1->offset > rec2->offset)
+		return 1;
+	return 0;
+}
+
+/*
+ * _read_job_journal - read the records of a snapshot's job state journal
+ * IN journal - from job_journal_load()
+ * OUT rec_cnt - count of job and purge records returned
+ * RET the last record of each job, sorted by job ID. xfree() it.
+ * NOTE: Updates job_id_sequence from the journal
+ */
+static job_journal_rec_t *_read_job_journal(Buf journal, uint32_t *rec_cnt)
+{
+	job_journal_rec_t rec, *recs = NULL;
+	uint32_t cnt = 0, size = 0, i, j;
+
+	while (remaining_buf(journal) > 0) {
+		if (job_journal_rec_next(journal, &rec) != SLURM_SUCCESS) {
+			error("Job state journal ends with a damaged record, ignoring it");
+			break;
+		}
+		if (rec.type == JOB_JOURNAL_REC_SEQ) {
+			if (rec.job_id <= slurmctld_conf.max_job_id)
+				job_id_sequence = MAX(rec.job_id,
+						      job_id_sequence);
+			continue;
+		}
+		if (cnt >= size) {
+			size = MAX(size * 2, 1024);
+			xrealloc(recs, sizeof(job_journal_rec_t) * size);
+		}
+		recs[cnt++] = rec;
+	}
+
+	/* Keep only the last record of each job */
+	if (cnt)
+		qsort(recs, cnt, sizeof(job_journal_rec_t),
+		      _cmp_journal_rec_id);
+	for (i = 0, j = 0; i < cnt; i++) {
+		if (((i + 1) < cnt) && (recs[i + 1].job_id == recs[i].job_id))
+			continue;
+		recs[j++] = recs[i];
+	}
+	*rec_cnt = j;
+
+	return recs;
+}
+
+/*
+ * _load_job_snapshot - load the jobs of a job_state snapshot, replaying the
+ *	job state journal written after it. A job in the journal is loaded
+ *	from its last journal record rather than from the snapshot.
+ * IN buffer - snapshot positioned after the header
+ * IN buf_time - snapshot time stamp
+ * IN protocol_version - snapshot protocol version
+ * IN/OUT job_cnt - incremented for each job loaded
+ * RET 0 or error code
+ * NOTE: assoc_mgr tres and assoc read lock must be locked before calling
+ */
+static int _load_job_snapshot(Buf buffer, time_t buf_time,
+			      uint16_t protocol_version, int *job_cnt)
+{
+	job_journal_rec_t rec, *journal_recs = NULL;
+	uint32_t journal_cnt = 0, rec_cnt = 0, rec_size = 0, i;
+	uint32_t *offsets = NULL;
+	uint16_t journal_version = NO_VAL16;
+	int error_code = SLURM_SUCCESS, replay_cnt = 0;
+	Buf journal;
+
+	if ((journal = job_journal_load(buf_time, &journal_version)))
+		journal_recs = _read_job_journal(journal, &journal_cnt);
+
+	/* Records carry their size, find them all before unpacking any */
+	while (remaining_buf(buffer) > 0) {
+		if (job_journal_rec_next(buffer, &rec) != SLURM_SUCCESS) {
+			error_code = SLURM_ERROR;
+			break;
+		}
+		if (journal_cnt &&
+		    bsearch(&rec, journal_recs, journal_cnt,
+			    sizeof(job_journal_rec_t), _find_journal_rec_id))
+			continue;	/* newer state in the journal */
+		if (rec_cnt >= rec_size) {
+			rec_size = MAX(rec_size * 2, 1024);
+			xrealloc(offsets, sizeof(uint32_t) * rec_size);
+		}
+		offsets[rec_cnt++] = rec.offset;
+	}
+	if (_load_job_recs(buffer, protocol_version, offsets, rec_cnt,
+			   job_cnt) != SLURM_SUCCESS)
+		error_code = SLURM_ERROR;
+	xfree(offsets);
+	if (error_code != SLURM_SUCCESS)
+		goto fini;
+
+	/* Load the journaled jobs in the order they were last saved */
+	if (journal_cnt)
+		qsort(journal_recs, journal_cnt, sizeof(job_journal_rec_t),
+		      _cmp_journal_rec_offset);
+	offsets = xmalloc(sizeof(uint32_t) * MAX(journal_cnt, 1));
+	for (i = 0, rec_cnt = 0; i < journal_cnt; i++) {
+		if (journal_recs[i].type != JOB_JOURNAL_REC_JOB)
+			continue;	/* purged */
+		offsets[rec_cnt++] = journal_recs[i].offset;
+	}
+	error_code = _load_job_recs(journal, journal_version, offsets,
+				    rec_cnt, &replay_cnt);
+	xfree(offsets);
+	*job_cnt += replay_cnt;
+	if (journal)
+		info("Replayed %d jobs from the job state journal", replay_cnt);
+
+fini:
+	xfree(journal_recs);
+	free_buf(journal);
+	return error_code;
+}
+
+/* Unpack the records of one job_unpack_args_t, see _load_job_recs() */
+static void *_unpack_job_recs(void *arg)
+{
+	job_unpack_args_t *args = (job_unpack_args_t *) arg;
+	struct slurm_buf view = *args->buffer;	/* same data, own offset */
+	Buf buffer = &view;
+	uint32_t i;
+
+	for (i = args->begin; i < args->end; i++) {
+		set_buf_offset(buffer, args->offsets[i]);
+		if (_unpack_job_state(buffer, args->protocol_version,
+				      &args->jobs[i]) != SLURM_SUCCESS)
+			break;
+	}
+	args->fail_inx = i;
+
+	return NULL;
+}
+
+/*
+ * _load_job_recs - load job records of a job_state snapshot or journal. The
+ *	records are unpacked on up to JOB_LOAD_MAX_THREADS threads into an array
+ *	sized to the record count, then added to job_list in file order by the
+ *	calling thread. Loading stops at the first record which can not be
+ *	unpacked. Set SLURMCTLD_LOAD_THREADS to cap the thread count.
+ * IN buffer - snapshot or journal
+ * IN protocol_version - protocol version of buffer
+ * IN offsets - offset in buffer of each record to load
+ * IN rec_cnt - count of records to load
+ * IN/OUT job_cnt - incremented for each job loaded
+ * RET 0 or error code
+ * NOTE: assoc_mgr tres and assoc read lock must be locked before calling
+ */
+static int _load_job_recs(Buf buffer, uint16_t protocol_version,
+			  uint32_t *offsets, uint32_t rec_cnt, int *job_cnt)
+{
+	job_unpack_args_t *args;
+	struct job_record **jobs;
+	pthread_t *threads;
+	uint32_t fail_inx = rec_cnt, i;
+	long cpu_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	char *max_threads;
+	int thread_cnt, t;
+
+	if (rec_cnt == 0)
+		return SLURM_SUCCESS;
+
+	thread_cnt = MIN(rec_cnt / JOB_LOAD_THREAD_RECS, JOB_LOAD_MAX_THREADS);
+	if (cpu_cnt > 0)
+		thread_cnt = MIN(thread_cnt, cpu_cnt);
+	/* Cap for comparing with a serial load, 1 unpacks on this thread */
+	if ((max_threads = getenv("SLURMCTLD_LOAD_THREADS")) &&
+	    (atoi(max_threads) > 0))
+		thread_cnt = MIN(thread_cnt, atoi(max_threads));
+	thread_cnt = MAX(thread_cnt, 1);
+
+	jobs = xmalloc(sizeof(struct job_record *) * rec_cnt);
+	args = xmalloc(sizeof(job_unpack_args_t) * thread_cnt);
+	threads = xmalloc(sizeof(pthread_t) * thread_cnt);
+	for (t = 0; t < thread_cnt; t++) {
+		args[t].begin = ((uint64_t) rec_cnt * t) / thread_cnt;
+		args[t].buffer = buffer;
+		args[t].end = ((uint64_t) rec_cnt * (t + 1)) / thread_cnt;
+		args[t].jobs = jobs;
+		args[t].offsets = offsets;
+		args[t].protocol_version = protocol_version;
+		if (t)	/* the calling thread takes the first range */
+			slurm_thread_create(&threads[t], _unpack_job_recs,
+					    &args[t]);
+	}
+	_unpack_job_recs(&args[0]);
+	for (t = 1; t < thread_cnt; t++)
+		pthread_join(threads[t], NULL);
+	debug("%s: unpacked %u job records on %d threads",
+	      __func__, rec_cnt, thread_cnt);
+
+	for (t = 0; t < thread_cnt; t++) {
+		if (args[t].fail_inx < args[t].end) {
+			fail_inx = args[t].fail_inx;
+			break;
+		}
+	}
+	for (i = 0; i < rec_cnt; i++) {
+		if (i < fail_inx) {
+			_link_job_state(jobs[i]);
+			(*job_cnt)++;
+		} else if (jobs[i]) {
+			_free_job_record(jobs[i]);
+		}
+	}
+
+	xfree(args);
+	xfree(jobs);
+	xfree(threads);
+	if (fail_inx < rec_cnt)
+		return SLURM_ERROR;
+	return SLURM_SUCCESS;
+}
+
+/* _load_journal_job_id - recover job_id_sequence from a snapshot's journal */
+static void _load_journal_job_id(time_t buf_time)
+{
+	job_journal_rec_t *journal_recs;
+	uint32_t journal_cnt = 0;
+	uint16_t journal_version;
+	Buf journal;
+
+	if (!(journal = job_journal_load(buf_time, &journal_version)))
+		return;
+	journal_recs = _read_job_journal(journal, &journal_cnt);
+	xfree(journal_recs);
+	free_buf(journal);
+	debug3("Job ID in job state journal is %u", job_id_sequence);
+}
+
 /*
  * load_last_job_id - load only the last job ID from state save file.
  *	Changes here should be reflected in load_all_job_state().
@@ -1062,6 +1567,7 @@ extern int load_last_job_id( void )
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = NO_VAL16;
+	bool journal_state = false;
 
 	/* read the file */
 	state_file = xstrdup_printf("%s/job_state",
@@ -1101,7 +1607,9 @@ extern int load_last_job_id( void )
 	buffer = create_buf(data, data_size);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
-	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+	if (ver_str && !xstrcmp(ver_str, JOB_JOURNAL_STATE_VERSION))
+		journal_state = true;
+	if (ver_str && (!xstrcmp(ver_str, JOB_STATE_VERSION) || journal_state))
 		safe_unpack16(&protocol_version, buffer);
 	xfree(ver_str);
 
@@ -1121,6 +1629,10 @@ extern int load_last_job_id( void )
 
 	/* Ignore the state for individual jobs stored here */
 
+	/* Jobs may have been submitted after the snapshot */
+	if (journal_state)
+		_load_journal_job_id(buf_time);
+
 	xfree(ver_str);
 	free_buf(buffer);
 	return SLURM_SUCCESS;
@@ -1339,9 +1851,18 @@ static int _dump_job_state(void *x, void *arg)
 	return 0;
 }
 
-/* Unpack a job's state information from a buffer */
-/* NOTE: assoc_mgr tres and assoc read lock must be locked before calling */
-static int _load_job_state(Buf buffer, uint16_t protocol_version)
+/*
+ * _unpack_job_state - unpack a job's state information from a buffer into a
+ *	new job record, not yet in job_list or the job hash tables. Only the
+ *	record itself is written, so several threads may unpack at once.
+ * IN buffer - job state, positioned at the record
+ * IN protocol_version - version the record was packed with
+ * OUT job_pptr - the record, add it with _link_job_state(). On error this
+ *	may be a partial record, release it with _free_job_record().
+ * RET SLURM_SUCCESS or SLURM_FAILURE
+ */
+static int _unpack_job_state(Buf buffer, uint16_t protocol_version,
+			     struct job_record **job_pptr)
 {
 	uint64_t db_index;
 	uint32_t job_id, user_id, group_id, time_limit, priority, alloc_sid;
@@ -1379,17 +1900,12 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	char *clusters = NULL, *pack_job_id_set = NULL, *user_name = NULL;
 	uint32_t task_id_size = NO_VAL;
 	char **spank_job_env = (char **) NULL;
-	List gres_list = NULL, part_ptr_list = NULL;
+	List gres_list = NULL;
 	struct job_record *job_ptr = NULL;
-	struct part_record *part_ptr;
-	int error_code, i, qos_error;
+	int error_code, i;
 	dynamic_plugin_data_t *select_jobinfo = NULL;
 	job_resources_t *job_resources = NULL;
 	check_jobinfo_t check_job = NULL;
-	slurmdb_assoc_rec_t assoc_rec;
-	slurmdb_qos_rec_t qos_rec;
-	bool job_finished = false;
-	char jbuf[JBUFSIZ];
 	double billable_tres = (double)NO_VAL;
 	char *tres_alloc_str = NULL, *tres_fmt_alloc_str = NULL,
 		*tres_req_str = NULL, *tres_fmt_req_str = NULL;
@@ -1398,6 +1914,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	uint32_t pack_leader = 0;
 	job_fed_details_t *job_fed_details = NULL;
 
+	*job_pptr = NULL;
 	memset(&limit_set, 0, sizeof(acct_policy_limit_set_t));
 	limit_set.tres = xmalloc(sizeof(uint16_t) * slurmctld_tres_cnt);
 
@@ -1430,18 +1947,10 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
-		job_ptr = find_job_record(job_id);
-		if (job_ptr == NULL) {
-			job_ptr = _create_job_record(1);
-			if (!job_ptr) {
-				error("Create job entry failed for job_id %u",
-				      job_id);
-				goto unpack_error;
-			}
-			job_ptr->job_id = job_id;
-			job_ptr->array_job_id = array_job_id;
-			job_ptr->array_task_id = array_task_id;
-		}
+		job_ptr = _alloc_job_record();
+		job_ptr->job_id = job_id;
+		job_ptr->array_job_id = array_job_id;
+		job_ptr->array_task_id = array_task_id;
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1511,21 +2020,6 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			error("No partition for job %u", job_id);
 			goto unpack_error;
 		}
-		part_ptr = find_part_record (partition);
-		if (part_ptr == NULL) {
-			char *err_part = NULL;
-			part_ptr_list = get_part_list(partition, &err_part);
-			if (part_ptr_list) {
-				part_ptr = list_peek(part_ptr_list);
-			} else {
-				verbose("Invalid partition (%s) for job_id %u",
-					err_part, job_id);
-				xfree(err_part);
-				/* not fatal error, partition could have been
-				 * removed, reset_job_bitmaps() will clean-up
-				 * this job */
-			}
-		}
 
 		safe_unpackstr_xmalloc(&name, &name_len, buffer);
 		safe_unpackstr_xmalloc(&user_name, &name_len, buffer);
@@ -1637,18 +2131,10 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
-		job_ptr = find_job_record(job_id);
-		if (job_ptr == NULL) {
-			job_ptr = _create_job_record(1);
-			if (!job_ptr) {
-				error("Create job entry failed for job_id %u",
-				      job_id);
-				goto unpack_error;
-			}
-			job_ptr->job_id = job_id;
-			job_ptr->array_job_id = array_job_id;
-			job_ptr->array_task_id = array_task_id;
-		}
+		job_ptr = _alloc_job_record();
+		job_ptr->job_id = job_id;
+		job_ptr->array_job_id = array_job_id;
+		job_ptr->array_task_id = array_task_id;
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1714,21 +2200,6 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			error("No partition for job %u", job_id);
 			goto unpack_error;
 		}
-		part_ptr = find_part_record (partition);
-		if (part_ptr == NULL) {
-			char *err_part = NULL;
-			part_ptr_list = get_part_list(partition, &err_part);
-			if (part_ptr_list) {
-				part_ptr = list_peek(part_ptr_list);
-			} else {
-				verbose("Invalid partition (%s) for job_id %u",
-					err_part, job_id);
-				xfree(err_part);
-				/* not fatal error, partition could have been
-				 * removed, reset_job_bitmaps() will clean-up
-				 * this job */
-			}
-		}
 
 		safe_unpackstr_xmalloc(&name, &name_len, buffer);
 		safe_unpackstr_xmalloc(&wckey, &name_len, buffer);
@@ -1841,18 +2312,10 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			goto unpack_error;
 		}
 
-		job_ptr = find_job_record(job_id);
-		if (job_ptr == NULL) {
-			job_ptr = _create_job_record(1);
-			if (!job_ptr) {
-				error("Create job entry failed for job_id %u",
-				      job_id);
-				goto unpack_error;
-			}
-			job_ptr->job_id = job_id;
-			job_ptr->array_job_id = array_job_id;
-			job_ptr->array_task_id = array_task_id;
-		}
+		job_ptr = _alloc_job_record();
+		job_ptr->job_id = job_id;
+		job_ptr->array_job_id = array_job_id;
+		job_ptr->array_task_id = array_task_id;
 
 		safe_unpack32(&user_id, buffer);
 		safe_unpack32(&group_id, buffer);
@@ -1922,21 +2385,6 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			error("No partition for job %u", job_id);
 			goto unpack_error;
 		}
-		part_ptr = find_part_record (partition);
-		if (part_ptr == NULL) {
-			char *err_part = NULL;
-			part_ptr_list = get_part_list(partition, &err_part);
-			if (part_ptr_list) {
-				part_ptr = list_peek(part_ptr_list);
-			} else {
-				verbose("Invalid partition (%s) for job_id %u",
-					err_part, job_id);
-				xfree(err_part);
-				/* not fatal error, partition could have been
-				 * removed, reset_job_bitmaps() will clean-up
-				 * this job */
-			}
-		}
 
 		safe_unpackstr_xmalloc(&name, &name_len, buffer);
 		safe_unpackstr_xmalloc(&wckey, &name_len, buffer);
@@ -2026,11 +2474,6 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 		goto unpack_error;
 	}
 
-	if ((priority > 1) && (direct_set_prio == 0)) {
-		highest_prio = MAX(highest_prio, priority);
-		lowest_prio  = MIN(lowest_prio,  priority);
-	}
-
 #if 0
 	/*
 	 * This is not necessary since the job_id_sequence is checkpointed and
@@ -2155,8 +2598,6 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	xfree(job_ptr->partition);
 	job_ptr->partition    = partition;
 	partition             = NULL;	/* reused, nothing left to free */
-	job_ptr->part_ptr = part_ptr;
-	job_ptr->part_ptr_list = part_ptr_list;
 	job_ptr->pre_sus_time = pre_sus_time;
 	job_ptr->priority     = priority;
 	job_ptr->qos_id       = qos_id;
@@ -2199,54 +2640,151 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 			job_ptr->array_recs->task_cnt =
 				bit_set_count(job_ptr->array_recs->
 					      task_id_bitmap);
+		} else
+			xfree(task_id_str);
+		job_ptr->array_recs->array_flags    = array_flags;
+		job_ptr->array_recs->max_run_tasks  = max_run_tasks;
+		job_ptr->array_recs->tot_run_tasks  = tot_run_tasks;
+		job_ptr->array_recs->min_exit_code  = min_exit_code;
+		job_ptr->array_recs->max_exit_code  = max_exit_code;
+		job_ptr->array_recs->tot_comp_tasks = tot_comp_tasks;
+	}
+	job_ptr->time_last_active = now;
+	job_ptr->time_limit   = time_limit;
+	job_ptr->time_min     = time_min;
+	job_ptr->total_cpus   = total_cpus;
+
+	if (IS_JOB_PENDING(job_ptr))
+		job_ptr->node_cnt_wag = total_nodes;
+	else
+		job_ptr->total_nodes  = total_nodes;
+
+	job_ptr->cpu_cnt      = cpu_cnt;
+	job_ptr->tot_sus_time = tot_sus_time;
+	job_ptr->last_sched_eval = last_sched_eval;
+	job_ptr->preempt_time = preempt_time;
+	job_ptr->user_id      = user_id;
+	select_g_select_jobinfo_set(job_ptr->select_jobinfo,
+				    SELECT_JOBDATA_USER_NAME, &user_id);
+	job_ptr->wait_all_nodes = wait_all_nodes;
+	job_ptr->warn_flags   = warn_flags;
+	job_ptr->warn_signal  = warn_signal;
+	job_ptr->warn_time    = warn_time;
+
+	memcpy(&job_ptr->limit_set, &limit_set,
+	       sizeof(acct_policy_limit_set_t));
+	limit_set.tres = NULL;
+
+	job_ptr->req_switch      = req_switch;
+	job_ptr->wait4switch     = wait4switch;
+	job_ptr->profile         = profile;
+	/* This needs to always to initialized to "true".  The select
+	   plugin will deal with it every time it goes through the
+	   logic if req_switch or wait4switch are set.
+	*/
+	job_ptr->best_switch     = true;
+	job_ptr->start_protocol_ver = start_protocol_ver;
+
+	job_ptr->clusters     = clusters;
+	job_ptr->fed_details  = job_fed_details;
+	*job_pptr = job_ptr;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	error("Incomplete job record");
+	xfree(alloc_node);
+	xfree(account);
+	xfree(admin_comment);
+	xfree(batch_host);
+	xfree(burst_buffer);
+	xfree(clusters);
+	xfree(comment);
+	xfree(gres);
+	xfree(gres_alloc);
+	xfree(gres_req);
+	xfree(gres_used);
+	free_job_fed_details(&job_fed_details);
+	free_job_resources(&job_resources);
+	xfree(resp_host);
+	xfree(licenses);
+	xfree(limit_set.tres);
+	xfree(mail_user);
+	xfree(mcs_label);
+	xfree(name);
+	xfree(nodes);
+	xfree(nodes_completing);
+	xfree(pack_job_id_set);
+	xfree(partition);
+	xfree(resv_name);
+	for (i = 0; i < spank_job_env_size; i++)
+		xfree(spank_job_env[i]);
+	xfree(spank_job_env);
+	xfree(state_desc);
+	xfree(task_id_str);
+	xfree(tres_alloc_str);
+	xfree(tres_fmt_alloc_str);
+	xfree(tres_fmt_req_str);
+	xfree(tres_req_str);
+	xfree(user_name);
+	xfree(wckey);
+	select_g_select_jobinfo_free(select_jobinfo);
+	checkpoint_free_jobinfo(check_job);
+	*job_pptr = job_ptr;
+	for (i=0; i<pelog_env_size; i++)
+		xfree(pelog_env[i]);
+	xfree(pelog_env);
+	return SLURM_FAILURE;
+}
 
-			if (job_ptr->array_recs->task_cnt > 1)
-				job_count += (job_ptr->array_recs->task_cnt-1);
-		} else
-			xfree(task_id_str);
-		job_ptr->array_recs->array_flags    = array_flags;
-		job_ptr->array_recs->max_run_tasks  = max_run_tasks;
-		job_ptr->array_recs->tot_run_tasks  = tot_run_tasks;
-		job_ptr->array_recs->min_exit_code  = min_exit_code;
-		job_ptr->array_recs->max_exit_code  = max_exit_code;
-		job_ptr->array_recs->tot_comp_tasks = tot_comp_tasks;
-	}
-	job_ptr->time_last_active = now;
-	job_ptr->time_limit   = time_limit;
-	job_ptr->time_min     = time_min;
-	job_ptr->total_cpus   = total_cpus;
+/*
+ * _link_job_state - add a job record from _unpack_job_state() to job_list and
+ *	the job hash tables, then resolve its partition, association and QOS
+ * NOTE: assoc_mgr tres and assoc read lock must be locked before calling
+ */
+static void _link_job_state(struct job_record *job_ptr)
+{
+	uint32_t job_id = job_ptr->job_id, num_jobs = 1;
+	List part_ptr_list = NULL;
+	struct part_record *part_ptr;
+	slurmdb_assoc_rec_t assoc_rec;
+	slurmdb_qos_rec_t qos_rec;
+	bool job_finished = false;
+	char jbuf[JBUFSIZ];
+	int qos_error;
 
-	if (IS_JOB_PENDING(job_ptr))
-		job_ptr->node_cnt_wag = total_nodes;
-	else
-		job_ptr->total_nodes  = total_nodes;
+	if (find_job_record(job_id)) {
+		error("Duplicate record for job %u, ignoring it", job_id);
+		_free_job_record(job_ptr);
+		return;
+	}
 
-	job_ptr->cpu_cnt      = cpu_cnt;
-	job_ptr->tot_sus_time = tot_sus_time;
-	job_ptr->last_sched_eval = last_sched_eval;
-	job_ptr->preempt_time = preempt_time;
-	job_ptr->user_id      = user_id;
-	select_g_select_jobinfo_set(job_ptr->select_jobinfo,
-				    SELECT_JOBDATA_USER_NAME, &user_id);
-	job_ptr->wait_all_nodes = wait_all_nodes;
-	job_ptr->warn_flags   = warn_flags;
-	job_ptr->warn_signal  = warn_signal;
-	job_ptr->warn_time    = warn_time;
+	part_ptr = find_part_record(job_ptr->partition);
+	if (part_ptr == NULL) {
+		char *err_part = NULL;
+		part_ptr_list = get_part_list(job_ptr->partition, &err_part);
+		if (part_ptr_list) {
+			part_ptr = list_peek(part_ptr_list);
+		} else {
+			verbose("Invalid partition (%s) for job_id %u",
+				err_part, job_id);
+			xfree(err_part);
+			/* not fatal error, partition could have been
+			 * removed, reset_job_bitmaps() will clean-up
+			 * this job */
+		}
+	}
+	job_ptr->part_ptr = part_ptr;
+	job_ptr->part_ptr_list = part_ptr_list;
 
-	memcpy(&job_ptr->limit_set, &limit_set,
-	       sizeof(acct_policy_limit_set_t));
-	limit_set.tres = NULL;
+	if ((job_ptr->priority > 1) && (job_ptr->direct_set_prio == 0)) {
+		highest_prio = MAX(highest_prio, job_ptr->priority);
+		lowest_prio  = MIN(lowest_prio,  job_ptr->priority);
+	}
 
-	job_ptr->req_switch      = req_switch;
-	job_ptr->wait4switch     = wait4switch;
-	job_ptr->profile         = profile;
-	/* This needs to always to initialized to "true".  The select
-	   plugin will deal with it every time it goes through the
-	   logic if req_switch or wait4switch are set.
-	*/
-	job_ptr->best_switch     = true;
-	job_ptr->start_protocol_ver = start_protocol_ver;
+	if (job_ptr->array_recs && (job_ptr->array_recs->task_cnt > 1))
+		num_jobs += job_ptr->array_recs->task_cnt - 1;
 
+	_add_job_record(job_ptr, num_jobs);
 	_add_job_hash(job_ptr);
 	_add_job_array_hash(job_ptr);
 
@@ -2339,59 +2877,22 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 		job_set_req_tres(job_ptr, true);
 
 	build_node_details(job_ptr, false);	/* set node_addr */
-	job_ptr->clusters     = clusters;
-	job_ptr->fed_details  = job_fed_details;
-	return SLURM_SUCCESS;
+}
 
-unpack_error:
-	error("Incomplete job record");
-	xfree(alloc_node);
-	xfree(account);
-	xfree(admin_comment);
-	xfree(batch_host);
-	xfree(burst_buffer);
-	xfree(clusters);
-	xfree(comment);
-	xfree(gres);
-	xfree(gres_alloc);
-	xfree(gres_req);
-	xfree(gres_used);
-	free_job_fed_details(&job_fed_details);
-	free_job_resources(&job_resources);
-	xfree(resp_host);
-	xfree(licenses);
-	xfree(limit_set.tres);
-	xfree(mail_user);
-	xfree(mcs_label);
-	xfree(name);
-	xfree(nodes);
-	xfree(nodes_completing);
-	xfree(pack_job_id_set);
-	xfree(partition);
-	FREE_NULL_LIST(part_ptr_list);
-	xfree(resv_name);
-	for (i = 0; i < spank_job_env_size; i++)
-		xfree(spank_job_env[i]);
-	xfree(spank_job_env);
-	xfree(state_desc);
-	xfree(task_id_str);
-	xfree(tres_alloc_str);
-	xfree(tres_fmt_alloc_str);
-	xfree(tres_fmt_req_str);
-	xfree(tres_req_str);
-	xfree(user_name);
-	xfree(wckey);
-	select_g_select_jobinfo_free(select_jobinfo);
-	checkpoint_free_jobinfo(check_job);
-	if (job_ptr) {
-		if (job_ptr->job_id == 0)
-			job_ptr->job_id = NO_VAL;
-		purge_job_record(job_ptr->job_id);
+/* Unpack a job's state information from a buffer and add it to job_list */
+/* NOTE: assoc_mgr tres and assoc read lock must be locked before calling */
+static int _load_job_state(Buf buffer, uint16_t protocol_version)
+{
+	struct job_record *job_ptr = NULL;
+
+	if (_unpack_job_state(buffer, protocol_version, &job_ptr) !=
+	    SLURM_SUCCESS) {
+		if (job_ptr)
+			_free_job_record(job_ptr);
+		return SLURM_FAILURE;
 	}
-	for (i=0; i<pelog_env_size; i++)
-		xfree(pelog_env[i]);
-	xfree(pelog_env);
-	return SLURM_FAILURE;
+	_link_job_state(job_ptr);
+	return SLURM_SUCCESS;
 }
 
 /*
@@ -3195,6 +3696,7 @@ static void _rebuild_part_name_list(struct job_record  *job_ptr)
 	}
 	list_iterator_destroy(part_iterator);
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 }
 
 /*
@@ -3395,6 +3897,7 @@ extern int kill_job_by_part_name(char *part_name)
 			}
 			list_iterator_destroy(part_iterator);
 			if (rebuild_name_list) {
+				job_set_changed(job_ptr);
 				if (list_count(job_ptr->part_ptr_list) > 0) {
 					_rebuild_part_name_list(job_ptr);
 					job_ptr->part_ptr =
@@ -3421,6 +3924,7 @@ extern int kill_job_by_part_name(char *part_name)
 		}
 		if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			info("Killing job_id %u on defunct partition %s",
 			     job_ptr->job_id, part_name);
 			job_ptr->job_state = JOB_NODE_FAIL | JOB_COMPLETING;
@@ -3439,6 +3943,7 @@ extern int kill_job_by_part_name(char *part_name)
 						 false);
 		} else if (pending) {
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			info("Killing job_id %u on defunct partition %s",
 			     job_ptr->job_id, part_name);
 			job_ptr->job_state	= JOB_CANCELLED;
@@ -3448,6 +3953,7 @@ extern int kill_job_by_part_name(char *part_name)
 			job_completion_logger(job_ptr, false);
 			fed_mgr_job_complete(job_ptr, 0, now);
 		}
+		job_set_changed(job_ptr);
 		job_ptr->part_ptr = NULL;
 		FREE_NULL_LIST(job_ptr->part_ptr_list);
 	}
@@ -3506,6 +4012,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 		}
 		if (IS_JOB_COMPLETING(job_ptr)) {
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			while ((i = bit_ffs(job_ptr->node_bitmap_cg)) >= 0) {
 				bit_clear(job_ptr->node_bitmap_cg, i);
 				if (job_ptr->node_cnt)
@@ -3529,6 +4036,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			if (job_ptr->batch_flag && job_ptr->details &&
 			    slurmctld_conf.job_requeue &&
 			    (job_ptr->details->requeue > 0)) {
@@ -3805,6 +4313,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			if (!bit_test(job_ptr->node_bitmap_cg, node_inx))
 				continue;
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			bit_clear(job_ptr->node_bitmap_cg, node_inx);
 			job_update_tres_cnt(job_ptr, node_inx);
 			if (job_ptr->node_cnt)
@@ -3825,6 +4334,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			job_set_changed(job_ptr);
 			if ((job_ptr->details) &&
 			    (job_ptr->kill_on_node_fail == 0) &&
 			    (job_ptr->node_cnt > 1)) {
@@ -4848,6 +5358,7 @@ extern int job_allocate(job_desc_msg_t * job_specs, int immediate,
 	error_code = _select_nodes_parts(job_ptr, no_alloc, NULL, err_msg);
 	if (!test_only) {
 		last_job_update = now;
+		job_set_changed(job_ptr);
 	}
 
        /* Moved this (_create_job_array) here to handle when a job
@@ -4962,6 +5473,7 @@ static int _job_fail(struct job_record *job_ptr, uint32_t job_state)
 		} else
 			job_ptr->end_time       = now;
 		last_job_update                 = now;
+		job_set_changed(job_ptr);
 		job_ptr->job_state = job_state | JOB_COMPLETING;
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_LAUNCH;
@@ -5087,6 +5599,7 @@ static int _job_signal(struct job_record *job_ptr, uint16_t signal,
 	/* let node select plugin do any state-dependent signaling actions */
 	select_g_job_signal(job_ptr, signal);
 	last_job_update = now;
+	job_set_changed(job_ptr);
 
 	/* save user ID of the one who requested the job be cancelled */
 	if (signal == SIGKILL)
@@ -5107,6 +5620,7 @@ static int _job_signal(struct job_record *job_ptr, uint16_t signal,
 
 	if (IS_JOB_CONFIGURING(job_ptr) && (signal == SIGKILL)) {
 		last_job_update         = now;
+		job_set_changed(job_ptr);
 		job_ptr->end_time       = now;
 		job_ptr->job_state      = JOB_CANCELLED | JOB_COMPLETING;
 		if (flags & KILL_FED_REQUEUE)
@@ -5153,6 +5667,7 @@ static int _job_signal(struct job_record *job_ptr, uint16_t signal,
 		job_term_state = JOB_CANCELLED;
 	if (IS_JOB_SUSPENDED(job_ptr) && (signal == SIGKILL)) {
 		last_job_update         = now;
+		job_set_changed(job_ptr);
 		job_ptr->end_time       = job_ptr->suspend_time;
 		job_ptr->tot_sus_time  += difftime(now, job_ptr->suspend_time);
 		job_ptr->job_state      = job_term_state | JOB_COMPLETING;
@@ -5184,6 +5699,7 @@ static int _job_signal(struct job_record *job_ptr, uint16_t signal,
 			job_ptr->time_last_active	= now;
 			job_ptr->end_time		= now;
 			last_job_update			= now;
+			job_set_changed(job_ptr);
 			job_ptr->job_state = job_term_state | JOB_COMPLETING;
 			if (flags & KILL_FED_REQUEUE)
 				job_ptr->job_state |= JOB_REQUEUE;
@@ -5495,6 +6011,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 			bit_and_not(job_ptr->array_recs->task_id_bitmap,
 				array_bitmap);
 			xfree(job_ptr->array_recs->task_id_str);
+			job_set_changed(job_ptr);
 			orig_task_cnt = job_ptr->array_recs->task_cnt;
 			new_task_count = bit_set_count(job_ptr->array_recs->
 						       task_id_bitmap);
@@ -5807,6 +6324,7 @@ static int _job_complete(struct job_record *job_ptr, uid_t uid, bool requeue,
 	}
 
 	last_job_update = now;
+	job_set_changed(job_ptr);
 	job_ptr->time_last_active = now;   /* Timer for resending kill RPC */
 	if (job_comp_flag) {	/* job was running */
 		build_cg_bitmap(job_ptr);
@@ -8290,6 +8808,7 @@ extern void job_config_fini(struct job_record *job_ptr)
 	time_t now = time(NULL);
 
 	last_job_update = now;
+	job_set_changed(job_ptr);
 	job_ptr->job_state &= ~JOB_CONFIGURING;
 	if (IS_JOB_POWER_UP_NODE(job_ptr)) {
 		info("Resetting job %u start time for node power up",
@@ -8479,6 +8998,7 @@ void job_time_limit(void)
 			job_ptr->state_reason = WAIT_NO_REASON;
 			set_job_prio(job_ptr);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		}
 
 		if (_pack_configuring_test(job_ptr))
@@ -8512,6 +9032,7 @@ void job_time_limit(void)
 			}
 			if (job_ptr->end_time <= now) {
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				info("%s: Preemption GraceTime reached JobId=%u",
 				     __func__, job_ptr->job_id);
 				job_ptr->job_state = JOB_PREEMPTED |
@@ -8598,6 +9119,7 @@ void job_time_limit(void)
 				over_run = now - (over_time_limit  * 60);
 			if (job_ptr->end_time <= over_run) {
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				info("Time limit exhausted for JobId=%u",
 				     job_ptr->job_id);
 				_job_timed_out(job_ptr);
@@ -8611,6 +9133,7 @@ void job_time_limit(void)
 		    (job_ptr->resv_ptr->end_time + resv_over_run)
 		     < time(NULL)) {
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			info("Reservation ended for JobId=%u",
 			     job_ptr->job_id);
 			_job_timed_out(job_ptr);
@@ -8631,6 +9154,7 @@ void job_time_limit(void)
 
 		if (job_ptr->state_reason == FAIL_TIMEOUT) {
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			_job_timed_out(job_ptr);
 			xfree(job_ptr->state_desc);
 			goto time_check;
@@ -9036,7 +9560,7 @@ _validate_min_mem_partition(job_desc_msg_t *job_desc_msg,
 static void _list_delete_job(void *job_entry)
 {
 	struct job_record *job_ptr = (struct job_record *) job_entry;
-	int job_array_size, i;
+	int job_array_size;
 
 	xassert(job_entry);
 	xassert (job_ptr->magic == JOB_MAGIC);
@@ -9045,6 +9569,13 @@ static void _list_delete_job(void *job_entry)
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
+	/* Report the purge to delta RPC clients which may have the job */
+	if (job_ptr->delta_gen)
+		info_delta_purge(&job_delta, job_ptr->job_id);
+
+	if (job_journal_enabled())
+		_journal_purge(job_ptr->job_id);
+
 	/* Remove the record from job hash table */
 	_remove_job_hash(job_ptr, JOB_HASH_JOB);
 
@@ -9060,6 +9591,35 @@ static void _list_delete_job(void *job_entry)
 		_remove_job_hash(job_ptr, JOB_HASH_ARRAY_TASK);
 	}
 
+	/*
+	 * Queue up job to have the batch script and environment deleted.
+	 * This is handled by a separate thread to limit the amount of
+	 * time purge_old_job needs to spend holding locks.
+	 */
+	if (job_ptr->details && IS_JOB_FINISHED(job_ptr)) {
+		uint32_t *job_id = xmalloc(sizeof(uint32_t));
+		*job_id = job_ptr->job_id;
+		list_enqueue(purge_files_list, job_id);
+	}
+
+	if (job_array_size > job_count) {
+		error("job_count underflow");
+		job_count = 0;
+	} else {
+		job_count -= job_array_size;
+	}
+
+	_free_job_record(job_ptr);
+}
+
+/*
+ * _free_job_record - free a job record and its corresponding job_details,
+ *	once out of job_list and the job hash tables (or never in them)
+ */
+static void _free_job_record(struct job_record *job_ptr)
+{
+	int i;
+
 	_delete_job_details(job_ptr);
 	xfree(job_ptr->account);
 	xfree(job_ptr->admin_comment);
@@ -9119,12 +9679,6 @@ static void _list_delete_job(void *job_entry)
 	select_g_select_jobinfo_free(job_ptr->select_jobinfo);
 	xfree(job_ptr->user_name);
 	xfree(job_ptr->wckey);
-	if (job_array_size > job_count) {
-		error("job_count underflow");
-		job_count = 0;
-	} else {
-		job_count -= job_array_size;
-	}
 	job_ptr->job_id = 0;
 	xfree(job_ptr);
 }
@@ -9292,8 +9846,9 @@ static void _pack_job(struct job_record *job_ptr,
 	    (pack_info->filter_uid != job_ptr->user_id))
 		return;
 
-	pack_job(job_ptr, pack_info->show_flags, pack_info->buffer,
-		 pack_info->protocol_version, pack_info->uid);
+	pack_job_fields(job_ptr, pack_info->show_flags, pack_info->fields,
+			pack_info->buffer, pack_info->protocol_version,
+			pack_info->uid);
 
 	(*pack_info->jobs_packed)++;
 }
@@ -9313,20 +9868,180 @@ static int _foreach_pack_jobid(void *object, void *arg)
 	uint32_t job_id = *(uint32_t *)object;
 	_foreach_pack_job_info_t *info = (_foreach_pack_job_info_t *)arg;
 
-	if (!(job_ptr = find_job_record(job_id)))
-		return SLURM_SUCCESS;
+	if (!(job_ptr = find_job_record(job_id)))
+		return SLURM_SUCCESS;
+
+	_pack_job(job_ptr, info);
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * pack_all_jobs - dump all job information for all jobs in
+ *	machine independent form (for network transmission)
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
+			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			  uint16_t protocol_version)
+{
+	uint32_t jobs_packed = 0, tmp_offset;
+	_foreach_pack_job_info_t pack_info = {0};
+	Buf buffer;
+
+	buffer_ptr[0] = NULL;
+	*buffer_size = 0;
+
+	buffer = init_buf(BUF_SIZE);
+
+	/* write message body header : size and time */
+	/* put in a place holder job record count of 0 for now */
+	pack32(jobs_packed, buffer);
+	pack_time(time(NULL), buffer);
+
+	/* write individual job records */
+	pack_info.buffer           = buffer;
+	pack_info.filter_uid       = filter_uid;
+	pack_info.jobs_packed      = &jobs_packed;
+	pack_info.protocol_version = protocol_version;
+	pack_info.fields           = JOB_FIELD_ALL;
+	pack_info.show_flags       = show_flags;
+	pack_info.uid              = uid;
+
+	list_for_each(job_list, _foreach_pack_job_ptr, &pack_info);
+
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack32(jobs_packed, buffer);
+	set_buf_offset(buffer, tmp_offset);
+
+	*buffer_size = get_buf_offset(buffer);
+	buffer_ptr[0] = xfer_buf_data(buffer);
+}
+
+/*
+ * job_set_changed - note that a job record was modified, call wherever
+ *	last_job_update is set for that job
+ * IN job_ptr - the modified job
+ * NOTE: job write lock must be locked before calling this
+ */
+extern void job_set_changed(struct job_record *job_ptr)
+{
+	info_delta_touch(&job_delta, &job_ptr->delta_gen);
+}
+
+static int _foreach_pack_job_delta(void *object, void *arg)
+{
+	struct job_record *job_ptr = (struct job_record *)object;
+	_foreach_pack_job_info_t *pack_info = (_foreach_pack_job_info_t *)arg;
+	uint32_t jobs_packed = *pack_info->jobs_packed;
+
+	if (pack_info->since && (job_ptr->delta_gen <= pack_info->since))
+		return SLURM_SUCCESS;
+
+	_pack_job(job_ptr, pack_info);
+	if ((*pack_info->jobs_packed == jobs_packed) && pack_info->since) {
+		/* The client may hold this job from before it was hidden */
+		xrealloc(pack_info->removed_ids,
+			 sizeof(uint32_t) * (pack_info->removed_cnt + 1));
+		pack_info->removed_ids[pack_info->removed_cnt++] =
+			job_ptr->job_id;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * pack_jobs_delta - dump job information for jobs changed since a
+ *	generation in machine independent form (for network transmission)
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN generation - generation from the client's previous response, 0 if none
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: A full response holds every job as pack_all_jobs() does, otherwise
+ *	only the changed jobs visible to the user are packed and the IDs of
+ *	changed jobs which are now hidden follow as removals
+ * NOTE: change _unpack_job_info_delta_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern void pack_jobs_delta(char **buffer_ptr, int *buffer_size,
+			    uint64_t generation, uint16_t show_flags,
+			    uid_t uid, uint32_t filter_uid,
+			    uint16_t protocol_version)
+{
+	uint32_t jobs_packed = 0, count_offset, tmp_offset;
+	_foreach_pack_job_info_t pack_info = {0};
+	uint64_t since;
+	bool full;
+	Buf buffer;
+
+	buffer_ptr[0] = NULL;
+	*buffer_size = 0;
+
+	buffer = init_buf(BUF_SIZE);
+
+	info_delta_lock(&job_delta);
+	full = info_delta_since(&job_delta, generation, &since);
+
+	/* write delta header: generation, full flag and purged jobs */
+	pack64(info_delta_generation(&job_delta), buffer);
+	pack16((uint16_t) full, buffer);
+	info_delta_pack_purged(&job_delta, since, full, buffer);
+
+	/* write message body header : size and time */
+	/* put in a place holder job record count of 0 for now */
+	count_offset = get_buf_offset(buffer);
+	pack32(jobs_packed, buffer);
+	pack_time(time(NULL), buffer);
+
+	/* write individual job records */
+	pack_info.buffer           = buffer;
+	pack_info.filter_uid       = filter_uid;
+	pack_info.jobs_packed      = &jobs_packed;
+	pack_info.protocol_version = protocol_version;
+	pack_info.fields           = JOB_FIELD_ALL;
+	pack_info.show_flags       = show_flags;
+	pack_info.since            = since;
+	pack_info.uid              = uid;
+
+	list_for_each(job_list, _foreach_pack_job_delta, &pack_info);
+	info_delta_end(&job_delta);
+
+	/* write the IDs of the jobs removed from the client's view */
+	pack32_array(pack_info.removed_ids, pack_info.removed_cnt, buffer);
+	xfree(pack_info.removed_ids);
 
-	_pack_job(job_ptr, info);
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, count_offset);
+	pack32(jobs_packed, buffer);
+	set_buf_offset(buffer, tmp_offset);
 
-	return SLURM_SUCCESS;
+	*buffer_size = get_buf_offset(buffer);
+	buffer_ptr[0] = xfer_buf_data(buffer);
 }
 
 /*
- * pack_all_jobs - dump all job information for all jobs in
+ * pack_spec_jobs - dump job information for specified jobs in
  *	machine independent form (for network transmission)
  * OUT buffer_ptr - the pointer is set to the allocated buffer.
  * OUT buffer_size - set to size of the buffer in bytes
  * IN show_flags - job filtering options
+ * IN job_ids - list of job_ids to pack
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
  * global: job_list - global list of job records
@@ -9334,14 +10049,16 @@ static int _foreach_pack_jobid(void *object, void *arg)
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
  *	whenever the data format changes
  */
-extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
-			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version)
+extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
+			   uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			   uint16_t protocol_version)
 {
 	uint32_t jobs_packed = 0, tmp_offset;
 	_foreach_pack_job_info_t pack_info = {0};
 	Buf buffer;
 
+	xassert(job_ids);
+
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
@@ -9357,10 +10074,11 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	pack_info.filter_uid       = filter_uid;
 	pack_info.jobs_packed      = &jobs_packed;
 	pack_info.protocol_version = protocol_version;
+	pack_info.fields           = JOB_FIELD_ALL;
 	pack_info.show_flags       = show_flags;
 	pack_info.uid              = uid;
 
-	list_for_each(job_list, _foreach_pack_job_ptr, &pack_info);
+	list_for_each(job_ids, _foreach_pack_jobid, &pack_info);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9372,33 +10090,210 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = xfer_buf_data(buffer);
 }
 
+/* Return true if a job matches every list of a job query */
+static bool _match_job_query(struct job_record *job_ptr, _job_query_t *q)
+{
+	job_info_query_t *query = q->query;
+	uint32_t base_state = job_ptr->job_state & JOB_STATE_BASE;
+	struct part_record *part_ptr;
+	ListIterator part_iterator;
+	bool match;
+	int i;
+
+	if (query->user_id_cnt) {
+		match = false;
+		for (i = 0; i < query->user_id_cnt; i++) {
+			if (query->user_ids[i] == job_ptr->user_id) {
+				match = true;
+				break;
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	if (query->state_cnt) {
+		match = false;
+		for (i = 0; i < query->state_cnt; i++) {
+			if (query->states[i] & JOB_STATE_FLAGS) {
+				if (query->states[i] & job_ptr->job_state)
+					match = true;
+			} else if (query->states[i] == base_state)
+				match = true;
+			if (match)
+				break;
+		}
+		if (!match)
+			return false;
+	}
+
+	if (q->account_cnt) {
+		match = false;
+		for (i = 0; i < q->account_cnt; i++) {
+			if (!xstrcasecmp(q->accounts[i], job_ptr->account)) {
+				match = true;
+				break;
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	if (query->partitions && query->partitions[0]) {
+		match = false;
+		for (i = 0; (i < q->part_cnt) && !match; i++) {
+			if (job_ptr->part_ptr == q->parts[i]) {
+				match = true;
+			} else if (job_ptr->part_ptr_list) {
+				part_iterator = list_iterator_create(
+					job_ptr->part_ptr_list);
+				while ((part_ptr = list_next(part_iterator))) {
+					if (part_ptr == q->parts[i]) {
+						match = true;
+						break;
+					}
+				}
+				list_iterator_destroy(part_iterator);
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	return true;
+}
+
+static int _foreach_pack_job_query(void *object, void *arg)
+{
+	struct job_record *job_ptr = (struct job_record *)object;
+	_foreach_pack_job_info_t *pack_info = (_foreach_pack_job_info_t *)arg;
+
+	if (_match_job_query(job_ptr, pack_info->query))
+		_pack_job(job_ptr, pack_info);
+
+	return SLURM_SUCCESS;
+}
+
+static int _sort_job_ptr(const void *a, const void *b)
+{
+	uintptr_t x = (uintptr_t) *(struct job_record **) a;
+	uintptr_t y = (uintptr_t) *(struct job_record **) b;
+
+	if (x < y)
+		return -1;
+	if (x > y)
+		return 1;
+	return 0;
+}
+
+static void _add_query_job(struct job_record ***jobs, int *job_cnt,
+			   int *job_size, struct job_record *job_ptr)
+{
+	if (*job_cnt >= *job_size) {
+		*job_size = MAX(16, *job_size * 2);
+		xrealloc(*jobs, sizeof(struct job_record *) * *job_size);
+	}
+	(*jobs)[(*job_cnt)++] = job_ptr;
+}
+
+/* Pack the jobs of the query's job IDs, found by the job hash tables */
+static void _pack_query_job_ids(_foreach_pack_job_info_t *pack_info)
+{
+	job_info_query_t *query = pack_info->query->query;
+	struct job_record *job_ptr, *pack_ptr, **jobs = NULL;
+	ListIterator iter;
+	int i, job_cnt = 0, job_size = 0;
+
+	for (i = 0; i < query->job_id_cnt; i++) {
+		uint32_t job_id = query->job_ids[i];
+
+		if ((job_ptr = find_job_record(job_id))) {
+			_add_query_job(&jobs, &job_cnt, &job_size, job_ptr);
+			if (job_ptr->pack_job_list) {
+				/* Heterogeneous job components */
+				iter = list_iterator_create(
+					job_ptr->pack_job_list);
+				while ((pack_ptr = list_next(iter)))
+					_add_query_job(&jobs, &job_cnt,
+						       &job_size, pack_ptr);
+				list_iterator_destroy(iter);
+			}
+		}
+		/* Job array tasks */
+		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		while (job_ptr) {
+			if (job_ptr->array_job_id == job_id)
+				_add_query_job(&jobs, &job_cnt, &job_size,
+					       job_ptr);
+			job_ptr = job_ptr->job_array_next_j;
+		}
+	}
+
+	/* Several IDs may name the same job, pack it once */
+	if (job_cnt > 1)
+		qsort(jobs, job_cnt, sizeof(struct job_record *),
+		      _sort_job_ptr);
+	for (i = 0; i < job_cnt; i++) {
+		if ((i > 0) && (jobs[i] == jobs[i - 1]))
+			continue;
+		if (_match_job_query(jobs[i], pack_info->query))
+			_pack_job(jobs[i], pack_info);
+	}
+	xfree(jobs);
+}
+
 /*
- * pack_spec_jobs - dump job information for specified jobs in
+ * pack_jobs_query - dump job information for the jobs matching a query in
  *	machine independent form (for network transmission)
  * OUT buffer_ptr - the pointer is set to the allocated buffer.
  * OUT buffer_size - set to size of the buffer in bytes
- * IN show_flags - job filtering options
- * IN job_ids - list of job_ids to pack
+ * IN query - jobs and field groups to pack
  * IN uid - uid of user making request (for partition filtering)
- * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
- * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
- *	whenever the data format changes
  */
-extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
-			   uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			   uint16_t protocol_version)
+extern void pack_jobs_query(char **buffer_ptr, int *buffer_size,
+			    job_info_query_t *query, uid_t uid,
+			    uint16_t protocol_version)
 {
 	uint32_t jobs_packed = 0, tmp_offset;
 	_foreach_pack_job_info_t pack_info = {0};
+	_job_query_t q = {0};
+	struct part_record *part_ptr;
+	char *tmp_str, *tok, *save_ptr = NULL;
 	Buf buffer;
 
-	xassert(job_ids);
-
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
+	/* Split the account names and find the partitions once */
+	q.query = query;
+	if (query->accounts && query->accounts[0]) {
+		tmp_str = xstrdup(query->accounts);
+		tok = strtok_r(tmp_str, ",", &save_ptr);
+		while (tok) {
+			xrealloc(q.accounts,
+				 sizeof(char *) * (q.account_cnt + 1));
+			q.accounts[q.account_cnt++] = xstrdup(tok);
+			tok = strtok_r(NULL, ",", &save_ptr);
+		}
+		xfree(tmp_str);
+	}
+	if (query->partitions && query->partitions[0]) {
+		tmp_str = xstrdup(query->partitions);
+		tok = strtok_r(tmp_str, ",", &save_ptr);
+		while (tok) {
+			if ((part_ptr = find_part_record(tok))) {
+				xrealloc(q.parts, sizeof(struct part_record *) *
+						  (q.part_cnt + 1));
+				q.parts[q.part_cnt++] = part_ptr;
+			}
+			tok = strtok_r(NULL, ",", &save_ptr);
+		}
+		xfree(tmp_str);
+	}
+
 	buffer = init_buf(BUF_SIZE);
 
 	/* write message body header : size and time */
@@ -9408,13 +10303,18 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 
 	/* write individual job records */
 	pack_info.buffer           = buffer;
-	pack_info.filter_uid       = filter_uid;
+	pack_info.fields           = query->fields;
+	pack_info.filter_uid       = NO_VAL;
 	pack_info.jobs_packed      = &jobs_packed;
 	pack_info.protocol_version = protocol_version;
-	pack_info.show_flags       = show_flags;
+	pack_info.query            = &q;
+	pack_info.show_flags       = query->show_flags;
 	pack_info.uid              = uid;
 
-	list_for_each(job_ids, _foreach_pack_jobid, &pack_info);
+	if (query->job_id_cnt)
+		_pack_query_job_ids(&pack_info);
+	else
+		list_for_each(job_list, _foreach_pack_job_query, &pack_info);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9424,6 +10324,11 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 
 	*buffer_size = get_buf_offset(buffer);
 	buffer_ptr[0] = xfer_buf_data(buffer);
+
+	while (q.account_cnt)
+		xfree(q.accounts[--q.account_cnt]);
+	xfree(q.accounts);
+	xfree(q.parts);
 }
 
 static int _pack_hetero_job(struct job_record *job_ptr, uint16_t show_flags,
@@ -9574,6 +10479,26 @@ static void _pack_job_gres(struct job_record *dump_job_ptr, Buf buffer,
  */
 void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 	      uint16_t protocol_version, uid_t uid)
+{
+	pack_job_fields(dump_job_ptr, show_flags, JOB_FIELD_ALL, buffer,
+			protocol_version, uid);
+}
+
+/*
+ * pack_job_fields - dump some configuration information about a specific
+ *	job in machine independent form (for network transmission)
+ * IN dump_job_ptr - pointer to job for which information is requested
+ * IN show_flags - job filtering options
+ * IN fields - JOB_FIELD_* groups to pack, others are packed as NULL
+ * IN/OUT buffer - buffer in which data is placed, pointers automatically
+ *	updated
+ * IN uid - user requesting the data
+ * NOTE: Only clients of protocol version SLURM_17_11_PROTOCOL_VERSION or
+ *	later get a subset of the fields
+ */
+extern void pack_job_fields(struct job_record *dump_job_ptr,
+			    uint16_t show_flags, uint32_t fields, Buf buffer,
+			    uint16_t protocol_version, uid_t uid)
 {
 	struct job_details *detail_ptr;
 	time_t begin_time = 0, start_time = 0, end_time = 0;
@@ -9675,7 +10600,9 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 		packstr(slurmctld_conf.cluster_name, buffer);
 		/* Only send the allocated nodelist since we are only sending
 		 * the number of cpus and nodes that are currently allocated. */
-		if (!IS_JOB_COMPLETING(dump_job_ptr))
+		if (!(fields & JOB_FIELD_NODES))
+			packnull(buffer);
+		else if (!IS_JOB_COMPLETING(dump_job_ptr))
 			packstr(dump_job_ptr->nodes, buffer);
 		else {
 			nodelist =
@@ -9684,20 +10611,40 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 			xfree(nodelist);
 		}
 
-		packstr(dump_job_ptr->sched_nodes, buffer);
+		if (fields & JOB_FIELD_NODES)
+			packstr(dump_job_ptr->sched_nodes, buffer);
+		else
+			packnull(buffer);
 
 		if (!IS_JOB_PENDING(dump_job_ptr) && dump_job_ptr->part_ptr)
 			packstr(dump_job_ptr->part_ptr->name, buffer);
 		else
 			packstr(dump_job_ptr->partition, buffer);
 		packstr(dump_job_ptr->account, buffer);
-		packstr(dump_job_ptr->admin_comment, buffer);
-		packstr(dump_job_ptr->network, buffer);
-		packstr(dump_job_ptr->comment, buffer);
-		packstr(dump_job_ptr->gres, buffer);
-		packstr(dump_job_ptr->batch_host, buffer);
-		packstr(dump_job_ptr->burst_buffer, buffer);
-		packstr(dump_job_ptr->burst_buffer_state, buffer);
+		if (fields & JOB_FIELD_TEXT) {
+			packstr(dump_job_ptr->admin_comment, buffer);
+			packstr(dump_job_ptr->network, buffer);
+			packstr(dump_job_ptr->comment, buffer);
+		} else {
+			packnull(buffer);
+			packnull(buffer);
+			packnull(buffer);
+		}
+		if (fields & JOB_FIELD_TRES)
+			packstr(dump_job_ptr->gres, buffer);
+		else
+			packnull(buffer);
+		if (fields & JOB_FIELD_NODES)
+			packstr(dump_job_ptr->batch_host, buffer);
+		else
+			packnull(buffer);
+		if (fields & JOB_FIELD_TEXT) {
+			packstr(dump_job_ptr->burst_buffer, buffer);
+			packstr(dump_job_ptr->burst_buffer_state, buffer);
+		} else {
+			packnull(buffer);
+			packnull(buffer);
+		}
 
 		assoc_mgr_lock(&locks);
 		if (assoc_mgr_qos_list) {
@@ -9707,15 +10654,21 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 			packnull(buffer);
 		assoc_mgr_unlock(&locks);
 
-		packstr(dump_job_ptr->licenses, buffer);
+		if (fields & JOB_FIELD_TEXT)
+			packstr(dump_job_ptr->licenses, buffer);
+		else
+			packnull(buffer);
 		packstr(dump_job_ptr->state_desc, buffer);
 		packstr(dump_job_ptr->resv_name, buffer);
-		packstr(dump_job_ptr->mcs_label, buffer);
+		if (fields & JOB_FIELD_TEXT)
+			packstr(dump_job_ptr->mcs_label, buffer);
+		else
+			packnull(buffer);
 
 		pack32(dump_job_ptr->exit_code, buffer);
 		pack32(dump_job_ptr->derived_ec, buffer);
 
-		if (show_flags & SHOW_DETAIL) {
+		if ((show_flags & SHOW_DETAIL) && (fields & JOB_FIELD_NODES)) {
 			pack_job_resources(dump_job_ptr->job_resrcs, buffer,
 					   protocol_version);
 			_pack_job_gres(dump_job_ptr, buffer, protocol_version);
@@ -9726,37 +10679,52 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		packstr(dump_job_ptr->name, buffer);
 		packstr(dump_job_ptr->user_name, buffer);
-		packstr(dump_job_ptr->wckey, buffer);
+		if (fields & JOB_FIELD_TEXT)
+			packstr(dump_job_ptr->wckey, buffer);
+		else
+			packnull(buffer);
 		pack32(dump_job_ptr->req_switch, buffer);
 		pack32(dump_job_ptr->wait4switch, buffer);
 
-		packstr(dump_job_ptr->alloc_node, buffer);
-		if (!IS_JOB_COMPLETING(dump_job_ptr))
-			pack_bit_str_hex(dump_job_ptr->node_bitmap, buffer);
-		else
-			pack_bit_str_hex(dump_job_ptr->node_bitmap_cg, buffer);
+		if (!(fields & JOB_FIELD_NODES)) {
+			packnull(buffer);
+			pack_bit_str_hex(NULL, buffer);
+		} else {
+			packstr(dump_job_ptr->alloc_node, buffer);
+			if (!IS_JOB_COMPLETING(dump_job_ptr))
+				pack_bit_str_hex(dump_job_ptr->node_bitmap,
+						 buffer);
+			else
+				pack_bit_str_hex(dump_job_ptr->node_bitmap_cg,
+						 buffer);
+		}
 
 		select_g_select_jobinfo_pack(dump_job_ptr->select_jobinfo,
 					     buffer, protocol_version);
 
 		/* A few details are always dumped here */
 		_pack_default_job_details(dump_job_ptr, buffer,
-					  protocol_version);
+					  protocol_version, fields);
 
 		/* other job details are only dumped until the job starts
 		 * running (at which time they become meaningless) */
 		if (detail_ptr)
 			_pack_pending_job_details(detail_ptr, buffer,
-						  protocol_version);
+						  protocol_version, fields);
 		else
 			_pack_pending_job_details(NULL, buffer,
-						  protocol_version);
+						  protocol_version, fields);
 		pack32(dump_job_ptr->bit_flags, buffer);
-		packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
-		packstr(dump_job_ptr->tres_fmt_req_str, buffer);
+		if (fields & JOB_FIELD_TRES) {
+			packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
+			packstr(dump_job_ptr->tres_fmt_req_str, buffer);
+		} else {
+			packnull(buffer);
+			packnull(buffer);
+		}
 		pack16(dump_job_ptr->start_protocol_ver, buffer);
 
-		if (dump_job_ptr->fed_details) {
+		if (dump_job_ptr->fed_details && (fields & JOB_FIELD_FED)) {
 			packstr(dump_job_ptr->fed_details->origin_str, buffer);
 			pack64(dump_job_ptr->fed_details->siblings_active,
 			       buffer);
@@ -9927,16 +10895,18 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		/* A few details are always dumped here */
 		_pack_default_job_details(dump_job_ptr, buffer,
-					  protocol_version);
+					  protocol_version, JOB_FIELD_ALL);
 
 		/* other job details are only dumped until the job starts
 		 * running (at which time they become meaningless) */
 		if (detail_ptr)
 			_pack_pending_job_details(detail_ptr, buffer,
-						  protocol_version);
+						  protocol_version,
+						  JOB_FIELD_ALL);
 		else
 			_pack_pending_job_details(NULL, buffer,
-						  protocol_version);
+						  protocol_version,
+						  JOB_FIELD_ALL);
 		pack32(dump_job_ptr->bit_flags, buffer);
 		packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
 		packstr(dump_job_ptr->tres_fmt_req_str, buffer);
@@ -10090,16 +11060,18 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		/* A few details are always dumped here */
 		_pack_default_job_details(dump_job_ptr, buffer,
-					  protocol_version);
+					  protocol_version, JOB_FIELD_ALL);
 
 		/* other job details are only dumped until the job starts
 		 * running (at which time they become meaningless) */
 		if (detail_ptr)
 			_pack_pending_job_details(detail_ptr, buffer,
-						  protocol_version);
+						  protocol_version,
+						  JOB_FIELD_ALL);
 		else
 			_pack_pending_job_details(NULL, buffer,
-						  protocol_version);
+						  protocol_version,
+						  JOB_FIELD_ALL);
 		pack32(dump_job_ptr->bit_flags, buffer);
 		packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
 		packstr(dump_job_ptr->tres_fmt_req_str, buffer);
@@ -10143,7 +11115,8 @@ static void _find_node_config(int *cpu_cnt_ptr, int *core_cnt_ptr)
 
 /* pack default job details for "get_job_info" RPC */
 static void _pack_default_job_details(struct job_record *job_ptr,
-				      Buf buffer, uint16_t protocol_version)
+				      Buf buffer, uint16_t protocol_version,
+				      uint32_t fields)
 {
 	int max_cpu_cnt = -1, max_core_cnt = -1;
 	int i;
@@ -10186,12 +11159,19 @@ static void _pack_default_job_details(struct job_record *job_ptr,
 
 	if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
 		if (detail_ptr) {
-			packstr(detail_ptr->features,   buffer);
-			packstr(detail_ptr->cluster_features, buffer);
-			packstr(detail_ptr->work_dir,   buffer);
-			packstr(detail_ptr->dependency, buffer);
+			if (fields & JOB_FIELD_DETAILS) {
+				packstr(detail_ptr->features,   buffer);
+				packstr(detail_ptr->cluster_features, buffer);
+				packstr(detail_ptr->work_dir,   buffer);
+				packstr(detail_ptr->dependency, buffer);
+			} else {
+				packnull(buffer);
+				packnull(buffer);
+				packnull(buffer);
+				packnull(buffer);
+			}
 
-			if (detail_ptr->argv) {
+			if (detail_ptr->argv && (fields & JOB_FIELD_DETAILS)) {
 				/* Determine size needed for a string
 				 * containing all arguments */
 				for (i =0; detail_ptr->argv[i]; i++) {
@@ -10487,7 +11467,8 @@ static void _pack_default_job_details(struct job_record *job_ptr,
 
 /* pack pending job details for "get_job_info" RPC */
 static void _pack_pending_job_details(struct job_details *detail_ptr,
-				      Buf buffer, uint16_t protocol_version)
+				      Buf buffer, uint16_t protocol_version,
+				      uint32_t fields)
 {
 	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
 		if (detail_ptr) {
@@ -10499,14 +11480,27 @@ static void _pack_pending_job_details(struct job_details *detail_ptr,
 			pack64(detail_ptr->pn_min_memory, buffer);
 			pack32(detail_ptr->pn_min_tmp_disk, buffer);
 
-			packstr(detail_ptr->req_nodes, buffer);
-			pack_bit_str_hex(detail_ptr->req_node_bitmap, buffer);
-			packstr(detail_ptr->exc_nodes, buffer);
-			pack_bit_str_hex(detail_ptr->exc_node_bitmap, buffer);
+			if (fields & JOB_FIELD_DETAILS) {
+				packstr(detail_ptr->req_nodes, buffer);
+				pack_bit_str_hex(detail_ptr->req_node_bitmap,
+						 buffer);
+				packstr(detail_ptr->exc_nodes, buffer);
+				pack_bit_str_hex(detail_ptr->exc_node_bitmap,
+						 buffer);
+
+				packstr(detail_ptr->std_err, buffer);
+				packstr(detail_ptr->std_in, buffer);
+				packstr(detail_ptr->std_out, buffer);
+			} else {
+				packnull(buffer);
+				pack_bit_str_hex(NULL, buffer);
+				packnull(buffer);
+				pack_bit_str_hex(NULL, buffer);
 
-			packstr(detail_ptr->std_err, buffer);
-			packstr(detail_ptr->std_in, buffer);
-			packstr(detail_ptr->std_out, buffer);
+				packnull(buffer);
+				packnull(buffer);
+				packnull(buffer);
+			}
 
 			pack_multi_core_data(detail_ptr->mc_ptr, buffer,
 					     protocol_version);
@@ -10758,6 +11752,7 @@ void reset_job_bitmaps(void)
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
 		job_fail = false;
+		job_set_changed(job_ptr);
 
 		if (job_ptr->partition == NULL) {
 			error("No partition for job_id %u", job_ptr->job_id);
@@ -11359,6 +12354,7 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 		    (job_specs->burst_buffer[0] == '\0')) {
 			xfree(job_ptr->burst_buffer);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		} else {
 			error_code = ESLURM_NOT_SUPPORTED;
 		}
@@ -11412,6 +12408,7 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 	if (detail_ptr)
 		mc_ptr = detail_ptr->mc_ptr;
 	last_job_update = now;
+	job_set_changed(job_ptr);
 
 	/*
 	 * Check partition here just in case the min_nodes is changed based on
@@ -13979,6 +14976,106 @@ static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
 	list_iterator_destroy (step_iterator);
 }
 
+#ifndef HAVE_FRONT_END
+typedef struct {
+	uint32_t job_id;
+	slurm_msg_type_t msg_type;
+	uint16_t protocol_version;
+} kill_batch_key_t;
+
+static int _find_kill_batch(void *x, void *key)
+{
+	agent_arg_t *agent_info = (agent_arg_t *) x;
+	kill_job_msg_t *kill_req = (kill_job_msg_t *) agent_info->msg_args;
+	kill_batch_key_t *batch_key = (kill_batch_key_t *) key;
+
+	if ((agent_info->msg_type == batch_key->msg_type) &&
+	    (agent_info->protocol_version == batch_key->protocol_version) &&
+	    (kill_req->job_id == batch_key->job_id))
+		return 1;
+	return 0;
+}
+#endif
+
+/*
+ * Add node_name to a deferred kill request for the same job, RPC and
+ * protocol version. RET true if one was found, false if a new request must
+ * be built and passed to _queue_kill_req().
+ */
+static bool _kill_batch_add(uint32_t job_id, slurm_msg_type_t msg_type,
+			    uint16_t protocol_version, char *node_name)
+{
+#ifdef HAVE_FRONT_END
+	/* The request goes to the front end, not to node_name */
+	return false;
+#else
+	kill_batch_key_t batch_key;
+	agent_arg_t *agent_info;
+
+	if (!kill_batch_list)
+		return false;
+
+	batch_key.job_id = job_id;
+	batch_key.msg_type = msg_type;
+	batch_key.protocol_version = protocol_version;
+	if (!(agent_info = list_find_first(kill_batch_list, _find_kill_batch,
+					   &batch_key)))
+		return false;
+	hostlist_push_host(agent_info->hostlist, node_name);
+	return true;
+#endif
+}
+
+static void _queue_kill_req(agent_arg_t *agent_info)
+{
+	if (kill_batch_list)
+		list_append(kill_batch_list, agent_info);
+	else
+		agent_queue_request(agent_info);
+}
+
+/*
+ * job_kill_batch_begin - Defer the requests built by abort_job_on_node()
+ *	and kill_job_on_node() until job_kill_batch_end(), merging those
+ *	for the same job into one multi-node agent request. Used while
+ *	validating a batch of node registrations.
+ * NOTE: Caller must hold the job write lock until job_kill_batch_end()
+ */
+extern void job_kill_batch_begin(void)
+{
+	if (!kill_batch_list)
+		kill_batch_list = list_create(NULL);
+}
+
+/*
+ * job_kill_batch_end - Queue the kill requests deferred since
+ *	job_kill_batch_begin()
+ */
+extern void job_kill_batch_end(void)
+{
+	agent_arg_t *agent_info;
+	kill_job_msg_t *kill_req;
+
+	if (!kill_batch_list)
+		return;
+
+	while ((agent_info = list_pop(kill_batch_list))) {
+		hostlist_uniq(agent_info->hostlist);
+		agent_info->node_count = hostlist_count(agent_info->hostlist);
+		if (agent_info->node_count > 1) {
+			kill_req = (kill_job_msg_t *) agent_info->msg_args;
+			xfree(kill_req->nodes);
+			kill_req->nodes = hostlist_ranged_string_xmalloc(
+						agent_info->hostlist);
+			debug("%s: %s job %u on nodes %s", __func__,
+			      rpc_num2string(agent_info->msg_type),
+			      kill_req->job_id, kill_req->nodes);
+		}
+		agent_queue_request(agent_info);
+	}
+	FREE_NULL_LIST(kill_batch_list);
+}
+
 /*
  * abort_job_on_node - Kill the specific job_id on a specific node,
  *	the request is not processed immediately, but queued.
@@ -13986,7 +15083,8 @@ static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
  *	without saved state and slurmd daemons register with a
  *	multitude of running jobs. Slurmctld will not recognize
  *	these jobs and use this function to kill them - one
- *	agent request per node as they register.
+ *	agent request per node as they register, or per job while
+ *	registrations are validated in a batch, see job_kill_batch_begin().
  * IN job_id - id of the job to be killed
  * IN job_ptr - pointer to terminating job (NULL if unknown, e.g. orphaned)
  * IN node_name - name of the node on which the job resides
@@ -13996,6 +15094,16 @@ abort_job_on_node(uint32_t job_id, struct job_record *job_ptr, char *node_name)
 {
 	agent_arg_t *agent_info;
 	kill_job_msg_t *kill_req;
+#ifndef HAVE_FRONT_END
+	struct node_record *node_ptr;
+
+	if ((node_ptr = find_node_record(node_name)) &&
+	    _kill_batch_add(job_id, REQUEST_ABORT_JOB,
+			    node_ptr->protocol_version, node_name)) {
+		debug("Aborting job %u on node %s", job_id, node_name);
+		return;
+	}
+#endif
 
 	kill_req = xmalloc(sizeof(kill_job_msg_t));
 	kill_req->job_id	= job_id;
@@ -14023,8 +15131,7 @@ abort_job_on_node(uint32_t job_id, struct job_record *job_ptr, char *node_name)
 			job_ptr->front_end_ptr->protocol_version;
 	debug("Aborting job %u on front end node %s", job_id, node_name);
 #else
-	struct node_record *node_ptr;
-	if ((node_ptr = find_node_record(node_name)))
+	if (node_ptr)
 		agent_info->protocol_version = node_ptr->protocol_version;
 
 	debug("Aborting job %u on node %s", job_id, node_name);
@@ -14032,7 +15139,7 @@ abort_job_on_node(uint32_t job_id, struct job_record *job_ptr, char *node_name)
 	agent_info->msg_type	= REQUEST_ABORT_JOB;
 	agent_info->msg_args	= kill_req;
 
-	agent_queue_request(agent_info);
+	_queue_kill_req(agent_info);
 }
 
 /*
@@ -14048,6 +15155,12 @@ kill_job_on_node(uint32_t job_id, struct job_record *job_ptr,
 	agent_arg_t *agent_info;
 	kill_job_msg_t *kill_req;
 
+	if (_kill_batch_add(job_id, REQUEST_TERMINATE_JOB,
+			    node_ptr->protocol_version, node_ptr->name)) {
+		debug("Killing job %u on node %s", job_id, node_ptr->name);
+		return;
+	}
+
 	kill_req = xmalloc(sizeof(kill_job_msg_t));
 	kill_req->job_id	= job_id;
 	kill_req->step_id	= NO_VAL;
@@ -14080,7 +15193,7 @@ kill_job_on_node(uint32_t job_id, struct job_record *job_ptr,
 	agent_info->msg_type	= REQUEST_TERMINATE_JOB;
 	agent_info->msg_args	= kill_req;
 
-	agent_queue_request(agent_info);
+	_queue_kill_req(agent_info);
 }
 
 /*
@@ -14139,6 +15252,7 @@ extern int job_alloc_info_ptr(uint32_t uid, struct job_record *job_ptr)
 	    (prolog == 0) && job_ptr->node_bitmap &&
 	    (bit_overlap(power_node_bitmap, job_ptr->node_bitmap) == 0)) {
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 		set_job_alias_list(job_ptr);
 	}
 
@@ -14516,6 +15630,7 @@ extern bool job_epilog_complete(uint32_t job_id, char *node_name,
 	step_epilog_complete(job_ptr, node_name);
 	/* nodes_completing is out of date, rebuild when next saved */
 	xfree(job_ptr->nodes_completing);
+	job_set_changed(job_ptr);
 	if (!IS_JOB_COMPLETING(job_ptr)) {	/* COMPLETED */
 		batch_requeue_fini(job_ptr);
 		return true;
@@ -14619,6 +15734,11 @@ void job_fini (void)
 	FREE_NULL_LIST(purge_files_list);
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
+	info_delta_fini(&job_delta);
+	slurm_mutex_lock(&journal_purge_mutex);
+	xfree(journal_purge_id);
+	journal_purge_cnt = journal_purge_size = 0;
+	slurm_mutex_unlock(&journal_purge_mutex);
 }
 
 /* Record the start of one job array task */
@@ -14700,6 +15820,7 @@ extern void job_completion_logger(struct job_record *job_ptr, bool requeue)
 
 	xassert(job_ptr);
 
+	job_set_changed(job_ptr);
 	acct_policy_remove_job_submit(job_ptr);
 	if (job_ptr->nodes &&  ((job_ptr->bit_flags & JOB_KILL_HURRY) == 0)) {
 		(void) bb_g_job_start_stage_out(job_ptr);
@@ -14901,6 +16022,7 @@ extern int job_node_ready(uint32_t job_id, int *ready)
 	    job_ptr->node_bitmap &&
 	    (bit_overlap(power_node_bitmap, job_ptr->node_bitmap) == 0)) {
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 		set_job_alias_list(job_ptr);
 	}
 
@@ -15149,6 +16271,7 @@ static int _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		}
 	}
 	last_job_update = last_node_update = now;
+	job_set_changed(job_ptr);
 	return rc;
 }
 
@@ -15197,6 +16320,7 @@ static int _resume_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		node_ptr->node_state = NODE_STATE_ALLOCATED | node_flags;
 	}
 	last_job_update = last_node_update = time(NULL);
+	job_set_changed(job_ptr);
 	return rc;
 }
 
@@ -15683,6 +16807,7 @@ static int _job_requeue_op(uid_t uid, struct job_record *job_ptr, bool preempt,
 	}
 
 	last_job_update = now;
+	job_set_changed(job_ptr);
 
 	/*
 	 * In the job is in the process of completing
@@ -16195,6 +17320,7 @@ static int _set_top(List top_job_list, uid_t uid)
 		delta_nice = MIN(job_ptr->details->nice, delta_prio);
 		total_delta += delta_nice;
 		job_ptr->priority = next_prio;
+		job_set_changed(job_ptr);
 		job_ptr->details->nice -= delta_nice;
 		job_ptr->bit_flags &= (~TOP_PRIO_TMP);
 	}
@@ -16214,6 +17340,7 @@ static int _set_top(List top_job_list, uid_t uid)
 			}
 			delta_nice = delta_prio;
 			job_ptr->priority = next_prio;
+			job_set_changed(job_ptr);
 			job_ptr->details->nice += delta_nice;
 			job_ptr->bit_flags &= (~TOP_PRIO_TMP);
 			total_delta -= delta_nice;
@@ -16555,6 +17682,7 @@ extern int update_job_account(char *module, struct job_record *job_ptr,
 	job_ptr->assoc_id = assoc_rec.id;
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -16619,6 +17747,7 @@ extern int update_job_wckey(char *module, struct job_record *job_ptr,
 	}
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -16746,6 +17875,7 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 		info("checkpoint_op %u of %u.%u complete, rc=%d",
 		     ckpt_ptr->op, ckpt_ptr->job_id, ckpt_ptr->step_id, rc);
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	} else {		/* operate on all of a job's steps */
 		int update_rc = -2;
 		ListIterator step_iterator;
@@ -16778,8 +17908,10 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 			rc = MAX(rc, update_rc);
 			xfree(image_dir);
 		}
-		if (update_rc != -2)	/* some work done */
+		if (update_rc != -2) {	/* some work done */
 			last_job_update = time(NULL);
+			job_set_changed(job_ptr);
+		}
 		list_iterator_destroy (step_iterator);
 	}
 
@@ -17182,6 +18314,7 @@ extern int job_restart(checkpoint_msg_t *ckpt_ptr, uid_t uid, int conn_fd,
 		image_dir = NULL;	/* Nothing left to xfree */
 
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	}
 
  unpack_error:
@@ -17633,6 +18766,7 @@ _kill_dependent(struct job_record *job_ptr)
 	job_ptr->end_time = now;
 	job_completion_logger(job_ptr, false);
 	last_job_update = now;
+	job_set_changed(job_ptr);
 	srun_allocate_abort(job_ptr);
 }
 
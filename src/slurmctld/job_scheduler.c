@@ -313,6 +313,7 @@ static bool _job_runnable_test1(struct job_record *job_ptr, bool sched_plugin)
 		job_ptr->state_reason = WAIT_NO_REASON;
 		xfree(job_ptr->state_desc);
 		last_job_update = now;
+		job_set_changed(job_ptr);
 	}
 #endif
 
@@ -329,6 +330,7 @@ static bool _job_runnable_test1(struct job_record *job_ptr, bool sched_plugin)
 			job_ptr->state_reason = WAIT_HELD;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		}
 		debug3("sched: JobId=%u. State=%s. Reason=%s. Priority=%u.",
 		       job_ptr->job_id,
@@ -511,11 +513,13 @@ extern List build_job_queue(bool clear_start, bool backfill)
 		if (job_ptr->state_reason != WAIT_NO_REASON) {
 			job_ptr->state_reason_prev = job_ptr->state_reason;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		} else if ((job_ptr->state_reason_prev == WAIT_TIME) &&
 			   job_ptr->details &&
 			   (job_ptr->details->begin_time <= now)) {
 			job_ptr->state_reason_prev = job_ptr->state_reason;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		}
 		if (!_job_runnable_test1(job_ptr, clear_start))
 			continue;
@@ -533,6 +537,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 					job_ptr->state_reason = reason;
 					xfree(job_ptr->state_desc);
 					last_job_update = now;
+					job_set_changed(job_ptr);
 				}
 				/* priority_array index matches part_ptr_list
 				 * position: increment inx */
@@ -830,6 +835,7 @@ next_part:		part_ptr = (struct part_record *)
 				xfree(job_ptr->state_desc);
 				job_ptr->assoc_id = assoc_rec.id;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			} else {
 				continue;
 			}
@@ -850,12 +856,14 @@ next_part:		part_ptr = (struct part_record *)
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_QOS;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				assoc_mgr_unlock(&locks);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -867,6 +875,7 @@ next_part:		part_ptr = (struct part_record *)
 			job_ptr->state_reason = WAIT_NO_REASON;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		}
 
 		if ((job_ptr->state_reason == WAIT_NODE_NOT_AVAIL) &&
@@ -886,6 +895,7 @@ next_part:		part_ptr = (struct part_record *)
 			job_ptr->state_reason = WAIT_LICENSES;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			continue;
 		}
 
@@ -899,6 +909,7 @@ next_part:		part_ptr = (struct part_record *)
 			info("sched: JobId=%u has invalid account",
 			     job_ptr->job_id);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -930,6 +941,7 @@ next_part:		part_ptr = (struct part_record *)
 		job_ptr->details->exc_node_bitmap = orig_exc_bitmap;
 		if (error_code == SLURM_SUCCESS) {
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			info("sched: Allocate JobId=%u Partition=%s NodeList=%s #CPUs=%u",
 			     job_ptr->job_id, job_ptr->part_ptr->name,
 			     job_ptr->nodes, job_ptr->total_cpus);
@@ -1040,6 +1052,7 @@ extern int schedule(uint32_t job_limit)
 {
 	static int sched_job_limit = -1;
 	int job_count = 0;
+	uint32_t old_lock_ctx;
 	struct timeval now;
 	long delta_t;
 
@@ -1076,7 +1089,9 @@ extern int schedule(uint32_t job_limit)
 		sched_job_limit = -1;
 		slurm_mutex_unlock(&sched_mutex);
 
+		old_lock_ctx = set_lock_context(LOCK_CTX_SCHEDULE);
 		job_count = _schedule(job_limit);
+		(void) set_lock_context(old_lock_ctx);
 
 		slurm_mutex_lock(&sched_mutex);
 		gettimeofday(&now, NULL);
@@ -1098,6 +1113,29 @@ extern int schedule(uint32_t job_limit)
 	return job_count;
 }
 
+/*
+ * schedule_pass - run the main scheduling loop right away, without the
+ *	sched_min_interval deferral done by schedule(). Used by the scheduler
+ *	benchmark (slurmctld -b).
+ * IN job_limit - maximum number of jobs to test, as for schedule()
+ * RET count of jobs scheduled
+ * Note: job_write_lock must be unlocked before calling this.
+ */
+extern int schedule_pass(uint32_t job_limit)
+{
+	uint32_t old_lock_ctx;
+	int job_count;
+
+	if (slurmctld_config.scheduling_disabled)
+		return 0;
+
+	old_lock_ctx = set_lock_context(LOCK_CTX_SCHEDULE);
+	job_count = _schedule(job_limit);
+	(void) set_lock_context(old_lock_ctx);
+
+	return job_count;
+}
+
 /* Thread used to possibly start job scheduler later, if nothing else does */
 static void *_sched_agent(void *args)
 {
@@ -1176,6 +1214,7 @@ extern bool deadline_ok(struct job_record *job_ptr, char *func)
 	}
 	if (fail_job) {
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		job_ptr->job_state = JOB_DEADLINE;
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_DEADLINE;
@@ -1584,6 +1623,7 @@ static int _schedule(uint32_t job_limit)
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				continue;
 			}
 			if (!_job_runnable_test1(job_ptr, false))
@@ -1620,6 +1660,7 @@ next_part:			part_ptr = (struct part_record *)
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				continue;
 			}
 			if ((job_ptr->array_task_id != array_task_id) &&
@@ -1734,6 +1775,7 @@ next_task:
 			job_ptr->state_reason = WAIT_PRIORITY;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			debug("sched: JobId=%u. State=PENDING. "
 			       "Reason=Priority, Priority=%u. Partition=%s.",
 			       job_ptr->job_id, job_ptr->priority,
@@ -1758,6 +1800,7 @@ next_task:
 				xfree(job_ptr->state_desc);
 				job_ptr->assoc_id = assoc_rec.id;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			} else {
 				debug("sched: JobId=%u has invalid association",
 				      job_ptr->job_id);
@@ -1784,12 +1827,14 @@ next_task:
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_QOS;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 				assoc_mgr_unlock(&locks);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				job_set_changed(job_ptr);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -1844,6 +1889,7 @@ next_task:
 			job_ptr->state_reason = WAIT_RESOURCES;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			debug3("sched: JobId=%u. State=%s. Reason=%s. "
 			       "Priority=%u. Partition=%s.",
 			       job_ptr->job_id,
@@ -1858,6 +1904,7 @@ next_task:
 			job_ptr->state_reason = WAIT_LICENSES;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			debug3("sched: JobId=%u. State=%s. Reason=%s. "
 			       "Priority=%u.",
 			       job_ptr->job_id,
@@ -1877,6 +1924,7 @@ next_task:
 			info("sched: JobId=%u has invalid account",
 			     job_ptr->job_id);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -1963,6 +2011,7 @@ skip_start:
 			job_ptr->state_reason = WAIT_FED_JOB_LOCK;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			debug3("sched: JobId=%u. State=%s. Reason=%s. "
 			       "Priority=%u. Partition=%s.",
 			       job_ptr->job_id,
@@ -1974,6 +2023,7 @@ skip_start:
 			/* job initiated */
 			debug3("sched: JobId=%u initiated", job_ptr->job_id);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			reject_array_job_id = 0;
 			reject_array_part   = NULL;
 
@@ -2053,6 +2103,7 @@ skip_start:
 			     jobid2str(job_ptr, jbuf, sizeof(jbuf)),
 			     slurm_strerror(error_code));
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			job_ptr->job_state = JOB_PENDING;
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
 			xfree(job_ptr->state_desc);
@@ -193,6 +193,15 @@ extern bool replace_batch_job(slurm_msg_t * msg, void *fini_job, bool locked);
  */
 extern int schedule(uint32_t job_limit);
 
+/*
+ * schedule_pass - run the main scheduling loop right away, without the
+ *	sched_min_interval deferral done by schedule(). Used by the scheduler
+ *	benchmark (slurmctld -b).
+ * IN job_limit - maximum number of jobs to test, as for schedule()
+ * RET count of jobs scheduled
+ */
+extern int schedule_pass(uint32_t job_limit);
+
 /*
  * set_job_elig_time - set the eligible time for pending jobs once their
  *	dependencies are lifted (in job->details->begin_time)
@@ -41,15 +41,69 @@
 #include <pthread.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 
-static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
+/*
+ * Each data type has its own mutex and wait queues, so taking or releasing
+ * a lock on one data type never wakes or serializes threads waiting on
+ * another one. The counters of a data type in slurmctld_locks and its
+ * entry in slurmctld_lock_stats are protected by its mutex.
+ *
+ * Writers have priority, but after WRITER_BURST_MAX consecutive write locks
+ * the readers waiting at that time no longer wait for the pending writers,
+ * so a steady flow of writers can not starve readers. rd_gen counts these
+ * hand-overs: a reader whose ticket is older than rd_gen was waiting at the
+ * last one and only waits for the lock to be free.
+ */
+#define WRITER_BURST_MAX	8
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t rd_cond;		/* readers waiting for the writers */
+	pthread_cond_t wr_cond;		/* writers waiting for the lock */
+	int rd_waiting;			/* readers waiting */
+	uint32_t rd_gen;		/* hand-overs to waiting readers */
+} entity_lock_t;
+
+#define ENTITY_LOCK_INITIALIZER						\
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,		\
+	  PTHREAD_COND_INITIALIZER, 0, 0 }
+
+static entity_lock_t entity_locks[ENTITY_COUNT] = {
+	ENTITY_LOCK_INITIALIZER,	/* CONFIG_LOCK */
+	ENTITY_LOCK_INITIALIZER,	/* JOB_LOCK */
+	ENTITY_LOCK_INITIALIZER,	/* NODE_LOCK */
+	ENTITY_LOCK_INITIALIZER,	/* PART_LOCK */
+	ENTITY_LOCK_INITIALIZER		/* FED_LOCK */
+};
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static slurmctld_lock_flags_t slurmctld_locks;
+static slurmctld_lock_stats_t slurmctld_lock_stats;
+
+/*
+ * Lock histograms per context (RPC type or LOCK_CTX_*). Slot 0 is
+ * LOCK_CTX_OTHER, also used once the table is full. Slots are never freed,
+ * so a thread can keep its slot index. The histograms of one data type are
+ * protected by that data type's mutex, the slot allocation by
+ * lock_ctx_mutex.
+ */
+#define LOCK_CTX_MAX	128
+static pthread_mutex_t lock_ctx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static lock_ctx_stats_t lock_ctx_stats[LOCK_CTX_MAX];
+static uint32_t lock_ctx_cnt = 1;
+static __thread uint32_t lock_ctx = LOCK_CTX_OTHER;
+static __thread uint32_t lock_ctx_inx = 0;
+
+/*
+ * Time at which this thread was granted its lock on each data type. A
+ * thread holds at most one lock per data type, so this is enough to time
+ * read locks held concurrently by several threads.
+ */
+static __thread uint64_t lock_granted[ENTITY_COUNT];
 
 static void _wr_rdlock(lock_datatype_t datatype);
 static void _wr_rdunlock(lock_datatype_t datatype);
@@ -109,6 +163,74 @@ extern bool verify_lock(lock_datatype_t datatype, lock_level_t level)
 }
 #endif
 
+/*
+ * time() and gettimeofday() return simulated time inside the simulator,
+ * lock timing needs the real clock.
+ */
+static uint64_t _now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void _hist_add(lock_stats_hist_t *hist, uint64_t usec)
+{
+	int b = 0;
+
+	if (usec)
+		b = MIN(63 - __builtin_clzll(usec),
+			LOCK_STATS_HIST_BUCKETS - 1);
+	hist->cnt++;
+	hist->sum_usec += usec;
+	if (usec > hist->max_usec)
+		hist->max_usec = usec;
+	hist->bucket[b]++;
+}
+
+/* Account for a lock being granted after waiting since wait_start, called
+ * with the data type's mutex held */
+static void _lock_granted(lock_datatype_t datatype, bool write,
+			  uint64_t wait_start)
+{
+	lock_stats_t *stats = &slurmctld_lock_stats.entity[datatype];
+	lock_ctx_stats_t *ctx = &lock_ctx_stats[lock_ctx_inx];
+	uint64_t now = _now_usec();
+
+	lock_granted[datatype] = now;
+	if (write) {
+		stats->wr_cnt++;
+		stats->wr_wait_usec += now - wait_start;
+		_hist_add(&ctx->wr_wait[datatype], now - wait_start);
+	} else {
+		stats->rd_cnt++;
+		stats->rd_wait_usec += now - wait_start;
+		_hist_add(&ctx->rd_wait[datatype], now - wait_start);
+	}
+}
+
+/* Account for a lock being released, called with the data type's mutex
+ * held */
+static void _lock_released(lock_datatype_t datatype, bool write)
+{
+	lock_stats_t *stats = &slurmctld_lock_stats.entity[datatype];
+	lock_ctx_stats_t *ctx = &lock_ctx_stats[lock_ctx_inx];
+	uint64_t held = _now_usec() - lock_granted[datatype];
+
+	if (write) {
+		stats->wr_hold_usec += held;
+		if (held > stats->wr_hold_max)
+			stats->wr_hold_max = held;
+		_hist_add(&ctx->wr_hold[datatype], held);
+	} else {
+		stats->rd_hold_usec += held;
+		if (held > stats->rd_hold_max)
+			stats->rd_hold_max = held;
+		_hist_add(&ctx->rd_hold[datatype], held);
+	}
+}
+
 /* init_locks - create locks used for slurmctld data structure access
  *	control */
 void init_locks(void)
@@ -181,74 +303,285 @@ extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
 }
 
 /* _wr_rdlock - Issue a read lock on the specified data type
- *	Wait until there are no write locks AND
- *	no pending write locks (write_wait_lock == 0)
- *
- *	NOTE: Always favoring write locks could result in starvation for
- *	read locks. */
+ *	Wait until there are no write locks AND no pending write locks
+ *	(write_wait_lock == 0), unless the readers waiting were handed the
+ *	lock by a writer since this one started waiting. */
 static void _wr_rdlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
-	while (1) {
-		if ((slurmctld_locks.entity[write_lock(datatype)] == 0) &&
-		    (slurmctld_locks.entity[write_wait_lock(datatype)] == 0)) {
-			slurmctld_locks.entity[read_lock(datatype)]++;
-			slurmctld_locks.entity[write_cnt_lock(datatype)] = 0;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-		}
+	entity_lock_t *lock = &entity_locks[datatype];
+	uint64_t wait_start = _now_usec();
+	uint32_t ticket;
+
+	slurm_mutex_lock(&lock->mutex);
+	ticket = lock->rd_gen;
+	if (slurmctld_locks.entity[write_lock(datatype)] ||
+	    slurmctld_locks.entity[write_wait_lock(datatype)]) {
+		lock->rd_waiting++;
+		do {
+			slurm_cond_wait(&lock->rd_cond, &lock->mutex);
+		} while (slurmctld_locks.entity[write_lock(datatype)] ||
+			 (slurmctld_locks.entity[write_wait_lock(datatype)] &&
+			  (ticket == lock->rd_gen)));
+		lock->rd_waiting--;
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurmctld_locks.entity[read_lock(datatype)]++;
+	slurmctld_locks.entity[write_cnt_lock(datatype)] = 0;
+	_lock_granted(datatype, false, wait_start);
+	slurm_mutex_unlock(&lock->mutex);
 }
 
 /* _wr_rdunlock - Issue a read unlock on the specified data type */
 static void _wr_rdunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	entity_lock_t *lock = &entity_locks[datatype];
+	bool wake_writer;
+
+	slurm_mutex_lock(&lock->mutex);
+	_lock_released(datatype, false);
 	slurmctld_locks.entity[read_lock(datatype)]--;
 	xassert(slurmctld_locks.entity[read_lock(datatype)] >= 0);
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	/* Only a writer can be waiting for readers */
+	wake_writer = ((slurmctld_locks.entity[read_lock(datatype)] == 0) &&
+		       slurmctld_locks.entity[write_wait_lock(datatype)]);
+	slurm_mutex_unlock(&lock->mutex);
+
+	/* Signal without the mutex, so the waiter does not block on it */
+	if (wake_writer)
+		slurm_cond_signal(&lock->wr_cond);
 }
 
 /* _wr_wrlock - Issue a write lock on the specified data type */
 static void _wr_wrlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
-	slurmctld_locks.entity[write_wait_lock(datatype)]++;
+	entity_lock_t *lock = &entity_locks[datatype];
+	uint64_t wait_start = _now_usec();
 
-	while (1) {
-		if ((slurmctld_locks.entity[read_lock(datatype)] == 0) &&
-		    (slurmctld_locks.entity[write_lock(datatype)] == 0)) {
-			slurmctld_locks.entity[write_lock(datatype)]++;
-			slurmctld_locks.entity[write_wait_lock(datatype)]--;
-			slurmctld_locks.entity[write_cnt_lock(datatype)]++;
-			break;
-		} else {	/* wait for state change and retry */
-			slurm_cond_wait(&locks_cond, &locks_mutex);
-		}
+	slurm_mutex_lock(&lock->mutex);
+	slurmctld_locks.entity[write_wait_lock(datatype)]++;
+	while (slurmctld_locks.entity[read_lock(datatype)] ||
+	       slurmctld_locks.entity[write_lock(datatype)]) {
+		slurm_cond_wait(&lock->wr_cond, &lock->mutex);
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurmctld_locks.entity[write_lock(datatype)]++;
+	slurmctld_locks.entity[write_wait_lock(datatype)]--;
+	slurmctld_locks.entity[write_cnt_lock(datatype)]++;
+	_lock_granted(datatype, true, wait_start);
+	slurm_mutex_unlock(&lock->mutex);
 }
 
-/* _wr_wrunlock - Issue a write unlock on the specified data type */
+/* _wr_wrunlock - Issue a write unlock on the specified data type
+ *	The next writer waiting gets the lock, unless WRITER_BURST_MAX write
+ *	locks were granted in a row while readers waited, in which case the
+ *	readers waiting are woken up and no longer wait for pending writers. */
 static void _wr_wrunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	entity_lock_t *lock = &entity_locks[datatype];
+	bool wake_readers = false, wake_writer = false;
+
+	slurm_mutex_lock(&lock->mutex);
+	_lock_released(datatype, true);
 	slurmctld_locks.entity[write_lock(datatype)]--;
 	xassert(slurmctld_locks.entity[write_lock(datatype)] >= 0);
-	slurm_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	if (lock->rd_waiting &&
+	    (!slurmctld_locks.entity[write_wait_lock(datatype)] ||
+	     (slurmctld_locks.entity[write_cnt_lock(datatype)] >=
+	      WRITER_BURST_MAX))) {
+		lock->rd_gen++;
+		wake_readers = true;
+	} else if (slurmctld_locks.entity[write_wait_lock(datatype)]) {
+		wake_writer = true;
+	}
+	slurm_mutex_unlock(&lock->mutex);
+
+	if (wake_readers)
+		slurm_cond_broadcast(&lock->rd_cond);
+	else if (wake_writer)
+		slurm_cond_signal(&lock->wr_cond);
 }
 
 /* get_lock_values - Get the current value of all locks
  * OUT lock_flags - a copy of the current lock values */
 void get_lock_values(slurmctld_lock_flags_t * lock_flags)
 {
+	int i;
+
 	xassert(lock_flags);
-	memcpy((void *) lock_flags, (void *) &slurmctld_locks,
-	       sizeof(slurmctld_locks));
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&entity_locks[i].mutex);
+		memcpy((void *) &lock_flags->entity[read_lock(i)],
+		       (void *) &slurmctld_locks.entity[read_lock(i)],
+		       sizeof(int) * 4);
+		slurm_mutex_unlock(&entity_locks[i].mutex);
+	}
+}
+
+/* get_lock_stats - Get the lock timing accumulated since the last
+ *	reset_lock_stats()
+ * OUT lock_stats - a copy of the current lock timing */
+extern void get_lock_stats(slurmctld_lock_stats_t *lock_stats)
+{
+	int i;
+
+	xassert(lock_stats);
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&entity_locks[i].mutex);
+		memcpy((void *) &lock_stats->entity[i],
+		       (void *) &slurmctld_lock_stats.entity[i],
+		       sizeof(lock_stats_t));
+		slurm_mutex_unlock(&entity_locks[i].mutex);
+	}
+}
+
+/* reset_lock_stats - Clear the lock timing, including the per context
+ *	histograms */
+extern void reset_lock_stats(void)
+{
+	int i, j;
+
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&entity_locks[i].mutex);
+		memset((void *) &slurmctld_lock_stats.entity[i], 0,
+		       sizeof(lock_stats_t));
+		for (j = 0; j < LOCK_CTX_MAX; j++) {
+			lock_ctx_stats_t *ctx = &lock_ctx_stats[j];
+			memset(&ctx->rd_wait[i], 0, sizeof(lock_stats_hist_t));
+			memset(&ctx->rd_hold[i], 0, sizeof(lock_stats_hist_t));
+			memset(&ctx->wr_wait[i], 0, sizeof(lock_stats_hist_t));
+			memset(&ctx->wr_hold[i], 0, sizeof(lock_stats_hist_t));
+		}
+		slurm_mutex_unlock(&entity_locks[i].mutex);
+	}
+}
+
+/* set_lock_context - Attribute the locks taken by this thread from now on
+ *	to ctx, an RPC type or LOCK_CTX_*
+ * RET the previous context of the thread, to restore it afterwards */
+extern uint32_t set_lock_context(uint32_t ctx)
+{
+	uint32_t i, old_ctx = lock_ctx;
+
+	if (ctx == lock_ctx)
+		return old_ctx;
+
+	lock_ctx = ctx;
+	if (ctx == LOCK_CTX_OTHER) {
+		lock_ctx_inx = 0;
+		return old_ctx;
+	}
+
+	slurm_mutex_lock(&lock_ctx_mutex);
+	for (i = 1; i < lock_ctx_cnt; i++) {
+		if (lock_ctx_stats[i].id == ctx)
+			break;
+	}
+	if (i == lock_ctx_cnt) {
+		if (lock_ctx_cnt < LOCK_CTX_MAX)
+			lock_ctx_stats[lock_ctx_cnt++].id = ctx;
+		else
+			i = 0;
+	}
+	lock_ctx_inx = i;
+	slurm_mutex_unlock(&lock_ctx_mutex);
+
+	return old_ctx;
+}
+
+static char *_lock_ctx_name(uint32_t ctx)
+{
+	switch (ctx) {
+	case LOCK_CTX_OTHER:
+		return "other";
+	case LOCK_CTX_SCHEDULE:
+		return "schedule";
+	case LOCK_CTX_BACKFILL:
+		return "backfill";
+	case LOCK_CTX_DECAY:
+		return "priority_decay";
+	default:
+		return rpc_num2string(ctx);
+	}
+}
+
+static void _pack_lock_stats_hist(lock_stats_hist_t *hist, Buf buffer)
+{
+	int i;
+
+	pack32(hist->cnt, buffer);
+	if (!hist->cnt)
+		return;
+	pack64(hist->sum_usec, buffer);
+	pack64(hist->max_usec, buffer);
+	for (i = 0; i < LOCK_STATS_HIST_BUCKETS; i++)
+		pack32(hist->bucket[i], buffer);
+}
+
+/* pack_lock_context_stats - Pack the lock wait/hold histograms of every
+ *	context that took a lock since the last reset_lock_stats(), for
+ *	REQUEST_STATS_INFO */
+extern void pack_lock_context_stats(Buf buffer, uint16_t protocol_version)
+{
+	lock_ctx_stats_t *ctx;
+	uint32_t cnt, used = 0, i, j;
+	bool *in_use;
+
+	xassert(ENTITY_COUNT == LOCK_STATS_DATATYPES);
+
+	slurm_mutex_lock(&lock_ctx_mutex);
+	cnt = lock_ctx_cnt;
+	slurm_mutex_unlock(&lock_ctx_mutex);
+
+	/* Snapshot each data type under its own mutex */
+	ctx = xmalloc(sizeof(lock_ctx_stats_t) * cnt);
+	for (j = 0; j < ENTITY_COUNT; j++) {
+		slurm_mutex_lock(&entity_locks[j].mutex);
+		for (i = 0; i < cnt; i++) {
+			ctx[i].rd_wait[j] = lock_ctx_stats[i].rd_wait[j];
+			ctx[i].rd_hold[j] = lock_ctx_stats[i].rd_hold[j];
+			ctx[i].wr_wait[j] = lock_ctx_stats[i].wr_wait[j];
+			ctx[i].wr_hold[j] = lock_ctx_stats[i].wr_hold[j];
+		}
+		slurm_mutex_unlock(&entity_locks[j].mutex);
+	}
+
+	in_use = xmalloc(sizeof(bool) * cnt);
+	for (i = 0; i < cnt; i++) {
+		ctx[i].id = lock_ctx_stats[i].id;
+		for (j = 0; j < ENTITY_COUNT; j++) {
+			if (ctx[i].rd_wait[j].cnt || ctx[i].wr_wait[j].cnt)
+				in_use[i] = true;
+		}
+		if (in_use[i])
+			used++;
+	}
+
+	if (protocol_version >= SLURM_PROTOCOL_VERSION) {
+		pack32(used, buffer);
+		pack32(LOCK_STATS_DATATYPES, buffer);
+		pack32(LOCK_STATS_HIST_BUCKETS, buffer);
+		for (i = 0; i < cnt; i++) {
+			if (!in_use[i])
+				continue;
+			pack32(ctx[i].id, buffer);
+			packstr(_lock_ctx_name(ctx[i].id), buffer);
+			for (j = 0; j < ENTITY_COUNT; j++) {
+				_pack_lock_stats_hist(&ctx[i].rd_wait[j],
+						      buffer);
+				_pack_lock_stats_hist(&ctx[i].rd_hold[j],
+						      buffer);
+				_pack_lock_stats_hist(&ctx[i].wr_wait[j],
+						      buffer);
+				_pack_lock_stats_hist(&ctx[i].wr_hold[j],
+						      buffer);
+			}
+		}
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		/* Older clients do not know about lock statistics */
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+	}
+	xfree(in_use);
+	xfree(ctx);
 }
 
 /* un/lock semaphore used for saving state of slurmctld */
@@ -73,7 +73,12 @@
  * the resource, used the resource and unlocked the resource.  The subsequent
  * unspecified number of readers are blocked because they are waiting for the
  * number of writers waiting semaphore to become 0, meaning that there are no
- * writers waiting to lock the resource.
+ * writers waiting to lock the resource. To avoid starving readers, once a
+ * few writers in a row have locked the resource while readers were waiting,
+ * those readers are granted the lock before the next writer.
+ *
+ * Each data type has its own mutex and wait queues, a lock operation on one
+ * data type does not wake up or delay threads waiting on another one.
  *
  * use init_locks() to initialize the locks then
  * lock_slurmctld() and unlock_slurmctld() to get the ordering so as to
@@ -91,8 +96,11 @@
 #ifndef _SLURMCTLD_LOCKS_H
 #define _SLURMCTLD_LOCKS_H
 
+#include <inttypes.h>
 #include <stdbool.h>
 
+#include "src/common/pack.h"
+
 /* levels of locking required for each data structure */
 typedef enum {
 	NO_LOCK,
@@ -116,7 +124,8 @@ typedef struct {
  *	(lock_datatype_t * 4 + 2) = write_wait_lock	write locks pending
  *	(lock_datatype_t * 4 + 3) = write_cnt_lock	write lock count
  * NOTE: If changing the number of functions (array size), then also change
- * the size of "entity" in src/common/assoc_mgr.h
+ * the size of "entity" in src/common/assoc_mgr.h and LOCK_STATS_DATATYPES
+ * in slurm/slurm.h.in
  */
 typedef enum {
 	CONFIG_LOCK,
@@ -140,11 +149,55 @@ typedef struct {
 	int entity[ENTITY_COUNT * 4];
 }	slurmctld_lock_flags_t;
 
+/* Cumulative timing of the locks on one data type, in microseconds */
+typedef struct {
+	uint64_t rd_cnt;	/* read locks granted */
+	uint64_t rd_wait_usec;	/* time spent waiting for read locks */
+	uint64_t rd_hold_usec;	/* time read locks were held */
+	uint64_t rd_hold_max;	/* longest single read lock hold */
+	uint64_t wr_cnt;	/* write locks granted */
+	uint64_t wr_wait_usec;	/* time spent waiting for write locks */
+	uint64_t wr_hold_usec;	/* time write locks were held */
+	uint64_t wr_hold_max;	/* longest single write lock hold */
+}	lock_stats_t;
+
+typedef struct {
+	lock_stats_t entity[ENTITY_COUNT];
+}	slurmctld_lock_stats_t;
+
+
+/*
+ * Lock timing is also kept per caller: the RPC type processed by the thread
+ * (set by slurmctld_req) or one of the internal contexts below. Threads
+ * which set no context are accounted as LOCK_CTX_OTHER.
+ */
+#define LOCK_CTX_OTHER		0
+#define LOCK_CTX_SCHEDULE	0x10000	/* main scheduler, _schedule() */
+#define LOCK_CTX_BACKFILL	0x10001	/* backfill scheduler */
+#define LOCK_CTX_DECAY		0x10002	/* priority decay */
+
+/* set_lock_context - Attribute the locks taken by this thread from now on
+ *	to ctx, an RPC type or LOCK_CTX_*
+ * RET the previous context of the thread, to restore it afterwards */
+extern uint32_t set_lock_context(uint32_t ctx);
+
+/* pack_lock_context_stats - Pack the lock wait/hold histograms of every
+ *	context that took a lock since the last reset_lock_stats(), for
+ *	REQUEST_STATS_INFO */
+extern void pack_lock_context_stats(Buf buffer, uint16_t protocol_version);
 
 /* get_lock_values - Get the current value of all locks
  * OUT lock_flags - a copy of the current lock values */
 extern void get_lock_values (slurmctld_lock_flags_t *lock_flags);
 
+/* get_lock_stats - Get the lock timing accumulated since the last
+ *	reset_lock_stats() */
+extern void get_lock_stats (slurmctld_lock_stats_t *lock_stats);
+
+/* reset_lock_stats - Clear the lock timing, including the per context
+ *	histograms */
+extern void reset_lock_stats (void);
+
 /* init_locks - create locks used for slurmctld data structure access
  *	control */
 extern void init_locks ( void );
@@ -71,6 +71,7 @@
 #include "src/common/xstring.h"
 #include "src/slurmctld/agent.h"
 #include "src/slurmctld/front_end.h"
+#include "src/slurmctld/info_delta.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/ping_nodes.h"
 #include "src/slurmctld/proc_req.h"
@@ -95,6 +96,8 @@ bitstr_t *power_node_bitmap = NULL;	/* bitmap of powered down nodes */
 bitstr_t *share_node_bitmap = NULL;  	/* bitmap of sharable nodes */
 bitstr_t *up_node_bitmap    = NULL;  	/* bitmap of non-down nodes */
 
+static info_delta_t node_delta = INFO_DELTA_INITIALIZER;
+
 static void 	_dump_node_state (struct node_record *dump_node_ptr,
 				  Buf buffer);
 static front_end_record_t * _front_end_reg(
@@ -864,6 +867,133 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = xfer_buf_data (buffer);
 }
 
+/*
+ * pack_nodes_delta - dump node information for nodes changed since a
+ *	generation in machine independent form (for network transmission)
+ * OUT buffer_ptr - pointer to the stored data
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN generation - generation from the client's previous response, 0 if none
+ * IN show_flags - node filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: node_record_table_ptr - pointer to global node table
+ * NOTE: the caller must xfree the buffer at *buffer_ptr
+ * NOTE: A full response holds every node as pack_all_node() does, otherwise
+ *	only the changed nodes visible to the user are packed and the names
+ *	of changed nodes which are now hidden follow as removals
+ * NOTE: change _unpack_node_info_delta_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern void pack_nodes_delta(char **buffer_ptr, int *buffer_size,
+			     uint64_t generation, uint16_t show_flags,
+			     uid_t uid, uint16_t protocol_version)
+{
+	int inx;
+	uint32_t nodes_packed = 0, count_offset, tmp_offset, node_scaling;
+	uint32_t removed_cnt = 0;
+	uint64_t since;
+	char **removed_names = NULL;
+	Buf buffer;
+	time_t now = time(NULL);
+	struct node_record *node_ptr;
+	bool full, hidden, new_rec = false;
+
+	xassert(verify_lock(CONFIG_LOCK, READ_LOCK));
+	xassert(verify_lock(PART_LOCK, READ_LOCK));
+
+	buffer_ptr[0] = NULL;
+	*buffer_size = 0;
+
+	buffer = init_buf(BUF_SIZE*16);
+
+	if (info_delta_begin(&node_delta, last_node_update)) {
+		node_ptr = node_record_table_ptr;
+		for (inx = 0; inx < node_record_count; inx++, node_ptr++) {
+			if (node_ptr->delta_gen == 0)
+				new_rec = true;
+			set_buf_offset(buffer, 0);
+			_pack_node(node_ptr, buffer, SLURM_PROTOCOL_VERSION,
+				   SHOW_ALL | SHOW_DETAIL);
+			info_delta_stamp(&node_delta, buffer, 0,
+					 &node_ptr->delta_gen,
+					 &node_ptr->delta_hash);
+		}
+		/* The node table was built again (reconfiguration), clients
+		 * may hold nodes which no longer exist */
+		if (new_rec)
+			info_delta_reset(&node_delta);
+		set_buf_offset(buffer, 0);
+	}
+	full = info_delta_since(&node_delta, generation, &since);
+
+	/* write delta header: generation and full flag */
+	pack64(info_delta_generation(&node_delta), buffer);
+	pack16((uint16_t) full, buffer);
+
+	/* write header: count and time */
+	count_offset = get_buf_offset(buffer);
+	pack32(nodes_packed, buffer);
+	select_g_alter_node_cnt(SELECT_GET_NODE_SCALING, &node_scaling);
+	pack32(node_scaling, buffer);
+	pack_time(now, buffer);
+
+	/* write node records */
+	node_ptr = node_record_table_ptr;
+	for (inx = 0; inx < node_record_count; inx++, node_ptr++) {
+		xassert (node_ptr->magic == NODE_MAGIC);
+		xassert (node_ptr->config_ptr->magic == CONFIG_MAGIC);
+
+		if (!full && (node_ptr->delta_gen <= since))
+			continue;
+
+		hidden = false;
+		if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
+		    (_node_is_hidden(node_ptr, uid)))
+			hidden = true;
+		else if (IS_NODE_FUTURE(node_ptr))
+			hidden = true;
+		else if (_is_cloud_hidden(node_ptr))
+			hidden = true;
+		else if ((node_ptr->name == NULL) ||
+			 (node_ptr->name[0] == '\0'))
+			hidden = true;
+
+		if (!hidden) {
+			_pack_node(node_ptr, buffer, protocol_version,
+				   show_flags);
+		} else if (full) {
+			/* Keep the node index pointers, see pack_all_node() */
+			char *orig_name = node_ptr->name;
+			node_ptr->name = NULL;
+			_pack_node(node_ptr, buffer, protocol_version,
+				   show_flags);
+			node_ptr->name = orig_name;
+		} else {
+			/* The client may hold this node from before */
+			if (node_ptr->name && node_ptr->name[0]) {
+				xrealloc(removed_names, sizeof(char *) *
+					 (removed_cnt + 1));
+				removed_names[removed_cnt++] = node_ptr->name;
+			}
+			continue;
+		}
+		nodes_packed++;
+	}
+	info_delta_end(&node_delta);
+
+	/* write the names of the nodes removed from the client's view */
+	packstr_array(removed_names, removed_cnt, buffer);
+	xfree(removed_names);
+
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, count_offset);
+	pack32(nodes_packed, buffer);
+	set_buf_offset(buffer, tmp_offset);
+
+	*buffer_size = get_buf_offset(buffer);
+	buffer_ptr[0] = xfer_buf_data(buffer);
+}
+
 /*
  * pack_one_node - dump all configuration and node information for one node
  *	in machine independent form (for network transmission)
@@ -3700,6 +3830,7 @@ void make_node_idle(struct node_record *node_ptr,
 	if (node_bitmap && (bit_test(node_bitmap, inx))) {
 		/* Not a replay */
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		bit_clear(node_bitmap, inx);
 
 		job_update_tres_cnt(job_ptr, inx);
@@ -3912,6 +4043,7 @@ extern void node_fini (void)
 	FREE_NULL_BITMAP(power_node_bitmap);
 	FREE_NULL_BITMAP(share_node_bitmap);
 	FREE_NULL_BITMAP(up_node_bitmap);
+	info_delta_fini(&node_delta);
 	node_fini2();
 }
 
@@ -476,6 +476,7 @@ extern void deallocate_nodes(struct job_record *job_ptr, bool timeout,
 	xassert(job_ptr->details);
 
 	trace_job(job_ptr, __func__, "");
+	job_set_changed(job_ptr);
 
 	if (select_serial == -1) {
 		if (xstrcmp(slurmctld_conf.select_type, "select/serial"))
@@ -2230,6 +2231,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = WAIT_QOS;
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		return ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
 	}
 
@@ -2243,6 +2245,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = WAIT_ACCOUNT;
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		return ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
 	}
 	assoc_mgr_unlock(&qos_read_lock);
@@ -2262,6 +2265,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 	if (bb != 1) {
 		xfree(job_ptr->state_desc);
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		if (bb == 0)
 			job_ptr->state_reason = WAIT_BURST_BUFFER_STAGING;
 		else
@@ -2412,6 +2416,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_PART_NODE_LIMIT;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 
 		/* Non-fatal errors for job below */
 		} else if (error_code == ESLURM_NODE_NOT_AVAIL) {
@@ -2454,6 +2459,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			}
 			xfree(unavail_node);
 			last_job_update = now;
+			job_set_changed(job_ptr);
 		} else if ((error_code == ESLURM_RESERVATION_NOT_USABLE) ||
 			   (error_code == ESLURM_RESERVATION_BUSY)) {
 			job_ptr->state_reason = WAIT_RESERVATION;
@@ -2529,6 +2535,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->priority = 0;
 		job_ptr->state_reason = WAIT_HELD;
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		goto cleanup;
 	}
 	if (select_g_job_begin(job_ptr) != SLURM_SUCCESS) {
@@ -2544,6 +2551,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		goto cleanup;
 	}
 
@@ -2567,6 +2575,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
 		last_job_update = now;
+		job_set_changed(job_ptr);
 		goto cleanup;
 	}
 
@@ -2591,6 +2600,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_RESOURCES;
 			job_ptr->job_state = JOB_PENDING;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			goto cleanup;
 		}
 	}
@@ -86,6 +86,7 @@
 #include "src/slurmctld/fed_mgr.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
+#include "src/slurmctld/info_cache.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
@@ -105,6 +106,8 @@
 #ifdef SLURM_SIMULATOR
 #include <semaphore.h>
 
+#include "src/common/sim_profile.h"
+
 pthread_mutex_t lock_finishing_jobs = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t lock_remaining_epilogs = PTHREAD_MUTEX_INITIALIZER;
 #endif
@@ -122,6 +125,26 @@ static uint64_t *rpc_user_time = NULL;
 static pthread_mutex_t throttle_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t throttle_cond = PTHREAD_COND_INITIALIZER;
 
+/*
+ * Node registrations waiting for validation. After a slurmctld restart or a
+ * network problem every slurmd registers at once, so RPC threads queue their
+ * message here and whichever finds no batch in progress validates up to
+ * NODE_REG_BATCH_MAX of them under one job write lock, see _node_reg_queue().
+ */
+#define NODE_REG_BATCH_MAX 256
+
+typedef struct {
+	slurm_msg_t *msg;
+	int error_code;
+	bool newly_up;
+	bool done;
+} node_reg_t;
+
+static pthread_mutex_t node_reg_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t node_reg_cond = PTHREAD_COND_INITIALIZER;
+static List node_reg_list = NULL;
+static bool node_reg_active = false;
+
 static void         _fill_ctld_conf(slurm_ctl_conf_t * build_ptr);
 static void         _kill_job_on_msg_fail(uint32_t job_id);
 static int          _is_prolog_finished(uint32_t job_id);
@@ -154,10 +177,13 @@ inline static void  _slurm_rpc_dump_batch_script(slurm_msg_t *msg);
 inline static void  _slurm_rpc_dump_conf(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_front_end(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_jobs(slurm_msg_t * msg);
+inline static void  _slurm_rpc_dump_jobs_delta(slurm_msg_t * msg);
+inline static void  _slurm_rpc_dump_jobs_query(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_jobs_user(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_job_single(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_licenses(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_nodes(slurm_msg_t * msg);
+inline static void  _slurm_rpc_dump_nodes_delta(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_node_single(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_partitions(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_spank(slurm_msg_t * msg);
@@ -263,7 +289,7 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 {
 	DEF_TIMERS;
 	int i, rpc_type_index = -1, rpc_user_index = -1;
-	uint32_t rpc_uid;
+	uint32_t rpc_uid, old_lock_ctx;
 
 	if (arg && (arg->newsockfd >= 0))
 		fd_set_nonblocking(arg->newsockfd);
@@ -312,6 +338,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	}
 	slurm_mutex_unlock(&rpc_mutex);
 
+	/* Attribute the locks taken below to this RPC type */
+	old_lock_ctx = set_lock_context(msg->msg_type);
+
 	/* Debug the protocol layer.
 	 */
 	START_TIMER;
@@ -346,6 +375,12 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_JOB_INFO:
 		_slurm_rpc_dump_jobs(msg);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		_slurm_rpc_dump_jobs_delta(msg);
+		break;
+	case REQUEST_JOB_INFO_QUERY:
+		_slurm_rpc_dump_jobs_query(msg);
+		break;
 	case REQUEST_JOB_USER_INFO:
 		_slurm_rpc_dump_jobs_user(msg);
 		break;
@@ -373,6 +408,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_NODE_INFO:
 		_slurm_rpc_dump_nodes(msg);
 		break;
+	case REQUEST_NODE_INFO_DELTA:
+		_slurm_rpc_dump_nodes_delta(msg);
+		break;
 	case REQUEST_NODE_INFO_SINGLE:
 		_slurm_rpc_dump_node_single(msg);
 		break;
@@ -615,6 +653,7 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	}
 
 	END_TIMER;
+	(void) set_lock_context(old_lock_ctx);
 	slurm_mutex_lock(&rpc_mutex);
 	if (rpc_type_index >= 0) {
 		rpc_type_cnt[rpc_type_index]++;
@@ -1680,6 +1719,21 @@ static void _slurm_rpc_dump_conf(slurm_msg_t * msg)
 	}
 }
 
+/* Return the uid an information response is cached for, NO_VAL if every
+ * user gets the same response. SlurmUser and root see all records (see
+ * part_is_visible()), others only visible partitions unless SHOW_ALL is
+ * set and their own records with PrivateData. */
+static uint32_t _info_cache_uid(uid_t uid, uint16_t show_flags,
+				uint16_t private_flag)
+{
+	if (validate_slurm_user(uid))
+		return 0;
+	if ((show_flags & SHOW_ALL) &&
+	    !(slurmctld_conf.private_data & private_flag))
+		return NO_VAL;
+	return uid;
+}
+
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
 static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 {
@@ -1687,6 +1741,7 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	char *dump;
 	int dump_size;
 	slurm_msg_t response_msg;
+	info_cache_ent_t *cache_ent = NULL;
 	job_info_request_msg_t *job_info_request_msg =
 		(job_info_request_msg_t *) msg->data;
 	/* Locks: Read config job part */
@@ -1710,9 +1765,24 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 				       job_info_request_msg->show_flags, uid,
 				       NO_VAL, msg->protocol_version);
 		} else {
-			pack_all_jobs(&dump, &dump_size,
-				      job_info_request_msg->show_flags, uid,
-				      NO_VAL, msg->protocol_version);
+			cache_ent = info_cache_get(
+				REQUEST_JOB_INFO,
+				job_info_request_msg->show_flags,
+				msg->protocol_version,
+				_info_cache_uid(uid,
+						job_info_request_msg->show_flags,
+						PRIVATE_DATA_JOBS),
+				last_job_update, last_part_update,
+				&dump, &dump_size);
+			if (!dump) {
+				pack_all_jobs(&dump, &dump_size,
+					      job_info_request_msg->show_flags,
+					      uid, NO_VAL,
+					      msg->protocol_version);
+				if (cache_ent)
+					info_cache_put(cache_ent, dump,
+						       dump_size);
+			}
 		}
 		unlock_slurmctld(job_read_lock);
 		END_TIMER2("_slurm_rpc_dump_jobs");
@@ -1732,10 +1802,88 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 
 		/* send message */
 		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
+		if (cache_ent)
+			info_cache_release(cache_ent);
+		else
+			xfree(dump);
 	}
 }
 
+/* _slurm_rpc_dump_jobs_delta - process RPC for job state changes */
+static void _slurm_rpc_dump_jobs_delta(slurm_msg_t * msg)
+{
+	DEF_TIMERS;
+	char *dump;
+	int dump_size;
+	slurm_msg_t response_msg;
+	info_delta_request_msg_t *delta_req_msg =
+		(info_delta_request_msg_t *) msg->data;
+	/* Locks: Read config job part */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
+					 slurmctld_config.auth_info);
+
+	START_TIMER;
+	debug3("Processing RPC: REQUEST_JOB_INFO_DELTA from uid=%d", uid);
+	lock_slurmctld(job_read_lock);
+	pack_jobs_delta(&dump, &dump_size, delta_req_msg->generation,
+			delta_req_msg->show_flags, uid, NO_VAL,
+			msg->protocol_version);
+	unlock_slurmctld(job_read_lock);
+	END_TIMER2("_slurm_rpc_dump_jobs_delta");
+
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.conn = msg->conn;
+	response_msg.msg_type = RESPONSE_JOB_INFO_DELTA;
+	response_msg.data = dump;
+	response_msg.data_size = dump_size;
+
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(dump);
+}
+
+/* _slurm_rpc_dump_jobs_query - process RPC for the jobs matching a query */
+static void _slurm_rpc_dump_jobs_query(slurm_msg_t * msg)
+{
+	DEF_TIMERS;
+	char *dump;
+	int dump_size;
+	slurm_msg_t response_msg;
+	job_info_query_t *query = (job_info_query_t *) msg->data;
+	/* Locks: Read config job part */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
+					 slurmctld_config.auth_info);
+
+	START_TIMER;
+	debug3("Processing RPC: REQUEST_JOB_INFO_QUERY from uid=%d", uid);
+	lock_slurmctld(job_read_lock);
+	pack_jobs_query(&dump, &dump_size, query, uid, msg->protocol_version);
+	unlock_slurmctld(job_read_lock);
+	END_TIMER2("_slurm_rpc_dump_jobs_query");
+
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.conn = msg->conn;
+	response_msg.msg_type = RESPONSE_JOB_INFO;
+	response_msg.data = dump;
+	response_msg.data_size = dump_size;
+
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(dump);
+}
+
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
 static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 {
@@ -2001,6 +2149,7 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 	char *dump;
 	int dump_size;
 	slurm_msg_t response_msg;
+	info_cache_ent_t *cache_ent = NULL;
 	node_info_request_msg_t *node_req_msg =
 		(node_info_request_msg_t *) msg->data;
 	/* Locks: Read config, write node (reset allocated CPU count in some
@@ -2030,8 +2179,21 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 		debug3("_slurm_rpc_dump_nodes, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
-		pack_all_node(&dump, &dump_size, node_req_msg->show_flags,
-			      uid, msg->protocol_version);
+		cache_ent = info_cache_get(REQUEST_NODE_INFO,
+					   node_req_msg->show_flags,
+					   msg->protocol_version,
+					   _info_cache_uid(
+						uid, node_req_msg->show_flags,
+						PRIVATE_DATA_NODES),
+					   last_node_update, last_part_update,
+					   &dump, &dump_size);
+		if (!dump) {
+			pack_all_node(&dump, &dump_size,
+				      node_req_msg->show_flags, uid,
+				      msg->protocol_version);
+			if (cache_ent)
+				info_cache_put(cache_ent, dump, dump_size);
+		}
 		unlock_slurmctld(node_write_lock);
 		END_TIMER2("_slurm_rpc_dump_nodes");
 #if 0
@@ -2050,10 +2212,63 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 
 		/* send message */
 		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
+		if (cache_ent)
+			info_cache_release(cache_ent);
+		else
+			xfree(dump);
 	}
 }
 
+/* _slurm_rpc_dump_nodes_delta - process RPC for node state changes */
+static void _slurm_rpc_dump_nodes_delta(slurm_msg_t * msg)
+{
+	DEF_TIMERS;
+	char *dump;
+	int dump_size;
+	slurm_msg_t response_msg;
+	info_delta_request_msg_t *delta_req_msg =
+		(info_delta_request_msg_t *) msg->data;
+	/* Locks: Read config, write node (reset allocated CPU count in some
+	 * select plugins), read part (for part_is_visible) */
+	slurmctld_lock_t node_write_lock = {
+		READ_LOCK, NO_LOCK, WRITE_LOCK, READ_LOCK, NO_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
+					 slurmctld_config.auth_info);
+
+	START_TIMER;
+	debug3("Processing RPC: REQUEST_NODE_INFO_DELTA from uid=%d", uid);
+
+	if ((slurmctld_conf.private_data & PRIVATE_DATA_NODES) &&
+	    (!validate_operator(uid))) {
+		error("Security violation, REQUEST_NODE_INFO_DELTA RPC "
+		      "from uid=%d", uid);
+		slurm_send_rc_msg(msg, ESLURM_ACCESS_DENIED);
+		return;
+	}
+
+	lock_slurmctld(node_write_lock);
+	select_g_select_nodeinfo_set_all();
+	pack_nodes_delta(&dump, &dump_size, delta_req_msg->generation,
+			 delta_req_msg->show_flags, uid,
+			 msg->protocol_version);
+	unlock_slurmctld(node_write_lock);
+	END_TIMER2("_slurm_rpc_dump_nodes_delta");
+
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.conn = msg->conn;
+	response_msg.msg_type = RESPONSE_NODE_INFO_DELTA;
+	response_msg.data = dump;
+	response_msg.data_size = dump_size;
+
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(dump);
+}
+
 /* _slurm_rpc_dump_node_single - done RPC state information for one node */
 static void _slurm_rpc_dump_node_single(slurm_msg_t * msg)
 {
@@ -2119,6 +2334,7 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t * msg)
 	int dump_size;
 	slurm_msg_t response_msg;
 	part_info_request_msg_t  *part_req_msg;
+	info_cache_ent_t *cache_ent = NULL;
 
 	/* Locks: Read configuration and partition */
 	slurmctld_lock_t part_read_lock = {
@@ -2142,8 +2358,21 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t * msg)
 		debug2("_slurm_rpc_dump_partitions, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
-		pack_all_part(&dump, &dump_size, part_req_msg->show_flags,
-			      uid, msg->protocol_version);
+		cache_ent = info_cache_get(REQUEST_PARTITION_INFO,
+					   part_req_msg->show_flags,
+					   msg->protocol_version,
+					   _info_cache_uid(
+						uid, part_req_msg->show_flags,
+						PRIVATE_DATA_PARTITIONS),
+					   last_part_update, 0,
+					   &dump, &dump_size);
+		if (!dump) {
+			pack_all_part(&dump, &dump_size,
+				      part_req_msg->show_flags, uid,
+				      msg->protocol_version);
+			if (cache_ent)
+				info_cache_put(cache_ent, dump, dump_size);
+		}
 		unlock_slurmctld(part_read_lock);
 		END_TIMER2("_slurm_rpc_dump_partitions");
 		debug2("_slurm_rpc_dump_partitions, size=%d %s",
@@ -2161,7 +2390,10 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t * msg)
 
 		/* send message */
 		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
+		if (cache_ent)
+			info_cache_release(cache_ent);
+		else
+			xfree(dump);
 	}
 }
 
@@ -3053,6 +3285,89 @@ static void _slurm_rpc_event_log(slurm_msg_t * msg)
 	slurm_send_rc_msg(msg, error_code);
 }
 
+/* Validate one node registration, job write lock must be held */
+static int _validate_node_reg(slurm_msg_t *msg, bool *newly_up)
+{
+	slurm_node_registration_status_msg_t *node_reg_stat_msg =
+		(slurm_node_registration_status_msg_t *) msg->data;
+
+#ifdef HAVE_FRONT_END		/* Operates only on front-end */
+	return validate_nodes_via_front_end(node_reg_stat_msg,
+					    msg->protocol_version, newly_up);
+#else
+	validate_jobs_on_node(node_reg_stat_msg);
+	return validate_node_specs(node_reg_stat_msg, msg->protocol_version,
+				   newly_up);
+#endif
+}
+
+/* Validate a batch of queued node registrations under one lock, merging the
+ * job kill requests they generate into multi-node agent requests */
+static void _node_reg_batch(List batch)
+{
+	DEF_TIMERS;
+	ListIterator iter;
+	node_reg_t *reg;
+	/* Locks: Read config, write job, write node */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
+
+	START_TIMER;
+	lock_slurmctld(job_write_lock);
+	job_kill_batch_begin();
+	iter = list_iterator_create(batch);
+	while ((reg = (node_reg_t *) list_next(iter)))
+		reg->error_code = _validate_node_reg(reg->msg, &reg->newly_up);
+	list_iterator_destroy(iter);
+	job_kill_batch_end();
+	unlock_slurmctld(job_write_lock);
+	END_TIMER2("_node_reg_batch");
+	if (list_count(batch) > 1)
+		debug("%s: validated %d node registrations %s", __func__,
+		      list_count(batch), TIME_STR);
+}
+
+/* Queue a node registration and wait until it has been validated, either
+ * in a batch run by this thread or by another RPC thread */
+static int _node_reg_queue(slurm_msg_t *msg, bool *newly_up)
+{
+	node_reg_t reg, *next;
+	List batch;
+
+	memset(&reg, 0, sizeof(node_reg_t));
+	reg.msg = msg;
+
+	slurm_mutex_lock(&node_reg_mutex);
+	if (!node_reg_list)
+		node_reg_list = list_create(NULL);
+	list_append(node_reg_list, &reg);
+	while (!reg.done) {
+		if (node_reg_active) {
+			slurm_cond_wait(&node_reg_cond, &node_reg_mutex);
+			continue;
+		}
+		node_reg_active = true;
+		batch = list_create(NULL);
+		while ((list_count(batch) < NODE_REG_BATCH_MAX) &&
+		       (next = list_dequeue(node_reg_list)))
+			list_append(batch, next);
+		slurm_mutex_unlock(&node_reg_mutex);
+
+		_node_reg_batch(batch);
+
+		slurm_mutex_lock(&node_reg_mutex);
+		while ((next = list_pop(batch)))
+			next->done = true;
+		FREE_NULL_LIST(batch);
+		node_reg_active = false;
+		slurm_cond_broadcast(&node_reg_cond);
+	}
+	slurm_mutex_unlock(&node_reg_mutex);
+
+	*newly_up = reg.newly_up;
+	return reg.error_code;
+}
+
 /* _slurm_rpc_node_registration - process RPC to determine if a node's
  *	actual configuration satisfies the configured specification */
 static void _slurm_rpc_node_registration(slurm_msg_t * msg,
@@ -3064,9 +3379,6 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg,
 	bool newly_up = false;
 	slurm_node_registration_status_msg_t *node_reg_stat_msg =
 		(slurm_node_registration_status_msg_t *) msg->data;
-	/* Locks: Read config, write job, write node */
-	slurmctld_lock_t job_write_lock = {
-		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
 					 slurmctld_config.auth_info);
 
@@ -3096,20 +3408,10 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg,
 			      "set DebugFlags=NO_CONF_HASH in your slurm.conf.",
 			      node_reg_stat_msg->node_name);
 		}
-		if (!running_composite)
-			lock_slurmctld(job_write_lock);
-#ifdef HAVE_FRONT_END		/* Operates only on front-end */
-		error_code = validate_nodes_via_front_end(node_reg_stat_msg,
-							  msg->protocol_version,
-							  &newly_up);
-#else
-		validate_jobs_on_node(node_reg_stat_msg);
-		error_code = validate_node_specs(node_reg_stat_msg,
-						 msg->protocol_version,
-						 &newly_up);
-#endif
-		if (!running_composite)
-			unlock_slurmctld(job_write_lock);
+		if (running_composite)
+			error_code = _validate_node_reg(msg, &newly_up);
+		else
+			error_code = _node_reg_queue(msg, &newly_up);
 		END_TIMER2("_slurm_rpc_node_registration");
 		if (newly_up) {
 			queue_job_scheduler();
@@ -6310,6 +6612,8 @@ static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
 	pack64_array(rpc_user_time, i, buffer);
 	slurm_mutex_unlock(&rpc_mutex);
 
+	pack_lock_context_stats(buffer, protocol_version);
+
 	*buffer_size = get_buf_offset(buffer);
 	buffer_ptr[0] = xfer_buf_data(buffer);
 }
@@ -6346,6 +6650,7 @@ inline static void _slurm_rpc_dump_stats(slurm_msg_t * msg)
 	if (request_msg->command_id == STAT_COMMAND_RESET) {
 		reset_stats(1);
 		_clear_rpc_stats();
+		reset_lock_stats();
 		pack_all_stat(0, &dump, &dump_size, msg->protocol_version);
 		_pack_rpc_stats(0, &dump, &dump_size, msg->protocol_version);
 		response_msg.data = dump;
@@ -6605,10 +6910,12 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 
 	_throttle_start(&active_rpc_cnt);
 	lock_slurmctld(job_write_lock);
+	job_kill_batch_begin();
 	gettimeofday(&start_tv, NULL);
 	_slurm_rpc_comp_msg_list(comp_msg, &run_scheduler,
 				 comp_resp_msg.msg_list, &start_tv,
 				 sched_timeout);
+	job_kill_batch_end();
 	unlock_slurmctld(job_write_lock);
 	_throttle_fini(&active_rpc_cnt);
 
@@ -7167,6 +7474,66 @@ static void do_backfill() {
         sem_wait(mutex_bf_done);
 }
 
+/*
+ * Complete the jobs reported in a MESSAGE_SIM_HELPER_CYCLE. Each job goes
+ * through the regular batch script completion and, since the simulated
+ * slurmd runs no epilog, its epilog completion is noted right away. Both
+ * run as embedded messages under a single lock, like the members of a
+ * MESSAGE_COMPOSITE, and their replies are collected and dropped.
+ */
+static void _sim_complete_jobs(slurm_msg_t *msg, sim_helper_msg_t *helper_msg)
+{
+	/* Locks: Read config, write job, write node, read federation */
+	/* Must cover the locks of both embedded RPCs */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, READ_LOCK };
+	complete_batch_script_msg_t comp_req;
+	epilog_complete_msg_t epilog_req;
+	slurm_msg_t comp_msg, epilog_msg;
+	struct job_record *job_ptr;
+	bool run_scheduler = false;
+	List ret_list;
+	uint32_t i;
+
+	ret_list = list_create(_slurmctld_free_comp_msg_list);
+	slurm_msg_t_init(&comp_msg);
+	comp_msg.msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
+	comp_msg.auth_cred = msg->auth_cred;
+	comp_msg.protocol_version = msg->protocol_version;
+	comp_msg.ret_list = ret_list;
+	comp_msg.data = &comp_req;
+	slurm_msg_t_init(&epilog_msg);
+	epilog_msg.msg_type = MESSAGE_EPILOG_COMPLETE;
+	epilog_msg.auth_cred = msg->auth_cred;
+	epilog_msg.protocol_version = msg->protocol_version;
+	epilog_msg.ret_list = ret_list;
+	epilog_msg.data = &epilog_req;
+
+	lock_slurmctld(job_write_lock);
+	for (i = 0; i < helper_msg->job_cnt; i++) {
+		memset(&comp_req, 0, sizeof(complete_batch_script_msg_t));
+		comp_req.job_id = helper_msg->job_ids[i];
+		comp_req.job_rc = 0;
+		comp_req.slurm_rc = SLURM_SUCCESS;
+		comp_msg.msg_index = i + 1;
+		_slurm_rpc_complete_batch_script(&comp_msg, &run_scheduler,
+						 true);
+
+		job_ptr = find_job_record(helper_msg->job_ids[i]);
+		memset(&epilog_req, 0, sizeof(epilog_complete_msg_t));
+		epilog_req.job_id = helper_msg->job_ids[i];
+		epilog_req.return_code = SLURM_SUCCESS;
+		epilog_req.node_name = job_ptr ? job_ptr->batch_host : NULL;
+		epilog_msg.msg_index = i + 1;
+		_slurm_rpc_epilog_complete(&epilog_msg, &run_scheduler, true);
+	}
+	unlock_slurmctld(job_write_lock);
+	FREE_NULL_LIST(ret_list);
+
+	if (run_scheduler)
+		queue_job_scheduler();
+}
+
 static void _slurm_rpc_sim_helper_cycle(slurm_msg_t * msg)
 {
         if (mutex_bf==NULL) {
@@ -7177,7 +7544,15 @@ static void _slurm_rpc_sim_helper_cycle(slurm_msg_t * msg)
         }
         sim_helper_msg_t *helper_msg =
                 (sim_helper_msg_t *) msg->data;
-
+        uint64_t prof_start;
+        int jobs_started;
+
+        (void) sim_prof_attach();
+        prof_start = sim_prof_begin();
+        if (helper_msg->job_cnt)
+                _sim_complete_jobs(msg, helper_msg);
+        sim_prof_end(SIM_PROF_COMPLETE_SEND, prof_start);
+        prof_start = sim_prof_begin();
 		while (1) {
 			pthread_mutex_lock(&lock_finishing_jobs);
 			if (total_finished_jobs == helper_msg->total_jobs_ended) {
@@ -7200,18 +7575,26 @@ static void _slurm_rpc_sim_helper_cycle(slurm_msg_t * msg)
 			debug3("Waiting epilogs to finish");
 			usleep(100);
 		}
+        sim_prof_end(SIM_PROF_CTLD_WAIT, prof_start);
         debug4("Processing RPC: MESSAGE_SIM_HELPER_CYCLE for %d jobs",
                         helper_msg->total_jobs_ended);
         time_t current_time=time(NULL);
           if (get_scheduler_cnt() > 0) {
                 reset_scheduler_cnt();
-                schedule(0);
+                prof_start = sim_prof_begin();
+                jobs_started = schedule(0);
+                sim_prof_end(SIM_PROF_SCHEDULE, prof_start);
+                sim_prof_count(SIM_PROF_SCHED_PASSES, 1);
+                sim_prof_count(SIM_PROF_JOBS_STARTED, jobs_started);
                 last_helper_schedule_time=current_time;
         }
         if (last_helper_backfill_time==0 ||
                 (current_time-last_helper_backfill_time)>backfill_interval) {
                 info("unlocking backfill, backfill_interval %d", backfill_interval);
+                prof_start = sim_prof_begin();
                 do_backfill();
+                sim_prof_end(SIM_PROF_BACKFILL, prof_start);
+                sim_prof_count(SIM_PROF_BF_PASSES, 1);
                 last_helper_backfill_time=current_time;
         }
 
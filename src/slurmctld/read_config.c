@@ -77,6 +77,7 @@
 #include "src/slurmctld/fed_mgr.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
+#include "src/slurmctld/job_journal.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
@@ -980,6 +981,26 @@ static void _validate_pack_jobs(void)
 	list_for_each(job_list, _test_pack_used, NULL);
 }
 
+/*
+ * Log the time taken by a phase of read_slurm_conf(), at startup these are
+ * logged at info level so that slow recovery phases are visible.
+ * IN/OUT tv - start of the phase, set to the start of the next one
+ */
+static void _log_phase(const char *phase, struct timeval *tv, bool reconfig)
+{
+	struct timeval now;
+	long delta_t;
+
+	gettimeofday(&now, NULL);
+	delta_t  = (now.tv_sec - tv->tv_sec) * 1000000;
+	delta_t += now.tv_usec - tv->tv_usec;
+	if (reconfig)
+		debug("read_slurm_conf: %s took %ld usec", phase, delta_t);
+	else
+		info("read_slurm_conf: %s took %ld usec", phase, delta_t);
+	*tv = now;
+}
+
 /*
  * read_slurm_conf - load the slurm configuration from the configured file.
  * read_slurm_conf can be called more than once if so desired.
@@ -998,6 +1019,7 @@ static void _validate_pack_jobs(void)
 int read_slurm_conf(int recover, bool reconfig)
 {
 	DEF_TIMERS;
+	struct timeval phase_tv;
 	int error_code, i, rc, load_job_ret = SLURM_SUCCESS;
 	int old_node_record_count = 0;
 	struct node_record *old_node_table_ptr = NULL, *node_ptr;
@@ -1019,6 +1041,11 @@ int read_slurm_conf(int recover, bool reconfig)
 
 	/* initialization */
 	START_TIMER;
+	phase_tv = tv1;
+
+	/* Have the job state read in while the tables below are built */
+	if (!reconfig && recover)
+		prefetch_job_state();
 
 	xfree(slurmctld_config.auth_info);
 	slurmctld_config.auth_info = slurm_get_auth_info();
@@ -1063,9 +1090,11 @@ int read_slurm_conf(int recover, bool reconfig)
 
 	if (slurm_topo_init() != SLURM_SUCCESS)
 		fatal("Failed to initialize topology plugin");
+	_log_phase("configuration", &phase_tv, reconfig);
 
 	/* Build node and partition information based upon slurm.conf file */
 	_build_all_nodeline_info();
+	_log_phase("node table", &phase_tv, reconfig);
 	if (reconfig) {
 		if (_compare_hostnames(old_node_table_ptr,
 				       old_node_record_count,
@@ -1076,6 +1105,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	}
 	_handle_all_downnodes();
 	_build_all_partitionline_info();
+	_log_phase("partition table", &phase_tv, reconfig);
 	if (!reconfig) {
 		restore_front_end_state(recover);
 
@@ -1142,6 +1172,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	 */
 	if (!reconfig && (layouts_load_config(recover) != SLURM_SUCCESS))
 		fatal("Failed to load the layouts framework configuration");
+	_log_phase("plugins and node hash", &phase_tv, reconfig);
 
 	if (reconfig) {		/* Preserve state from memory */
 		if (old_node_table_ptr) {
@@ -1175,15 +1206,20 @@ int read_slurm_conf(int recover, bool reconfig)
 	} else if (recover == 1) {	/* Load job & node state files */
 		(void) load_all_node_state(true);
 		(void) load_all_front_end_state(true);
+		_log_phase("node state", &phase_tv, reconfig);
 		load_job_ret = load_all_job_state();
 		sync_job_priorities();
 	} else if (recover > 1) {	/* Load node, part & job state files */
 		(void) load_all_node_state(false);
 		(void) load_all_front_end_state(false);
+		_log_phase("node state", &phase_tv, reconfig);
 		(void) load_all_part_state();
+		_log_phase("partition state", &phase_tv, reconfig);
 		load_job_ret = load_all_job_state();
 		sync_job_priorities();
 	}
+	_log_phase(reconfig ? "state restore" : "job state", &phase_tv,
+		   reconfig);
 
 	_sync_part_prio();
 	_build_bitmaps_pre_select();
@@ -1197,11 +1233,13 @@ int read_slurm_conf(int recover, bool reconfig)
 	}
 
 	xfree(state_save_dir);
+	_log_phase("select plugin state", &phase_tv, reconfig);
 	_gres_reconfig(reconfig);
 	reset_job_bitmaps();		/* must follow select_g_job_init() */
 
 	(void) _sync_nodes_to_jobs(reconfig);
 	(void) sync_job_files();
+	_log_phase("job bitmaps", &phase_tv, reconfig);
 	_purge_old_node_state(old_node_table_ptr, old_node_record_count);
 	_purge_old_part_state(old_part_list, old_def_part_name);
 
@@ -1213,6 +1251,7 @@ int read_slurm_conf(int recover, bool reconfig)
 		fatal("Invalid Licenses value: %s", slurmctld_conf.licenses);
 
 	init_requeue_policy();
+	job_journal_reconfig();
 
 	/* NOTE: Run restore_node_features before _restore_job_dependencies */
 	restore_node_features(recover);
@@ -1240,6 +1279,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	_validate_pack_jobs();
 	(void) _sync_nodes_to_comp_job();/* must follow select_g_node_init() */
 	load_part_uid_allow_list(1);
+	_log_phase("node features", &phase_tv, reconfig);
 
 	if (reconfig) {
 		load_all_resv_state(0);
@@ -1250,6 +1290,7 @@ int read_slurm_conf(int recover, bool reconfig)
 			(void) slurm_sched_g_reconfig();
 		}
 	}
+	_log_phase("reservation and trigger state", &phase_tv, reconfig);
 
 	/* NOTE: Run load_all_resv_state() before _restore_job_dependencies */
 	_restore_job_dependencies();
@@ -1304,6 +1345,8 @@ int read_slurm_conf(int recover, bool reconfig)
 			fatal("Failed to reconfigure mcs plugin");
 	}
 
+	_log_phase("plugin reconfiguration", &phase_tv, reconfig);
+
 	slurmctld_conf.last_update = time(NULL);
 	END_TIMER2("read_slurm_conf");
 	return error_code;
@@ -98,6 +98,10 @@ time_t    last_resv_update = (time_t) 0;
 List      resv_list = (List) NULL;
 uint32_t  top_suffix = 0;
 
+/* Hash table of resv_list records by name, see _find_resv_by_name() */
+#define RESV_NAME_HASH_SIZE	256
+static slurmctld_resv_t *resv_name_hash[RESV_NAME_HASH_SIZE];
+
 #ifdef HAVE_BG
 uint32_t  cpu_mult = 0;
 uint32_t  cnodes_per_mp = 0;
@@ -132,6 +136,7 @@ static uint32_t _max_constraint_planning(constraint_planning_t* sched,
 					 time_t *start, time_t *end);
 
 
+static void _add_resv_name_hash(slurmctld_resv_t *resv_ptr);
 static void _advance_resv_time(slurmctld_resv_t *resv_ptr);
 static void _advance_time(time_t *res_time, int day_cnt);
 static int  _build_account_list(char *accounts, int *account_cnt,
@@ -140,10 +145,11 @@ static int  _build_uid_list(char *users, int *user_cnt, uid_t **user_list,
 			    bool *user_not);
 static void _clear_job_resv(slurmctld_resv_t *resv_ptr);
 static slurmctld_resv_t *_copy_resv(slurmctld_resv_t *resv_orig_ptr);
+static void _del_resv_name_hash(slurmctld_resv_t *resv_ptr);
 static void _del_resv_rec(void *x);
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode);
 static int  _find_resv_id(void *x, void *key);
-static int  _find_resv_name(void *x, void *key);
+static slurmctld_resv_t *_find_resv_by_name(char *name);
 static void *_fork_script(void *x);
 static void _free_script_arg(resv_thread_args_t *args);
 static int  _generate_resv_id(void);
@@ -430,6 +436,7 @@ static void _del_resv_rec(void *x)
 
 	if (resv_ptr) {
 		xassert(resv_ptr->magic == RESV_MAGIC);
+		_del_resv_name_hash(resv_ptr);
 		resv_ptr->magic = 0;
 		xfree(resv_ptr->accounts);
 		for (i = 0; i < resv_ptr->account_cnt; i++)
@@ -467,16 +474,56 @@ static int _find_resv_id(void *x, void *key)
 		return 1;	/* match */
 }
 
-static int _find_resv_name(void *x, void *key)
+static int _resv_name_hash_inx(char *name)
 {
-	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
-
-	xassert(resv_ptr->magic == RESV_MAGIC);
+	uint32_t hash = 0;
 
-	if (xstrcmp(resv_ptr->name, (char *) key))
+	if (!name)
 		return 0;
-	else
-		return 1;	/* match */
+	while (*name)
+		hash = (hash * 31) + (unsigned char) *name++;
+	return hash % RESV_NAME_HASH_SIZE;
+}
+
+/* Add a record appended to resv_list to the name hash table */
+static void _add_resv_name_hash(slurmctld_resv_t *resv_ptr)
+{
+	int inx = _resv_name_hash_inx(resv_ptr->name);
+
+	resv_ptr->name_next = resv_name_hash[inx];
+	resv_name_hash[inx] = resv_ptr;
+}
+
+/* Remove a record from the name hash table, if present */
+static void _del_resv_name_hash(slurmctld_resv_t *resv_ptr)
+{
+	slurmctld_resv_t **resv_pptr;
+
+	resv_pptr = &resv_name_hash[_resv_name_hash_inx(resv_ptr->name)];
+	while (*resv_pptr) {
+		if (*resv_pptr == resv_ptr) {
+			*resv_pptr = resv_ptr->name_next;
+			break;
+		}
+		resv_pptr = &(*resv_pptr)->name_next;
+	}
+	resv_ptr->name_next = NULL;
+}
+
+/* Find a resv_list record by name, without walking the list */
+static slurmctld_resv_t *_find_resv_by_name(char *name)
+{
+	slurmctld_resv_t *resv_ptr;
+
+	if (!name)
+		return NULL;
+	resv_ptr = resv_name_hash[_resv_name_hash_inx(name)];
+	for ( ; resv_ptr; resv_ptr = resv_ptr->name_next) {
+		xassert(resv_ptr->magic == RESV_MAGIC);
+		if (!xstrcmp(resv_ptr->name, name))
+			return resv_ptr;
+	}
+	return NULL;
 }
 
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode)
@@ -2451,8 +2498,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 		goto bad_parse;
 
 	if (resv_desc_ptr->name) {
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, resv_desc_ptr->name);
+		resv_ptr = _find_resv_by_name(resv_desc_ptr->name);
 		if (resv_ptr) {
 			info("Reservation request name duplication (%s)",
 			     resv_desc_ptr->name);
@@ -2462,9 +2508,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	} else {
 		while (1) {
 			_generate_resv_name(resv_desc_ptr);
-			resv_ptr = (slurmctld_resv_t *)
-					list_find_first (resv_list,
-					_find_resv_name, resv_desc_ptr->name);
+			resv_ptr = _find_resv_by_name(resv_desc_ptr->name);
 			if (!resv_ptr)
 				break;
 			rc = _generate_resv_id();	/* makes new suffix */
@@ -2542,6 +2586,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	_set_tres_cnt(resv_ptr, NULL);
 
 	list_append(resv_list, resv_ptr);
+	_add_resv_name_hash(resv_ptr);
 	last_resv_update = now;
 	schedule_resv_save();
 
@@ -2579,8 +2624,7 @@ extern int update_resv(resv_desc_msg_t *resv_desc_ptr)
 	if (!resv_desc_ptr->name)
 		return ESLURM_RESERVATION_INVALID;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, resv_desc_ptr->name);
+	resv_ptr = _find_resv_by_name(resv_desc_ptr->name);
 	if (!resv_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
@@ -3094,8 +3138,7 @@ extern int delete_resv(reservation_name_msg_t *resv_desc_ptr)
 extern slurmctld_resv_t *find_resv_name(char *resv_name)
 {
 	slurmctld_resv_t *resv_ptr;
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, resv_name);
+	resv_ptr = _find_resv_by_name(resv_name);
 	return resv_ptr;
 }
 
@@ -3467,10 +3510,8 @@ static void _validate_all_reservations(void)
 
 		if ((job_ptr->resv_ptr == NULL) ||
 		    (job_ptr->resv_ptr->magic != RESV_MAGIC)) {
-			job_ptr->resv_ptr = (slurmctld_resv_t *)
-					list_find_first(resv_list,
-							_find_resv_name,
-							job_ptr->resv_name);
+			job_ptr->resv_ptr =
+				_find_resv_by_name(job_ptr->resv_name);
 		}
 		if (!job_ptr->resv_ptr) {
 			error("JobId %u linked to defunct reservation %s",
@@ -3754,6 +3795,7 @@ extern int load_all_resv_state(int recover)
 			break;
 
 		list_append(resv_list, resv_ptr);
+		_add_resv_name_hash(resv_ptr);
 		info("Recovered state of reservation %s", resv_ptr->name);
 	}
 
@@ -3796,8 +3838,7 @@ extern int validate_job_resv(struct job_record *job_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
 	/* Find the named reservation */
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = _find_resv_by_name(job_ptr->resv_name);
 	rc = _valid_job_access_resv(job_ptr, resv_ptr);
 	if (rc == SLURM_SUCCESS) {
 		job_ptr->resv_id    = resv_ptr->resv_id;
@@ -4507,8 +4548,7 @@ extern int job_test_resv_now(struct job_record *job_ptr)
 	if (job_ptr->resv_name == NULL)
 		return SLURM_SUCCESS;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = _find_resv_by_name(job_ptr->resv_name);
 	job_ptr->resv_ptr = resv_ptr;
 	rc = _valid_job_access_resv(job_ptr, resv_ptr);
 	if (rc != SLURM_SUCCESS)
@@ -4548,8 +4588,7 @@ extern void job_claim_resv(struct job_record *job_ptr)
 	if (job_ptr->resv_name == NULL)
 		return;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = _find_resv_by_name(job_ptr->resv_name);
 	if (!resv_ptr ||
 	    (!resv_ptr->full_nodes && (resv_ptr->node_cnt > 1)) ||
 	    !(resv_ptr->flags & RESERVE_FLAG_REPLACE) ||
@@ -5119,8 +5158,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 	*node_bitmap = (bitstr_t *) NULL;
 
 	if (job_ptr->resv_name) {
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, job_ptr->resv_name);
+		resv_ptr = _find_resv_by_name(job_ptr->resv_name);
 		job_ptr->resv_ptr = resv_ptr;
 		rc2 = _valid_job_access_resv(job_ptr, resv_ptr);
 		if (rc2 != SLURM_SUCCESS)
@@ -0,0 +1,579 @@
+/*****************************************************************************\
+ *  rpc_pool.c - slurmctld RPC reader and worker pool
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * One reader thread (the slurmctld RPC manager) waits with epoll on the
+ * listening sockets and on every accepted connection. It reads each
+ * connection's length prefixed message without blocking, so a slow client
+ * costs no thread. Complete messages are queued to a fixed set of worker
+ * threads which unpack and process them with slurmctld_req().
+ *
+ * Messages are queued in one of three lanes by RPC type. Workers always
+ * take from the most urgent non-empty lane. Queries may only occupy half of
+ * the workers, so a flood of squeue/sinfo requests can not hold every worker
+ * in lock waits while job completions and node registrations queue up.
+ *
+ * slurmctld_config.server_thread_count counts the RPCs queued or being
+ * processed, as it counted RPC threads before, since the schedulers use it
+ * to defer work while slurmctld is busy.
+ */
+
+#include "config.h"
+
+#if HAVE_SYS_PRCTL_H
+#  include <sys/prctl.h>
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/common/fd.h"
+#include "src/common/forward.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rpc_pool.h"
+#include "src/slurmctld/slurmctld.h"
+
+#define RPC_LANE_URGENT	0	/* completions, registrations, control */
+#define RPC_LANE_NORMAL	1	/* submissions, updates, ... */
+#define RPC_LANE_QUERY	2	/* read only information requests */
+#define RPC_LANE_CNT	3
+
+#define MAX_EVENTS	64
+/* same limit as slurm_msg_recvfrom_timeout() */
+#define MAX_MSG_SIZE	(1024*1024*1024)
+
+/* A connection being read by the reader thread */
+typedef struct rpc_conn {
+	struct rpc_conn *next, *prev;
+	int fd;
+	bool listen;		/* listening socket, only fd is set */
+	slurm_addr_t cli_addr;
+	time_t start;		/* accept time from _mono_sec(), for the
+				 * message timeout */
+	uint32_t msglen;	/* length prefix, network byte order */
+	uint32_t len_got;	/* bytes of msglen read */
+	char *buf;		/* message, allocated once msglen is read */
+	uint32_t buf_got;	/* bytes of buf read */
+} rpc_conn_t;
+
+/* A complete message waiting for a worker */
+typedef struct {
+	int fd;
+	slurm_addr_t cli_addr;
+	Buf buffer;
+	int lane;
+} rpc_work_t;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  work_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  space_cond = PTHREAD_COND_INITIALIZER;
+static List      lanes[RPC_LANE_CNT];
+static uint32_t  pending = 0;	/* RPCs queued or being processed */
+static uint32_t  pending_max = 0;
+static uint32_t  query_active = 0, query_max = 0;
+static bool      pool_shutdown = false;
+static uint32_t  worker_cnt = 0;
+static pthread_t *workers = NULL;
+
+static rpc_conn_t *conn_head = NULL;	/* reader thread only */
+
+/* Seconds on a clock that is not affected by the simulator's time() */
+static time_t _mono_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
+
+static int _msg_lane(Buf buffer)
+{
+	header_t header;
+	int lane = RPC_LANE_NORMAL;
+
+	/* On error, slurm_unpack_received_msg() reports it from a worker */
+	if (unpack_header(&header, buffer) != SLURM_SUCCESS)
+		return lane;
+	destroy_forward(&header.forward);
+	FREE_NULL_LIST(header.ret_list);
+	set_buf_offset(buffer, 0);
+
+	switch (header.msg_type) {
+	case MESSAGE_EPILOG_COMPLETE:
+	case MESSAGE_NODE_REGISTRATION_STATUS:
+	case MESSAGE_COMPOSITE:
+	case REQUEST_COMPLETE_BATCH_SCRIPT:
+	case REQUEST_COMPLETE_JOB_ALLOCATION:
+	case REQUEST_COMPLETE_PROLOG:
+	case REQUEST_STEP_COMPLETE:
+	case REQUEST_STEP_COMPLETE_AGGR:
+	case REQUEST_CONTROL:
+	case REQUEST_TAKEOVER:
+	case REQUEST_RECONFIGURE:
+	case REQUEST_SHUTDOWN:
+		lane = RPC_LANE_URGENT;
+		break;
+	case REQUEST_ASSOC_MGR_INFO:
+	case REQUEST_BUILD_INFO:
+	case REQUEST_BURST_BUFFER_INFO:
+	case REQUEST_FED_INFO:
+	case REQUEST_FRONT_END_INFO:
+	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_INFO_DELTA:
+	case REQUEST_JOB_INFO_QUERY:
+	case REQUEST_JOB_INFO_SINGLE:
+	case REQUEST_JOB_STEP_INFO:
+	case REQUEST_JOB_USER_INFO:
+	case REQUEST_LAYOUT_INFO:
+	case REQUEST_LICENSE_INFO:
+	case REQUEST_NODE_INFO:
+	case REQUEST_NODE_INFO_DELTA:
+	case REQUEST_NODE_INFO_SINGLE:
+	case REQUEST_PARTITION_INFO:
+	case REQUEST_PRIORITY_FACTORS:
+	case REQUEST_RESERVATION_INFO:
+	case REQUEST_SHARE_INFO:
+	case REQUEST_STATS_INFO:
+	case REQUEST_TOPO_INFO:
+	case REQUEST_TRIGGER_GET:
+		lane = RPC_LANE_QUERY;
+		break;
+	default:
+		break;
+	}
+
+	return lane;
+}
+
+/* Take the next message to process, NULL once the pool is shut down and
+ * every lane is empty */
+static rpc_work_t *_dequeue(void)
+{
+	rpc_work_t *work = NULL;
+	int i;
+
+	slurm_mutex_lock(&pool_mutex);
+	while (1) {
+		for (i = 0; i < RPC_LANE_CNT; i++) {
+			if ((i == RPC_LANE_QUERY) &&
+			    (query_active >= query_max))
+				continue;
+			if ((work = list_dequeue(lanes[i])))
+				break;
+		}
+		if (work) {
+			if (work->lane == RPC_LANE_QUERY)
+				query_active++;
+			break;
+		}
+		if (pool_shutdown && !list_count(lanes[RPC_LANE_URGENT]) &&
+		    !list_count(lanes[RPC_LANE_NORMAL]) &&
+		    !list_count(lanes[RPC_LANE_QUERY]))
+			break;
+		slurm_cond_wait(&work_cond, &pool_mutex);
+	}
+	slurm_mutex_unlock(&pool_mutex);
+
+	return work;
+}
+
+static void _enqueue(int fd, slurm_addr_t *cli_addr, Buf buffer)
+{
+	rpc_work_t *work = xmalloc(sizeof(rpc_work_t));
+
+	work->fd = fd;
+	memcpy(&work->cli_addr, cli_addr, sizeof(slurm_addr_t));
+	work->buffer = buffer;
+	work->lane = _msg_lane(buffer);
+
+	server_thread_incr();
+	slurm_mutex_lock(&pool_mutex);
+	pending++;
+	list_enqueue(lanes[work->lane], work);
+	slurm_cond_signal(&work_cond);
+	slurm_mutex_unlock(&pool_mutex);
+}
+
+/* Unpack and process one message, then close its connection unless the
+ * RPC took it over */
+static void _process_work(rpc_work_t *work)
+{
+	connection_arg_t conn;
+	slurm_msg_t msg;
+
+	conn.newsockfd = work->fd;
+	memcpy(&conn.cli_addr, &work->cli_addr, sizeof(slurm_addr_t));
+
+	slurm_msg_t_init(&msg);
+	msg.flags |= SLURM_MSG_KEEP_BUFFER;
+	msg.conn_fd = work->fd;
+	/* slurm_free_msg_members() frees the buffer */
+	msg.buffer = work->buffer;
+	work->buffer = NULL;
+
+	if (slurm_unpack_received_msg(&msg, work->fd, msg.buffer) != 0) {
+		char addr_buf[32];
+		slurm_print_slurm_addr(&conn.cli_addr, addr_buf,
+				       sizeof(addr_buf));
+		error("slurm_receive_msg [%s]: %m", addr_buf);
+	} else {
+		/* process the request */
+		slurmctld_req(&msg, &conn);
+	}
+
+	if ((conn.newsockfd >= 0) && (close(conn.newsockfd) < 0))
+		error("close(%d): %m", conn.newsockfd);
+
+	slurm_free_msg_members(&msg);
+}
+
+static void *_rpc_worker(void *no_data)
+{
+	rpc_work_t *work;
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "rpcwrk", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "rpcwrk");
+	}
+#endif
+
+	while ((work = _dequeue())) {
+		_process_work(work);
+		server_thread_decr();
+
+		slurm_mutex_lock(&pool_mutex);
+		pending--;
+		if (work->lane == RPC_LANE_QUERY) {
+			query_active--;
+			/* A waiting worker may now take a query */
+			slurm_cond_signal(&work_cond);
+		}
+		slurm_cond_signal(&space_cond);
+		slurm_mutex_unlock(&pool_mutex);
+		xfree(work);
+	}
+
+	return NULL;
+}
+
+extern void rpc_pool_init(uint32_t workers_req, uint32_t max_pending)
+{
+	int i;
+
+	worker_cnt = MAX(workers_req, 1);
+	pending_max = MAX(max_pending, worker_cnt);
+	query_max = MAX(worker_cnt / 2, 1);
+	pool_shutdown = false;
+	for (i = 0; i < RPC_LANE_CNT; i++)
+		lanes[i] = list_create(NULL);
+
+	workers = xmalloc(sizeof(pthread_t) * worker_cnt);
+	for (i = 0; i < worker_cnt; i++)
+		slurm_thread_create(&workers[i], _rpc_worker, NULL);
+	debug("%s: %u RPC worker threads, up to %u pending RPCs",
+	      __func__, worker_cnt, pending_max);
+}
+
+extern void rpc_pool_fini(void)
+{
+	int i;
+
+	slurm_mutex_lock(&pool_mutex);
+	pool_shutdown = true;
+	slurm_cond_broadcast(&work_cond);
+	slurm_mutex_unlock(&pool_mutex);
+
+	for (i = 0; i < worker_cnt; i++)
+		pthread_join(workers[i], NULL);
+	xfree(workers);
+	worker_cnt = 0;
+
+	for (i = 0; i < RPC_LANE_CNT; i++)
+		FREE_NULL_LIST(lanes[i]);
+}
+
+static void _conn_link(rpc_conn_t *conn)
+{
+	conn->prev = NULL;
+	conn->next = conn_head;
+	if (conn_head)
+		conn_head->prev = conn;
+	conn_head = conn;
+}
+
+static void _conn_unlink(rpc_conn_t *conn)
+{
+	if (conn->prev)
+		conn->prev->next = conn->next;
+	else
+		conn_head = conn->next;
+	if (conn->next)
+		conn->next->prev = conn->prev;
+}
+
+/* Stop reading conn, close it unless keep_fd */
+static void _conn_free(int epfd, rpc_conn_t *conn, bool keep_fd)
+{
+	(void) epoll_ctl(epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+	_conn_unlink(conn);
+	if (!keep_fd)
+		close(conn->fd);
+	xfree(conn->buf);
+	xfree(conn);
+}
+
+static void _accept_conns(int epfd, int sockfd)
+{
+	struct epoll_event ev;
+	slurm_addr_t cli_addr;
+	rpc_conn_t *conn;
+	int newsockfd;
+
+	/* The listening socket is non-blocking, take all pending
+	 * connections */
+	while (1) {
+		newsockfd = slurm_accept_msg_conn(sockfd, &cli_addr);
+		if (newsockfd == SLURM_SOCKET_ERROR) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+			    (errno != EINTR))
+				error("slurm_accept_msg_conn: %m");
+			return;
+		}
+		fd_set_close_on_exec(newsockfd);
+		fd_set_nonblocking(newsockfd);
+
+		if (slurmctld_conf.debug_flags & DEBUG_FLAG_PROTOCOL) {
+			char inetbuf[64];
+
+			slurm_print_slurm_addr(&cli_addr, inetbuf,
+					       sizeof(inetbuf));
+			info("%s: accept() connection from %s",
+			     __func__, inetbuf);
+		}
+
+		conn = xmalloc(sizeof(rpc_conn_t));
+		conn->fd = newsockfd;
+		memcpy(&conn->cli_addr, &cli_addr, sizeof(slurm_addr_t));
+		conn->start = _mono_sec();
+
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = conn;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, newsockfd, &ev) < 0) {
+			error("%s: epoll_ctl: %m", __func__);
+			close(newsockfd);
+			xfree(conn);
+			continue;
+		}
+		_conn_link(conn);
+	}
+}
+
+/*
+ * Read what is available on conn
+ * RET 1 when the message is complete, 0 if more is expected, -1 on error
+ *	or when the peer closed the connection
+ */
+static int _read_conn(rpc_conn_t *conn)
+{
+	ssize_t len;
+
+	while (conn->len_got < sizeof(conn->msglen)) {
+		len = recv(conn->fd, ((char *) &conn->msglen) + conn->len_got,
+			   sizeof(conn->msglen) - conn->len_got, 0);
+		if (len > 0) {
+			conn->len_got += len;
+			continue;
+		}
+		if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+				  (errno == EINTR)))
+			return 0;
+		return -1;
+	}
+
+	if (!conn->buf) {
+		conn->msglen = ntohl(conn->msglen);
+		if (conn->msglen > MAX_MSG_SIZE) {
+			error("%s: message length %u exceeds limit",
+			      __func__, conn->msglen);
+			return -1;
+		}
+		conn->buf = xmalloc_nz(MAX(conn->msglen, 1));
+	}
+
+	while (conn->buf_got < conn->msglen) {
+		len = recv(conn->fd, conn->buf + conn->buf_got,
+			   conn->msglen - conn->buf_got, 0);
+		if (len > 0) {
+			conn->buf_got += len;
+			continue;
+		}
+		if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+				  (errno == EINTR)))
+			return 0;
+		return -1;
+	}
+
+	return 1;
+}
+
+/* Drop connections whose message did not arrive within MessageTimeout */
+static void _expire_conns(int epfd, time_t now)
+{
+	rpc_conn_t *conn, *next;
+	int timeout = slurm_get_msg_timeout();
+	char addr_buf[32];
+
+	for (conn = conn_head; conn; conn = next) {
+		next = conn->next;
+		if ((now - conn->start) <= timeout)
+			continue;
+		slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
+				       sizeof(addr_buf));
+		error("slurm_receive_msg [%s]: Socket timed out on "
+		      "send/recv operation", addr_buf);
+		_conn_free(epfd, conn, false);
+	}
+}
+
+/* Block the reader while the workers are saturated,
+ * RET false once shutdown has started */
+static bool _wait_for_space(void)
+{
+	static time_t last_print_time = 0;
+	struct timespec ts;
+	time_t now;
+	bool rc = true;
+
+	slurm_mutex_lock(&pool_mutex);
+	while (pending >= pending_max) {
+		if (slurmctld_config.shutdown_time) {
+			rc = false;
+			break;
+		}
+		/* just a delay and not an error, this can happen when the
+		 * epilog completes on a bunch of nodes at the same time */
+		now = _mono_sec();
+		if ((now - last_print_time) > 2) {
+			verbose("server_thread_count over limit (%u), waiting",
+				pending);
+			last_print_time = now;
+		}
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += 1;
+		slurm_cond_timedwait(&space_cond, &pool_mutex, &ts);
+	}
+	slurm_mutex_unlock(&pool_mutex);
+
+	return rc;
+}
+
+extern void rpc_pool_serve(int *sockfd, int nports)
+{
+	struct epoll_event ev, events[MAX_EVENTS];
+	rpc_conn_t *listen_conns, *conn;
+	time_t now, last_expire = _mono_sec();
+	int epfd, i, n, rc;
+
+	if ((epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		fatal("%s: epoll_create1: %m", __func__);
+
+	listen_conns = xmalloc(sizeof(rpc_conn_t) * nports);
+	for (i = 0; i < nports; i++) {
+		listen_conns[i].fd = sockfd[i];
+		listen_conns[i].listen = true;
+		fd_set_nonblocking(sockfd[i]);
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = &listen_conns[i];
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd[i], &ev) < 0)
+			fatal("%s: epoll_ctl: %m", __func__);
+	}
+
+	while (_wait_for_space()) {
+		/* SIGUSR1 from the signal handler thread interrupts the
+		 * wait at shutdown */
+		n = epoll_wait(epfd, events, MAX_EVENTS, 1000);
+		if (n < 0) {
+			if (errno != EINTR)
+				error("%s: epoll_wait: %m", __func__);
+			n = 0;
+		}
+		if (slurmctld_config.shutdown_time)
+			break;
+
+		for (i = 0; i < n; i++) {
+			conn = events[i].data.ptr;
+			if (conn->listen) {
+				_accept_conns(epfd, conn->fd);
+				continue;
+			}
+			rc = _read_conn(conn);
+			if (rc == 0)
+				continue;
+			if (rc > 0) {
+				_enqueue(conn->fd, &conn->cli_addr,
+					 create_buf(conn->buf, conn->msglen));
+				conn->buf = NULL;
+			}
+			_conn_free(epfd, conn, (rc > 0));
+		}
+
+		now = _mono_sec();
+		if (now != last_expire) {
+			_expire_conns(epfd, now);
+			last_expire = now;
+		}
+	}
+
+	while (conn_head)
+		_conn_free(epfd, conn_head, false);
+	for (i = 0; i < nports; i++)
+		(void) epoll_ctl(epfd, EPOLL_CTL_DEL, sockfd[i], NULL);
+	xfree(listen_conns);
+	close(epfd);
+}
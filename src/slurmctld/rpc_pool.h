@@ -0,0 +1,68 @@
+/*****************************************************************************\
+ *  rpc_pool.h - slurmctld RPC reader and worker pool (rpc_pool.c)
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_RPC_POOL_H
+#define _SLURMCTLD_RPC_POOL_H
+
+#include <inttypes.h>
+
+/* Default count of threads servicing incoming RPCs, see rpc_workers= in
+ * SchedulerParameters */
+#ifndef RPC_WORKER_THREADS
+#define RPC_WORKER_THREADS 64
+#endif
+
+/*
+ * rpc_pool_init - start the RPC worker threads
+ * IN workers - count of worker threads
+ * IN max_pending - maximum count of RPCs queued or being processed, the
+ *	reader stops accepting connections at this limit
+ */
+extern void rpc_pool_init(uint32_t workers, uint32_t max_pending);
+
+/*
+ * rpc_pool_serve - accept connections on the listening sockets, read their
+ *	message without blocking and queue each complete message to the
+ *	worker threads. Returns once slurmctld shutdown has started.
+ * IN sockfd - listening sockets
+ * IN nports - count of sockets in sockfd
+ */
+extern void rpc_pool_serve(int *sockfd, int nports);
+
+/*
+ * rpc_pool_fini - process the RPCs still queued then stop the worker threads
+ */
+extern void rpc_pool_fini(void);
+
+#endif /* !_SLURMCTLD_RPC_POOL_H */
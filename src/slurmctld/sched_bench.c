@@ -0,0 +1,224 @@
+/*****************************************************************************\
+ *  sched_bench.c - headless scheduler benchmark
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * The benchmark runs in a slurmctld started with -b. The controller
+ * recovers its state from StateSaveLocation and initializes its plugins as
+ * usual, but starts none of its threads: no RPC manager, no agent, no
+ * backfill or background thread. Each pass is then called directly in a
+ * loop. Passes do change the state (jobs are started and never end), so
+ * the first pass of each kind is reported apart from the steady state.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "src/common/list.h"
+#include "src/common/slurm_priority.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmctld/agent.h"
+#include "src/slurmctld/job_scheduler.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/sched_bench.h"
+#include "src/slurmctld/sched_plugin.h"
+#include "src/slurmctld/slurmctld.h"
+
+typedef struct {
+	char *name;
+	uint32_t (*run)(void);	/* run one pass, RET count of jobs tested */
+} bench_pass_t;
+
+static char *lock_names[ENTITY_COUNT] = {
+	"config", "job", "node", "partition", "federation"
+};
+
+static uint32_t _run_schedule(void);
+static uint32_t _run_sched_plugin(void);
+static uint32_t _run_decay(void);
+
+static bench_pass_t bench_passes[] = {
+	{ "schedule", _run_schedule },
+	{ "sched_plugin", _run_sched_plugin },
+	{ "priority_decay", _run_decay },
+	{ NULL, NULL }
+};
+
+/* time() and gettimeofday() may be simulated, use the real clock */
+static uint64_t _now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static uint32_t _run_schedule(void)
+{
+	uint32_t depth = slurmctld_diag_stats.schedule_cycle_depth;
+
+	(void) schedule_pass(0);
+	return slurmctld_diag_stats.schedule_cycle_depth - depth;
+}
+
+static uint32_t _run_sched_plugin(void)
+{
+	slurmctld_diag_stats.bf_last_depth = 0;
+	(void) slurm_sched_g_run_pass();
+	return slurmctld_diag_stats.bf_last_depth;
+}
+
+static uint32_t _run_decay(void)
+{
+	(void) priority_g_decay_pass();
+	return list_count(job_list);
+}
+
+static int _cmp_usec(const void *a, const void *b)
+{
+	uint64_t x = *(uint64_t *) a, y = *(uint64_t *) b;
+
+	if (x < y)
+		return -1;
+	return (x > y);
+}
+
+/* Nearest rank percentile of sorted usec[cnt] */
+static uint64_t _percentile(uint64_t *usec, int cnt, int pct)
+{
+	return usec[((cnt - 1) * pct) / 100];
+}
+
+static void _print_lock_stats(slurmctld_lock_stats_t *lock_stats)
+{
+	lock_stats_t *stats;
+	int i;
+
+	printf("  %-10s %9s %12s %12s %9s %12s %12s %12s\n", "lock",
+	       "rd_cnt", "rd_hold_avg", "rd_hold_max", "wr_cnt", "wr_hold_avg",
+	       "wr_hold_max", "wait_total");
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		stats = &lock_stats->entity[i];
+		if (!stats->rd_cnt && !stats->wr_cnt)
+			continue;
+		printf("  %-10s %9"PRIu64" %12.1f %12"PRIu64" %9"PRIu64
+		       " %12.1f %12"PRIu64" %12"PRIu64"\n", lock_names[i],
+		       stats->rd_cnt, stats->rd_cnt ?
+		       (double) stats->rd_hold_usec / stats->rd_cnt : 0.0,
+		       stats->rd_hold_max, stats->wr_cnt, stats->wr_cnt ?
+		       (double) stats->wr_hold_usec / stats->wr_cnt : 0.0,
+		       stats->wr_hold_max,
+		       stats->rd_wait_usec + stats->wr_wait_usec);
+	}
+}
+
+static void _bench_pass(bench_pass_t *pass, int iterations)
+{
+	slurmctld_lock_stats_t lock_stats;
+	uint64_t *usec, start, first_usec, total_usec = 0, tested = 0;
+	uint32_t first_tested;
+	int i;
+
+	start = _now_usec();
+	first_tested = pass->run();
+	first_usec = _now_usec() - start;
+	agent_purge();
+
+	usec = xmalloc(sizeof(uint64_t) * iterations);
+	reset_lock_stats();
+	for (i = 0; i < iterations; i++) {
+		start = _now_usec();
+		tested += pass->run();
+		usec[i] = _now_usec() - start;
+		total_usec += usec[i];
+		agent_purge();
+	}
+	get_lock_stats(&lock_stats);
+	qsort(usec, iterations, sizeof(uint64_t), _cmp_usec);
+
+	printf("%s:\n", pass->name);
+	printf("  first pass    %.3f ms, %u jobs tested\n",
+	       first_usec / 1000.0, first_tested);
+	printf("  latency (ms)  min %.3f  p50 %.3f  p90 %.3f  p99 %.3f  "
+	       "max %.3f  mean %.3f\n",
+	       usec[0] / 1000.0, _percentile(usec, iterations, 50) / 1000.0,
+	       _percentile(usec, iterations, 90) / 1000.0,
+	       _percentile(usec, iterations, 99) / 1000.0,
+	       usec[iterations - 1] / 1000.0,
+	       (total_usec / 1000.0) / iterations);
+	printf("  jobs tested   %.1f per pass, %.1f per second\n",
+	       (double) tested / iterations,
+	       total_usec ? (tested * 1000000.0) / total_usec : 0.0);
+	_print_lock_stats(&lock_stats);
+	printf("\n");
+
+	xfree(usec);
+}
+
+static int _pending_job(void *x, void *arg)
+{
+	struct job_record *job_ptr = (struct job_record *) x;
+
+	if (IS_JOB_PENDING(job_ptr))
+		(*(int *) arg)++;
+	return 0;
+}
+
+extern int sched_bench_run(int iterations)
+{
+	/* Read job, node and partition */
+	slurmctld_lock_t read_lock = {
+		NO_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
+	bench_pass_t *pass;
+	int pending = 0;
+
+	if (iterations < 1) {
+		error("%s: invalid iteration count %d", __func__, iterations);
+		return SLURM_ERROR;
+	}
+
+	lock_slurmctld(read_lock);
+	list_for_each(job_list, _pending_job, &pending);
+	printf("Scheduler benchmark: %d jobs (%d pending), %d nodes, "
+	       "%d partitions, %d iterations\n", list_count(job_list),
+	       pending, node_record_count, list_count(part_list), iterations);
+	unlock_slurmctld(read_lock);
+	printf("SchedulerType=%s PriorityType=%s\n\n",
+	       slurmctld_conf.schedtype, slurmctld_conf.priority_type);
+
+	for (pass = bench_passes; pass->name; pass++)
+		_bench_pass(pass, iterations);
+
+	return SLURM_SUCCESS;
+}
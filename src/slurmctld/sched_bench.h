@@ -0,0 +1,50 @@
+/*****************************************************************************\
+ *  sched_bench.h - headless scheduler benchmark (sched_bench.c)
+ *****************************************************************************
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_SCHED_BENCH_H
+#define _SLURMCTLD_SCHED_BENCH_H
+
+/*
+ * sched_bench_run - time the main scheduler, the scheduler plugin pass
+ *	(backfill) and the priority decay pass against the state loaded by
+ *	slurmctld -b, and print the results to stdout.
+ * IN iterations - number of timed passes of each kind, run after one
+ *	first pass, reported on its own, which starts whatever can start now
+ * RET SLURM_SUCCESS or an error code
+ * NOTE: Call with no locks held and without the agent or RPC threads
+ *	running, RPCs queued by the passes are discarded.
+ */
+extern int sched_bench_run(int iterations);
+
+#endif /* !_SLURMCTLD_SCHED_BENCH_H */
@@ -53,6 +53,7 @@ typedef struct slurm_sched_ops {
 	uint32_t	(*initial_priority)	( uint32_t,
 						  struct job_record * );
 	int		(*reconfig)		( void );
+	int		(*run_pass)		( void );
 } slurm_sched_ops_t;
 
 /*
@@ -61,6 +62,7 @@ typedef struct slurm_sched_ops {
 static const char *syms[] = {
 	"slurm_sched_p_initial_priority",
 	"slurm_sched_p_reconfig",
+	"slurm_sched_p_run_pass",
 };
 
 static slurm_sched_ops_t ops;
@@ -139,3 +141,11 @@ uint32_t slurm_sched_g_initial_priority(uint32_t last_prio,
 
 	return (*(ops.initial_priority))( last_prio, job_ptr );
 }
+
+extern int slurm_sched_g_run_pass(void)
+{
+	if ( slurm_sched_init() < 0 )
+		return SLURM_ERROR;
+
+	return (*(ops.run_pass))();
+}
@@ -73,4 +73,11 @@ int slurm_sched_g_reconfig(void);
 uint32_t slurm_sched_g_initial_priority(uint32_t max_prio,
 					struct job_record *job_ptr);
 
+/*
+ * Run one pass of the plugin's scheduling agent (e.g. backfill) in the
+ * calling thread. Used by the scheduler benchmark (slurmctld -b), which
+ * loads the plugin with scheduling disabled so its agent is not started.
+ */
+extern int slurm_sched_g_run_pass(void);
+
 #endif /*__SLURM_CONTROLLER_SCHED_PLUGIN_API_H__*/
@@ -71,7 +71,7 @@
 /*****************************************************************************\
  *  GENERAL CONFIGURATION parameters and data structures
 \*****************************************************************************/
-/* Maximum parallel threads to service incoming RPCs.
+/* Maximum incoming RPCs queued or being serviced (see rpc_pool.c).
  * Also maximum parallel threads to service outgoing RPCs (separate counter).
  * Since some systems schedule pthread on a First-In-Last-Out basis,
  * increasing this value is strongly discouraged. */
@@ -410,6 +410,8 @@ typedef struct slurmctld_resv {
 	bool flags_set_node;	/* flags (i.e. NODE_STATE_MAINT |
 				 * NODE_STATE_RES) set for nodes	*/
 	char *name;		/* name of reservation			*/
+	struct slurmctld_resv *name_next; /* next entry with this name's
+				 * hash, see _find_resv_by_name()	*/
 	bitstr_t *node_bitmap;	/* bitmap of reserved nodes		*/
 	uint32_t node_cnt;	/* count of nodes required		*/
 	char *node_list;	/* list of reserved nodes or ALL	*/
@@ -639,6 +641,7 @@ struct job_record {
 	uint64_t db_index;              /* used only for database plugins */
 	time_t deadline;		/* deadline */
 	uint32_t delay_boot;		/* Delay boot for desired node mode */
+	uint64_t delta_gen;		/* change stamp, see job_set_changed() */
 	uint32_t derived_ec;		/* highest exit code of all job steps */
 	struct job_details *details;	/* job details */
 	uint16_t direct_set_prio;	/* Priority set directly if
@@ -941,7 +944,8 @@ enum select_plugindata_info {
  *	without saved state and slurmd daemons register with a
  *	multitude of running jobs. Slurmctld will not recognize
  *	these jobs and use this function to kill them - one
- *	agent request per node as they register.
+ *	agent request per node as they register, or per job while
+ *	registrations are validated in a batch, see job_kill_batch_begin().
  * IN job_id - id of the job to be killed
  * IN job_ptr - pointer to terminating job (NULL if unknown, e.g. orphaned)
  * IN node_name - name of the node on which the job resides
@@ -1568,6 +1572,14 @@ extern int job_requeue(uid_t uid, uint32_t job_id, slurm_msg_t *msg,
 extern int job_requeue2(uid_t uid, requeue_msg_t *req_ptr, slurm_msg_t *msg,
 			bool preempt);
 
+/*
+ * job_set_changed - note that a job record was modified, call wherever
+ *	last_job_update is set for that job
+ * IN job_ptr - the modified job
+ * NOTE: job write lock must be locked before calling this
+ */
+extern void job_set_changed(struct job_record *job_ptr);
+
 /*
  * job_set_top - Move the specified job to the top of the queue (at least
  *	for that user ID, partition, account, and QOS).
@@ -1668,6 +1680,21 @@ extern int kill_job_step(job_step_kill_msg_t *job_step_kill_msg, uint32_t uid);
  */
 extern int kill_job_by_part_name(char *part_name);
 
+/*
+ * job_kill_batch_begin - Defer the requests built by abort_job_on_node()
+ *	and kill_job_on_node() until job_kill_batch_end(), merging those
+ *	for the same job into one multi-node agent request. Used while
+ *	validating a batch of node registrations.
+ * NOTE: Caller must hold the job write lock until job_kill_batch_end()
+ */
+extern void job_kill_batch_begin(void);
+
+/*
+ * job_kill_batch_end - Queue the kill requests deferred since
+ *	job_kill_batch_begin()
+ */
+extern void job_kill_batch_end(void);
+
 /*
  * kill_job_on_node - Kill the specific job_id on a specific node.
  *	agent request per node as they register.
@@ -1741,6 +1768,13 @@ extern int list_find_job_id(void *job_entry, void *key);
  */
 extern int load_all_job_state ( void );
 
+/*
+ * prefetch_job_state - map the job state save file ahead of
+ *	load_all_job_state() so that it is read in while the node and
+ *	partition tables are built. Startup only.
+ */
+extern void prefetch_job_state(void);
+
 /*
  * load_all_node_state - Load the node state from file, recover on slurmctld
  *	restart. Execute this after loading the configuration file data.
@@ -1855,6 +1889,39 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 			  uint16_t protocol_version);
 
+/*
+ * pack_jobs_delta - dump job information for jobs changed since a
+ *	generation in machine independent form (for network transmission)
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN generation - generation from the client's previous response, 0 if none
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ */
+extern void pack_jobs_delta(char **buffer_ptr, int *buffer_size,
+			    uint64_t generation, uint16_t show_flags,
+			    uid_t uid, uint32_t filter_uid,
+			    uint16_t protocol_version);
+
+/*
+ * pack_jobs_query - dump job information for the jobs matching a query in
+ *	machine independent form (for network transmission)
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN query - jobs and field groups to pack
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ */
+extern void pack_jobs_query(char **buffer_ptr, int *buffer_size,
+			    job_info_query_t *query, uid_t uid,
+			    uint16_t protocol_version);
+
 /*
  * pack_spec_jobs - dump job information for specified jobs in
  *	machine independent form (for network transmission)
@@ -1890,6 +1957,23 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid,
 			   uint16_t protocol_version);
 
+/*
+ * pack_nodes_delta - dump node information for nodes changed since a
+ *	generation in machine independent form (for network transmission)
+ * OUT buffer_ptr - pointer to the stored data
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN generation - generation from the client's previous response, 0 if none
+ * IN show_flags - node filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: node_record_table_ptr - pointer to global node table
+ * NOTE: the caller must xfree the buffer at *buffer_ptr
+ * NOTE: READ lock_slurmctld config before entry
+ */
+extern void pack_nodes_delta(char **buffer_ptr, int *buffer_size,
+			     uint64_t generation, uint16_t show_flags,
+			     uid_t uid, uint16_t protocol_version);
+
 /* Pack all scheduling statistics */
 extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			  uint16_t protocol_version);
@@ -1939,6 +2023,20 @@ extern void pack_all_part(char **buffer_ptr, int *buffer_size,
 extern void pack_job (struct job_record *dump_job_ptr, uint16_t show_flags,
 		      Buf buffer, uint16_t protocol_version, uid_t uid);
 
+/*
+ * pack_job_fields - dump some configuration information about a specific
+ *	job in machine independent form (for network transmission)
+ * IN dump_job_ptr - pointer to job for which information is requested
+ * IN show_flags - job filtering options
+ * IN fields - JOB_FIELD_* groups to pack, others are packed as NULL
+ * IN/OUT buffer - buffer in which data is placed, pointers automatically
+ *	updated
+ * IN uid - user requesting the data
+ */
+extern void pack_job_fields(struct job_record *dump_job_ptr,
+			    uint16_t show_flags, uint32_t fields, Buf buffer,
+			    uint16_t protocol_version, uid_t uid);
+
 /*
  * pack_part - dump all configuration information about a specific partition
  *	in machine independent form (for network transmission)
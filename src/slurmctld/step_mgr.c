@@ -74,6 +74,8 @@
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/srun_comm.h"
 
+static struct step_record * _alloc_step_record(struct job_record *job_ptr,
+					       uint16_t protocol_version);
 static void _build_pending_step(struct job_record  *job_ptr,
 				job_step_create_request_msg_t *step_specs);
 static int  _count_cpus(struct job_record *job_ptr, bitstr_t *bitmap,
@@ -154,14 +156,17 @@ static int _opt_node_cnt(uint32_t step_min_nodes, uint32_t step_max_nodes,
 }
 
 /*
- * _create_step_record - create an empty step_record for the specified job.
+ * _alloc_step_record - add an empty step_record to the specified job without
+ *	stamping the job as changed, see _create_step_record().
  * IN job_ptr - pointer to job table entry to have step record added
  * IN protocol_version - slurm protocol version of client
  * RET a pointer to the record or NULL if error
  * NOTE: allocates memory that should be xfreed with delete_step_record
+ * NOTE: Touches only job_ptr, load_step_state() calls this for job records
+ *	which are not yet in job_list, possibly from several threads
  */
-static struct step_record * _create_step_record(struct job_record *job_ptr,
-						uint16_t protocol_version)
+static struct step_record * _alloc_step_record(struct job_record *job_ptr,
+					       uint16_t protocol_version)
 {
 	struct step_record *step_ptr;
 
@@ -177,7 +182,6 @@ static struct step_record * _create_step_record(struct job_record *job_ptr,
 
 	step_ptr = (struct step_record *) xmalloc(sizeof(struct step_record));
 
-	last_job_update = time(NULL);
 	step_ptr->job_ptr    = job_ptr;
 	step_ptr->exit_code  = NO_VAL;
 	step_ptr->time_limit = INFINITE;
@@ -193,6 +197,27 @@ static struct step_record * _create_step_record(struct job_record *job_ptr,
 	return step_ptr;
 }
 
+/*
+ * _create_step_record - create an empty step_record for the specified job.
+ * IN job_ptr - pointer to job table entry to have step record added
+ * IN protocol_version - slurm protocol version of client
+ * RET a pointer to the record or NULL if error
+ * NOTE: allocates memory that should be xfreed with delete_step_record
+ */
+static struct step_record * _create_step_record(struct job_record *job_ptr,
+						uint16_t protocol_version)
+{
+	struct step_record *step_ptr;
+
+	step_ptr = _alloc_step_record(job_ptr, protocol_version);
+	if (step_ptr) {
+		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
+	}
+
+	return step_ptr;
+}
+
 /* Purge any duplicate job steps for this PID */
 static int _purge_duplicate_steps(struct job_record *job_ptr,
 				  job_step_create_request_msg_t *step_specs)
@@ -322,6 +347,7 @@ extern void delete_step_records (struct job_record *job_ptr)
 	xassert(job_ptr);
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 	step_iterator = list_iterator_create(job_ptr->step_list);
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		/* Only check if not a pending step */
@@ -426,6 +452,7 @@ delete_step_record (struct job_record *job_ptr, uint32_t step_id)
 		return error_code;
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 	step_iterator = list_iterator_create (job_ptr->step_list);
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		if (step_ptr->step_id != step_id)
@@ -853,6 +880,7 @@ int job_step_complete(uint32_t job_id, uint32_t step_id, uid_t uid,
 	_internal_step_complete(job_ptr, step_ptr);
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -3302,6 +3330,7 @@ extern int job_step_checkpoint(checkpoint_msg_t *ckpt_ptr,
 				   &resp_data.error_code,
 				   &resp_data.error_msg);
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	}
 
     reply:
@@ -3368,6 +3397,7 @@ extern int job_step_checkpoint_comp(checkpoint_comp_msg_t *ckpt_ptr,
 		rc = checkpoint_comp((void *)step_ptr, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	}
 
     reply:
@@ -3427,6 +3457,7 @@ extern int job_step_checkpoint_task_comp(checkpoint_task_comp_msg_t *ckpt_ptr,
 			ckpt_ptr->task_id, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
 	}
 
     reply:
@@ -4066,9 +4097,10 @@ extern int load_step_state(struct job_record *job_ptr, Buf buffer,
 		goto unpack_error;
 	}
 
+	/* The job is stamped as changed when it is added to job_list */
 	step_ptr = find_step_record(job_ptr, step_id);
 	if (step_ptr == NULL)
-		step_ptr = _create_step_record(job_ptr, start_protocol_ver);
+		step_ptr = _alloc_step_record(job_ptr, start_protocol_ver);
 	if (step_ptr == NULL)
 		goto unpack_error;
 
@@ -4251,6 +4283,7 @@ extern void step_checkpoint(void)
 					      -1, NO_VAL16);
 			job_ptr->ckpt_time = now;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			continue; /* ignore periodic step ckpt */
 		}
 		step_iterator = list_iterator_create (job_ptr->step_list);
@@ -4277,6 +4310,7 @@ extern void step_checkpoint(void)
 
 			step_ptr->ckpt_time = now;
 			last_job_update = now;
+			job_set_changed(job_ptr);
 			image_dir = xstrdup(step_ptr->ckpt_dir);
 			xstrfmtcat(image_dir, "/%u.%u", job_ptr->job_id,
 				   step_ptr->step_id);
@@ -4544,8 +4578,10 @@ extern int update_step(step_update_request_msg_t *req, uid_t uid)
 			     req->job_id, req->step_id, req->time_limit);
 		}
 	}
-	if (mod_cnt)
+	if (mod_cnt) {
 		last_job_update = time(NULL);
+		job_set_changed(job_ptr);
+	}
 	if (new_step) {
 		/*
 		 * This was a temporary step record, never linked to the job,
@@ -4655,6 +4691,7 @@ extern int post_job_step(struct step_record *step_ptr)
 				 step_ptr->step_id);
 
 	last_job_update = time(NULL);
+	job_set_changed(job_ptr);
 	/* Don't need to set state. Will be destroyed in next steps. */
 	/* step_ptr->state = JOB_COMPLETE; */
 
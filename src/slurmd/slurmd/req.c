@@ -435,6 +435,11 @@ slurmd_req(slurm_msg_t *msg)
 		rc = _rpc_file_bcast(msg);
 		slurm_send_rc_msg(msg, rc);
 		break;
+	case REQUEST_FILE_BCAST_PWRITE:
+		/* Blocks are written at their block_offset, so sbcast
+		 * may send them out of order */
+		slurm_send_rc_msg(msg, SLURM_SUCCESS);
+		break;
 	case REQUEST_STEP_COMPLETE:
 		(void) _rpc_step_complete(msg);
 		break;
@@ -3491,11 +3496,6 @@ static void
 simulator_rpc_terminate_job(slurm_msg_t *rec_msg)
 {
 
-        slurm_msg_t            msg;
-        epilog_complete_msg_t  req;
-        hostlist_t hl;
-        char *node_name;
-        int             rc     = SLURM_SUCCESS;
         kill_job_msg_t *req_kill    = rec_msg->data;
         volatile simulator_event_t *temp, *event_sim, *prev;
 
@@ -3541,27 +3541,10 @@ simulator_rpc_terminate_job(slurm_msg_t *rec_msg)
 
         pthread_mutex_unlock(&simulator_mutex);
 
-        hl = hostlist_create(event_sim->nodelist);
-
-        /* With FRONTEND just one epilog complete message is needed */
-        node_name = hostlist_shift(hl);
-
-        info("SIM: Sending epilog complete message for job %d node %s", req_kill->job_id, node_name);
-        slurm_msg_t_init(&msg);
-
-        req.job_id      = req_kill->job_id;
-        req.return_code = rc;
-        req.node_name   = node_name;
-
-        msg.msg_type    = MESSAGE_EPILOG_COMPLETE;
-        msg.data        = &req;
-
-        /* Let wait for an answer for simulation syncronization */
-        slurm_send_recv_controller_rc_msg(&msg, &rc, working_cluster_rec);
-        pthread_mutex_lock(&epilogs_mutex);
-		waiting_epilog_msgs--;
-		pthread_mutex_unlock(&epilogs_mutex);
-        hostlist_destroy(hl);
+        /*
+         * slurmctld already noted the epilog of this job when it completed
+         * it from MESSAGE_SIM_HELPER_CYCLE, there is nothing to send back.
+         */
         free((void*)event_sim);
 }
 
@@ -4405,10 +4388,15 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 		return SLURM_FAILURE;
 	}
 
+	/*
+	 * Blocks between the first and the last one may arrive in any order
+	 * (sbcast keeps several in flight), write each at its own offset.
+	 */
 	offset = 0;
 	while (req->block_len - offset) {
-		inx = write(file_info->fd, &req->block[offset],
-			    (req->block_len - offset));
+		inx = pwrite(file_info->fd, &req->block[offset],
+			     (req->block_len - offset),
+			     req->block_offset + offset);
 		if (inx == -1) {
 			if ((errno == EINTR) || (errno == EAGAIN))
 				continue;
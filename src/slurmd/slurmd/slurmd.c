@@ -126,6 +126,7 @@
 #include "sim_events.h"
 #include "src/common/slurm_sim.h"
 #include "src/common/sim_funcs.h"
+#include "src/common/sim_profile.h"
 #endif
 
 #define GETOPT_ARGS	"bcCd:Df:hL:Mn:N:vV"
@@ -141,7 +142,6 @@
 
 /* global, copied to STDERR_FILENO in tasks before the exec */
 int devnull = -1;
-int waiting_epilog_msgs = 0;
 slurmd_conf_t * conf = NULL;
 int fini_job_cnt = 0;
 uint32_t *fini_job_id = NULL;
@@ -165,7 +165,6 @@ typedef struct connection {
 volatile simulator_event_t *head_simulator_event;
 volatile simulator_event_t *head_sim_completed_jobs;
 int    total_sim_events = 0;
-pthread_mutex_t epilogs_mutex = PTHREAD_MUTEX_INITIALIZER;
 sem_t *sim_sem         = SEM_FAILED;
 sem_t *slurm_sem       = SEM_FAILED;
 /*** ANA: Replacing signals for slurmd registration ****/
@@ -290,7 +289,7 @@ main (int argc, char **argv)
 	int i, pidfd;
 	int blocked_signals[] = {SIGPIPE, 0};
 	int cc;
-	char *oom_value;
+	char *oom_value, *log_async;
 	uint32_t slurmd_uid = 0;
 	uint32_t curr_uid = 0;
 	char time_stamp[256];
@@ -385,6 +384,13 @@ main (int argc, char **argv)
 		set_oom_adj(i);
 	}
 
+	/* Size in KB of the ring for writing the logfile asynchronously */
+	if ((log_async = getenv("SLURMD_LOG_ASYNC"))) {
+		i = atoi(log_async);
+		debug("Setting slurmd asynchronous logging to %d KB", i);
+		log_set_async(MAX(i, 0) * 1024);
+	}
+
 	_kill_old_slurmd();
 
 	if (conf->mlock_pages) {
@@ -556,59 +562,21 @@ int notify_sim_mgr()
 	return 0;
 }
 
+/*
+ * Report the end of a simulated cycle to slurmctld. The jobs that ended in
+ * the cycle travel in the same message, slurmctld completes them and notes
+ * their epilogs before replying, so one exchange covers the whole cycle.
+ */
 static int
-_send_complete_batch_script_msg(uint32_t jobid, int err, int status)
-{
-       int             rc, i;
-       slurm_msg_t     req_msg;
-       complete_batch_script_msg_t req;
-
-       req.job_id      = jobid;
-       req.job_rc      = status;
-       req.slurm_rc    = err;
-
-       slurm_msg_t_init(&req_msg);
-       req.node_name   = NULL;
-       req_msg.msg_type= REQUEST_COMPLETE_BATCH_SCRIPT;
-       req_msg.data    = &req;
-
-       info("SIM: sending REQUEST_COMPLETE_BATCH_SCRIPT");
-
-       /* Note: these log messages don't go to slurmd.log from here */
-       for (i=0; i<=5; i++) {
-               	struct timespec waiting;
-
-               	if (slurm_send_recv_controller_rc_msg(&req_msg, &rc, working_cluster_rec) == 0)
-                       break;
-               info("SIM: Retrying job complete RPC for %u",
-                    jobid);
-               waiting.tv_sec = 0;
-               waiting.tv_nsec = 10000000;
-               //usleep(10000);
-               nanosleep(&waiting, 0);
-       }
-       if (i > 5) {
-               sleep(10);
-               error("SIM: Unable to send job complete message: %m");
-               return SLURM_ERROR;
-       }
-
-       if ((rc == ESLURM_ALREADY_DONE) || (rc == ESLURM_INVALID_JOB_ID))
-               rc = SLURM_SUCCESS;
-       if (rc)
-               slurm_seterrno_ret(rc);
-
-       return SLURM_SUCCESS;
-}
-
-static int
-_send_sim_helper_cycle_msg(uint32_t jobs_count)
+_send_sim_helper_cycle_msg(uint32_t *job_ids, uint32_t jobs_count)
 {
        int             rc, i;
        slurm_msg_t     req_msg;
        sim_helper_msg_t req;
 
        req.total_jobs_ended = jobs_count;
+       req.job_cnt          = jobs_count;
+       req.job_ids          = job_ids;
 
        slurm_msg_t_init(&req_msg);
        req_msg.msg_type= MESSAGE_SIM_HELPER_CYCLE;
@@ -646,7 +614,9 @@ void *
 _simulator_helper(void *arg)
 {
 	time_t now, last;
-	int jobs_ended;
+	uint32_t jobs_ended, job_id_size = 0;
+	uint32_t *job_ids = NULL;
+	uint64_t prof_start;
 
 	_increment_thd_count();
 
@@ -655,6 +625,7 @@ _simulator_helper(void *arg)
 	info("SIM: Simulator Helper starting...\n");
 	while (!_shutdown) {
 		sem_wait(slurm_sem);
+		(void) sim_prof_attach();
 		jobs_ended = 0;
 		now = time(NULL);
 		info("now: %ld last: %ld diff: %ld", now, last, now - last);
@@ -666,48 +637,27 @@ _simulator_helper(void *arg)
 		
 		while((head_simulator_event) && (now >= head_simulator_event->when)){
 			volatile simulator_event_t *aux;
-			int event_jid;
-			event_jid = head_simulator_event->job_id;
 			aux = head_simulator_event;
 			head_simulator_event = head_simulator_event->next;
 			aux->next = head_sim_completed_jobs;
 			head_sim_completed_jobs = aux;
 			total_sim_events--;
-			info("SIM: Sending JOB_COMPLETE_BATCH_SCRIPT for job %d", event_jid);
-			pthread_mutex_unlock(&simulator_mutex);
-			if(_send_complete_batch_script_msg(event_jid, SLURM_SUCCESS, 0) == SLURM_SUCCESS) { 
-				pthread_mutex_lock(&simulator_mutex);
-				pthread_mutex_lock(&epilogs_mutex);        	
-				waiting_epilog_msgs++;
-				pthread_mutex_unlock(&epilogs_mutex);
-				info("SIM: JOB_COMPLETE_BATCH_SCRIPT for job %d SENT", event_jid);
-				jobs_ended++;
-			} else {
-				error("SIM: JOB_COMPLETE_BATCH_SCRIPT for job %d NOT SENT", event_jid);
-				pthread_exit(0);
-				_decrement_thd_count();
-				return NULL;
-			} 
+			if (jobs_ended >= job_id_size) {
+				job_id_size = MAX(job_id_size * 2, 64);
+				xrealloc(job_ids, sizeof(uint32_t) * job_id_size);
+			}
+			job_ids[jobs_ended++] = aux->job_id;
+			info("SIM: job %d ended", aux->job_id);
     	}
 		pthread_mutex_unlock(&simulator_mutex);
 		last = now;
-		if(jobs_ended){
-            while (1) {
-				pthread_mutex_lock(&epilogs_mutex);
-				if (waiting_epilog_msgs == 0) {
-					pthread_mutex_unlock(&epilogs_mutex);
-					break;
-				}
-				pthread_mutex_unlock(&epilogs_mutex);
-				debug3("Waiting epilog to finish");
-				usleep(100);
-			}
-			_send_sim_helper_cycle_msg(jobs_ended);
-        } else {
-        	_send_sim_helper_cycle_msg(0);
-		}
+		sim_prof_count(SIM_PROF_JOBS_ENDED, jobs_ended);
+		prof_start = sim_prof_begin();
+		_send_sim_helper_cycle_msg(job_ids, jobs_ended);
+		sim_prof_end(SIM_PROF_HELPER_RPC, prof_start);
 		sem_post(sim_sem);
         }
+        xfree(job_ids);
         info("SIM: Simulator Helper finishing...");
 
         _decrement_thd_count();
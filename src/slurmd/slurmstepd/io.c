@@ -56,6 +56,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "src/common/cbuf.h"
@@ -426,14 +427,19 @@ _client_read(eio_obj_t *obj, List objs)
 }
 
 /*
- * Write outgoing packed messages to the client socket.
+ * Write outgoing packed messages to the client socket. Messages already
+ * queued behind the current one go out in the same writev(), each is
+ * at most MAX_MSG_LEN bytes so heavy output otherwise costs a system
+ * call per message.
  */
 static int
 _client_write(eio_obj_t *obj, List objs)
 {
 	struct client_io_info *client = (struct client_io_info *) obj->arg;
-	void *buf;
-	int n;
+	struct iovec iov[STDIO_MAX_WRITEV];
+	struct io_buf *msg;
+	ListIterator itr;
+	int cnt, i, n;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -456,13 +462,23 @@ _client_write(eio_obj_t *obj, List objs)
 
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
+	iov[0].iov_base = client->out_msg->data +
+		(client->out_msg->length - client->out_remaining);
+	iov[0].iov_len = client->out_remaining;
+	cnt = 1;
+	itr = list_iterator_create(client->msg_queue);
+	while ((cnt < STDIO_MAX_WRITEV) && (msg = list_next(itr))) {
+		iov[cnt].iov_base = msg->data;
+		iov[cnt].iov_len = msg->length;
+		cnt++;
+	}
+	list_iterator_destroy(itr);
+
 	/*
-	 * Write message to socket.
+	 * Write messages to socket.
 	 */
-	buf = client->out_msg->data +
-		(client->out_msg->length - client->out_remaining);
 again:
-	if ((n = write(obj->fd, buf, client->out_remaining)) < 0) {
+	if ((n = writev(obj->fd, iov, cnt)) < 0) {
 		if (errno == EINTR) {
 			goto again;
 		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
@@ -474,17 +490,22 @@ again:
 			return SLURM_SUCCESS;
 		}
 	}
-	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket",
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
-		return SLURM_SUCCESS;
+	debug5("Wrote %d bytes in %d messages to socket", n, cnt);
 
-	_free_outgoing_msg(client->out_msg, client->job);
-	client->out_msg = NULL;
+	/* Release the messages which were sent completely */
+	for (i = 0; i < cnt; i++) {
+		if (n < client->out_remaining) {
+			client->out_remaining -= n;
+			break;
+		}
+		n -= client->out_remaining;
+		_free_outgoing_msg(client->out_msg, client->job);
+		client->out_msg = NULL;
+		if ((i + 1) < cnt) {
+			client->out_msg = list_dequeue(client->msg_queue);
+			client->out_remaining = client->out_msg->length;
+		}
+	}
 
 	return SLURM_SUCCESS;
 }
@@ -1860,18 +1881,16 @@ alloc_io_buf(void)
 {
 	struct io_buf *buf;
 
-	buf = (struct io_buf *)xmalloc(sizeof(struct io_buf));
-	if (!buf)
-		return NULL;
+	/*
+	 * One allocation holds the descriptor and its data. The following
+	 * "+ 1" is just temporary so I can stick a \0 at the end and do a
+	 * printf of the data pointer
+	 */
+	buf = xmalloc(sizeof(struct io_buf) +
+		      MAX_MSG_LEN + io_hdr_packed_size() + 1);
 	buf->ref_count = 0;
 	buf->length = 0;
-	/* The following "+ 1" is just temporary so I can stick a \0 at
-	   the end and do a printf of the data pointer */
-	buf->data = xmalloc(MAX_MSG_LEN + io_hdr_packed_size() + 1);
-	if (!buf->data) {
-		xfree(buf);
-		return NULL;
-	}
+	buf->data = buf + 1;
 
 	return buf;
 }
@@ -1879,11 +1898,7 @@ alloc_io_buf(void)
 void
 free_io_buf(struct io_buf *buf)
 {
-	if (buf) {
-		if (buf->data)
-			xfree(buf->data);
-		xfree(buf);
-	}
+	xfree(buf);
 }
 
 /* This just determines if there's space to hold more of the stdin stream */
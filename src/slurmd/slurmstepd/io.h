@@ -50,6 +50,9 @@
 #define STDIO_MAX_FREE_BUF 1024
 #define STDIO_MAX_MSG_CACHE 128
 
+/* Most queued messages sent to a client in one writev() */
+#define STDIO_MAX_WRITEV 64
+
 struct io_buf {
 	int ref_count;
 	uint32_t length;
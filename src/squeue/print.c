@@ -484,6 +484,73 @@ job_format_add_function(List list, int width, bool right, char *suffix,
 	return SLURM_SUCCESS;
 }
 
+/* Job record field groups (JOB_FIELD_*) used by print functions, the
+ * others use only fields which are always reported */
+static struct {
+	int (*function) (job_info_t *, int, bool, char*);
+	uint32_t fields;
+} job_format_fields[] = {
+	{ _print_job_admin_comment,		JOB_FIELD_TEXT },
+	{ _print_job_alloc_nodes,		JOB_FIELD_NODES },
+	{ _print_job_batch_host,		JOB_FIELD_NODES },
+	{ _print_job_burst_buffer,		JOB_FIELD_TEXT },
+	{ _print_job_burst_buffer_state,	JOB_FIELD_TEXT },
+	{ _print_job_cluster_features,		JOB_FIELD_DETAILS },
+	{ _print_job_command,			JOB_FIELD_DETAILS },
+	{ _print_job_comment,			JOB_FIELD_TEXT },
+	{ _print_job_dependency,		JOB_FIELD_DETAILS },
+	{ _print_job_exc_nodes,			JOB_FIELD_DETAILS },
+	{ _print_job_exc_node_inx,		JOB_FIELD_DETAILS },
+	{ _print_job_features,			JOB_FIELD_DETAILS },
+	{ _print_job_fed_origin,		JOB_FIELD_FED },
+	{ _print_job_fed_origin_raw,		JOB_FIELD_FED },
+	{ _print_job_fed_siblings_active,	JOB_FIELD_FED },
+	{ _print_job_fed_siblings_active_raw,	JOB_FIELD_FED },
+	{ _print_job_fed_siblings_viable,	JOB_FIELD_FED },
+	{ _print_job_fed_siblings_viable_raw,	JOB_FIELD_FED },
+	{ _print_job_gres,			JOB_FIELD_TRES },
+	{ _print_job_licenses,			JOB_FIELD_TEXT },
+	{ _print_job_mcs_label,			JOB_FIELD_TEXT |
+						JOB_FIELD_NODES },
+	{ _print_job_network,			JOB_FIELD_TEXT },
+	{ _print_job_node_inx,			JOB_FIELD_NODES },
+	{ _print_job_nodes,			JOB_FIELD_NODES },
+	{ _print_job_reason_list,		JOB_FIELD_NODES },
+	{ _print_job_req_nodes,			JOB_FIELD_DETAILS },
+	{ _print_job_req_node_inx,		JOB_FIELD_DETAILS },
+	{ _print_job_schednodes,		JOB_FIELD_NODES },
+	{ _print_job_std_err,			JOB_FIELD_DETAILS },
+	{ _print_job_std_in,			JOB_FIELD_DETAILS },
+	{ _print_job_std_out,			JOB_FIELD_DETAILS },
+	{ _print_job_tres,			JOB_FIELD_TRES },
+	{ _print_job_wckey,			JOB_FIELD_TEXT },
+	{ _print_job_work_dir,			JOB_FIELD_DETAILS },
+	{ NULL,					0 }
+};
+
+/* Return the job record field groups needed to print a format list */
+uint32_t job_format_get_fields(List format)
+{
+	ListIterator iter;
+	job_format_t *current;
+	uint32_t fields = 0;
+	int i;
+
+	iter = list_iterator_create(format);
+	while ((current = list_next(iter))) {
+		for (i = 0; job_format_fields[i].function; i++) {
+			if (job_format_fields[i].function ==
+			    current->function) {
+				fields |= job_format_fields[i].fields;
+				break;
+			}
+		}
+	}
+	list_iterator_destroy(iter);
+
+	return fields;
+}
+
 int _print_job_array_job_id(job_info_t * job, int width, bool right,
 			    char* suffix)
 {
@@ -83,6 +83,7 @@ int print_steps_array(job_step_info_t * steps, int size, List format);
 int job_format_add_function(List list, int width, bool right_justify,
 			    char *suffix,
 			    int (*function) (job_info_t *, int, bool, char*));
+uint32_t job_format_get_fields(List format);
 #define job_format_add_array_job_id(list,wid,right,suffix) \
 	job_format_add_function(list,wid,right,suffix,_print_job_array_job_id)
 #define job_format_add_array_task_id(list,wid,right,suffix) \
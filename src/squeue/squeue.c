@@ -163,6 +163,98 @@ _get_window_width( void )
 }
 
 
+/* Copy a list of uint32_t values into an xmalloc'ed array */
+static uint32_t *_list_to_array(List list, uint32_t *cnt)
+{
+	ListIterator iterator;
+	uint32_t *array, *value;
+	int i = 0;
+
+	*cnt = list_count(list);
+	array = xmalloc(sizeof(uint32_t) * (*cnt + 1));
+	iterator = list_iterator_create(list);
+	while ((value = list_next(iterator)))
+		array[i++] = *value;
+	list_iterator_destroy(iterator);
+
+	return array;
+}
+
+/*
+ * _load_jobs - load the jobs to be printed. Unless information from other
+ *	clusters of the federation is wanted, the controller is asked to
+ *	filter jobs on the user, account, partition and state options and to
+ *	only send the fields the output format needs. Every record is still
+ *	filtered locally, so this is purely an optimization and a controller
+ *	not supporting the request falls back to loading all jobs. The reply
+ *	to a query is never SLURM_NO_CHANGE_IN_DATA.
+ */
+static int _load_jobs(time_t update_time, job_info_msg_t **job_pptr,
+		      uint16_t show_flags)
+{
+	static bool query_failed = false;
+	job_info_query_t query;
+	ListIterator iterator;
+	squeue_job_step_t *job_step_id;
+	int error_code, i = 0;
+
+	if (query_failed || (show_flags & SHOW_FEDERATION))
+		return slurm_load_jobs(update_time, job_pptr, show_flags);
+
+	memset(&query, 0, sizeof(job_info_query_t));
+	query.show_flags = show_flags;
+	query.fields = job_format_get_fields(params.format_list);
+	if ((show_flags & SHOW_DETAIL) || params.nodes)
+		query.fields |= JOB_FIELD_NODES;
+	if (params.licenses_list)
+		query.fields |= JOB_FIELD_TEXT;
+	if (params.sort)	/* Sort keys may use any field */
+		query.fields = JOB_FIELD_ALL;
+
+	if (params.account_list)
+		query.accounts = params.accounts;
+	if (params.part_list)
+		query.partitions = params.partitions;
+	if (params.user_list) {
+		query.user_ids = _list_to_array(params.user_list,
+						&query.user_id_cnt);
+	}
+	if (params.state_list) {
+		query.states = _list_to_array(params.state_list,
+					      &query.state_cnt);
+	} else {
+		/* Same default as _filter_job() */
+		query.state_cnt = 4;
+		query.states = xmalloc(sizeof(uint32_t) * query.state_cnt);
+		query.states[0] = JOB_PENDING;
+		query.states[1] = JOB_RUNNING;
+		query.states[2] = JOB_SUSPENDED;
+		query.states[3] = JOB_COMPLETING;
+	}
+	if (params.job_list) {
+		query.job_id_cnt = list_count(params.job_list);
+		query.job_ids = xmalloc(sizeof(uint32_t) * query.job_id_cnt);
+		iterator = list_iterator_create(params.job_list);
+		while ((job_step_id = list_next(iterator)))
+			query.job_ids[i++] = job_step_id->job_id;
+		list_iterator_destroy(iterator);
+	}
+
+	error_code = slurm_load_jobs_query(&query, job_pptr);
+	if (error_code) {
+		if (params.verbose)
+			slurm_perror("slurm_load_jobs_query error");
+		query_failed = true;
+		error_code = slurm_load_jobs(update_time, job_pptr,
+					     show_flags);
+	}
+	xfree(query.job_ids);
+	xfree(query.states);
+	xfree(query.user_ids);
+
+	return error_code;
+}
+
 /* _print_job - print the specified job's information */
 static int
 _print_job ( bool clear_old )
@@ -185,6 +277,23 @@ _print_job ( bool clear_old )
 	if (params.format && strstr(params.format, "C"))
 		show_flags |= SHOW_DETAIL;
 
+	if (!params.format && !params.format_long) {
+		if (params.long_list) {
+			xstrcat(params.format,
+				"%.18i %.9P %.8j %.8u %.8T %.10M %.9l %.6D %R");
+		} else {
+			xstrcat(params.format,
+				"%.18i %.9P %.8j %.8u %.2t %.10M %.6D %R");
+		}
+	}
+
+	if (!params.format_list) {
+		if (params.format)
+			parse_format(params.format);
+		else if (params.format_long)
+			parse_long_format(params.format_long);
+	}
+
 	if (old_job_ptr) {
 		if (clear_old)
 			old_job_ptr->last_update = 0;
@@ -199,9 +308,8 @@ _print_job ( bool clear_old )
 		} else {
 			if (params.clusters)
 				show_flags |= SHOW_LOCAL;
-			error_code = slurm_load_jobs(
-				old_job_ptr->last_update,
-				&new_job_ptr, show_flags);
+			error_code = _load_jobs(old_job_ptr->last_update,
+						&new_job_ptr, show_flags);
 		}
 		if (error_code ==  SLURM_SUCCESS)
 			slurm_free_job_info_msg( old_job_ptr );
@@ -216,8 +324,8 @@ _print_job ( bool clear_old )
 		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
 						 show_flags);
 	} else {
-		error_code = slurm_load_jobs((time_t) NULL, &new_job_ptr,
-					     show_flags);
+		error_code = _load_jobs((time_t) NULL, &new_job_ptr,
+					show_flags);
 	}
 
 	if (error_code) {
@@ -234,23 +342,6 @@ _print_job ( bool clear_old )
 			new_job_ptr->record_count);
 	}
 
-	if (!params.format && !params.format_long) {
-		if (params.long_list) {
-			xstrcat(params.format,
-				"%.18i %.9P %.8j %.8u %.8T %.10M %.9l %.6D %R");
-		} else {
-			xstrcat(params.format,
-				"%.18i %.9P %.8j %.8u %.2t %.10M %.6D %R");
-		}
-	}
-
-	if (!params.format_list) {
-		if (params.format)
-			parse_format(params.format);
-		else if (params.format_long)
-			parse_long_format(params.format_long);
-	}
-
 	print_jobs_array(new_job_ptr->job_array, new_job_ptr->record_count,
 			 params.format_list) ;
 	return SLURM_SUCCESS;
@@ -1,4 +1,6 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -9,6 +11,45 @@ int bad_func()
 {
 	slurm_seterrno_ret(EINVAL);
 }
+/* Log a burst through a small asynchronous ring, errors must not be lost */
+static int _test_async(log_options_t log_opts)
+{
+	char logfile[] = "/tmp/log-test.XXXXXX";
+	char line[256];
+	int fd, n, first = 0, last_error = 0;
+	FILE *fp;
+
+	if ((fd = mkstemp(logfile)) < 0)
+		return 1;
+	close(fd);
+
+	log_opts.stderr_level = LOG_LEVEL_QUIET;
+	log_opts.logfile_level = LOG_LEVEL_DEBUG;
+	log_alter(log_opts, 0, logfile);
+	log_set_async(4096);
+	for (n = 0; n < 10000; n++)
+		debug("async message %d", n);
+	error("async error after burst");
+	log_set_async(0);
+
+	if (!(fp = fopen(logfile, "r")))
+		return 1;
+	while (fgets(line, sizeof(line), fp)) {
+		if (strstr(line, "async message 0\n"))
+			first = 1;
+		if (strstr(line, "async error after burst"))
+			last_error = 1;
+	}
+	fclose(fp);
+	unlink(logfile);
+
+	if (!first || !last_error) {
+		fprintf(stderr, "asynchronous logfile lost messages\n");
+		return 1;
+	}
+	return 0;
+}
+
 int main(int ac, char **av)
 {
 	/* test elements */
@@ -62,7 +103,8 @@ int main(int ac, char **av)
 
 	if (bad_func() < 0)
 		error("bad_func: %m");
-	return 0;
+
+	return _test_async(log_opts);
 }
 	
 
@@ -0,0 +1,186 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_interface.h"
+#include "src/common/xmalloc.h"
+
+/*
+ * Messages per second through a socket pair, sending header and body
+ * concatenated in a new buffer then received into a new allocation, as
+ * slurm_send_node_msg() and slurm_receive_msg() used to, and with the
+ * header and body in pooled buffers sent with one writev() and received
+ * into a pooled buffer. The header stands for the packed header and auth
+ * credential. Usage: msg-rate-test [message count scale in percent]
+ */
+
+#define HEAD_SIZE	256
+#define TIMEOUT		10000	/* msec */
+
+typedef struct {
+	uint32_t body_size;
+	int msg_cnt;
+} rate_case_t;
+
+static rate_case_t cases[] = {
+	{ 256,		50000 },
+	{ 16 * 1024,	20000 },
+	{ 256 * 1024,	2000 },
+	{ 1024 * 1024,	500 },
+	{ 0,		0 }
+};
+
+static char head_data[HEAD_SIZE];
+
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static int _send_copy(int fd, char *body, uint32_t body_size)
+{
+	Buf buffer = init_buf(HEAD_SIZE + body_size);
+	int rc = 0;
+
+	memcpy(get_buf_data(buffer), head_data, HEAD_SIZE);
+	memcpy(get_buf_data(buffer) + HEAD_SIZE, body, body_size);
+	set_buf_offset(buffer, HEAD_SIZE + body_size);
+	if (slurm_msg_sendto_timeout(fd, get_buf_data(buffer),
+				     get_buf_offset(buffer), 0, TIMEOUT) < 0)
+		rc = -1;
+	free_buf(buffer);
+	return rc;
+}
+
+static int _send_pool(int fd, char *body, uint32_t body_size)
+{
+	Buf head = get_pool_buf(HEAD_SIZE), body_buf = get_pool_buf(body_size);
+	struct iovec iov[2];
+	int rc = 0;
+
+	memcpy(get_buf_data(head), head_data, HEAD_SIZE);
+	set_buf_offset(head, HEAD_SIZE);
+	memcpy(get_buf_data(body_buf), body, body_size);
+	set_buf_offset(body_buf, body_size);
+	iov[0].iov_base = get_buf_data(head);
+	iov[0].iov_len  = get_buf_offset(head);
+	iov[1].iov_base = get_buf_data(body_buf);
+	iov[1].iov_len  = get_buf_offset(body_buf);
+	if (slurm_msg_sendv_timeout(fd, iov, 2, 0, TIMEOUT) < 0)
+		rc = -1;
+	put_pool_buf(head);
+	put_pool_buf(body_buf);
+	return rc;
+}
+
+static ssize_t _recv_copy(int fd)
+{
+	char *buf = NULL;
+	size_t len = 0;
+	ssize_t rc;
+
+	rc = slurm_msg_recvfrom_timeout(fd, &buf, &len, 0, TIMEOUT);
+	xfree(buf);
+	return rc;
+}
+
+static ssize_t _recv_pool(int fd, uint32_t size)
+{
+	Buf buffer = get_pool_buf(size);
+	ssize_t rc;
+
+	rc = slurm_msg_recv_buf_timeout(fd, buffer, TIMEOUT);
+	put_pool_buf(buffer);
+	return rc;
+}
+
+/* Receive msg_cnt messages in a child, RET messages per second or -1 */
+static double _run(bool pool, rate_case_t *rate_case)
+{
+	uint32_t msg_size = HEAD_SIZE + rate_case->body_size;
+	char *body, ack = 0;
+	int fds[2], i, status;
+	ssize_t len;
+	double start, rate = -1;
+	pid_t pid;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+		perror("socketpair");
+		return -1;
+	}
+	if ((pid = fork()) < 0) {
+		perror("fork");
+		return -1;
+	}
+	if (pid == 0) {
+		close(fds[0]);
+		for (i = 0; i < rate_case->msg_cnt; i++) {
+			if (pool)
+				len = _recv_pool(fds[1], msg_size);
+			else
+				len = _recv_copy(fds[1]);
+			if (len != msg_size)
+				_exit(1);
+		}
+		if (write(fds[1], &ack, 1) != 1)
+			_exit(1);
+		_exit(0);
+	}
+	close(fds[1]);
+
+	body = xmalloc(rate_case->body_size);
+	memset(body, 'x', rate_case->body_size);
+	start = _now();
+	for (i = 0; i < rate_case->msg_cnt; i++) {
+		if ((pool ? _send_pool(fds[0], body, rate_case->body_size) :
+			    _send_copy(fds[0], body, rate_case->body_size)) < 0)
+			break;
+	}
+	if ((i == rate_case->msg_cnt) && (read(fds[0], &ack, 1) == 1))
+		rate = rate_case->msg_cnt / (_now() - start);
+	close(fds[0]);
+	xfree(body);
+
+	if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) ||
+	    WEXITSTATUS(status))
+		rate = -1;
+	return rate;
+}
+
+int main(int argc, char *argv[])
+{
+	rate_case_t *rate_case;
+	double copy_rate, pool_rate;
+	int scale = 100, rc = 0;
+
+	if (argc > 1)
+		scale = MAX(atoi(argv[1]), 1);
+
+	printf("%10s %14s %14s\n", "body_size", "copy_msgs/s", "pool_msgs/s");
+	for (rate_case = cases; rate_case->body_size; rate_case++) {
+		rate_case->msg_cnt = MAX((rate_case->msg_cnt * scale) / 100, 1);
+		copy_rate = _run(false, rate_case);
+		pool_rate = _run(true, rate_case);
+		if ((copy_rate < 0) || (pool_rate < 0)) {
+			fprintf(stderr, "%u byte messages were not received\n",
+				rate_case->body_size);
+			rc = 1;
+			continue;
+		}
+		printf("%10u %14.0f %14.0f\n", rate_case->body_size,
+		       copy_rate, pool_rate);
+	}
+	return rc;
+}